@@ -28,3 +28,11 @@ else()
     # lots of warnings and all warnings as errors
     add_compile_options(-Wall -Wextra -pedantic -Werror)
 endif()
+
+if (UNIFEX_CXX_COMPILER_GCC)
+    # GCC flags coroutines that take 'std::allocator_arg, alloc'; see
+    # frame_allocator_promise in detail/coroutine_frame_allocator.hpp.
+    # Targets that define such coroutines turn the warning off themselves.
+    check_cxx_compiler_flag(-Wmismatched-new-delete
+        UNIFEX_HAS_WMISMATCHED_NEW_DELETE)
+endif()
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmark: hops onto a static_thread_pool through any_scheduler
+//
+// Schedules onto a single-threaded static_thread_pool in a loop, once
+// with the pool's own scheduler and once through any_scheduler and
+// any_scheduler_ref, and reports the cost and heap allocations per hop.
+
+#include <unifex/any_scheduler.hpp>
+#include <unifex/defer.hpp>
+#include <unifex/repeat_effect_until.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/static_thread_pool.hpp>
+#include <unifex/sync_wait.hpp>
+
+#include "allocation_counter.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+using namespace unifex;
+using unifex_test::allocation_count;
+using bench_clock = std::chrono::steady_clock;
+
+static constexpr int hops = 200'000;
+
+namespace {
+template <typename Scheduler>
+void bench(const char* label, Scheduler sched) {
+  int count = 0;
+  auto allocationsBefore = allocation_count();
+  auto t0 = bench_clock::now();
+  sync_wait(repeat_effect_until(
+      defer([&] { return schedule(sched); }),
+      [&] { return ++count == hops; }));
+  auto seconds = std::chrono::duration<double>(bench_clock::now() - t0);
+  auto allocations = allocation_count() - allocationsBefore;
+
+  std::printf(
+      "  %-28s %8.1f ns/hop  %5.2f allocations/hop\n",
+      label,
+      seconds.count() * 1e9 / hops,
+      static_cast<double>(allocations) / hops);
+}
+}  // namespace
+
+int main() {
+  static_thread_pool pool{1};
+  auto poolSched = pool.get_scheduler();
+
+  std::printf("%d hops onto a static_thread_pool:\n", hops);
+  bench("static_thread_pool::scheduler", poolSched);
+  bench("any_scheduler", any_scheduler{poolSched});
+  bench("any_scheduler_ref", any_scheduler_ref{poolSched});
+  return 0;
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmark: connect() and start() on type-erased just() senders
+//
+// Compares the concrete just() sender against any_sender_of<int>, whose
+// connect() puts the concrete operation state on the heap, against
+// any_sender_of<int> with a receiver that provides a recycling allocator
+// through get_allocator(), and against any_sender_of_inplace<64, int>,
+// which keeps the operation state inside the returned one. The erased
+// sender itself is still constructed, and heap-allocated, in every
+// iteration, so only the operation state's allocation differs.
+
+#include <unifex/any_sender_of.hpp>
+#include <unifex/get_allocator.hpp>
+#include <unifex/just.hpp>
+#include <unifex/receiver_concepts.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <exception>
+#include <new>
+#include <utility>
+
+using namespace unifex;
+using bench_clock = std::chrono::steady_clock;
+
+static constexpr int iterations = 2'000'000;
+
+namespace {
+struct sum_receiver {
+  long long* sum_;
+
+  void set_value(int value) && noexcept { *sum_ += value; }
+  void set_error(std::exception_ptr) && noexcept {}
+  void set_done() && noexcept {}
+};
+
+// Hands out the same block over and over; only one operation state is
+// alive at a time.
+struct recycling_arena {
+  alignas(std::max_align_t) std::byte block_[256];
+};
+
+template <typename T>
+struct recycling_allocator {
+  using value_type = T;
+
+  explicit recycling_allocator(recycling_arena* arena) noexcept
+    : arena_(arena) {}
+
+  template <typename U>
+  recycling_allocator(const recycling_allocator<U>& other) noexcept
+    : arena_(other.arena_) {}
+
+  T* allocate(std::size_t n) {
+    if (n * sizeof(T) > sizeof(arena_->block_)) {
+      throw std::bad_alloc{};
+    }
+    return reinterpret_cast<T*>(arena_->block_);
+  }
+
+  void deallocate(T*, std::size_t) noexcept {}
+
+  friend bool
+  operator==(const recycling_allocator& a, const recycling_allocator& b) {
+    return a.arena_ == b.arena_;
+  }
+  friend bool
+  operator!=(const recycling_allocator& a, const recycling_allocator& b) {
+    return !(a == b);
+  }
+
+  recycling_arena* arena_;
+};
+
+struct arena_receiver : sum_receiver {
+  recycling_arena* arena_;
+
+  friend recycling_allocator<std::byte>
+  tag_invoke(tag_t<get_allocator>, const arena_receiver& r) noexcept {
+    return recycling_allocator<std::byte>{r.arena_};
+  }
+};
+
+template <typename MakeSender, typename MakeReceiver>
+void bench(const char* label, MakeSender makeSender, MakeReceiver makeReceiver) {
+  long long sum = 0;
+  auto t0 = bench_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    auto op = connect(makeSender(i), makeReceiver(&sum));
+    start(op);
+  }
+  auto seconds = std::chrono::duration<double>(bench_clock::now() - t0);
+
+  std::printf(
+      "  %-30s %7.2f ns/op  (sum %lld)\n",
+      label,
+      seconds.count() * 1e9 / iterations,
+      sum);
+}
+}  // namespace
+
+int main() {
+  recycling_arena arena;
+  auto plain = [](long long* sum) {
+    return sum_receiver{sum};
+  };
+  auto withArena = [&](long long* sum) {
+    return arena_receiver{{sum}, &arena};
+  };
+
+  std::printf("connect + start of just(i), %d iterations:\n", iterations);
+  bench("just()", [](int i) { return just(i); }, plain);
+  bench(
+      "any_sender_of",
+      [](int i) { return any_sender_of<int>{just(i)}; },
+      plain);
+  bench(
+      "any_sender_of, arena receiver",
+      [](int i) { return any_sender_of<int>{just(i)}; },
+      withArena);
+  bench(
+      "any_sender_of_inplace<64>",
+      [](int i) { return any_sender_of_inplace<64, int>{just(i)}; },
+      plain);
+  return 0;
+}
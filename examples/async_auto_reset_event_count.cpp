@@ -13,17 +13,42 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+
+// Counts the elements of an async_auto_reset_event stream, then benchmarks
+// the mutex-based event against the lock-free v2::async_auto_reset_event.
+//
+// Ping-pong (wakeup latency):
+//   two events, two consumers on different threads; each consumer sets
+//   the other event for every element it receives, so every set() finds
+//   a parked next() and has to wake it.
+//
+// Contention (set() throughput):
+//   N producer threads call set() in a tight loop while one consumer
+//   drains the stream; most set() calls find the event already set and
+//   coalesce.
+
 #include <unifex/async_auto_reset_event.hpp>
 #include <unifex/reduce_stream.hpp>
 #include <unifex/sync_wait.hpp>
 #include <unifex/then.hpp>
+#include <unifex/v2/async_auto_reset_event.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <cstdio>
+#include <thread>
+#include <vector>
 
 using namespace unifex;
+using bench_clock = std::chrono::steady_clock;
 
-int main() {
-  async_auto_reset_event evt{true};
+namespace {
+
+template <typename Event>
+void count(const char* name) {
+  std::printf("%s:\n", name);
+  Event evt{true};
   sync_wait(then(
       reduce_stream(
           evt.stream(),
@@ -38,6 +63,115 @@ int main() {
             return ++count;
           }),
       [](int result) { std::printf("result %d\n", result); }));
+}
+
+template <typename Event>
+double ping_pong(int iterations) {
+  Event ping;
+  Event pong;
+
+  auto t0 = bench_clock::now();
+  std::thread listener([&] {
+    sync_wait(
+        reduce_stream(ping.stream(), 0, [&pong](int count) noexcept {
+          pong.set();
+          return count + 1;
+        }));
+  });
+
+  ping.set();
+  auto rounds = sync_wait(reduce_stream(
+      pong.stream(), 0, [&, iterations](int count) noexcept {
+        if (count + 1 < iterations) {
+          ping.set();
+        } else {
+          ping.set_done();
+          pong.set_done();
+        }
+        return count + 1;
+      }));
+  listener.join();
+  auto elapsed = std::chrono::duration<double>(bench_clock::now() - t0);
+
+  if (rounds.value_or(0) != iterations) {
+    std::printf("  ping-pong: unexpected round count %d\n", rounds.value_or(0));
+  }
+  return elapsed.count() * 1e9 / iterations;
+}
+
+struct contention_result {
+  double setNs;
+  double elementsPerSecond;
+};
+
+template <typename Event>
+contention_result contention(int producers, std::chrono::milliseconds duration) {
+  Event evt;
+  std::atomic<bool> stop{false};
+  std::vector<std::uint64_t> sets(producers, 0);
+  std::vector<std::thread> threads;
+
+  for (int i = 0; i < producers; ++i) {
+    threads.emplace_back([&, i] {
+      std::uint64_t n = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        evt.set();
+        ++n;
+      }
+      sets[i] = n;
+    });
+  }
+  std::thread timer([&] {
+    std::this_thread::sleep_for(duration);
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& t : threads) {
+      t.join();
+    }
+    evt.set_done();
+  });
+
+  auto t0 = bench_clock::now();
+  auto elements = sync_wait(reduce_stream(
+      evt.stream(), std::uint64_t{0}, [](std::uint64_t count) noexcept {
+        return count + 1;
+      }));
+  auto elapsed = std::chrono::duration<double>(bench_clock::now() - t0);
+  timer.join();
+
+  std::uint64_t totalSets = 0;
+  for (auto n : sets) {
+    totalSets += n;
+  }
+  return {
+      duration.count() * 1e6 * producers / static_cast<double>(totalSets),
+      static_cast<double>(elements.value_or(0)) / elapsed.count()};
+}
+
+template <typename Event>
+void bench(const char* name) {
+  constexpr int iterations = 20'000;
+  std::printf(
+      "%-4s ping-pong:           %8.1f ns/round trip\n",
+      name,
+      ping_pong<Event>(iterations));
+  for (int producers : {1, 4}) {
+    auto r = contention<Event>(producers, std::chrono::milliseconds(200));
+    std::printf(
+        "%-4s %d producer(s):       %8.1f ns/set, %10.0f elements/s\n",
+        name,
+        producers,
+        r.setNs,
+        r.elementsPerSecond);
+  }
+}
+
+}  // namespace
+
+int main() {
+  count<async_auto_reset_event>("v1");
+  count<v2::async_auto_reset_event>("v2");
 
+  bench<async_auto_reset_event>("v1");
+  bench<v2::async_auto_reset_event>("v2");
   return 0;
 }
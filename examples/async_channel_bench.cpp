@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmark: v2::async_channel MPMC throughput
+//
+// 4 producers and 4 consumers run on a 4-thread static_thread_pool and
+// pass ints through one bounded queue.  Each producer sends n values
+// and each consumer receives n values.
+//
+// async_channel is compared against the ad-hoc alternative: a
+// std::deque guarded by v2::async_mutex, bounded by a pair of
+// v2::async_semaphores counting free slots and queued items.
+//
+// ns/item is wall time over the total number of values passed.
+
+#include <unifex/defer.hpp>
+#include <unifex/let_value.hpp>
+#include <unifex/on.hpp>
+#include <unifex/repeat_effect_until.hpp>
+#include <unifex/static_thread_pool.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/then.hpp>
+#include <unifex/v2/async_channel.hpp>
+#include <unifex/v2/async_mutex.hpp>
+#include <unifex/v2/async_semaphore.hpp>
+#include <unifex/when_all.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+
+using namespace unifex;
+using bench_clock = std::chrono::steady_clock;
+
+// ---- Queues under test ----------------------------------------------------
+
+struct channel_queue {
+  explicit channel_queue(std::size_t capacity) : channel_(capacity) {}
+
+  auto send(int value) { return channel_.async_send(value); }
+  auto receive() { return channel_.async_receive(); }
+
+  v2::async_channel<int> channel_;
+};
+
+struct mutex_queue {
+  explicit mutex_queue(std::size_t capacity) : space_(capacity) {}
+
+  auto send(int value) {
+    return space_.async_acquire() | let_value([this, value] {
+             return mutex_.async_lock() | then([this, value]() noexcept {
+                      items_.push_back(value);
+                      mutex_.unlock();
+                      ready_.release();
+                    });
+           });
+  }
+
+  auto receive() {
+    return ready_.async_acquire() | let_value([this] {
+             return mutex_.async_lock() | then([this]() noexcept {
+                      int value = items_.front();
+                      items_.pop_front();
+                      mutex_.unlock();
+                      space_.release();
+                      return value;
+                    });
+           });
+  }
+
+  v2::async_semaphore space_;
+  v2::async_semaphore ready_{0};
+  v2::async_mutex mutex_;
+  std::deque<int> items_;
+};
+
+// Runs body() n times in a row.
+template <typename Body>
+auto loop(int n, Body body) {
+  return repeat_effect_until(
+      defer(std::move(body)), [n, i = 0]() mutable { return ++i >= n; });
+}
+
+// ---- Workload -------------------------------------------------------------
+
+template <typename Queue, typename Scheduler>
+auto producer(Queue& q, Scheduler sched, int n) {
+  return on(sched, loop(n, [&q] { return q.send(1); }));
+}
+
+template <typename Queue, typename Scheduler>
+auto consumer(Queue& q, Scheduler sched, std::atomic<long>& sum, int n) {
+  return on(sched, loop(n, [&q, &sum] {
+              return q.receive() | then([&sum](int value) noexcept {
+                       sum.fetch_add(value, std::memory_order_relaxed);
+                     });
+            }));
+}
+
+template <typename Queue>
+void run_mpmc(static_thread_pool& pool, std::size_t capacity, int n) {
+  Queue q{capacity};
+  std::atomic<long> sum{0};
+  auto s = pool.get_scheduler();
+  sync_wait(when_all(
+      when_all(
+          producer(q, s, n),
+          producer(q, s, n),
+          producer(q, s, n),
+          producer(q, s, n)),
+      when_all(
+          consumer(q, s, sum, n),
+          consumer(q, s, sum, n),
+          consumer(q, s, sum, n),
+          consumer(q, s, sum, n))));
+  long expected = 4L * n;
+  if (sum.load() != expected) {
+    std::printf("error: lost values, %ld != %ld\n", sum.load(), expected);
+  }
+}
+
+// ---- Time-bounded benchmarking -------------------------------------------
+//
+// Same scheme as async_manual_reset_event_bench.cpp: run fixed-size
+// batches until the target duration is reached.
+
+static constexpr auto bench_duration = std::chrono::seconds(1);
+static constexpr int batch = 1000;
+
+template <typename Fn>
+void bench(const char* label, Fn fn, int itemsPerIter) {
+  long total = 0;
+  auto t0 = bench_clock::now();
+  bench_clock::duration elapsed;
+
+  do {
+    fn(batch);
+    total += batch;
+    elapsed = bench_clock::now() - t0;
+  } while (elapsed < bench_duration);
+
+  auto elapsed_ns = static_cast<double>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+
+  std::printf(
+      "  %-26s %8ld iters  %8.0f ns/item\n",
+      label,
+      total,
+      elapsed_ns / (static_cast<double>(total) * itemsPerIter));
+}
+
+int main() {
+  static_thread_pool pool{4};
+
+  std::printf("MPMC (4 producers, 4 consumers, 4 pool threads):\n");
+  for (std::size_t capacity : {1, 16, 256}) {
+    char label[48];
+    std::snprintf(label, sizeof(label), "async_channel(%zu)", capacity);
+    bench(
+        label,
+        [&](int n) { run_mpmc<channel_queue>(pool, capacity, n); },
+        4);
+    std::snprintf(label, sizeof(label), "mutex+deque(%zu)", capacity);
+    bench(
+        label, [&](int n) { run_mpmc<mutex_queue>(pool, capacity, n); }, 4);
+  }
+
+  return 0;
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// A streaming "key=value" line parser written as a pair of async_generators:
+// one cuts the input into fixed-size chunks, the other reassembles lines
+// across chunk boundaries and yields one record per line. Records are yielded
+// by reference and reuse the same line buffer, so once the buffer has grown
+// to the longest line, parsing allocates nothing per record.
+
+#include <unifex/coroutine.hpp>
+
+#if !UNIFEX_NO_COROUTINES
+
+#  include <unifex/async_generator.hpp>
+#  include <unifex/done_as_optional.hpp>
+#  include <unifex/just.hpp>
+#  include <unifex/let_done.hpp>
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/task.hpp>
+#  include <unifex/then.hpp>
+
+#  include <chrono>
+#  include <cstdio>
+#  include <string>
+#  include <string_view>
+
+using namespace unifex;
+using bench_clock = std::chrono::steady_clock;
+
+namespace {
+struct record {
+  std::string_view key_;
+  long value_ = 0;
+};
+
+template <typename Stream>
+auto next_or_null(Stream& stream) {
+  // Keeps yielded values by reference instead of copying them into the
+  // std::optional.
+  return done_as_optional(
+      then(next(stream), [](auto& value) noexcept { return &value; }));
+}
+
+template <typename Stream>
+auto cleanup_as_void(Stream& stream) {
+  return let_done(cleanup(stream), [] { return just(); });
+}
+
+async_generator<const std::string_view>
+chunks(std::string_view input, std::size_t chunkSize) {
+  while (!input.empty()) {
+    co_yield input.substr(0, chunkSize);
+    input.remove_prefix(std::min(chunkSize, input.size()));
+  }
+}
+
+bool parse_line(std::string_view line, record& out) noexcept {
+  auto eq = line.find('=');
+  if (eq == std::string_view::npos) {
+    return false;
+  }
+  out.key_ = line.substr(0, eq);
+  out.value_ = 0;
+  for (char c : line.substr(eq + 1)) {
+    out.value_ = out.value_ * 10 + (c - '0');
+  }
+  return true;
+}
+
+async_generator<const record>
+records(async_generator<const std::string_view> input) {
+  std::string line;
+  record current;
+  while (auto chunk = co_await next_or_null(input)) {
+    std::string_view rest = **chunk;
+    for (auto eol = rest.find('\n'); eol != std::string_view::npos;
+         eol = rest.find('\n')) {
+      line.append(rest.substr(0, eol));
+      rest.remove_prefix(eol + 1);
+      if (parse_line(line, current)) {
+        co_yield current;
+      }
+      line.clear();
+    }
+    line.append(rest);
+  }
+  co_await cleanup_as_void(input);
+  if (parse_line(line, current)) {
+    co_yield current;
+  }
+}
+
+task<long> sum_values(std::string_view input, std::size_t chunkSize) {
+  auto parsed = records(chunks(input, chunkSize));
+  long total = 0;
+  while (auto r = co_await next_or_null(parsed)) {
+    total += (*r)->value_;
+  }
+  co_await cleanup_as_void(parsed);
+  co_return total;
+}
+}  // namespace
+
+int main() {
+  constexpr int lines = 200'000;
+  std::string input;
+  long expected = 0;
+  for (int i = 0; i < lines; ++i) {
+    input += "key" + std::to_string(i % 100) + "=" + std::to_string(i) + "\n";
+    expected += i;
+  }
+  input.pop_back();  // the last line has no terminating newline
+
+  for (std::size_t chunkSize : {7u, 64u, 4096u}) {
+    auto t0 = bench_clock::now();
+    long total = sync_wait(sum_values(input, chunkSize)).value();
+    auto seconds = std::chrono::duration<double>(bench_clock::now() - t0);
+    std::printf(
+        "%5zu-byte chunks: sum %ld (%s), %.2f ns/record\n",
+        chunkSize,
+        total,
+        total == expected ? "ok" : "MISMATCH",
+        seconds.count() * 1e9 / lines);
+    if (total != expected) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+#else  // UNIFEX_NO_COROUTINES
+
+#  include <cstdio>
+
+int main() {
+  std::printf(
+      "This test only supported for compilers that support coroutines\n");
+  return 0;
+}
+
+#endif  // UNIFEX_NO_COROUTINES
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmark: v2::async_mutex barging vs. handoff fairness
+//
+// 4 async workers, each pinned to its own thread, loop
+// async_lock -> short critical section -> unlock, recording how long
+// every async_lock() took to complete.  2 plain threads hammer
+// try_lock()/unlock() alongside them; these are the lock attempts that
+// can barge ahead of queued waiters.
+//
+// Reports total throughput (critical sections per second, async and
+// try_lock together) and the p50/p99/max async_lock() wait.
+
+#include <unifex/defer.hpp>
+#include <unifex/repeat_effect_until.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/single_thread_context.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/then.hpp>
+#include <unifex/v2/async_mutex.hpp>
+#include <unifex/when_all.hpp>
+#include <unifex/with_query_value.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace unifex;
+using bench_clock = std::chrono::steady_clock;
+
+static constexpr int async_workers = 4;
+static constexpr int barging_threads = 2;
+static constexpr int iterations = 20'000;
+
+// A few hundred nanoseconds of work inside the lock.
+static void critical_section(std::uint64_t& state) noexcept {
+  for (int i = 0; i < 64; ++i) {
+    state = state * 6364136223846793005u + 1442695040888963407u;
+  }
+}
+
+template <typename Scheduler>
+auto async_worker(
+    v2::async_mutex& mutex,
+    Scheduler sched,
+    std::uint64_t& state,
+    std::vector<std::int64_t>& waits) {
+  return repeat_effect_until(
+      defer([&mutex, &state, &waits, sched] {
+        auto t0 = bench_clock::now();
+        return with_query_value(mutex.async_lock(), get_scheduler, sched) |
+            then([&mutex, &state, &waits, t0]() noexcept {
+                 waits.push_back(
+                     std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         bench_clock::now() - t0)
+                         .count());
+                 critical_section(state);
+                 mutex.unlock();
+               });
+      }),
+      [i = 0]() mutable { return ++i >= iterations; });
+}
+
+void run(const char* label, v2::async_mutex::fairness fairness) {
+  v2::async_mutex mutex{fairness};
+  std::uint64_t state = 0;
+  std::vector<std::int64_t> waits[async_workers];
+  for (auto& w : waits) {
+    w.reserve(iterations);
+  }
+
+  std::atomic<bool> done{false};
+  std::atomic<std::uint64_t> barged{0};
+  std::vector<std::thread> bargers;
+
+  single_thread_context ctx[async_workers];
+
+  auto t0 = bench_clock::now();
+  for (int i = 0; i < barging_threads; ++i) {
+    bargers.emplace_back([&] {
+      std::uint64_t n = 0;
+      while (!done.load(std::memory_order_relaxed)) {
+        if (mutex.try_lock()) {
+          critical_section(state);
+          mutex.unlock();
+          ++n;
+        }
+        std::this_thread::yield();
+      }
+      barged += n;
+    });
+  }
+
+  sync_wait(when_all(
+      async_worker(mutex, ctx[0].get_scheduler(), state, waits[0]),
+      async_worker(mutex, ctx[1].get_scheduler(), state, waits[1]),
+      async_worker(mutex, ctx[2].get_scheduler(), state, waits[2]),
+      async_worker(mutex, ctx[3].get_scheduler(), state, waits[3])));
+
+  done = true;
+  for (auto& t : bargers) {
+    t.join();
+  }
+  auto elapsed = std::chrono::duration<double>(bench_clock::now() - t0);
+
+  std::vector<std::int64_t> all;
+  for (auto& w : waits) {
+    all.insert(all.end(), w.begin(), w.end());
+  }
+  std::sort(all.begin(), all.end());
+  auto percentile = [&](double p) {
+    return static_cast<double>(all[static_cast<std::size_t>(
+               p * static_cast<double>(all.size() - 1))]) /
+        1000.0;
+  };
+
+  auto sections = static_cast<double>(all.size() + barged.load());
+  std::printf(
+      "  %-8s %10.0f sections/s  (%6.1f%% try_lock)  "
+      "wait p50 %8.1f us  p99 %8.1f us  max %9.1f us\n",
+      label,
+      sections / elapsed.count(),
+      100.0 * static_cast<double>(barged.load()) / sections,
+      percentile(0.5),
+      percentile(0.99),
+      percentile(1.0));
+}
+
+int main() {
+  std::printf(
+      "%d async workers x %d locks, %d try_lock threads:\n",
+      async_workers,
+      iterations,
+      barging_threads);
+  for (int round = 0; round < 2; ++round) {
+    run("barging", v2::async_mutex::fairness::barging);
+    run("handoff", v2::async_mutex::fairness::handoff);
+  }
+  return 0;
+}
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmark: v2::async_semaphore and v2::async_shared_mutex
+//
+// Mutual exclusion (4 workers):
+//   each worker, pinned to its own thread, loops
+//   acquire -> bump a counter -> release.  A one-unit semaphore and
+//   an async_shared_mutex used exclusively are compared against
+//   v2::async_mutex doing the same.
+//
+// Bounded concurrency (8 workers, limit 1/2/4):
+//   the "at most N requests in flight to a backend" pattern.  Each
+//   worker hops to its own thread while holding a unit, so units are
+//   held across a reschedule and waiters really queue up.
+//
+// Read-mostly (4 readers + 1 writer):
+//   async_shared_mutex against v2::async_mutex, which serialises the
+//   readers too.  Critical sections hop threads, as above.
+//
+// Iterations are per worker; ns/iter is wall time over the total
+// number of critical sections entered.
+
+#include <unifex/defer.hpp>
+#include <unifex/let_value.hpp>
+#include <unifex/repeat_effect_until.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/single_thread_context.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/then.hpp>
+#include <unifex/v2/async_mutex.hpp>
+#include <unifex/v2/async_semaphore.hpp>
+#include <unifex/v2/async_shared_mutex.hpp>
+#include <unifex/when_all.hpp>
+#include <unifex/with_query_value.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+using namespace unifex;
+using bench_clock = std::chrono::steady_clock;
+
+// ---- Primitives under test ------------------------------------------------
+//
+// Each adaptor exposes lock()/unlock() and lock_shared()/unlock_shared();
+// the exclusive-only primitives map the shared flavour onto the
+// exclusive one.
+
+struct semaphore_lock {
+  explicit semaphore_lock(std::size_t limit = 1) : sem_(limit) {}
+
+  auto lock() { return sem_.async_acquire(); }
+  void unlock() { sem_.release(); }
+  auto lock_shared() { return lock(); }
+  void unlock_shared() { unlock(); }
+
+  v2::async_semaphore sem_;
+};
+
+struct mutex_lock {
+  auto lock() { return mutex_.async_lock(); }
+  void unlock() { mutex_.unlock(); }
+  auto lock_shared() { return lock(); }
+  void unlock_shared() { unlock(); }
+
+  v2::async_mutex mutex_;
+};
+
+struct shared_mutex_lock {
+  auto lock() { return mutex_.async_lock(); }
+  void unlock() { mutex_.unlock(); }
+  auto lock_shared() { return mutex_.async_lock_shared(); }
+  void unlock_shared() { mutex_.unlock_shared(); }
+
+  v2::async_shared_mutex mutex_;
+};
+
+// Runs body() n times in a row.
+template <typename Body>
+auto loop(int n, Body body) {
+  return repeat_effect_until(
+      defer(std::move(body)), [n, i = 0]() mutable { return ++i >= n; });
+}
+
+// Lock completions are rescheduled onto the scheduler of the receiver,
+// so pin each worker to its thread.
+template <typename Sender, typename Scheduler>
+auto on(Sender&& sender, Scheduler sched) {
+  return with_query_value((Sender &&) sender, get_scheduler, sched);
+}
+
+// ---- Workloads ------------------------------------------------------------
+
+template <typename Lock, typename Scheduler>
+auto bump(Lock& lk, Scheduler sched, std::size_t& counter, int n) {
+  return loop(n, [&lk, &counter, sched] {
+    return on(lk.lock(), sched) | then([&lk, &counter]() noexcept {
+             ++counter;
+             lk.unlock();
+           });
+  });
+}
+
+template <typename Lock, typename Scheduler>
+auto hop(Lock& lk, Scheduler sched, int n) {
+  return loop(n, [&lk, sched] {
+    return on(lk.lock(), sched) | let_value([&lk, sched] {
+             return schedule(sched) |
+                 then([&lk]() noexcept { lk.unlock(); });
+           });
+  });
+}
+
+template <typename Lock, typename Scheduler>
+auto hop_shared(Lock& lk, Scheduler sched, int n) {
+  return loop(n, [&lk, sched] {
+    return on(lk.lock_shared(), sched) | let_value([&lk, sched] {
+             return schedule(sched) |
+                 then([&lk]() noexcept { lk.unlock_shared(); });
+           });
+  });
+}
+
+template <typename Lock>
+void run_exclusion(int n) {
+  Lock lk;
+  std::size_t counter = 0;
+  single_thread_context ctx[4];
+  sync_wait(when_all(
+      bump(lk, ctx[0].get_scheduler(), counter, n),
+      bump(lk, ctx[1].get_scheduler(), counter, n),
+      bump(lk, ctx[2].get_scheduler(), counter, n),
+      bump(lk, ctx[3].get_scheduler(), counter, n)));
+  if (counter != 4u * static_cast<std::size_t>(n)) {
+    std::printf("error: lost update, %zu != %d\n", counter, 4 * n);
+  }
+}
+
+void run_bounded(std::size_t limit, int n) {
+  semaphore_lock lk{limit};
+  single_thread_context ctx[8];
+  sync_wait(when_all(
+      when_all(
+          hop(lk, ctx[0].get_scheduler(), n),
+          hop(lk, ctx[1].get_scheduler(), n),
+          hop(lk, ctx[2].get_scheduler(), n),
+          hop(lk, ctx[3].get_scheduler(), n)),
+      when_all(
+          hop(lk, ctx[4].get_scheduler(), n),
+          hop(lk, ctx[5].get_scheduler(), n),
+          hop(lk, ctx[6].get_scheduler(), n),
+          hop(lk, ctx[7].get_scheduler(), n))));
+}
+
+template <typename Lock>
+void run_read_mostly(int n) {
+  Lock lk;
+  single_thread_context ctx[5];
+  sync_wait(when_all(
+      hop_shared(lk, ctx[0].get_scheduler(), n),
+      hop_shared(lk, ctx[1].get_scheduler(), n),
+      hop_shared(lk, ctx[2].get_scheduler(), n),
+      hop_shared(lk, ctx[3].get_scheduler(), n),
+      hop(lk, ctx[4].get_scheduler(), n / 10 + 1)));
+}
+
+// ---- Time-bounded benchmarking -------------------------------------------
+//
+// Same scheme as async_manual_reset_event_bench.cpp: run fixed-size
+// batches until the target duration is reached.
+
+static constexpr auto bench_duration = std::chrono::seconds(1);
+static constexpr int batch = 1000;
+
+template <typename Fn>
+void bench(const char* label, Fn fn, int sectionsPerIter) {
+  long total = 0;
+  auto t0 = bench_clock::now();
+  bench_clock::duration elapsed;
+
+  do {
+    fn(batch);
+    total += batch;
+    elapsed = bench_clock::now() - t0;
+  } while (elapsed < bench_duration);
+
+  auto elapsed_ns = static_cast<double>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+
+  std::printf(
+      "  %-22s %8ld iters  %8.0f ns/iter\n",
+      label,
+      total,
+      elapsed_ns / (static_cast<double>(total) * sectionsPerIter));
+}
+
+int main() {
+  std::printf("Mutual exclusion (4 workers):\n");
+  bench("async_mutex", run_exclusion<mutex_lock>, 4);
+  bench("async_semaphore(1)", run_exclusion<semaphore_lock>, 4);
+  bench("async_shared_mutex", run_exclusion<shared_mutex_lock>, 4);
+
+  std::printf("\nBounded concurrency (8 workers, hop while held):\n");
+  for (std::size_t limit : {1, 2, 4}) {
+    char label[32];
+    std::snprintf(label, sizeof(label), "async_semaphore(%zu)", limit);
+    bench(label, [limit](int n) { run_bounded(limit, n); }, 8);
+  }
+
+  std::printf("\nRead-mostly (4 readers, 1 writer, hop while held):\n");
+  bench("async_mutex", run_read_mostly<mutex_lock>, 4);
+  bench("async_shared_mutex", run_read_mostly<shared_mutex_lock>, 4);
+
+  return 0;
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Example: overlapping a latency-bound producer with a CPU-bound consumer
+//
+// Each value of the source stream takes about 1ms to arrive (a delay stands
+// in for I/O) and the consumer then spends about 1ms of CPU time on it on
+// its own thread. Without buffering the two alternate, so every value costs
+// the sum of both; buffer_stream keeps requesting values while the consumer
+// is busy, so each value costs roughly the slower of the two.
+
+#include <unifex/buffer_stream.hpp>
+#include <unifex/delay.hpp>
+#include <unifex/for_each.hpp>
+#include <unifex/range_stream.hpp>
+#include <unifex/single_thread_context.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/timed_single_thread_context.hpp>
+#include <unifex/via_stream.hpp>
+
+#include <chrono>
+#include <cstdio>
+
+using namespace unifex;
+using namespace std::chrono_literals;
+using bench_clock = std::chrono::steady_clock;
+
+static constexpr int value_count = 100;
+
+namespace {
+void busy_work() {
+  auto end = bench_clock::now() + 1ms;
+  while (bench_clock::now() < end) {
+  }
+}
+
+template <typename Stream>
+void run(const char* label, Stream&& stream) {
+  int consumed = 0;
+  auto start = bench_clock::now();
+  sync_wait(for_each((Stream &&) stream, [&](int) {
+    busy_work();
+    ++consumed;
+  }));
+  auto elapsed = std::chrono::duration<double, std::milli>(
+      bench_clock::now() - start);
+  std::printf(
+      "  %-18s %3d values in %6.1f ms (%.2f ms/value)\n",
+      label,
+      consumed,
+      elapsed.count(),
+      elapsed.count() / consumed);
+}
+}  // namespace
+
+int main() {
+  timed_single_thread_context io;
+  single_thread_context cpu;
+
+  std::printf("1ms per value to produce, 1ms per value to consume:\n");
+  run("unbuffered",
+      range_stream{0, value_count} | delay(io.get_scheduler(), 1ms) |
+          via_stream(cpu.get_scheduler()));
+  run("buffer_stream(8)",
+      range_stream{0, value_count} | delay(io.get_scheduler(), 1ms) |
+          buffer_stream(8) | via_stream(cpu.get_scheduler()));
+  return 0;
+}
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+// The HTTP server shared by http_server_io_uring_test and
+// http_server_io_epoll_test, written against the generic socket CPOs so the
+// two I/O backends can be compared on the same workload.
+
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_COROUTINES
+#  include <unifex/for_each.hpp>
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/io_concepts.hpp>
+#  include <unifex/just_done.hpp>
+#  include <unifex/on.hpp>
+#  include <unifex/scheduler_concepts.hpp>
+#  include <unifex/scope_guard.hpp>
+#  include <unifex/socket_concepts.hpp>
+#  include <unifex/span.hpp>
+#  include <unifex/spawn_detached.hpp>
+#  include <unifex/stop_when.hpp>
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/task.hpp>
+#  include <unifex/then.hpp>
+#  include <unifex/v2/async_scope.hpp>
+
+#  include <array>
+#  include <cerrno>
+#  include <chrono>
+#  include <cstdint>
+#  include <cstdio>
+#  include <cstdlib>
+#  include <string>
+#  include <string_view>
+#  include <thread>
+
+namespace http_server {
+using namespace unifex;
+using namespace std::string_view_literals;
+
+static constexpr port_t port = 8080;
+static constexpr std::size_t buffer_size = 1024;
+// payloads
+static constexpr auto divider = "\r\n\r\n"sv;
+static constexpr auto not_allowed = "HTTP/1.1 405 Method Not Allowed\r\n\r\n"sv;
+static constexpr std::string_view index =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/html\r\n\r\n"
+    "<!DOCTYPE html>\r\n"
+    "<html><head>\r\n"
+    "<title>coroutine based http:// server demo</title>\r\n"
+    "<link rel=\"icon\" type=\"image/x-icon\" "
+    "href=\"data:image/"
+    "x-icon;base64,"
+    "AAABAAEAEBACAAAAAACwAAAAFgAAACgAAAAQAAAAIAAAAAEAAQAAAAAAQAAAAAAAAAAAAAAAAg"
+    "AAAAAAAAAAAAAAD///AP//AAD//wAA778AALffAAD77wAAvfcAAP77AAD//wAA//"
+    "8AAMzDAAC7fwAAu38AAMz/AAD//wAA//8AAP//"
+    "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA"
+    "AAAAAAAAAAAAAA\">"
+    "</head><body>Hello from <code>unifex::</code></body></html>\r\n";
+
+enum class Method {
+  GET,
+  OTHER,
+};
+
+struct Request {
+  Method method{Method::OTHER};
+  std::string headers;
+  std::string body;
+};
+
+template <typename Socket>
+task<Request> parse_request(Socket& readWriteFile) {
+  std::array<char, buffer_size> buffer;
+  std::string req;
+  Request request;
+  while (auto read = co_await async_read_some_at(
+             readWriteFile,
+             0,
+             as_writable_bytes(span{buffer.data(), buffer.size()}))) {
+    if (read < 0) {
+      break;
+    }
+    req.append(buffer.data(), read);
+    if (req.size() < 3) {
+      // too small, keep going
+      continue;
+    }
+    if (req.starts_with("GET")) {
+      request.method = Method::GET;
+    } else {
+      // not supported
+      break;
+    }
+    if (auto idx = req.find(divider); idx != std::string::npos) {
+      request.headers = req.substr(0, idx);
+      break;
+    }
+    // protect from infite request
+    if (req.size() > 8 * buffer.size()) {
+      std::printf("req too big=%ld\n", req.size());
+      request.method = Method::OTHER;
+      break;
+    }
+  }
+  if (req.size() == 0) {
+    // not a valid http, cancel
+    co_await just_done();  // TODO co_yield stop()
+  }
+  co_return std::move(request);
+}
+
+template <typename Socket>
+task<void> handle(Socket readWriteFile) {
+  auto req = co_await parse_request(readWriteFile);
+  if (req.method != Method::GET) {
+    auto rsp = not_allowed;
+    std::printf("writing=%s\n", rsp.data());
+    co_await async_write_some_at(
+        readWriteFile, 0, as_bytes(span{rsp.data(), rsp.size()}));
+  } else if (req.body.empty()) {
+    auto rsp = index;
+    std::printf("writing=%s\n", rsp.data());
+    co_await async_write_some_at(
+        readWriteFile, 0, as_bytes(span{rsp.data(), rsp.size()}));
+  } else {
+    std::printf("unhandled request\n");
+    co_await just_done();
+  }
+}
+
+template <typename Scheduler>
+task<void> run(Scheduler sched) {
+  // mangle bulk_transform to support Sender returning []{}
+  v2::async_scope requests;
+  auto mainThread = co_await current_scheduler();
+  std::printf("opening port=%d\n", port);
+  co_await for_each(
+      open_listening_socket(sched, port),
+      [&mainThread, &requests](auto readWriteFile) {
+        spawn_detached(
+            on(mainThread, handle(std::move(readWriteFile))), requests);
+      });
+  co_await requests.join();
+}
+
+template <typename Scheduler>
+task<void>
+stopTrigger(std::chrono::milliseconds ms, Scheduler sched, task<void> quit) {
+  if (ms.count() > 0) {
+    co_await stop_when(
+        schedule_at(sched, now(sched) + ms) |
+            then([ms] { std::printf("Timeout after %ldms\n", ms.count()); }),
+        std::move(quit));
+  } else {
+    co_await std::move(quit);
+  }
+}
+
+// Runs the server on a fresh 'Context' until the timeout given on the
+// command line elapses or the task returned by 'quit(context)' completes.
+template <typename Context, typename Quit>
+int main(int argc, const char** argv, Quit quit) {
+  auto usage = [&]() noexcept {
+    std::printf(
+        "usage: %s [TIMEOUT_MS (quit after TIMEOUT_MS, default 1000, 0 means "
+        "infinity)]\n",
+        argv[0]);
+    return 1;
+  };
+  if (argc > 2) {
+    return usage();
+  }
+  std::uint64_t timeoutMs = 1000;
+  if (argc == 2) {
+    const char* start = argv[1];
+    char* end = nullptr;
+    auto ms = std::strtoul(start, &end, 10);
+    if (end == argv[1] || errno) {
+      return usage();
+    }
+    timeoutMs = ms;
+  }
+  Context ctx;
+
+  inplace_stop_source stopSource;
+  std::thread t{[&] {
+    ctx.run(stopSource.get_token());
+  }};
+  scope_guard stopOnExit = [&]() noexcept {
+    stopSource.request_stop();
+    t.join();
+  };
+  sync_wait(stop_when(
+      run(ctx.get_scheduler()),
+      stopTrigger(
+          std::chrono::milliseconds{timeoutMs},
+          ctx.get_scheduler(),
+          quit(ctx))));
+  return 0;
+}
+}  // namespace http_server
+
+#endif  // !UNIFEX_NO_COROUTINES
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_EPOLL && !UNIFEX_NO_COROUTINES
+#  include "http_server.hpp"
+
+#  include <unifex/linux/io_epoll_context.hpp>
+#  include <unifex/never.hpp>
+
+#  include <optional>
+#  include <system_error>
+
+#  include <unistd.h>
+
+using namespace unifex;
+using namespace unifex::linuxos;
+
+namespace {
+task<void> quit(io_epoll_context& ctx) {
+  // epoll only accepts pollable fds (ttys, pipes, sockets), so when stdin is
+  // a regular file or /dev/null rely on the timeout alone.
+  std::optional<io_epoll_context::async_reader> in;
+  try {
+    in.emplace(ctx, ::dup(STDIN_FILENO));
+  } catch (const std::system_error&) {
+  }
+  if (!in) {
+    co_await never_sender{};
+  }
+  std::array<char, http_server::buffer_size> buffer;
+  while (auto read = co_await async_read_some(
+             *in, as_writable_bytes(span{buffer.data(), buffer.size()}))) {
+    if (read > 0 && buffer[0] == 'q') {
+      std::printf("quit requested\n");
+      co_return;
+    }
+  }
+}
+}  // namespace
+
+int main(int argc, const char** argv) {
+  std::printf("hit 'q' to stop\n");
+  return http_server::main<io_epoll_context>(argc, argv, quit);
+}
+
+#else  // !UNIFEX_NO_EPOLL && !UNIFEX_NO_COROUTINES
+
+#  include <cstdio>
+int main() {
+  printf("epoll / coroutines support not found\n");
+  return 0;
+}
+
+#endif  // !UNIFEX_NO_EPOLL && !UNIFEX_NO_COROUTINES
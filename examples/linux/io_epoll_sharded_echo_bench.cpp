@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmark: loopback echo server on sharded_io_epoll_context
+//
+// For each shard count, every shard listens on the same port through an
+// SO_REUSEPORT group and echoes whatever its accepted connections send.
+// A separate client context opens a fixed number of connections, each doing
+// sequential request/response round trips, and the aggregate round trips
+// per second are reported together with how the kernel spread the
+// connections across the shards.
+//
+// Note that the clients share the machine with the server, so on hosts with
+// few cores the numbers mostly measure per-request overhead, not scaling.
+
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_EPOLL && !UNIFEX_NO_EXCEPTIONS
+
+#  include <unifex/async_scope.hpp>
+#  include <unifex/defer.hpp>
+#  include <unifex/for_each.hpp>
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/just.hpp>
+#  include <unifex/let_error.hpp>
+#  include <unifex/let_value.hpp>
+#  include <unifex/let_value_with.hpp>
+#  include <unifex/linux/io_epoll_context.hpp>
+#  include <unifex/linux/sharded_io_epoll_context.hpp>
+#  include <unifex/repeat_effect_until.hpp>
+#  include <unifex/scope_guard.hpp>
+#  include <unifex/socket_concepts.hpp>
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/then.hpp>
+#  include <unifex/when_all_range.hpp>
+
+#  include <array>
+#  include <atomic>
+#  include <chrono>
+#  include <csignal>
+#  include <cstdio>
+#  include <memory>
+#  include <thread>
+#  include <vector>
+
+#  include <netinet/in.h>
+
+using namespace unifex;
+using namespace unifex::linuxos;
+using bench_clock = std::chrono::steady_clock;
+using async_socket = io_epoll_context::async_socket;
+
+static constexpr std::size_t message_size = 64;
+static constexpr std::size_t connection_count = 32;
+static constexpr std::size_t requests_per_connection = 500;
+
+namespace {
+struct connection {
+  explicit connection(async_socket socket) : socket_(std::move(socket)) {}
+
+  async_socket socket_;
+  std::array<std::byte, message_size> buffer_{};
+  bool closed_ = false;
+};
+
+// Echo until the peer closes. Errors (e.g. ECONNRESET) end the connection.
+auto echo(async_socket socket) {
+  auto c = std::make_shared<connection>(std::move(socket));
+  return repeat_effect_until(
+             defer([c] {
+               return async_read_some(c->socket_, span{c->buffer_}) |
+                   let_value([c](ssize_t bytesRead) {
+                        c->closed_ = bytesRead <= 0;
+                        std::size_t n = c->closed_ ? 0 : bytesRead;
+                        return async_write_some(
+                            c->socket_, as_bytes(span{c->buffer_.data(), n}));
+                      }) |
+                   then([](ssize_t) noexcept {});
+             }),
+             [c]() noexcept { return c->closed_; }) |
+      let_error([](auto&&) noexcept { return just(); });
+}
+
+struct client_state {
+  std::array<std::byte, message_size> request_{};
+  std::array<std::byte, message_size> response_{};
+  std::size_t received_ = 0;
+  std::size_t completed_ = 0;
+};
+
+// Connect, then send one message at a time and wait for all of its echo.
+auto ping(io_epoll_context::scheduler s, const sockaddr_in6& address) {
+  return let_value(
+      async_connect(
+          s,
+          reinterpret_cast<const sockaddr*>(&address),
+          socklen_t(sizeof(address))),
+      [](async_socket& socket) {
+        return let_value_with(
+            [] { return client_state{}; },
+            [&socket](client_state& st) {
+              auto receive = [&socket, &st] {
+                return async_read_some(
+                           socket,
+                           span{
+                               st.response_.data() + st.received_,
+                               message_size - st.received_}) |
+                    then([&st](ssize_t bytesRead) {
+                         if (bytesRead <= 0) {
+                           throw std::runtime_error{"server hung up"};
+                         }
+                         st.received_ += bytesRead;
+                       });
+              };
+              return repeat_effect_until(
+                  defer([&socket, &st, receive] {
+                    st.received_ = 0;
+                    auto request = as_bytes(span{st.request_});
+                    return async_write_some(socket, request) |
+                        let_value([&st, receive](ssize_t) {
+                               return repeat_effect_until(
+                                   defer(receive), [&st]() noexcept {
+                                     return st.received_ == message_size;
+                                   });
+                             }) |
+                        then([&st]() noexcept { ++st.completed_; });
+                  }),
+                  [&st]() noexcept {
+                    return st.completed_ == requests_per_connection;
+                  });
+            });
+      });
+}
+
+void bench(std::size_t shardCount, io_epoll_context::scheduler clients) {
+  sharded_io_epoll_context server{shardCount};
+  auto listeners = server.open_listening_sockets(0);
+
+  sockaddr_in6 address = {};
+  address.sin6_family = AF_INET6;
+  address.sin6_port = htons(listeners[0].port());
+  address.sin6_addr = in6addr_loopback;
+
+  auto accepted = std::make_unique<std::atomic<std::size_t>[]>(shardCount);
+  async_scope scope;
+  for (std::size_t i = 0; i < shardCount; ++i) {
+    scope.detached_spawn(
+        for_each(
+            std::move(listeners[i]),
+            [&scope, &accepted, i](async_socket socket) {
+              ++accepted[i];
+              scope.detached_spawn(echo(std::move(socket)));
+            }) |
+        let_error([](auto&&) noexcept { return just(); }));
+  }
+  scope_guard stopServer = [&]() noexcept {
+    sync_wait(scope.cleanup());
+  };
+
+  std::vector<decltype(ping(clients, address))> pings;
+  for (std::size_t i = 0; i < connection_count; ++i) {
+    pings.push_back(ping(clients, address));
+  }
+
+  auto t0 = bench_clock::now();
+  sync_wait(when_all_range(std::move(pings)));
+  auto elapsed = bench_clock::now() - t0;
+
+  auto seconds = std::chrono::duration<double>(elapsed).count();
+  auto requests = connection_count * requests_per_connection;
+  std::printf(
+      "  shards=%zu  %9.0f req/s  accepted per shard:",
+      shardCount,
+      static_cast<double>(requests) / seconds);
+  for (std::size_t i = 0; i < shardCount; ++i) {
+    std::printf(" %zu", accepted[i].load());
+  }
+  std::printf("\n");
+}
+}  // namespace
+
+int main() {
+  // Writing to a connection the peer already closed must fail with EPIPE,
+  // not kill the process.
+  std::signal(SIGPIPE, SIG_IGN);
+
+  io_epoll_context clientContext;
+  inplace_stop_source stopSource;
+  std::thread t{[&] {
+    clientContext.run(stopSource.get_token());
+  }};
+  scope_guard stopOnExit = [&]() noexcept {
+    stopSource.request_stop();
+    t.join();
+  };
+
+  std::printf(
+      "Loopback echo, %zu connections x %zu round trips of %zu bytes:\n",
+      connection_count,
+      requests_per_connection,
+      message_size);
+  try {
+    for (std::size_t shards : {1, 2, 4}) {
+      bench(shards, clientContext.get_scheduler());
+    }
+  } catch (const std::exception& ex) {
+    std::printf("error: %s\n", ex.what());
+  }
+  return 0;
+}
+
+#else  // !UNIFEX_NO_EPOLL && !UNIFEX_NO_EXCEPTIONS
+
+#  include <cstdio>
+int main() {
+  printf("epoll support not found\n");
+  return 0;
+}
+
+#endif  // !UNIFEX_NO_EPOLL && !UNIFEX_NO_EXCEPTIONS
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmark: timer slack on io_epoll_context and io_uring_context
+//
+// Starts a batch of timers with due times spread over a short window and
+// started in random order, so that the earliest deadline keeps moving, then
+// waits for all of them. This is repeated for several slack values.
+//
+// Reported per run: the number of voluntary context switches of the process
+// (a proxy for the number of times the I/O thread went to sleep on its OS
+// timer), the CPU time used and the worst lateness of any timer relative to
+// its due time.
+
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_EPOLL || !UNIFEX_NO_LIBURING
+
+#  include <unifex/async_scope.hpp>
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/scope_guard.hpp>
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/then.hpp>
+
+#  if !UNIFEX_NO_EPOLL
+#    include <unifex/linux/io_epoll_context.hpp>
+#  endif
+#  if !UNIFEX_NO_LIBURING
+#    include <unifex/linux/io_uring_context.hpp>
+#  endif
+
+#  include <algorithm>
+#  include <chrono>
+#  include <cstdio>
+#  include <numeric>
+#  include <random>
+#  include <thread>
+#  include <vector>
+
+#  include <sys/resource.h>
+
+using namespace unifex;
+using namespace unifex::linuxos;
+using namespace std::chrono_literals;
+
+static constexpr std::size_t timer_count = 2000;
+static constexpr auto window = 200ms;
+
+namespace {
+struct usage {
+  long contextSwitches;
+  std::chrono::microseconds cpu;
+};
+
+usage get_usage() {
+  rusage ru = {};
+  ::getrusage(RUSAGE_SELF, &ru);
+  auto toMicros = [](const timeval& tv) {
+    return std::chrono::seconds{tv.tv_sec} +
+        std::chrono::microseconds{tv.tv_usec};
+  };
+  return {ru.ru_nvcsw, toMicros(ru.ru_utime) + toMicros(ru.ru_stime)};
+}
+
+template <typename Scheduler>
+void bench(Scheduler s, monotonic_clock::duration slack) {
+  std::vector<monotonic_clock::duration> offsets(timer_count);
+  for (std::size_t i = 0; i < timer_count; ++i) {
+    offsets[i] = window * i / timer_count;
+  }
+  std::shuffle(offsets.begin(), offsets.end(), std::mt19937{42});
+
+  monotonic_clock::duration maxLate{0};
+  async_scope scope;
+  auto before = get_usage();
+  auto start = monotonic_clock::now() + 50ms;
+  for (auto offset : offsets) {
+    auto dueTime = start + offset;
+    scope.detached_spawn(
+        s.schedule_at(dueTime, slack) | then([&maxLate, dueTime] {
+          maxLate = std::max(maxLate, monotonic_clock::now() - dueTime);
+        }));
+  }
+  sync_wait(scope.complete());
+  auto after = get_usage();
+
+  std::printf(
+      "  slack %5.1f ms  %6ld context switches  %7.1f ms cpu  "
+      "%6.2f ms max late\n",
+      std::chrono::duration<double, std::milli>(slack).count(),
+      after.contextSwitches - before.contextSwitches,
+      std::chrono::duration<double, std::milli>(after.cpu - before.cpu)
+          .count(),
+      std::chrono::duration<double, std::milli>(maxLate).count());
+}
+
+template <typename Context>
+void bench_context(const char* name) {
+  Context ctx;
+  inplace_stop_source stopSource;
+  std::thread t{[&] {
+    ctx.run(stopSource.get_token());
+  }};
+  scope_guard stopOnExit = [&]() noexcept {
+    stopSource.request_stop();
+    t.join();
+  };
+
+  std::printf(
+      "%s, %zu timers over %lld ms:\n",
+      name,
+      timer_count,
+      static_cast<long long>(window.count()));
+  for (auto slack : {0us, 100us, 1000us, 10000us}) {
+    bench(ctx.get_scheduler(), slack);
+  }
+}
+}  // namespace
+
+int main() {
+#  if !UNIFEX_NO_EPOLL
+  bench_context<io_epoll_context>("io_epoll_context");
+#  endif
+#  if !UNIFEX_NO_LIBURING
+  bench_context<io_uring_context>("io_uring_context");
+#  endif
+  return 0;
+}
+
+#else  // !UNIFEX_NO_EPOLL || !UNIFEX_NO_LIBURING
+
+#  include <cstdio>
+int main() {
+  printf("neither epoll nor liburing support found\n");
+  return 0;
+}
+
+#endif  // !UNIFEX_NO_EPOLL || !UNIFEX_NO_LIBURING
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmark: buffered vs direct (O_DIRECT) sequential scan over io_uring
+//
+// Writes a scratch file in the current directory and then reads it from
+// start to end in fixed-size blocks with one read outstanding at a time,
+// once through the page cache and once bypassing it.
+//
+// Before the buffered pass the file's pages are dropped from the page cache
+// with posix_fadvise(POSIX_FADV_DONTNEED) so both passes start cold.  On
+// filesystems that do not support O_DIRECT (e.g. tmpfs) the direct pass is
+// skipped.
+
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
+
+#  include <unifex/defer.hpp>
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/linux/aligned_buffer_pool.hpp>
+#  include <unifex/linux/io_uring_context.hpp>
+#  include <unifex/repeat_effect_until.hpp>
+#  include <unifex/scope_guard.hpp>
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/then.hpp>
+
+#  include <chrono>
+#  include <cstdio>
+#  include <optional>
+#  include <system_error>
+#  include <thread>
+#  include <vector>
+
+#  include <fcntl.h>
+#  include <unistd.h>
+
+using namespace unifex;
+using namespace unifex::linuxos;
+using bench_clock = std::chrono::steady_clock;
+
+static constexpr const char* scratch_path = "io_uring_direct_io_bench.dat";
+static constexpr std::size_t file_size = 64 * 1024 * 1024;
+static constexpr std::size_t block_size = 1024 * 1024;
+
+static void write_scratch_file() {
+  int fd = ::open(scratch_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    throw std::system_error{errno, std::system_category()};
+  }
+  scope_guard closeOnExit = [fd]() noexcept {
+    ::close(fd);
+  };
+
+  std::vector<char> block(block_size, 'x');
+  for (std::size_t offset = 0; offset < file_size; offset += block_size) {
+    if (::pwrite(fd, block.data(), block.size(), offset) < 0) {
+      throw std::system_error{errno, std::system_category()};
+    }
+  }
+  ::fsync(fd);
+  ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+}
+
+template <typename File>
+std::size_t scan(File& file, span<std::byte> buffer) {
+  std::size_t offset = 0;
+  bool eof = false;
+  sync_wait(repeat_effect_until(
+      defer([&] {
+        return async_read_some_at(file, offset, buffer) |
+            then([&](ssize_t bytesRead) {
+                 offset += static_cast<std::size_t>(bytesRead);
+                 eof = bytesRead == 0;
+               });
+      }),
+      [&] { return eof || offset >= file_size; }));
+  return offset;
+}
+
+template <typename Fn>
+void bench(const char* label, Fn fn) {
+  auto t0 = bench_clock::now();
+  std::size_t bytes = fn();
+  auto elapsed = bench_clock::now() - t0;
+  auto seconds = std::chrono::duration<double>(elapsed).count();
+  std::printf(
+      "  %-8s %6zu MiB in %7.1f ms  %8.1f MiB/s\n",
+      label,
+      bytes >> 20,
+      seconds * 1000.0,
+      static_cast<double>(bytes >> 20) / seconds);
+}
+
+int main() {
+  io_uring_context ctx;
+
+  inplace_stop_source stopSource;
+  std::thread t{[&] {
+    ctx.run(stopSource.get_token());
+  }};
+  scope_guard stopOnExit = [&]() noexcept {
+    stopSource.request_stop();
+    t.join();
+    ::unlink(scratch_path);
+  };
+
+  auto scheduler = ctx.get_scheduler();
+
+  try {
+    write_scratch_file();
+
+    aligned_buffer_pool pool{block_size, 1};
+    auto buffer = pool.acquire();
+
+    std::printf(
+        "Sequential scan, %zu KiB blocks, 1 read in flight:\n",
+        block_size >> 10);
+
+    {
+      auto file = open_file_read_only(scheduler, scratch_path);
+      bench("buffered", [&] { return scan(file, buffer.bytes()); });
+    }
+
+    std::optional<io_uring_context::async_read_only_file> direct;
+    try {
+      direct.emplace(open_file_read_only_direct(scheduler, scratch_path));
+    } catch (const std::system_error& ex) {
+      std::printf("  direct   skipped: %s\n", ex.what());
+    }
+    if (direct) {
+      bench("direct", [&] { return scan(*direct, buffer.bytes()); });
+    }
+  } catch (const std::exception& ex) {
+    std::printf("error: %s\n", ex.what());
+  }
+
+  return 0;
+}
+
+#else  // !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
+
+#  include <cstdio>
+int main() {
+  printf("liburing support not found\n");
+  return 0;
+}
+
+#endif  // !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmark: sequential file scan over io_uring with read-ahead
+//
+// Writes a scratch file in the current directory and reads it from start to
+// end in fixed-size blocks, first with a loop that keeps one
+// async_read_some_at() outstanding and then with read_ahead_stream() at
+// several read-ahead depths.
+//
+// Before each pass the file's pages are dropped from the page cache with
+// posix_fadvise(POSIX_FADV_DONTNEED) so that every pass starts cold. If the
+// filesystem supports O_DIRECT the passes are repeated with direct I/O,
+// where the benefit of keeping several reads in flight is most visible.
+
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
+
+#  include <unifex/defer.hpp>
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/linux/aligned_buffer_pool.hpp>
+#  include <unifex/linux/io_uring_context.hpp>
+#  include <unifex/linux/read_ahead_stream.hpp>
+#  include <unifex/reduce_stream.hpp>
+#  include <unifex/repeat_effect_until.hpp>
+#  include <unifex/scope_guard.hpp>
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/then.hpp>
+
+#  include <chrono>
+#  include <cstdio>
+#  include <initializer_list>
+#  include <optional>
+#  include <system_error>
+#  include <thread>
+#  include <vector>
+
+#  include <fcntl.h>
+#  include <unistd.h>
+
+using namespace unifex;
+using namespace unifex::linuxos;
+using bench_clock = std::chrono::steady_clock;
+
+static constexpr const char* scratch_path = "io_uring_read_ahead_bench.dat";
+static constexpr std::size_t file_size = 64 * 1024 * 1024;
+static constexpr std::size_t block_size = 128 * 1024;
+
+static void drop_cached_pages() {
+  int fd = ::open(scratch_path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw std::system_error{errno, std::system_category()};
+  }
+  ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  ::close(fd);
+}
+
+static void write_scratch_file() {
+  int fd = ::open(scratch_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    throw std::system_error{errno, std::system_category()};
+  }
+  scope_guard closeOnExit = [fd]() noexcept {
+    ::close(fd);
+  };
+
+  std::vector<char> block(block_size, 'x');
+  for (std::size_t offset = 0; offset < file_size; offset += block_size) {
+    if (::pwrite(fd, block.data(), block.size(), offset) < 0) {
+      throw std::system_error{errno, std::system_category()};
+    }
+  }
+  ::fsync(fd);
+}
+
+template <typename File>
+std::size_t scan_one_at_a_time(File& file) {
+  aligned_buffer_pool pool{block_size, 1, 4096};
+  auto buffer = pool.acquire();
+  std::size_t offset = 0;
+  bool eof = false;
+  sync_wait(repeat_effect_until(
+      defer([&] {
+        return async_read_some_at(file, offset, buffer.bytes()) |
+            then([&](ssize_t bytesRead) {
+                 offset += static_cast<std::size_t>(bytesRead);
+                 eof = bytesRead == 0;
+               });
+      }),
+      [&] { return eof || offset >= file_size; }));
+  return offset;
+}
+
+template <typename File>
+std::size_t scan_read_ahead(File& file, std::size_t readAhead) {
+  return sync_wait(reduce_stream(
+                       read_ahead_stream(file, block_size, readAhead),
+                       std::size_t(0),
+                       [](std::size_t total, span<const std::byte> block) {
+                         return total + block.size();
+                       }))
+      .value();
+}
+
+template <typename Fn>
+void bench(const char* label, std::size_t depth, Fn fn) {
+  drop_cached_pages();
+  auto t0 = bench_clock::now();
+  std::size_t bytes = fn();
+  auto elapsed = bench_clock::now() - t0;
+  auto seconds = std::chrono::duration<double>(elapsed).count();
+  std::printf(
+      "  %-10s %2zu in flight  %6zu MiB in %7.1f ms  %8.1f MiB/s\n",
+      label,
+      depth,
+      bytes >> 20,
+      seconds * 1000.0,
+      static_cast<double>(bytes >> 20) / seconds);
+}
+
+template <typename File>
+void bench_all(const char* mode, File& file) {
+  std::printf("%s:\n", mode);
+  bench("loop", 1, [&] { return scan_one_at_a_time(file); });
+  for (std::size_t depth : {1, 4, 16}) {
+    bench("read_ahead", depth, [&] { return scan_read_ahead(file, depth); });
+  }
+}
+
+int main() {
+  io_uring_context ctx;
+
+  inplace_stop_source stopSource;
+  std::thread t{[&] {
+    ctx.run(stopSource.get_token());
+  }};
+  scope_guard stopOnExit = [&]() noexcept {
+    stopSource.request_stop();
+    t.join();
+    ::unlink(scratch_path);
+  };
+
+  auto scheduler = ctx.get_scheduler();
+
+  try {
+    write_scratch_file();
+
+    std::printf("Sequential scan, %zu KiB blocks\n", block_size >> 10);
+
+    {
+      auto file = open_file_read_only(scheduler, scratch_path);
+      bench_all("buffered", file);
+    }
+
+    std::optional<io_uring_context::async_read_only_file> direct;
+    try {
+      direct.emplace(open_file_read_only_direct(scheduler, scratch_path));
+    } catch (const std::system_error& ex) {
+      std::printf("direct: skipped: %s\n", ex.what());
+    }
+    if (direct) {
+      bench_all("direct", *direct);
+    }
+  } catch (const std::exception& ex) {
+    std::printf("error: %s\n", ex.what());
+  }
+
+  return 0;
+}
+
+#else  // !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
+
+#  include <cstdio>
+int main() {
+  printf("liburing support not found\n");
+  return 0;
+}
+
+#endif  // !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmark: io_uring_context timer reprogramming under churn
+//
+// From the I/O thread, starts one far-future timer per event loop iteration,
+// each due slightly earlier than the one before. In the 'fixed' run an even
+// earlier anchor timer is started first, so the earliest deadline and with it
+// the kernel timer never move. In the 'moving' run every new timer becomes the
+// earliest one and the kernel timer is reprogrammed once per iteration. The
+// difference between the two rates is the cost of reprogramming.
+//
+// All the timers are cancelled at the end of each run, which is timed
+// separately.
+
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
+
+#  include <unifex/async_scope.hpp>
+#  include <unifex/defer.hpp>
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/linux/io_uring_context.hpp>
+#  include <unifex/repeat_effect_until.hpp>
+#  include <unifex/scheduler_concepts.hpp>
+#  include <unifex/scope_guard.hpp>
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/then.hpp>
+
+#  include <chrono>
+#  include <cstdio>
+#  include <thread>
+
+using namespace unifex;
+using namespace unifex::linuxos;
+using namespace std::chrono_literals;
+using bench_clock = std::chrono::steady_clock;
+
+static constexpr std::size_t timer_count = 20000;
+
+namespace {
+double seconds_since(bench_clock::time_point start) {
+  return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+void bench(const char* label, io_uring_context::scheduler s, bool moving) {
+  const auto base = now(s) + 2h;
+  async_scope scope;
+  if (!moving) {
+    scope.detached_spawn(schedule_at(s, now(s) + 1h));
+  }
+  std::size_t i = 0;
+
+  auto t0 = bench_clock::now();
+  sync_wait(repeat_effect_until(
+      defer([&] {
+        return schedule(s) | then([&] {
+                 auto offset = std::chrono::microseconds(i);
+                 scope.detached_spawn(schedule_at(s, base - offset));
+                 ++i;
+               });
+      }),
+      [&]() noexcept { return i == timer_count; }));
+  auto startSeconds = seconds_since(t0);
+
+  auto t1 = bench_clock::now();
+  sync_wait(scope.cleanup());
+  auto cancelSeconds = seconds_since(t1);
+
+  std::printf(
+      "  %-7s %9.0f starts/s  %9.0f cancels/s\n",
+      label,
+      static_cast<double>(timer_count) / startSeconds,
+      static_cast<double>(timer_count) / cancelSeconds);
+}
+}  // namespace
+
+int main() {
+  io_uring_context ctx;
+  inplace_stop_source stopSource;
+  std::thread t{[&] {
+    ctx.run(stopSource.get_token());
+  }};
+  scope_guard stopOnExit = [&]() noexcept {
+    stopSource.request_stop();
+    t.join();
+  };
+
+  std::printf("%zu timers, one started per loop iteration:\n", timer_count);
+  bench("fixed", ctx.get_scheduler(), false);
+  bench("moving", ctx.get_scheduler(), true);
+  return 0;
+}
+
+#else  // !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
+
+#  include <cstdio>
+int main() {
+  printf("liburing support not found\n");
+  return 0;
+}
+
+#endif  // !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmark: reduce_stream(filter_stream(transform_stream(range_stream)))
+//
+// Runs the same transform/filter/reduce pipeline three ways:
+//  - layered: every adaptor sits on an opaque wrapper, so each one adds its
+//    own operation and receiver per value, as before fusion;
+//  - fused: the adaptors collapse into one stage chain, but the source only
+//    exposes next(), so there is still one operation per value;
+//  - fused, batched: the source is a plain range_stream, so reduce_stream
+//    runs the stage chain over whole batches in a loop.
+//
+// Synchronous streams complete inline and recurse once per operation; the
+// ranges are kept short enough for the per-value runs not to overflow the
+// stack and the reduction is repeated instead.
+
+#include <unifex/filter_stream.hpp>
+#include <unifex/range_stream.hpp>
+#include <unifex/reduce_stream.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/transform_stream.hpp>
+
+#include <chrono>
+#include <cstdio>
+
+using namespace unifex;
+using bench_clock = std::chrono::steady_clock;
+
+static constexpr int range_size = 2'000;
+static constexpr int repetitions = 500;
+
+namespace {
+// Hides the wrapped stream's type (and next_batch()) from the adaptors.
+template <typename Stream>
+struct opaque_stream {
+  Stream inner_;
+
+  friend auto tag_invoke(tag_t<next>, opaque_stream& s) {
+    return next(s.inner_);
+  }
+  friend auto tag_invoke(tag_t<cleanup>, opaque_stream& s) {
+    return cleanup(s.inner_);
+  }
+};
+
+template <typename Stream>
+opaque_stream<Stream> opaque(Stream stream) {
+  return opaque_stream<Stream>{std::move(stream)};
+}
+
+auto triple = [](int value) {
+  return value * 3;
+};
+auto isEven = [](int value) {
+  return value % 2 == 0;
+};
+auto plusOne = [](int value) {
+  return value + 1;
+};
+auto sum = [](long long state, int value) {
+  return state + value;
+};
+
+template <typename MakeStream>
+void bench(const char* label, MakeStream makeStream) {
+  long long total = 0;
+  auto t0 = bench_clock::now();
+  for (int i = 0; i < repetitions; ++i) {
+    total += *sync_wait(reduce_stream(makeStream(), 0LL, sum));
+  }
+  auto seconds = std::chrono::duration<double>(bench_clock::now() - t0);
+
+  std::printf(
+      "  %-16s %8.2f ns/value  (sum %lld)\n",
+      label,
+      seconds.count() * 1e9 / (static_cast<double>(range_size) * repetitions),
+      total);
+}
+}  // namespace
+
+int main() {
+  std::printf(
+      "transform | filter | transform | reduce, %d x %d values:\n",
+      repetitions,
+      range_size);
+  bench("layered", [] {
+    return opaque(transform_stream(
+        opaque(filter_stream(
+            opaque(transform_stream(
+                opaque(range_stream{0, range_size}), triple)),
+            isEven)),
+        plusOne));
+  });
+  bench("fused", [] {
+    return opaque(range_stream{0, range_size}) | transform_stream(triple) |
+        filter_stream(isEven) | transform_stream(plusOne);
+  });
+  bench("fused, batched", [] {
+    return range_stream{0, range_size} | transform_stream(triple) |
+        filter_stream(isEven) | transform_stream(plusOne);
+  });
+  return 0;
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmark: co_await inside a task<>
+//
+// Awaits a task<>, just() and schedule() on the inline_scheduler from a loop
+// in a task<>, each two ways:
+//  - direct: a task<> is resumed by symmetric transfer, and senders that
+//    complete inline resume the awaiting coroutine once start() returns;
+//  - opaque: the awaited object is hidden behind a sender that only exposes
+//    connect(), so it is awaited through the general path: a task<> goes
+//    through connect_awaitable() and the others resume the coroutine from
+//    within start().
+//
+// Resuming from within start() grows the stack with every iteration, so each
+// task<> only loops a few thousand times and the tasks are repeated instead.
+
+#include <unifex/coroutine.hpp>
+
+#if !UNIFEX_NO_COROUTINES
+
+#  include <unifex/inline_scheduler.hpp>
+#  include <unifex/just.hpp>
+#  include <unifex/scheduler_concepts.hpp>
+#  include <unifex/sender_concepts.hpp>
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/task.hpp>
+
+#  include <chrono>
+#  include <cstdio>
+#  include <utility>
+
+using namespace unifex;
+using bench_clock = std::chrono::steady_clock;
+
+static constexpr int iterations = 5'000;
+static constexpr int repetitions = 400;
+
+namespace {
+// Hides the wrapped sender's type and blocking kind from the coroutine.
+template <typename Sender>
+struct opaque_sender {
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = sender_value_types_t<Sender, Variant, Tuple>;
+
+  template <template <typename...> class Variant>
+  using error_types = sender_error_types_t<Sender, Variant>;
+
+  static constexpr bool sends_done = sender_traits<Sender>::sends_done;
+
+  // All of the wrapped senders complete on the awaiting coroutine's
+  // scheduler, so there is no need to transition back to it afterwards.
+  static constexpr bool is_always_scheduler_affine = true;
+
+  Sender sender_;
+
+  template <typename Receiver>
+  friend auto tag_invoke(tag_t<connect>, opaque_sender&& s, Receiver&& r) {
+    return connect(std::move(s.sender_), static_cast<Receiver&&>(r));
+  }
+};
+
+struct direct_t {
+  template <typename Sender>
+  Sender operator()(Sender&& sender) const {
+    return static_cast<Sender&&>(sender);
+  }
+};
+
+struct opaque_t {
+  template <typename Sender>
+  opaque_sender<Sender> operator()(Sender&& sender) const {
+    return opaque_sender<Sender>{static_cast<Sender&&>(sender)};
+  }
+};
+
+task<int> leaf(int value) {
+  co_return value;
+}
+
+template <typename Wrap>
+task<long long> await_tasks(Wrap wrap) {
+  long long total = 0;
+  for (int i = 0; i < iterations; ++i) {
+    total += co_await wrap(leaf(i));
+  }
+  co_return total;
+}
+
+template <typename Wrap>
+task<long long> await_just(Wrap wrap) {
+  long long total = 0;
+  for (int i = 0; i < iterations; ++i) {
+    total += co_await wrap(just(i));
+  }
+  co_return total;
+}
+
+template <typename Wrap>
+task<long long> await_schedule(Wrap wrap) {
+  long long total = 0;
+  for (int i = 0; i < iterations; ++i) {
+    co_await wrap(schedule(inline_scheduler{}));
+    total += i;
+  }
+  co_return total;
+}
+
+template <typename MakeTask>
+void bench(const char* label, MakeTask makeTask) {
+  long long total = 0;
+  auto t0 = bench_clock::now();
+  for (int i = 0; i < repetitions; ++i) {
+    total += *sync_wait(makeTask());
+  }
+  auto seconds = std::chrono::duration<double>(bench_clock::now() - t0);
+
+  std::printf(
+      "  %-20s %8.2f ns/await  (sum %lld)\n",
+      label,
+      seconds.count() * 1e9 / (static_cast<double>(iterations) * repetitions),
+      total);
+}
+}  // namespace
+
+int main() {
+  std::printf("%d x %d awaits from a task<>:\n", repetitions, iterations);
+  bench("task, direct", [] { return await_tasks(direct_t{}); });
+  bench("task, opaque", [] { return await_tasks(opaque_t{}); });
+  bench("just, direct", [] { return await_just(direct_t{}); });
+  bench("just, opaque", [] { return await_just(opaque_t{}); });
+  bench("schedule, direct", [] { return await_schedule(direct_t{}); });
+  bench("schedule, opaque", [] { return await_schedule(opaque_t{}); });
+  return 0;
+}
+
+#else  // UNIFEX_NO_COROUTINES
+
+#  include <cstdio>
+
+int main() {
+  std::printf(
+      "This test only supported for compilers that support coroutines\n");
+  return 0;
+}
+
+#endif  // UNIFEX_NO_COROUTINES
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmark: coroutine frame allocation for a deep recursive task chain
+//
+// Awaits a chain of nested task<int> calls and reports the cost and the
+// global operator new calls per task call when frames come from:
+//  - std::allocator, passed as 'std::allocator_arg, alloc', which is what
+//    every frame used before the frame pool;
+//  - the default thread-local frame pool;
+//  - a caller-supplied bump allocator that is reset after each chain.
+
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_COROUTINES
+
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/task.hpp>
+
+#  include "allocation_counter.hpp"
+
+#  include <chrono>
+#  include <cstddef>
+#  include <cstdio>
+#  include <memory>
+#  include <new>
+
+using namespace unifex;
+using unifex_test::allocation_count;
+using bench_clock = std::chrono::steady_clock;
+
+static constexpr int depth = 100;
+static constexpr int repetitions = 20'000;
+
+namespace {
+struct bump_arena {
+  alignas(std::max_align_t) std::byte buffer_[256 * 1024];
+  std::size_t used_ = 0;
+};
+
+template <typename T>
+struct bump_allocator {
+  using value_type = T;
+
+  explicit bump_allocator(bump_arena* arena) noexcept : arena_(arena) {}
+
+  template <typename U>
+  bump_allocator(const bump_allocator<U>& other) noexcept
+    : arena_(other.arena_) {}
+
+  T* allocate(std::size_t n) {
+    std::size_t bytes = n * sizeof(T);
+    if (arena_->used_ + bytes > sizeof(arena_->buffer_)) {
+      throw std::bad_alloc{};
+    }
+    void* p = arena_->buffer_ + arena_->used_;
+    arena_->used_ += bytes;
+    return static_cast<T*>(p);
+  }
+
+  void deallocate(T*, std::size_t) noexcept {}
+
+  friend bool operator==(const bump_allocator& a, const bump_allocator& b) {
+    return a.arena_ == b.arena_;
+  }
+  friend bool operator!=(const bump_allocator& a, const bump_allocator& b) {
+    return !(a == b);
+  }
+
+  bump_arena* arena_;
+};
+
+task<int> sum_to(int n) {
+  if (n == 0) {
+    co_return 0;
+  }
+  co_return n + co_await sum_to(n - 1);
+}
+
+template <typename Allocator>
+task<int> sum_to(std::allocator_arg_t, Allocator alloc, int n) {
+  if (n == 0) {
+    co_return 0;
+  }
+  co_return n + co_await sum_to(std::allocator_arg, alloc, n - 1);
+}
+
+template <typename MakeTask>
+void bench(const char* label, MakeTask makeTask) {
+  long long total = 0;
+  auto allocationsBefore = allocation_count();
+  auto t0 = bench_clock::now();
+  for (int i = 0; i < repetitions; ++i) {
+    total += *sync_wait(makeTask());
+  }
+  auto seconds = std::chrono::duration<double>(bench_clock::now() - t0);
+  auto allocations = allocation_count() - allocationsBefore;
+  double calls = static_cast<double>(depth + 1) * repetitions;
+
+  std::printf(
+      "  %-14s %7.2f ns/call  %5.2f allocations/call  (sum %lld)\n",
+      label,
+      seconds.count() * 1e9 / calls,
+      static_cast<double>(allocations) / calls,
+      total);
+}
+}  // namespace
+
+int main() {
+  auto arena = std::make_unique<bump_arena>();
+
+  std::printf("%d x task chain of depth %d:\n", repetitions, depth);
+  bench("std::allocator", [] {
+    return sum_to(std::allocator_arg, std::allocator<std::byte>{}, depth);
+  });
+  bench("frame pool", [] { return sum_to(depth); });
+  bench("bump allocator", [&] {
+    arena->used_ = 0;
+    return sum_to(
+        std::allocator_arg, bump_allocator<std::byte>{arena.get()}, depth);
+  });
+  return 0;
+}
+
+#else  // UNIFEX_NO_COROUTINES
+
+#  include <cstdio>
+
+int main() {
+  std::printf(
+      "This test only supported for compilers that support coroutines\n");
+  return 0;
+}
+
+#endif  // UNIFEX_NO_COROUTINES
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmark: schedule_after + cancel throughput on timed_single_thread_context
+//
+// For each population size, starts that many schedule_after() timers, a
+// quarter of them on each of the timer wheel's four levels (delays of up
+// to 256ms, ~65s, ~4.7 hours and ~49 days), then cancels all of them. Reports the rate at which
+// timers were started and the rate at which the cancelled timers completed.
+//
+// This models request timeouts: many outstanding at once, nearly all of
+// them cancelled before they fire.
+
+#include <unifex/async_scope.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/timed_single_thread_context.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+using namespace unifex;
+using bench_clock = std::chrono::steady_clock;
+
+static void bench(std::size_t timerCount) {
+  timed_single_thread_context context;
+  auto s = context.get_scheduler();
+  async_scope scope;
+
+  // The span of each level of the wheel, in 1ms ticks.
+  constexpr std::uint64_t levelSpanMs[] = {
+      std::uint64_t{1} << 8,
+      std::uint64_t{1} << 16,
+      std::uint64_t{1} << 24,
+      std::uint64_t{1} << 32};
+  auto t0 = bench_clock::now();
+  for (std::size_t i = 0; i < timerCount; ++i) {
+    // A cheap, well-spread permutation of delays within each level.
+    std::chrono::milliseconds delay{
+        1 + (std::uint64_t{i} * 7919) % levelSpanMs[i % 4]};
+    scope.detached_spawn(schedule_after(s, delay));
+  }
+  auto t1 = bench_clock::now();
+  // Requests stop on every outstanding timer and waits for them.
+  sync_wait(scope.cleanup());
+  auto t2 = bench_clock::now();
+
+  auto rate = [&](auto elapsed) {
+    return static_cast<double>(timerCount) /
+        std::chrono::duration<double>(elapsed).count();
+  };
+  std::printf(
+      "  %8zu timers  schedule %12.0f/s  cancel %12.0f/s\n",
+      timerCount,
+      rate(t1 - t0),
+      rate(t2 - t1));
+}
+
+int main() {
+  std::printf("timed_single_thread_context schedule_after + cancel:\n");
+  for (std::size_t count : {10'000, 100'000, 1'000'000}) {
+    bench(count);
+  }
+  return 0;
+}
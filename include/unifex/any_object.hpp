@@ -68,11 +68,11 @@ struct _any_object {
   static constexpr bool can_be_type_erased_v = unifex::detail::
       supports_type_erased_cpos_v<T, detail::_destroy_cpo, CPOs...>;
 
+  // Checked where it is used rather than here so that CPOs may return
+  // types that are incomplete when the any_object is instantiated.
   struct invalid_obj
     : private detail::with_abort_tag_invoke<invalid_obj, CPOs>... {};
 
-  static_assert(can_be_type_erased_v<invalid_obj>);
-
   class type;
 };
 
@@ -219,7 +219,7 @@ public:
       // object. Just in case the move-construction below throws. So we at
       // least leave the current object in a valid state.
       if constexpr (!RequireNoexceptMove) {
-        vtable_ = vtable_holder_t::template create<invalid_obj>();
+        vtable_ = invalid_vtable();
       }
 
       auto* moveConstruct = other.vtable_->template get<
@@ -256,7 +256,7 @@ public:
     using value_type = remove_cvref_t<T>;
 
     if (!std::is_nothrow_constructible_v<value_type, T>) {
-      vtable_ = vtable_holder_t::template create<invalid_obj>();
+      vtable_ = invalid_vtable();
     }
 
     ::new (static_cast<void*>(&storage_)) value_type(static_cast<T&&>(value));
@@ -276,7 +276,7 @@ public:
     auto* destroy = vtable_->template get<detail::_destroy_cpo>();
     destroy(detail::_destroy_cpo{}, &storage_);
 
-    vtable_ = vtable_holder_t::template create<invalid_obj>();
+    vtable_ = invalid_vtable();
 
     using value_type = detail::any_heap_allocated_storage<
         remove_cvref_t<T>,
@@ -295,6 +295,11 @@ public:
   }
 
 private:
+  static vtable_holder_t invalid_vtable() noexcept {
+    static_assert(_any_object::can_be_type_erased_v<invalid_obj>);
+    return vtable_holder_t::template create<invalid_obj>();
+  }
+
   friend const vtable_holder_t& get_vtable(const type& self) noexcept {
     return self.vtable_;
   }
@@ -15,10 +15,12 @@
  */
 #pragma once
 
+#include <unifex/any_object.hpp>
 #include <unifex/any_ref.hpp>
 #include <unifex/any_sender_of.hpp>
 #include <unifex/any_unique.hpp>
 #include <unifex/receiver_concepts.hpp>
+#include <unifex/running_in_this_thread.hpp>
 #include <unifex/scheduler_concepts.hpp>
 #include <unifex/sender_concepts.hpp>
 #include <unifex/std_concepts.hpp>
@@ -65,6 +67,19 @@ inline constexpr struct _get_type_index_fn {
   }
 } _get_type_index{};
 
+inline constexpr struct _get_address_fn {
+  using type_erased_signature_t = const void*(const this_&) noexcept;
+
+  template <typename T>
+  const void* operator()(const T& x) const noexcept {
+    if constexpr (tag_invocable<_get_address_fn, const T&>) {
+      return tag_invoke(*this, x);
+    } else {
+      return &x;
+    }
+  }
+} _get_address{};
+
 inline constexpr struct _equal_to_fn {
   template(typename T, typename U)                                //
       (requires tag_invocable<_equal_to_fn, const T&, const U&>)  //
@@ -83,7 +98,7 @@ inline constexpr struct _equal_to_fn {
         noexcept(t == t),
         "Equality comparison of schedulers ought to be noexcept");
     return type_id<T>() == _get_type_index(u.impl_) &&
-        t == *static_cast<const T*>(get_object_address(u.impl_));
+        t == *static_cast<const T*>(_get_address(u.impl_));
   }
 } _equal_to{};
 
@@ -94,43 +109,71 @@ template <typename... CPOs>
 struct _schedule_and_connect_fn {
   struct type {
     using _rec_ref_t = _void_receiver_ref<CPOs...>;
-    using type_erased_signature_t =
-        _any::_operation_state(const this_&, _rec_ref_t);
+    using type_erased_signature_t = _any::_operation_state(
+        const this_&, _rec_ref_t, const _any::_op_storage&);
 
 #ifdef _MSC_VER
     // MSVC (_MSC_VER == 1927) doesn't seem to like the requires
     // clause here. Use SFINAE instead.
     template <typename Scheduler>
     std::enable_if_t<
-        is_tag_invocable_v<type, const Scheduler&, _rec_ref_t>,
+        is_tag_invocable_v<
+            type,
+            const Scheduler&,
+            _rec_ref_t,
+            const _any::_op_storage&>,
         _any::_operation_state>
-    operator()(const Scheduler& sched, _rec_ref_t rec) const {
-      return tag_invoke(*this, sched, (_rec_ref_t &&) rec);
+    operator()(
+        const Scheduler& sched,
+        _rec_ref_t rec,
+        const _any::_op_storage& storage) const {
+      return tag_invoke(*this, sched, (_rec_ref_t &&) rec, storage);
     }
 
     template <typename Scheduler>
     std::enable_if_t<
-        !is_tag_invocable_v<type, const Scheduler&, _rec_ref_t>,
+        !is_tag_invocable_v<
+            type,
+            const Scheduler&,
+            _rec_ref_t,
+            const _any::_op_storage&>,
         _any::_operation_state>
-    operator()(const Scheduler& sched, _rec_ref_t rec) const {
+    operator()(
+        const Scheduler& sched,
+        _rec_ref_t rec,
+        const _any::_op_storage& storage) const {
       return _any::_connect<type_list<CPOs...>>(
-          schedule(sched), (_rec_ref_t &&) rec);
+          schedule(sched), (_rec_ref_t &&) rec, storage);
     }
 #else
-    template(typename Scheduler)                                      //
-        (requires tag_invocable<type, const Scheduler&, _rec_ref_t>)  //
+    template(typename Scheduler)  //
+        (requires tag_invocable<
+            type,
+            const Scheduler&,
+            _rec_ref_t,
+            const _any::_op_storage&>)  //
         _any::_operation_state
-        operator()(const Scheduler& sched, _rec_ref_t rec) const {
-      return tag_invoke(*this, sched, (_rec_ref_t &&) rec);
+        operator()(
+            const Scheduler& sched,
+            _rec_ref_t rec,
+            const _any::_op_storage& storage) const {
+      return tag_invoke(*this, sched, (_rec_ref_t &&) rec, storage);
     }
 
     template(typename Scheduler)  //
-        (requires(!tag_invocable<type, const Scheduler&, _rec_ref_t>)
+        (requires(!tag_invocable<
+                  type,
+                  const Scheduler&,
+                  _rec_ref_t,
+                  const _any::_op_storage&>)
              AND scheduler<Scheduler>)  //
         _any::_operation_state
-        operator()(const Scheduler& sched, _rec_ref_t rec) const {
+        operator()(
+            const Scheduler& sched,
+            _rec_ref_t rec,
+            const _any::_op_storage& storage) const {
       return _any::_connect<type_list<CPOs...>>(
-          schedule(sched), (_rec_ref_t &&) rec);
+          schedule(sched), (_rec_ref_t &&) rec, storage);
     }
 #endif
   };
@@ -144,13 +187,23 @@ template <typename... CPOs>
 using _any_void_sender_of =
     typename _any::_with<CPOs...>::template any_sender_of<>;
 
+// Large enough for the schedule operations of the thread pool, io_uring and
+// epoll schedulers connected to an erased receiver; larger ones are
+// allocated with the receiver's allocator.
+inline constexpr std::size_t _schedule_op_inline_size = 20 * sizeof(void*);
+
+// Schedulers are usually a pointer to their context, so they are stored
+// inline and copying an any_scheduler into its schedule sender does not
+// allocate.
 template <typename... CPOs>
-using any_scheduler_impl = any_unique_t<
+using any_scheduler_impl = any_object_t<
     _schedule_and_connect<CPOs...>,
     _copy_as<any_scheduler<CPOs...>>,
     _get_type_index,
+    _get_address,
     overload<bool(const this_&, const any_scheduler<CPOs...>&) noexcept>(
-        _equal_to)>;
+        _equal_to),
+    overload<bool(const this_&) noexcept>(running_in_this_thread)>;
 
 template <typename... CPOs>
 struct _with<CPOs...>::any_scheduler {
@@ -188,22 +241,22 @@ struct _with<CPOs...>::any_scheduler {
     template(typename Receiver)  //
         (requires receiver_of<Receiver> AND(
             std::is_invocable_v<CPOs, const Receiver&>&&...))  //
-        any_operation_state_for<Receiver> connect(Receiver rec) && {
+        _any::_operation_state_for<Receiver, _schedule_op_inline_size>
+        connect(Receiver rec) && {
       any_scheduler_impl<CPOs...> const& impl = sched_.impl_;
-      return any_operation_state_for<Receiver>{
-          (Receiver &&) rec, [&impl](_void_receiver_ref<CPOs...> rec2) {
+      return _any::_operation_state_for<Receiver, _schedule_op_inline_size>{
+          (Receiver &&) rec,
+          [&impl](
+              _void_receiver_ref<CPOs...> rec2,
+              const _any::_op_storage& storage) {
             return _schedule_and_connect<CPOs...>(
-                impl, (_void_receiver_ref<CPOs...> &&) rec2);
+                impl, (_void_receiver_ref<CPOs...> &&) rec2, storage);
           }};
     }
 
   private:
     friend any_scheduler;
     _sender(const any_scheduler* sched) : sched_(*sched) {}
-    // TODO This does a dynamic allocation. Fix this by:
-    // 1. Implementing the small-object optimization in any_unique, and
-    // 2. Provide hooks so that _sender can take a strong reference on
-    //    the impl when it's dynamically allocated.
     any_scheduler sched_;
   };
 
@@ -221,6 +274,11 @@ struct _with<CPOs...>::any_scheduler {
     return !(left == right);
   }
 
+  friend bool tag_invoke(
+      tag_t<running_in_this_thread>, const any_scheduler& s) noexcept {
+    return running_in_this_thread(s.impl_);
+  }
+
 private:
   any_scheduler_impl<CPOs...> impl_;
 };
@@ -229,8 +287,10 @@ template <typename... CPOs>
 using any_scheduler_ref_impl = any_ref_t<
     _schedule_and_connect<CPOs...>,
     _get_type_index,
+    _get_address,
     overload<bool(const this_&, const any_scheduler_ref<CPOs...>&) noexcept>(
-        _equal_to)>;
+        _equal_to),
+    overload<bool(const this_&) noexcept>(running_in_this_thread)>;
 
 #if defined(__GLIBCXX__)
 template <typename>
@@ -282,12 +342,16 @@ struct _with<CPOs...>::any_scheduler_ref {
     template(typename Receiver)  //
         (requires receiver_of<Receiver> AND(
             std::is_invocable_v<CPOs, const Receiver&>&&...))  //
-        any_operation_state_for<Receiver> connect(Receiver rec) && {
+        _any::_operation_state_for<Receiver, _schedule_op_inline_size>
+        connect(Receiver rec) && {
       any_scheduler_ref_impl<CPOs...> const& impl = sched_.impl_;
-      return any_operation_state_for<Receiver>{
-          (Receiver &&) rec, [&impl](_void_receiver_ref<CPOs...> rec2) {
+      return _any::_operation_state_for<Receiver, _schedule_op_inline_size>{
+          (Receiver &&) rec,
+          [&impl](
+              _void_receiver_ref<CPOs...> rec2,
+              const _any::_op_storage& storage) {
             return _schedule_and_connect<CPOs...>(
-                impl, (_void_receiver_ref<CPOs...> &&) rec2);
+                impl, (_void_receiver_ref<CPOs...> &&) rec2, storage);
           }};
     }
 
@@ -317,6 +381,11 @@ struct _with<CPOs...>::any_scheduler_ref {
     return _equal_to(impl_, that);
   }
 
+  friend bool tag_invoke(
+      tag_t<running_in_this_thread>, const any_scheduler_ref& s) noexcept {
+    return running_in_this_thread(s.impl_);
+  }
+
 private:
   any_scheduler_ref_impl<CPOs...> impl_;
 };
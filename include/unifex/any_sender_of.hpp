@@ -17,6 +17,7 @@
 
 #include <unifex/any_ref.hpp>
 #include <unifex/any_unique.hpp>
+#include <unifex/get_allocator.hpp>
 #include <unifex/get_stop_token.hpp>
 #include <unifex/inplace_stop_token.hpp>
 #include <unifex/receiver_concepts.hpp>
@@ -25,6 +26,11 @@
 #include <unifex/type_list.hpp>
 #include <unifex/with_query_value.hpp>
 
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
 #include <unifex/detail/prologue.hpp>
 
 namespace unifex {
@@ -49,7 +55,130 @@ using any_scheduler_ref = typename _with<CPOs...>::any_scheduler_ref;
 
 namespace _any {
 
-using _operation_state = any_unique_t<overload<void(this_&) noexcept>(start)>;
+inline constexpr std::size_t _op_storage_align = alignof(std::max_align_t);
+
+// Where connecting a type-erased sender may put the concrete operation
+// state: in the outer operation state's inline buffer if it fits there,
+// otherwise in memory from the receiver's allocator.
+struct _op_storage {
+  void* buffer_;
+  std::size_t size_;
+  void* alloc_;
+  void* (*allocate_)(void* alloc, std::size_t size, std::size_t align);
+  void (*deallocate_)(
+      void* alloc, void* p, std::size_t size, std::size_t align) noexcept;
+};
+
+// Owns the concrete operation state of a connected type-erased sender.
+class _operation_state {
+  struct _vtable {
+    void (*start_)(void* op) noexcept;
+    void (*destroy_)(_operation_state& self) noexcept;
+  };
+
+  template <typename Op>
+  static void _start(void* op) noexcept {
+    unifex::start(*static_cast<Op*>(op));
+  }
+
+  template <typename Op>
+  static void _destroy(_operation_state& self) noexcept {
+    static_cast<Op*>(self.op_)->~Op();
+    if (self.deallocate_ != nullptr) {
+      self.deallocate_(self.alloc_, self.op_, sizeof(Op), alignof(Op));
+    }
+  }
+
+  template <typename Op>
+  static constexpr _vtable _vtable_for{&_start<Op>, &_destroy<Op>};
+
+public:
+  template <typename Op, typename Fn>
+  _operation_state(
+      std::in_place_type_t<Op>, Fn&& fn, const _op_storage& storage)
+    : vtable_(&_vtable_for<Op>) {
+    if constexpr (alignof(Op) <= _op_storage_align) {
+      if (sizeof(Op) <= storage.size_) {
+        op_ = ::new (storage.buffer_) Op(((Fn &&) fn)());
+        return;
+      }
+    }
+    void* p = storage.allocate_(storage.alloc_, sizeof(Op), alignof(Op));
+    UNIFEX_TRY { op_ = ::new (p) Op(((Fn &&) fn)()); }
+    UNIFEX_CATCH(...) {
+      storage.deallocate_(storage.alloc_, p, sizeof(Op), alignof(Op));
+      UNIFEX_RETHROW();
+    }
+    alloc_ = storage.alloc_;
+    deallocate_ = storage.deallocate_;
+  }
+
+  _operation_state(_operation_state&&) = delete;
+
+  ~_operation_state() { vtable_->destroy_(*this); }
+
+  friend void tag_invoke(tag_t<start>, _operation_state& self) noexcept {
+    self.vtable_->start_(self.op_);
+  }
+
+private:
+  const _vtable* vtable_;
+  void* op_ = nullptr;
+  // Only set when the operation state did not fit in the inline buffer.
+  void* alloc_ = nullptr;
+  void (*deallocate_)(
+      void* alloc, void* p, std::size_t size, std::size_t align) noexcept =
+      nullptr;
+};
+
+// Allocates memory for operation states with the receiver's allocator,
+// rebound to blocks of the inline buffer's alignment. Over-aligned
+// operation states fall back to aligned operator new.
+template <typename Allocator>
+struct _alloc_fns {
+  struct alignas(_op_storage_align) block {
+    std::byte bytes_[_op_storage_align];
+  };
+  using allocator_type =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<block>;
+  using traits = std::allocator_traits<allocator_type>;
+
+  static std::size_t blocks(std::size_t size) noexcept {
+    return (size + sizeof(block) - 1) / sizeof(block);
+  }
+
+  static void* allocate(void* alloc, std::size_t size, std::size_t align) {
+    if (align > _op_storage_align) {
+      return ::operator new(size, std::align_val_t{align});
+    }
+    return traits::allocate(
+        *static_cast<allocator_type*>(alloc), blocks(size));
+  }
+
+  static void deallocate(
+      void* alloc, void* p, std::size_t size, std::size_t align) noexcept {
+    if (align > _op_storage_align) {
+      ::operator delete(p, size, std::align_val_t{align});
+      return;
+    }
+    traits::deallocate(
+        *static_cast<allocator_type*>(alloc),
+        static_cast<block*>(p),
+        blocks(size));
+  }
+};
+
+template <std::size_t InlineSize>
+struct _op_buffer {
+  void* data() noexcept { return bytes_; }
+
+  alignas(_op_storage_align) std::byte bytes_[InlineSize];
+};
+
+template <>
+struct _op_buffer<0> {
+  void* data() noexcept { return nullptr; }
+};
 
 template <typename CPOs>
 struct _rec_ref_base;
@@ -99,28 +228,6 @@ private:
 template <typename CPOs, typename... Values>
 using _receiver_ref = typename _rec_ref<CPOs, Values...>::type;
 
-template <typename Op>
-struct _op_wrapper final {
-  struct type;
-};
-
-template <typename Op>
-struct _op_wrapper<Op>::type final {
-  template(typename Fn)                   //
-      (requires std::is_invocable_v<Fn>)  //
-      explicit type(Fn&& fn)
-    : op_(std::forward<Fn>(fn)()) {}
-
-  type(type&&) = delete;
-
-  ~type() = default;
-
-  void start() & noexcept { unifex::start(op_); }
-
-private:
-  Op op_;
-};
-
 template <typename CPOs, typename... Values>
 struct _connect_fn {
   struct type;
@@ -129,12 +236,13 @@ struct _connect_fn {
 template <typename CPOs, typename... Values>
 struct _connect_fn<CPOs, Values...>::type {
   using _rec_ref_t = _receiver_ref<CPOs, Values...>;
-  using type_erased_signature_t = _operation_state(this_&&, _rec_ref_t);
+  using type_erased_signature_t =
+      _operation_state(this_&&, _rec_ref_t, const _op_storage&);
 
   template(typename Sender)                     //
       (requires sender_to<Sender, _rec_ref_t>)  //
-      friend _operation_state
-      tag_invoke(const type&, Sender&& s, _rec_ref_t r) {
+      friend _operation_state tag_invoke(
+          const type&, Sender&& s, _rec_ref_t r, const _op_storage& storage) {
     // MSVC can't resolve std::forward<Sender>(s) inside the lambda, but
     // saving Sender into sender_t and then invoking std::forward<sender_t>(s)
     // works just fine ¯\_(ツ)_/¯
@@ -144,25 +252,25 @@ struct _connect_fn<CPOs, Values...>::type {
     };
 
     using inner_op_t = decltype(cnct());
-    using wrapper_t = typename _op_wrapper<inner_op_t>::type;
 
-    return _operation_state{std::in_place_type<wrapper_t>, std::move(cnct)};
+    return _operation_state{
+        std::in_place_type<inner_op_t>, std::move(cnct), storage};
   }
 
 #ifdef _MSC_VER
   // MSVC (_MSC_VER == 1927) doesn't seem to like the requires
   // clause here. Use SFINAE instead.
   template <typename Self>
-  tag_invoke_result_t<type, Self, _rec_ref_t>
-  operator()(Self&& s, _rec_ref_t r) const {
-    return tag_invoke(*this, (Self&&)s, std::move(r));
+  tag_invoke_result_t<type, Self, _rec_ref_t, const _op_storage&>
+  operator()(Self&& s, _rec_ref_t r, const _op_storage& storage) const {
+    return tag_invoke(*this, (Self&&)s, std::move(r), storage);
   }
 #else
-  template(typename Self)                               //
-      (requires tag_invocable<type, Self, _rec_ref_t>)  //
+  template(typename Self)  //
+      (requires tag_invocable<type, Self, _rec_ref_t, const _op_storage&>)  //
       _operation_state
-      operator()(Self&& s, _rec_ref_t r) const {
-    return tag_invoke(*this, (Self&&)s, std::move(r));
+      operator()(Self&& s, _rec_ref_t r, const _op_storage& storage) const {
+    return tag_invoke(*this, (Self&&)s, std::move(r), storage);
   }
 #endif
 };
@@ -170,21 +278,30 @@ struct _connect_fn<CPOs, Values...>::type {
 template <typename CPOs, typename... Values>
 inline constexpr typename _connect_fn<CPOs, Values...>::type _connect{};
 
-template <typename Receiver>
+template <typename Receiver, std::size_t InlineSize>
 struct _op_for {
   struct type;
 };
 
-template <typename Receiver>
-using _operation_state_for = typename _op_for<Receiver>::type;
+template <typename Receiver, std::size_t InlineSize = 0>
+using _operation_state_for = typename _op_for<Receiver, InlineSize>::type;
 
-template <typename Receiver>
-struct _op_for<Receiver>::type {
+// Keeps the type-erased operation state in an inline buffer of 'InlineSize'
+// bytes if it fits, otherwise allocates it with the receiver's allocator.
+template <typename Receiver, std::size_t InlineSize>
+struct _op_for<Receiver, InlineSize>::type {
   template <typename Fn>
   explicit type(Receiver r, Fn fn)
     : rec_((Receiver&&)r)
-    , state_{
-          fn({subscription_.subscribe(unifex::get_stop_token(rec_)), this})} {}
+    , alloc_(unifex::get_allocator(rec_))
+    , state_{fn(
+          {subscription_.subscribe(unifex::get_stop_token(rec_)), this},
+          _op_storage{
+              buffer_.data(),
+              InlineSize,
+              &alloc_,
+              &_alloc_fns_t::allocate,
+              &_alloc_fns_t::deallocate})} {}
 
   void start() & noexcept { unifex::start(state_); }
 
@@ -209,10 +326,17 @@ struct _op_for<Receiver>::type {
     return std::move(cpo)(self.rec_);
   }
 
+  using _alloc_fns_t =
+      _alloc_fns<remove_cvref_t<get_allocator_t<const Receiver&>>>;
+
   UNIFEX_NO_UNIQUE_ADDRESS
   Receiver rec_;
   detail::inplace_stop_token_adapter_subscription<stop_token_type_t<Receiver>>
       subscription_{};
+  UNIFEX_NO_UNIQUE_ADDRESS
+  typename _alloc_fns_t::allocator_type alloc_;
+  UNIFEX_NO_UNIQUE_ADDRESS
+  _op_buffer<InlineSize> buffer_;
   _operation_state state_;
 };
 
@@ -224,15 +348,25 @@ struct _sender {
   struct type;
 };
 
+template <std::size_t InlineSize, typename... Values>
+struct _sender_inplace {
+  struct type;
+};
+
 template <typename... CPOs>
 struct _with {
-  template <typename... Values>
+  template <std::size_t InlineSize, typename... Values>
   struct _sender {
     struct type;
   };
 
   template <typename... Values>
-  using any_sender_of = typename _sender<Values...>::type;
+  using any_sender_of = typename _sender<0, Values...>::type;
+
+  // Connecting puts operation states of up to 'InlineSize' bytes inside the
+  // returned operation state instead of allocating them.
+  template <std::size_t InlineSize, typename... Values>
+  using any_sender_of_inplace = typename _sender<InlineSize, Values...>::type;
 
   using any_scheduler = _any_sched::any_scheduler<CPOs...>;
 
@@ -243,8 +377,8 @@ struct _with {
 };
 
 template <typename... CPOs>
-template <typename... Values>
-struct _with<CPOs...>::_sender<Values...>::type
+template <std::size_t InlineSize, typename... Values>
+struct _with<CPOs...>::_sender<InlineSize, Values...>::type
   : private _sender_base<type_list<CPOs...>, Values...> {
   template <template <class...> class Variant, template <class...> class Tuple>
   using value_types = Variant<Tuple<Values...>>;
@@ -257,13 +391,15 @@ struct _with<CPOs...>::_sender<Values...>::type
   template(typename Receiver)  //
       (requires receiver_of<Receiver, Values...> AND(
           std::is_invocable_v<CPOs, Receiver const&>&&...))  //
-      _operation_state_for<Receiver> connect(Receiver r) && {
+      _operation_state_for<Receiver, InlineSize> connect(Receiver r) && {
     any_unique_t<_connect<type_list<CPOs...>, Values...>>& self = *this;
-    return _operation_state_for<Receiver>{
+    return _operation_state_for<Receiver, InlineSize>{
         std::move(r),
-        [&self](_receiver_ref<type_list<CPOs...>, Values...> rec) {
+        [&self](
+            _receiver_ref<type_list<CPOs...>, Values...> rec,
+            const _op_storage& storage) {
           return _connect<type_list<CPOs...>, Values...>(
-              std::move(self), std::move(rec));
+              std::move(self), std::move(rec), storage);
         }};
   }
 
@@ -273,8 +409,14 @@ struct _with<CPOs...>::_sender<Values...>::type
 };
 
 template <typename... Values>
-struct _sender<Values...>::type : _with<>::_sender<Values...>::type {
-  using _with<>::_sender<Values...>::type::type;
+struct _sender<Values...>::type : _with<>::_sender<0, Values...>::type {
+  using _with<>::_sender<0, Values...>::type::type;
+};
+
+template <std::size_t InlineSize, typename... Values>
+struct _sender_inplace<InlineSize, Values...>::type
+  : _with<>::_sender<InlineSize, Values...>::type {
+  using _with<>::_sender<InlineSize, Values...>::type::type;
 };
 
 }  // namespace _any
@@ -285,6 +427,10 @@ using any_operation_state_for = _any::_operation_state_for<Receiver>;
 template <typename... Values>
 using any_sender_of = typename _any::_sender<Values...>::type;
 
+template <std::size_t InlineSize, typename... Values>
+using any_sender_of_inplace =
+    typename _any::_sender_inplace<InlineSize, Values...>::type;
+
 template <typename... Values>
 using any_receiver_ref = _any::_receiver_ref<type_list<>, Values...>;
 
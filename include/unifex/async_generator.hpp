@@ -0,0 +1,614 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/any_scheduler.hpp>
+#include <unifex/await_transform.hpp>
+#include <unifex/continuations.hpp>
+#include <unifex/coroutine.hpp>
+#include <unifex/detail/coroutine_frame_allocator.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/inline_scheduler.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/std_concepts.hpp>
+#include <unifex/stream_concepts.hpp>
+#include <unifex/tracing/async_stack.hpp>
+#include <unifex/tracing/get_async_stack_frame.hpp>
+#include <unifex/type_traits.hpp>
+#include <unifex/unhandled_done.hpp>
+#include <unifex/with_scheduler_affinity.hpp>
+
+#if UNIFEX_NO_COROUTINES
+#  error "Coroutine support is required to use <unifex/async_generator.hpp>"
+#endif
+
+#include <exception>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace _async_gen {
+// An async_generator<T> is a coroutine that produces a stream: each next()
+// resumes the coroutine until it reaches a 'co_yield', which completes the
+// next() operation with a reference to the yielded value. Finishing the
+// coroutine completes next() with done and an exception escaping it completes
+// next() with that error. cleanup() destroys the coroutine frame.
+//
+// Yielded values are passed by reference: an lvalue is referred to where it
+// lives and a temporary lives in the coroutine frame until the following
+// next(). Only values of another type are converted, into storage that is
+// also part of the frame.
+//
+// The coroutine body runs on the scheduler of whoever calls next(); every
+// co_await inside it returns there, as in a task<>. Its frame comes from the
+// same thread-local pool as a task<>'s, or from the allocator passed as
+// 'std::allocator_arg, alloc' at the start of its parameter list (which
+// needs -Wno-mismatched-new-delete on GCC; see frame_allocator_promise).
+template <typename T>
+struct _gen {
+  class type;
+};
+
+template <typename T>
+struct _promise {
+  struct type;
+};
+
+enum class _state { value, done, error };
+
+// Whoever is waiting for the generator's next value, resumed through
+// complete_ once the generator has yielded, finished or failed. Its scheduler
+// and stop token are only looked up when the generator awaits something, so
+// that producing a value costs no more than a pair of coroutine switches.
+struct _consumer {
+  coro::coroutine_handle<> (*complete_)(_consumer& self) noexcept;
+  any_scheduler (*getScheduler_)(_consumer& self) noexcept;
+  inplace_stop_token (*getStopToken_)(_consumer& self) noexcept;
+  AsyncStackFrame* frame_ = nullptr;
+};
+
+template <typename T>
+struct _promise<T>::type : _coro_frame::frame_allocator_promise {
+  using reference = std::conditional_t<std::is_reference_v<T>, T, T&>;
+  using pointer = std::add_pointer_t<reference>;
+
+  typename _gen<T>::type get_return_object() noexcept {
+    return typename _gen<T>::type{
+        coro::coroutine_handle<type>::from_promise(*this)};
+  }
+
+  coro::suspend_always initial_suspend() noexcept { return {}; }
+
+  struct _final_awaiter {
+    bool await_ready() noexcept { return false; }
+
+#if (defined(_MSC_VER) && !defined(__clang__)) || defined(__EMSCRIPTEN__)
+    // MSVC doesn't seem to like symmetric transfer in this final awaiter
+    // and the Emscripten (WebAssembly) compiler doesn't support tail-calls
+    void await_suspend(coro::coroutine_handle<type> h) noexcept {
+      h.promise().finish().resume();
+    }
+#else
+    coro::coroutine_handle<>
+    await_suspend(coro::coroutine_handle<type> h) noexcept {
+      return h.promise().finish();
+    }
+#endif
+
+    [[noreturn]] void await_resume() noexcept { std::terminate(); }
+  };
+
+  _final_awaiter final_suspend() noexcept { return {}; }
+
+  void return_void() noexcept {}
+
+  void unhandled_exception() noexcept {
+    error_ = std::current_exception();
+    state_ = _state::error;
+  }
+
+  coro::coroutine_handle<> unhandled_done() noexcept {
+    if (!doneCoro_.handle()) {
+      doneCoro_ = unifex::unhandled_done(
+          [this]() noexcept -> coro::coroutine_handle<> {
+            state_ = _state::done;
+            finished_ = true;
+            return consumer_->complete_(*consumer_);
+          });
+    }
+    return doneCoro_.handle();
+  }
+
+  struct _yield_awaiter {
+    bool await_ready() noexcept { return false; }
+
+    coro::coroutine_handle<>
+    await_suspend(coro::coroutine_handle<type> h) noexcept {
+      auto& promise = h.promise();
+      promise.state_ = _state::value;
+      return promise.consumer_->complete_(*promise.consumer_);
+    }
+
+    void await_resume() noexcept {}
+  };
+
+  template <typename Value>
+  struct _converted_yield_awaiter : _yield_awaiter {
+    coro::coroutine_handle<>
+    await_suspend(coro::coroutine_handle<type> h) noexcept {
+      h.promise().value_ = std::addressof(value_);
+      return _yield_awaiter::await_suspend(h);
+    }
+
+    Value value_;
+  };
+
+  _yield_awaiter yield_value(reference value) noexcept {
+    value_ = std::addressof(value);
+    return {};
+  }
+
+  template(typename Value = T)                 //
+      (requires(!std::is_reference_v<Value>))  //
+      _yield_awaiter yield_value(Value&& value) noexcept {
+    value_ = std::addressof(value);
+    return {};
+  }
+
+  template(typename Value)                                       //
+      (requires(!same_as<remove_cvref_t<Value>, remove_cvref_t<T>>)  //
+           AND constructible_from<remove_cvref_t<T>, Value>)         //
+      _converted_yield_awaiter<remove_cvref_t<T>> yield_value(
+          Value&& value) noexcept(std::
+                                      is_nothrow_constructible_v<
+                                          remove_cvref_t<T>,
+                                          Value>) {
+    return {{}, remove_cvref_t<T>(static_cast<Value&&>(value))};
+  }
+
+  template <typename Value>
+  decltype(auto) await_transform(Value&& value) {
+    if constexpr (unifex::sender<Value>) {
+      return unifex::await_transform(
+          *this,
+          with_scheduler_affinity(
+              static_cast<Value&&>(value), get_scheduler(*this)));
+    } else if constexpr (
+        tag_invocable<tag_t<unifex::await_transform>, type&, Value> ||
+        detail::_awaitable<Value>) {
+      return with_scheduler_affinity(
+          *this,
+          unifex::await_transform(*this, static_cast<Value&&>(value)),
+          get_scheduler(*this));
+    } else {
+      return unifex::await_transform(*this, static_cast<Value&&>(value));
+    }
+  }
+
+  friend inplace_stop_token
+  tag_invoke(tag_t<get_stop_token>, const type& p) noexcept {
+    return p.consumer_->getStopToken_(*p.consumer_);
+  }
+
+  friend any_scheduler
+  tag_invoke(tag_t<get_scheduler>, const type& p) noexcept {
+    return p.consumer_->getScheduler_(*p.consumer_);
+  }
+
+  friend AsyncStackFrame*
+  tag_invoke(tag_t<get_async_stack_frame>, const type& p) noexcept {
+    return p.consumer_->frame_;
+  }
+
+  coro::coroutine_handle<> finish() noexcept {
+    if (state_ != _state::error) {
+      state_ = _state::done;
+    }
+    finished_ = true;
+    return consumer_->complete_(*consumer_);
+  }
+
+  // Called by the consumer to resume the generator.
+  coro::coroutine_handle<> resume_from(_consumer& consumer) noexcept {
+    consumer_ = &consumer;
+    if (finished_) {
+      state_ = _state::done;
+      return consumer.complete_(consumer);
+    }
+    return coro::coroutine_handle<type>::from_promise(*this);
+  }
+
+  _consumer* consumer_ = nullptr;
+  pointer value_ = nullptr;
+  std::exception_ptr error_;
+  _state state_ = _state::done;
+  bool finished_ = false;
+  done_coro doneCoro_;
+};
+
+// A receiver that asks for the next value from within set_value() would
+// resume the generator on top of the frames that delivered the previous one.
+// Instead, the start() further up this thread's stack that is resuming the
+// same generator resumes it again once the yield that called set_value() has
+// suspended. Generators consuming generators nest these trampolines.
+struct _resume_trampoline {
+  const void* promise_;
+  coro::coroutine_handle<> pending_;
+  _resume_trampoline* outer_;
+};
+
+inline thread_local _resume_trampoline* _current_trampoline = nullptr;
+
+// Adapts the consumer's stop token the first time the generator asks for it
+// while it is producing a value.
+template <typename StopToken>
+struct _lazy_stop_token {
+  template <typename Consumer>
+  inplace_stop_token get(const Consumer& consumer) noexcept {
+    if (!subscribed_) {
+      stoken_ = adapter_.subscribe(get_stop_token(consumer));
+      subscribed_ = true;
+    }
+    return stoken_;
+  }
+
+  void reset() noexcept {
+    if (subscribed_) {
+      subscribed_ = false;
+      adapter_.unsubscribe();
+    }
+  }
+
+  bool subscribed_ = false;
+  inplace_stop_token stoken_;
+  UNIFEX_NO_UNIQUE_ADDRESS inplace_stop_token_adapter<StopToken> adapter_;
+};
+
+template <typename Consumer>
+any_scheduler _scheduler_of(const Consumer& consumer) noexcept {
+  if constexpr (scheduler_provider<const Consumer&>) {
+    return get_scheduler(consumer);
+  } else {
+    return inline_scheduler{};
+  }
+}
+
+template <typename T, typename Receiver>
+struct _next_op {
+  class type;
+};
+
+template <typename T, typename Receiver>
+class _next_op<T, Receiver>::type : _consumer {
+  using promise_type = typename _promise<T>::type;
+  using reference = typename promise_type::reference;
+
+public:
+  template <typename Receiver2>
+  explicit type(
+      coro::coroutine_handle<promise_type> coro,
+      Receiver2&& receiver) noexcept(std::
+                                         is_nothrow_constructible_v<
+                                             Receiver,
+                                             Receiver2>)
+    : _consumer{&complete, &scheduler, &stop_token}
+    , coro_(coro)
+    , receiver_(static_cast<Receiver2&&>(receiver)) {}
+
+  type(type&&) = delete;
+
+  void start() & noexcept {
+    coro::coroutine_handle<> next = coro_.promise().resume_from(*this);
+    auto* outer = _current_trampoline;
+    for (auto* t = outer; t != nullptr; t = t->outer_) {
+      if (t->promise_ == &coro_.promise()) {
+        t->pending_ = next;
+        return;
+      }
+    }
+    // 'this' may be destroyed as soon as the generator is resumed.
+    _resume_trampoline trampoline{&coro_.promise(), next, outer};
+    _current_trampoline = &trampoline;
+    while (trampoline.pending_) {
+      std::exchange(trampoline.pending_, {}).resume();
+    }
+    _current_trampoline = outer;
+  }
+
+private:
+  static coro::coroutine_handle<> complete(_consumer& self) noexcept {
+    auto& op = static_cast<type&>(self);
+    op.stopToken_.reset();
+    auto& promise = op.coro_.promise();
+    switch (promise.state_) {
+      case _state::value:
+        UNIFEX_TRY {
+          unifex::set_value(
+              std::move(op.receiver_),
+              static_cast<reference>(*promise.value_));
+        }
+        UNIFEX_CATCH(...) {
+          unifex::set_error(std::move(op.receiver_), std::current_exception());
+        }
+        break;
+      case _state::done: unifex::set_done(std::move(op.receiver_)); break;
+      case _state::error:
+        unifex::set_error(
+            std::move(op.receiver_), std::exchange(promise.error_, {}));
+        break;
+    }
+    return coro::noop_coroutine();
+  }
+
+  static any_scheduler scheduler(_consumer& self) noexcept {
+    return _scheduler_of(static_cast<type&>(self).receiver_);
+  }
+
+  static inplace_stop_token stop_token(_consumer& self) noexcept {
+    auto& op = static_cast<type&>(self);
+    return op.stopToken_.get(op.receiver_);
+  }
+
+  coro::coroutine_handle<promise_type> coro_;
+  Receiver receiver_;
+  _lazy_stop_token<stop_token_type_t<Receiver>> stopToken_;
+};
+
+// Awaiting next() directly from a coroutine hands control back and forth by
+// symmetric transfer, with no operation state in between. While it runs, the
+// generator gets an async stack frame of its own on top of the consumer's.
+template <typename T, typename Promise, bool WithAsyncStackSupport>
+struct _next_awaiter {
+  class type;
+};
+
+template <typename T, typename Promise, bool WithAsyncStackSupport>
+class _next_awaiter<T, Promise, WithAsyncStackSupport>::type : _consumer {
+  using promise_type = typename _promise<T>::type;
+  using reference = typename promise_type::reference;
+
+public:
+  explicit type(coro::coroutine_handle<promise_type> coro) noexcept
+    : _consumer{&complete, &scheduler, &stop_token}
+    , coro_(coro) {}
+
+  // Only ever called before the awaiter is awaited.
+  type(type&& other) noexcept
+    : _consumer{&complete, &scheduler, &stop_token}
+    , coro_(other.coro_) {}
+
+  bool await_ready() noexcept { return false; }
+
+  coro::coroutine_handle<>
+  await_suspend(coro::coroutine_handle<Promise> h) noexcept {
+    continuation_ = h;
+    maybePushAsyncStackFrame(
+        h.promise(), instruction_ptr::read_return_address());
+    return coro_.promise().resume_from(*this);
+  }
+
+  reference await_resume() {
+    auto& promise = coro_.promise();
+    if (promise.state_ == _state::error) {
+      std::rethrow_exception(std::exchange(promise.error_, {}));
+    }
+    return static_cast<reference>(*promise.value_);
+  }
+
+private:
+  static coro::coroutine_handle<> complete(_consumer& self) noexcept {
+    auto& awaiter = static_cast<type&>(self);
+    awaiter.stopToken_.reset();
+    if (awaiter.coro_.promise().state_ == _state::done) {
+      // The consumer's unhandled_done() pops the generator's frame, as it
+      // does for a child task<> that completes with done.
+      return awaiter.continuation_.done_handle();
+    }
+    awaiter.maybePopAsyncStackFrame();
+    return awaiter.continuation_.handle();
+  }
+
+  static any_scheduler scheduler(_consumer& self) noexcept {
+    return _scheduler_of(static_cast<type&>(self).continuation_.promise());
+  }
+
+  static inplace_stop_token stop_token(_consumer& self) noexcept {
+    auto& awaiter = static_cast<type&>(self);
+    return awaiter.stopToken_.get(awaiter.continuation_.promise());
+  }
+
+  void maybePushAsyncStackFrame(
+      [[maybe_unused]] Promise& caller,
+      [[maybe_unused]] instruction_ptr returnAddress) noexcept {
+    if constexpr (WithAsyncStackSupport) {
+      if (auto* callerFrame = get_async_stack_frame(caller)) {
+        calleeFrame_.setReturnAddress(returnAddress);
+        pushAsyncStackFrameCallerCallee(*callerFrame, calleeFrame_);
+        frame_ = &calleeFrame_;
+      }
+    }
+  }
+
+  void maybePopAsyncStackFrame() noexcept {
+    if constexpr (WithAsyncStackSupport) {
+      if (calleeFrame_.getParentFrame() != nullptr) {
+        popAsyncStackFrameCallee(calleeFrame_);
+      }
+    }
+  }
+
+  coro::coroutine_handle<promise_type> coro_;
+  continuation_handle<Promise> continuation_;
+  _lazy_stop_token<stop_token_type_t<Promise>> stopToken_;
+  UNIFEX_NO_UNIQUE_ADDRESS
+  conditional_t<WithAsyncStackSupport, AsyncStackFrame, detail::_empty<0>>
+      calleeFrame_;
+};
+
+template <typename T>
+struct _next_sender {
+  class type;
+};
+
+template <typename T>
+class _next_sender<T>::type {
+  using promise_type = typename _promise<T>::type;
+
+public:
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<Tuple<typename promise_type::reference>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::exception_ptr>;
+
+  static constexpr bool sends_done = true;
+
+  // see the comment on _gen<T>
+  static constexpr bool is_always_scheduler_affine = true;
+
+  explicit type(coro::coroutine_handle<promise_type> coro) noexcept
+    : coro_(coro) {}
+
+  template(typename Receiver)           //
+      (requires receiver<Receiver>)     //
+      friend typename _next_op<T, remove_cvref_t<Receiver>>::type
+      tag_invoke(tag_t<connect>, type&& s, Receiver&& r) noexcept(
+          std::is_nothrow_constructible_v<remove_cvref_t<Receiver>, Receiver>) {
+    return typename _next_op<T, remove_cvref_t<Receiver>>::type{
+        s.coro_, static_cast<Receiver&&>(r)};
+  }
+
+  template <
+      typename Promise,
+      bool WithAsyncStackSupport = !UNIFEX_NO_ASYNC_STACKS>
+  friend typename _next_awaiter<T, Promise, WithAsyncStackSupport>::type
+  tag_invoke(tag_t<unifex::await_transform>, Promise&, type&& s) noexcept {
+    return typename _next_awaiter<T, Promise, WithAsyncStackSupport>::type{
+        s.coro_};
+  }
+
+private:
+  coro::coroutine_handle<promise_type> coro_;
+};
+
+template <typename T, typename Receiver>
+struct _cleanup_op {
+  struct type;
+};
+
+template <typename T, typename Receiver>
+struct _cleanup_op<T, Receiver>::type {
+  coro::coroutine_handle<> coro_;
+  Receiver receiver_;
+
+  void start() & noexcept {
+    if (coro_) {
+      coro_.destroy();
+    }
+    unifex::set_done(std::move(receiver_));
+  }
+};
+
+template <typename T>
+struct _cleanup_sender {
+  class type;
+};
+
+template <typename T>
+class _cleanup_sender<T>::type {
+public:
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<>;
+
+  static constexpr bool sends_done = true;
+
+  static constexpr blocking_kind blocking = blocking_kind::always_inline;
+
+  explicit type(coro::coroutine_handle<> coro) noexcept : coro_(coro) {}
+
+  template(typename Receiver)        //
+      (requires receiver<Receiver>)  //
+      friend typename _cleanup_op<T, remove_cvref_t<Receiver>>::type
+      tag_invoke(tag_t<connect>, type&& s, Receiver&& r) noexcept(
+          std::is_nothrow_constructible_v<remove_cvref_t<Receiver>, Receiver>) {
+    return {std::exchange(s.coro_, {}), static_cast<Receiver&&>(r)};
+  }
+
+private:
+  coro::coroutine_handle<> coro_;
+};
+
+template <typename T>
+class _gen<T>::type {
+public:
+  using promise_type = typename _promise<T>::type;
+
+  type(type&& other) noexcept : coro_(std::exchange(other.coro_, {})) {}
+
+  type& operator=(type other) noexcept {
+    std::swap(coro_, other.coro_);
+    return *this;
+  }
+
+  ~type() {
+    if (coro_) {
+      coro_.destroy();
+    }
+  }
+
+  friend typename _next_sender<T>::type tag_invoke(tag_t<next>, type& gen) {
+    UNIFEX_ASSERT(gen.coro_);
+    return typename _next_sender<T>::type{gen.coro_};
+  }
+
+  friend typename _cleanup_sender<T>::type
+  tag_invoke(tag_t<cleanup>, type& gen) noexcept {
+    return typename _cleanup_sender<T>::type{std::exchange(gen.coro_, {})};
+  }
+
+private:
+  friend promise_type;
+
+  explicit type(coro::coroutine_handle<promise_type> coro) noexcept
+    : coro_(coro) {}
+
+  coro::coroutine_handle<promise_type> coro_;
+};
+}  // namespace _async_gen
+
+template <typename T>
+using async_generator = typename _async_gen::_gen<T>::type;
+
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
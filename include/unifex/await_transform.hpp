@@ -68,7 +68,11 @@ private:
 namespace _await_tfx {
 using namespace _util;
 
-template <typename Promise, typename Value, bool WithAsyncStackSupport>
+template <
+    typename Promise,
+    typename Value,
+    bool WithAsyncStackSupport,
+    bool CompletesInline>
 struct _awaitable_base {
   struct type;
 };
@@ -78,8 +82,16 @@ struct _awaitable {
   struct type;
 };
 
-template <typename Promise, typename Value, bool WithAsyncStackSupport>
-struct _awaitable_base<Promise, Value, WithAsyncStackSupport>::type {
+template <
+    typename Promise,
+    typename Value,
+    bool WithAsyncStackSupport,
+    bool CompletesInline>
+struct _awaitable_base<
+    Promise,
+    Value,
+    WithAsyncStackSupport,
+    CompletesInline>::type {
   struct _rec {
   public:
     explicit _rec(
@@ -93,6 +105,11 @@ struct _awaitable_base<Promise, Value, WithAsyncStackSupport>::type {
       , continuation_(std::move(r.continuation_)) {}
 
     void complete() noexcept {
+      if constexpr (CompletesInline) {
+        // await_suspend() resumes the continuation once start() returns
+        return;
+      }
+
       if constexpr (WithAsyncStackSupport) {
         if (auto* frame = get_async_stack_frame(continuation_.promise())) {
           detail::ScopedAsyncStackRoot root;
@@ -131,9 +148,14 @@ struct _awaitable_base<Promise, Value, WithAsyncStackSupport>::type {
     void set_done() && noexcept {
       result_->state_ = _state::done;
 
+      if constexpr (!CompletesInline) {
+        resume_done(continuation_);
+      }
+    }
+
+    static void resume_done(continuation_handle<Promise> continuation) noexcept {
       if constexpr (WithAsyncStackSupport) {
-        if (auto* parentFrame =
-                get_async_stack_frame(continuation_.promise())) {
+        if (auto* parentFrame = get_async_stack_frame(continuation.promise())) {
           // we need a dummy frame for the waiting coroutine's unhandled_done()
           // to pop for us
           AsyncStackFrame frame;
@@ -142,12 +164,12 @@ struct _awaitable_base<Promise, Value, WithAsyncStackSupport>::type {
           detail::ScopedAsyncStackRoot root;
           root.activateFrame(frame);
 
-          return continuation_.resume_done();
+          return continuation.resume_done();
         }
       }
 
       // run this when stacks are disabled and when the parent hasn't got one
-      continuation_.resume_done();
+      continuation.resume_done();
     }
 
     template(typename CPO)  //
@@ -188,11 +210,19 @@ protected:
   _expected<Value> result_;
 };
 
+// Senders like just() or schedule() on the inline_scheduler complete before
+// start() returns; see _awaitable<>::type::await_suspend().
+template <typename Sender>
+inline constexpr bool _completes_inline_v =
+    sender_traits<remove_cvref_t<Sender>>::blocking ==
+    blocking_kind::always_inline;
+
 template <typename Promise, typename Sender, bool WithAsyncStackSupport>
 using _awaitable_base_t = typename _awaitable_base<
     Promise,
     sender_single_value_return_type_t<remove_cvref_t<Sender>>,
-    WithAsyncStackSupport>::type;
+    WithAsyncStackSupport,
+    _completes_inline_v<Sender>>::type;
 
 template <typename Promise, typename Sender, bool WithAsyncStackSupport>
 using _receiver_t =
@@ -210,14 +240,31 @@ public:
       is_nothrow_connectable_v<Sender, _rec>)
     : op_(unifex::connect((Sender&&)sender, _rec{&this->result_, h})) {}
 
-  void await_suspend(coro::coroutine_handle<Promise> handle) noexcept {
+  // Senders that complete inline have finished by the time start() returns
+  // so, unless they completed with done, we return false to resume the
+  // awaiting coroutine there rather than from within start(). Otherwise a
+  // loop that awaits such senders would grow the stack with every iteration.
+  auto await_suspend(coro::coroutine_handle<Promise> handle) noexcept {
+    if constexpr (_completes_inline_v<Sender>) {
+      unifex::start(op_);
+      if (this->result_.state_ != _state::done) {
+        return false;
+      }
+    }
+
     if constexpr (WithAsyncStackSupport) {
       auto* frame = get_async_stack_frame(handle.promise());
       if (frame) {
         deactivateAsyncStackFrame((*frame));
       }
     }
-    unifex::start(op_);
+
+    if constexpr (_completes_inline_v<Sender>) {
+      _rec::resume_done(handle);
+      return true;
+    } else {
+      unifex::start(op_);
+    }
   }
 };
 
@@ -0,0 +1,679 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/bind_back.hpp>
+#include <unifex/config.hpp>
+#include <unifex/exception.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/stop_token_concepts.hpp>
+#include <unifex/stream_concepts.hpp>
+#include <unifex/type_list.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace _buffer_stream {
+
+// buffer_stream(stream, capacity)
+//
+// Once the first value is requested, keeps pulling values from 'stream' into
+// a ring buffer of 'capacity' values, independently of the consumer, until the
+// buffer is full. Values are handed out of the buffer in order. When the
+// consumer asks for a value that has not been produced yet, it completes on
+// the producer's execution context once the value arrives.
+//
+// The buffer is a single-producer/single-consumer ring: the producer and the
+// consumer may run on different threads and only synchronise through atomics.
+//
+// cleanup() stops the producer, waits for its outstanding next() to complete,
+// discards any buffered values and then cleans up the underlying stream.
+
+enum class producer_state {
+  idle,      // next() has not been called yet.
+  running,   // a next() on the underlying stream is (about to be) in flight.
+  parked,    // the buffer is full; the consumer restarts the producer.
+  stopping,  // cleanup() was called while a next() was in flight.
+  finished,  // no further next() will be made on the underlying stream.
+};
+
+struct consumer_base {
+  void (*resume_)(consumer_base*) noexcept;
+};
+
+struct cleanup_base {
+  void (*start_)(cleanup_base*) noexcept;
+};
+
+template <typename Stream>
+struct _state {
+  class type;
+};
+template <typename Stream>
+using state = typename _state<Stream>::type;
+
+template <typename Stream>
+struct _producer_receiver {
+  struct type;
+};
+template <typename Stream>
+using producer_receiver = typename _producer_receiver<Stream>::type;
+
+template <typename Stream>
+struct _producer_receiver<Stream>::type {
+  state<Stream>& state_;
+
+  template <typename... Values>
+  void set_value(Values&&... values) && noexcept {
+    state_.on_value((Values &&) values...);
+  }
+
+  void set_done() && noexcept { state_.on_done(); }
+
+  void set_error(std::exception_ptr ex) && noexcept {
+    state_.on_error(std::move(ex));
+  }
+
+  template <typename Error>
+  void set_error(Error&& error) && noexcept {
+    state_.on_error(make_exception_ptr((Error &&) error));
+  }
+
+  friend inplace_stop_token
+  tag_invoke(tag_t<get_stop_token>, const type& r) noexcept {
+    return r.state_.get_stop_token();
+  }
+};
+
+template <typename Stream>
+class _state<Stream>::type {
+public:
+  using values_type = typename sender_value_types_t<
+      next_sender_t<Stream>,
+      single_overload,
+      decayed_tuple<std::tuple>::template apply>::type;
+
+  template <typename Stream2>
+  explicit type(Stream2&& stream, std::size_t capacity)
+    : stream_((Stream2 &&) stream)
+    , capacity_(capacity)
+    , buffer_(new manual_lifetime<values_type>[capacity]) {
+    UNIFEX_ASSERT(capacity > 0);
+  }
+
+  ~type() {
+    UNIFEX_ASSERT(
+        producerState_.load(std::memory_order_relaxed) !=
+            producer_state::running &&
+        producerState_.load(std::memory_order_relaxed) !=
+            producer_state::stopping);
+    discard_buffered_values();
+  }
+
+  // Consumer side.
+
+  // Start pulling from the underlying stream on the first call.
+  void start_producer() noexcept {
+    auto expected = producer_state::idle;
+    if (producerState_.compare_exchange_strong(
+            expected, producer_state::running)) {
+      pull();
+    }
+  }
+
+  // Returns the next buffered value, if any.
+  values_type* front() noexcept {
+    const auto head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_seq_cst)) {
+      return nullptr;
+    }
+    return &buffer_[head % capacity_].get();
+  }
+
+  // Releases the slot returned by front(), restarting the producer if it was
+  // waiting for space.
+  void pop_front() noexcept {
+    const auto head = head_.load(std::memory_order_relaxed);
+    buffer_[head % capacity_].destruct();
+    head_.store(head + 1, std::memory_order_seq_cst);
+
+    if (producerState_.load(std::memory_order_seq_cst) ==
+        producer_state::parked) {
+      auto expected = producer_state::parked;
+      if (producerState_.compare_exchange_strong(
+              expected, producer_state::running)) {
+        pull();
+      }
+    }
+  }
+
+  bool is_finished() const noexcept {
+    return producerState_.load(std::memory_order_seq_cst) ==
+        producer_state::finished;
+  }
+
+  // Publish 'consumer' to be resumed once a value is buffered or the
+  // producer finishes.
+  void park(consumer_base* consumer) noexcept {
+    consumer_.store(consumer, std::memory_order_seq_cst);
+  }
+
+  // Withdraw 'consumer'. Returns false if the producer has already taken it
+  // to resume it.
+  bool withdraw(consumer_base* consumer) noexcept {
+    return consumer_.compare_exchange_strong(consumer, nullptr);
+  }
+
+  bool has_value_or_finished() noexcept {
+    return front() != nullptr || is_finished();
+  }
+
+  std::exception_ptr& error() noexcept { return error_; }
+
+  // Cleanup side.
+
+  // Returns true if the underlying stream can be cleaned up right away;
+  // otherwise the producer starts 'cleanup' once its next() completes.
+  bool stop_producer(cleanup_base* cleanup) noexcept {
+    cleanup_ = cleanup;
+    stopSource_.request_stop();
+    auto current = producerState_.load(std::memory_order_seq_cst);
+    while (true) {
+      if (current == producer_state::running) {
+        if (producerState_.compare_exchange_weak(
+                current, producer_state::stopping)) {
+          return false;
+        }
+      } else if (producerState_.compare_exchange_weak(
+                     current, producer_state::finished)) {
+        return true;
+      }
+    }
+  }
+
+  void discard_buffered_values() noexcept {
+    auto head = head_.load(std::memory_order_relaxed);
+    const auto tail = tail_.load(std::memory_order_acquire);
+    for (; head != tail; ++head) {
+      buffer_[head % capacity_].destruct();
+    }
+    head_.store(head, std::memory_order_relaxed);
+  }
+
+  Stream& stream() noexcept { return stream_; }
+
+  inplace_stop_token get_stop_token() noexcept {
+    return stopSource_.get_token();
+  }
+
+private:
+  friend producer_receiver<Stream>;
+
+  using next_op =
+      manual_lifetime<next_operation_t<Stream, producer_receiver<Stream>>>;
+
+  // Producer side.
+
+  void pull() noexcept {
+    UNIFEX_TRY {
+      next_.construct_with([&] {
+        return unifex::connect(
+            next(stream_), producer_receiver<Stream>{*this});
+      });
+    }
+    UNIFEX_CATCH(...) {
+      finish(std::current_exception());
+      return;
+    }
+    unifex::start(next_.get());
+  }
+
+  template <typename... Values>
+  void on_value(Values&&... values) noexcept {
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    UNIFEX_TRY {
+      buffer_[tail % capacity_].construct((Values &&) values...);
+    }
+    UNIFEX_CATCH(...) {
+      next_.destruct();
+      finish(std::current_exception());
+      return;
+    }
+    next_.destruct();
+    tail_.store(tail + 1, std::memory_order_seq_cst);
+
+    resume_consumer();
+
+    if (stopSource_.stop_requested()) {
+      finish(nullptr);
+      return;
+    }
+
+    while (true) {
+      if (!is_full()) {
+        pull();
+        return;
+      }
+
+      auto expected = producer_state::running;
+      if (!producerState_.compare_exchange_strong(
+              expected, producer_state::parked)) {
+        UNIFEX_ASSERT(expected == producer_state::stopping);
+        finish(nullptr);
+        return;
+      }
+
+      // The consumer restarts the producer once it frees up a slot, unless
+      // it did so before seeing the producer parked.
+      if (is_full()) {
+        return;
+      }
+      expected = producer_state::parked;
+      if (!producerState_.compare_exchange_strong(
+              expected, producer_state::running)) {
+        return;
+      }
+    }
+  }
+
+  void on_done() noexcept {
+    next_.destruct();
+    finish(nullptr);
+  }
+
+  void on_error(std::exception_ptr ex) noexcept {
+    next_.destruct();
+    finish(std::move(ex));
+  }
+
+  void finish(std::exception_ptr ex) noexcept {
+    error_ = std::move(ex);
+    auto previous = producerState_.exchange(producer_state::finished);
+    if (previous == producer_state::stopping) {
+      // Cleanup is waiting on this next() to complete.
+      cleanup_->start_(cleanup_);
+      return;
+    }
+    resume_consumer();
+  }
+
+  bool is_full() const noexcept {
+    return tail_.load(std::memory_order_relaxed) -
+        head_.load(std::memory_order_seq_cst) ==
+        capacity_;
+  }
+
+  void resume_consumer() noexcept {
+    if (consumer_.load(std::memory_order_seq_cst) != nullptr) {
+      if (auto* consumer = consumer_.exchange(nullptr)) {
+        consumer->resume_(consumer);
+      }
+    }
+  }
+
+  Stream stream_;
+  const std::size_t capacity_;
+  std::unique_ptr<manual_lifetime<values_type>[]> buffer_;
+
+  // Indices of the next slot to pop and push, increasing monotonically.
+  std::atomic<std::size_t> head_{0};
+  std::atomic<std::size_t> tail_{0};
+
+  std::atomic<producer_state> producerState_{producer_state::idle};
+  std::atomic<consumer_base*> consumer_{nullptr};
+  cleanup_base* cleanup_ = nullptr;
+  std::exception_ptr error_;
+  inplace_stop_source stopSource_;
+  next_op next_;
+};
+
+template <typename Stream, typename Receiver>
+struct _next_op {
+  class type;
+};
+template <typename Stream, typename Receiver>
+using next_operation =
+    typename _next_op<Stream, remove_cvref_t<Receiver>>::type;
+
+template <typename Stream, typename Receiver>
+class _next_op<Stream, Receiver>::type : consumer_base {
+public:
+  template <typename Receiver2>
+  explicit type(state<Stream>& state, Receiver2&& receiver)
+    : state_(state)
+    , receiver_((Receiver2 &&) receiver) {
+    this->resume_ = &type::resume;
+  }
+
+  void start() noexcept {
+    state_.start_producer();
+    if (try_complete()) {
+      return;
+    }
+
+    // Until the 'starting' flag is cleared, neither the producer nor the
+    // stop callback complete the operation; they leave that to start().
+    flags_.store(starting_flag, std::memory_order_relaxed);
+    stopCallback_.construct(get_stop_token(receiver_), cancel_callback{*this});
+    state_.park(this);
+
+    if (state_.has_value_or_finished() && state_.withdraw(this)) {
+      stopCallback_.destruct();
+      [[maybe_unused]] bool completed = try_complete();
+      UNIFEX_ASSERT(completed);
+      return;
+    }
+
+    const auto flags =
+        flags_.fetch_and(~starting_flag, std::memory_order_acq_rel);
+    if ((flags & resumed_flag) != 0) {
+      complete_resumed();
+    } else if ((flags & stop_flag) != 0 && state_.withdraw(this)) {
+      complete_stopped();
+    }
+    // Otherwise the producer or the stop callback complete the operation.
+  }
+
+private:
+  using values_type = typename state<Stream>::values_type;
+  using stop_token_type = stop_token_type_t<Receiver&>;
+
+  static constexpr std::uint8_t starting_flag = 1;
+  static constexpr std::uint8_t resumed_flag = 2;
+  static constexpr std::uint8_t stop_flag = 4;
+
+  struct cancel_callback {
+    type& op_;
+    void operator()() noexcept { op_.request_stop(); }
+  };
+
+  static void resume(consumer_base* base) noexcept {
+    auto& op = *static_cast<type*>(base);
+    const auto flags =
+        op.flags_.fetch_or(resumed_flag, std::memory_order_acq_rel);
+    if ((flags & starting_flag) == 0) {
+      op.complete_resumed();
+    }
+  }
+
+  void request_stop() noexcept {
+    const auto flags = flags_.fetch_or(stop_flag, std::memory_order_acq_rel);
+    if ((flags & starting_flag) == 0 && state_.withdraw(this)) {
+      complete_stopped();
+    }
+  }
+
+  void complete_resumed() noexcept {
+    stopCallback_.destruct();
+    [[maybe_unused]] bool completed = try_complete();
+    UNIFEX_ASSERT(completed);
+  }
+
+  void complete_stopped() noexcept {
+    stopCallback_.destruct();
+    unifex::set_done(std::move(receiver_));
+  }
+
+  bool try_complete() noexcept {
+    values_type* values = state_.front();
+    if (values == nullptr && state_.is_finished()) {
+      // Values produced before the producer finished are still buffered.
+      values = state_.front();
+      if (values == nullptr) {
+        if (auto& error = state_.error()) {
+          unifex::set_error(std::move(receiver_), std::move(error));
+        } else {
+          unifex::set_done(std::move(receiver_));
+        }
+        return true;
+      }
+    }
+    if (values == nullptr) {
+      return false;
+    }
+
+    UNIFEX_TRY {
+      values_type taken = std::move(*values);
+      state_.pop_front();
+      std::apply(
+          [&](auto&&... vs) {
+            unifex::set_value(std::move(receiver_), std::move(vs)...);
+          },
+          std::move(taken));
+    }
+    UNIFEX_CATCH(...) {
+      unifex::set_error(std::move(receiver_), std::current_exception());
+    }
+    return true;
+  }
+
+  state<Stream>& state_;
+  Receiver receiver_;
+  std::atomic<std::uint8_t> flags_{0};
+  manual_lifetime<
+      typename stop_token_type::template callback_type<cancel_callback>>
+      stopCallback_;
+};
+
+template <typename Stream>
+struct _next_sender {
+  class type;
+};
+template <typename Stream>
+using next_sender = typename _next_sender<Stream>::type;
+
+template <typename Stream>
+class _next_sender<Stream>::type {
+public:
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = sender_value_types_t<
+      next_sender_t<Stream>,
+      Variant,
+      decayed_tuple<Tuple>::template apply>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::exception_ptr>;
+
+  static constexpr bool sends_done = true;
+
+  explicit type(state<Stream>& state) noexcept : state_(state) {}
+
+  template(typename Receiver)        //
+      (requires receiver<Receiver>)  //
+      friend next_operation<Stream, Receiver> tag_invoke(
+          tag_t<connect>, const type& s, Receiver&& r) {
+    return next_operation<Stream, Receiver>{s.state_, (Receiver &&) r};
+  }
+
+private:
+  state<Stream>& state_;
+};
+
+template <typename Stream, typename Receiver>
+struct _cleanup_op {
+  class type;
+};
+template <typename Stream, typename Receiver>
+using cleanup_operation =
+    typename _cleanup_op<Stream, remove_cvref_t<Receiver>>::type;
+
+template <typename Stream, typename Receiver>
+class _cleanup_op<Stream, Receiver>::type : cleanup_base {
+public:
+  template <typename Receiver2>
+  explicit type(state<Stream>& state, Receiver2&& receiver)
+    : state_(state)
+    , receiver_((Receiver2 &&) receiver) {
+    this->start_ = &type::start_cleanup;
+  }
+
+  void start() noexcept {
+    if (state_.stop_producer(this)) {
+      start_cleanup(this);
+    }
+  }
+
+private:
+  struct cleanup_receiver {
+    type& op_;
+
+    void set_done() && noexcept {
+      auto& op = op_;
+      op.cleanupOp_.destruct();
+      unifex::set_done(std::move(op.receiver_));
+    }
+
+    template <typename Error>
+    void set_error(Error&& error) && noexcept {
+      auto& op = op_;
+      op.cleanupOp_.destruct();
+      unifex::set_error(std::move(op.receiver_), (Error &&) error);
+    }
+
+    template(typename CPO)                       //
+        (requires is_receiver_query_cpo_v<CPO>)  //
+        friend auto tag_invoke(CPO cpo, const cleanup_receiver& r) noexcept(
+            std::is_nothrow_invocable_v<CPO, const Receiver&>)
+            -> std::invoke_result_t<CPO, const Receiver&> {
+      return std::move(cpo)(r.get_receiver());
+    }
+
+    const Receiver& get_receiver() const noexcept { return op_.receiver_; }
+  };
+
+  static void start_cleanup(cleanup_base* base) noexcept {
+    auto& op = *static_cast<type*>(base);
+    op.state_.discard_buffered_values();
+    UNIFEX_TRY {
+      op.cleanupOp_.construct_with([&] {
+        return unifex::connect(
+            cleanup(op.state_.stream()), cleanup_receiver{op});
+      });
+    }
+    UNIFEX_CATCH(...) {
+      unifex::set_error(std::move(op.receiver_), std::current_exception());
+      return;
+    }
+    unifex::start(op.cleanupOp_.get());
+  }
+
+  state<Stream>& state_;
+  Receiver receiver_;
+  manual_lifetime<cleanup_operation_t<Stream, cleanup_receiver>> cleanupOp_;
+};
+
+template <typename Stream>
+struct _cleanup_sender {
+  class type;
+};
+template <typename Stream>
+using cleanup_sender = typename _cleanup_sender<Stream>::type;
+
+template <typename Stream>
+class _cleanup_sender<Stream>::type {
+public:
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<>;
+
+  template <template <typename...> class Variant>
+  using error_types = typename concat_type_lists_unique_t<
+      sender_error_types_t<cleanup_sender_t<Stream>, type_list>,
+      type_list<std::exception_ptr>>::template apply<Variant>;
+
+  static constexpr bool sends_done = true;
+
+  explicit type(state<Stream>& state) noexcept : state_(state) {}
+
+  template(typename Receiver)        //
+      (requires receiver<Receiver>)  //
+      friend cleanup_operation<Stream, Receiver> tag_invoke(
+          tag_t<connect>, const type& s, Receiver&& r) {
+    return cleanup_operation<Stream, Receiver>{s.state_, (Receiver &&) r};
+  }
+
+private:
+  state<Stream>& state_;
+};
+
+template <typename Stream>
+struct _stream {
+  class type;
+};
+template <typename Stream>
+using stream = typename _stream<remove_cvref_t<Stream>>::type;
+
+template <typename Stream>
+class _stream<Stream>::type {
+public:
+  template <typename Stream2>
+  explicit type(Stream2&& stream, std::size_t capacity)
+    : state_(std::make_unique<state<Stream>>((Stream2 &&) stream, capacity)) {}
+
+  friend next_sender<Stream> tag_invoke(tag_t<next>, type& s) noexcept {
+    return next_sender<Stream>{*s.state_};
+  }
+
+  friend cleanup_sender<Stream> tag_invoke(tag_t<cleanup>, type& s) noexcept {
+    return cleanup_sender<Stream>{*s.state_};
+  }
+
+private:
+  // The producer refers to the state while it runs, so keep it at a fixed
+  // address even if the stream is moved before it is started.
+  std::unique_ptr<state<Stream>> state_;
+};
+}  // namespace _buffer_stream
+
+namespace _buffer_stream_cpo {
+inline const struct _fn {
+  template <typename Stream>
+  auto operator()(Stream&& stream, std::size_t capacity) const
+      -> _buffer_stream::stream<Stream> {
+    return _buffer_stream::stream<Stream>{(Stream &&) stream, capacity};
+  }
+  constexpr auto operator()(std::size_t capacity) const
+      noexcept(std::is_nothrow_invocable_v<tag_t<bind_back>, _fn, std::size_t>)
+          -> bind_back_result_t<_fn, std::size_t> {
+    return bind_back(*this, capacity);
+  }
+} buffer_stream{};
+}  // namespace _buffer_stream_cpo
+using _buffer_stream_cpo::buffer_stream;
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
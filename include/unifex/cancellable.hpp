@@ -38,6 +38,10 @@ struct _op {
     non_stop = 8
   };
 
+  // Handshake between stop_type::start() and a try_complete() that
+  // runs before started is set.
+  enum sync_state : uint8_t { sync_running, sync_claimed, sync_completed };
+
   // NestedOp is embedded in aligned storage rather than used as a base
   // class, working around a clang 19 bug where guaranteed copy elision
   // is not applied for base-class initialization from a prvalue.
@@ -78,16 +82,18 @@ struct _op {
     using non_stop_type::non_stop_type;
 
     void start() noexcept {
-      std::atomic<bool> sync_complete{false};
-      sync_complete_ = &sync_complete;
+      std::atomic<uint8_t> sync{sync_running};
+      sync_ = &sync;
 
       unifex::start(this->nested_op());
 
-      // If the nested op completed synchronously (within unifex::start
-      // above), the receiver may have already destroyed *this. The
-      // stack-local sync_complete flag lets us detect this without
-      // touching any member.
-      if (sync_complete.load(std::memory_order_acquire)) {
+      // If the nested op already completed (synchronously within
+      // unifex::start above, or on another thread that got here first),
+      // the receiver may have destroyed *this. Claiming the stack-local
+      // sync flag lets us detect this without touching any member.
+      uint8_t expected = sync_running;
+      if (!sync.compare_exchange_strong(
+              expected, sync_claimed, std::memory_order_acq_rel)) {
         return;
       }
 
@@ -96,11 +102,11 @@ struct _op {
           state == stopped) {
         this->nested_op().stop();
       } else if (state & completed) {
-        // try_complete() ran on another thread after unifex::start()
-        // returned but before we set started. It will write
-        // sync_complete_ = true momentarily. Wait for it to finish
-        // before destroying the stack-local.
-        while (!sync_complete.load(std::memory_order_acquire)) {
+        // try_complete() ran on another thread after we claimed the
+        // flag but before we set started. It waits for started before
+        // completing; wait for it to be done with the stack-local
+        // before destroying it.
+        while (sync.load(std::memory_order_acquire) != sync_completed) {
         }
       }
     }
@@ -116,7 +122,7 @@ struct _op {
 
     void (*cleanup_)(stop_type*) noexcept = [](stop_type*) noexcept {
     };
-    std::atomic<bool>* sync_complete_{nullptr};
+    std::atomic<uint8_t>* sync_{nullptr};
   };
 
   struct stop_callback {
@@ -158,11 +164,17 @@ bool try_complete(NestedOp* self) noexcept {
 #endif
     if (!(state & op::started)) {
       // Notify start() that the op completed before started was set.
-      // start() will either see this via its initial sync_complete
-      // check (synchronous completion on the same thread) or via the
-      // spin-wait after observing completed in fetch_or(started).
-      if (auto* flag = stop_self->sync_complete_) {
-        flag->store(true, std::memory_order_release);
+      // If start() hasn't claimed its stack-local yet, it will see this
+      // and return without touching the op. Otherwise it is about to
+      // set started, and must finish doing so before we let the
+      // receiver destroy the op.
+      if (auto* flag = stop_self->sync_) {
+        if (flag->exchange(op::sync_completed, std::memory_order_acq_rel) ==
+            op::sync_claimed) {
+          while (!(non_stop->state_.load(std::memory_order_acquire) &
+                   op::started)) {
+          }
+        }
       }
     }
 
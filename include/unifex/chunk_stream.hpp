@@ -0,0 +1,577 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/bind_back.hpp>
+#include <unifex/config.hpp>
+#include <unifex/detail/locked_stream.hpp>
+#include <unifex/exception.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/stream_concepts.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace _chunk_stream {
+
+// chunk_stream(stream, scheduler, maxCount, maxDelay)
+// chunk_stream(stream, scheduler, maxCount, maxDelay, makeBuffer)
+//
+// Groups the values of 'stream' into chunks and sends each chunk as a
+// single value. A chunk is sent once it holds 'maxCount' values or once
+// 'maxDelay' has passed on 'scheduler' since its first value arrived,
+// whichever comes first, and when the stream ends while it holds any.
+//
+// Chunks are std::vector<T> by default. Pass 'makeBuffer', called with
+// 'maxCount' to get the container for each new chunk, to supply the
+// containers yourself, e.g. from a pool; it must support push_back(),
+// size() and empty().
+//
+// Values keep being pulled into the current chunk while the consumer is
+// busy, until the chunk is full or due. An error from 'stream' is sent after
+// the chunk it interrupted. cleanup() cancels the outstanding next() and
+// timer, waits for them and then cleans up 'stream'.
+
+using _locked_stream::cleanup_base;
+using _locked_stream::consumer_base;
+using _locked_stream::outcome;
+using _locked_stream::single_consumer;
+
+template <typename Stream>
+using value_t = typename sender_value_types_t<
+    next_sender_t<Stream>,
+    single_overload,
+    single_value_type>::type::type;
+
+template <typename T>
+struct make_vector {
+  std::vector<T> operator()(std::size_t maxCount) const {
+    std::vector<T> buffer;
+    buffer.reserve(maxCount);
+    return buffer;
+  }
+};
+
+template <
+    typename Stream,
+    typename Scheduler,
+    typename Duration,
+    typename MakeBuffer>
+struct _state {
+  class type;
+};
+template <
+    typename Stream,
+    typename Scheduler,
+    typename Duration,
+    typename MakeBuffer>
+using state = typename _state<Stream, Scheduler, Duration, MakeBuffer>::type;
+
+template <typename State>
+struct _source_receiver {
+  struct type;
+};
+template <typename State>
+using source_receiver = typename _source_receiver<State>::type;
+
+template <typename State>
+struct _source_receiver<State>::type {
+  State& state_;
+
+  template <typename Value>
+  void set_value(Value&& value) && noexcept {
+    state_.on_value((Value &&) value);
+  }
+
+  void set_done() && noexcept { state_.on_source_finished(nullptr); }
+
+  void set_error(std::exception_ptr ex) && noexcept {
+    state_.on_source_finished(std::move(ex));
+  }
+
+  template <typename Error>
+  void set_error(Error&& error) && noexcept {
+    state_.on_source_finished(make_exception_ptr((Error &&) error));
+  }
+
+  friend inplace_stop_token
+  tag_invoke(tag_t<get_stop_token>, const type& r) noexcept {
+    return r.state_.get_stop_token();
+  }
+};
+
+template <typename State>
+struct _timer_receiver {
+  struct type;
+};
+template <typename State>
+using timer_receiver = typename _timer_receiver<State>::type;
+
+template <typename State>
+struct _timer_receiver<State>::type {
+  State& state_;
+
+  void set_value() && noexcept { state_.on_timer(); }
+
+  void set_done() && noexcept { state_.on_timer(); }
+
+  template <typename Error>
+  void set_error(Error&&) && noexcept {
+    state_.on_timer();
+  }
+
+  friend inplace_stop_token
+  tag_invoke(tag_t<get_stop_token>, const type& r) noexcept {
+    return r.state_.get_stop_token();
+  }
+};
+
+template <
+    typename Stream,
+    typename Scheduler,
+    typename Duration,
+    typename MakeBuffer>
+class _state<Stream, Scheduler, Duration, MakeBuffer>::type
+  : public single_consumer {
+  using time_point = decltype(now(std::declval<Scheduler&>()));
+  using timer_sender = decltype(schedule_at(
+      std::declval<Scheduler&>(), std::declval<time_point>()));
+
+public:
+  using buffer_type = std::invoke_result_t<MakeBuffer&, std::size_t>;
+  using values_type = std::tuple<buffer_type>;
+
+  template <
+      typename Stream2,
+      typename Scheduler2,
+      typename Duration2,
+      typename MakeBuffer2>
+  explicit type(
+      Stream2&& stream,
+      Scheduler2&& scheduler,
+      std::size_t maxCount,
+      Duration2&& maxDelay,
+      MakeBuffer2&& makeBuffer)
+    : stream_((Stream2 &&) stream)
+    , scheduler_((Scheduler2 &&) scheduler)
+    , maxCount_(maxCount)
+    , maxDelay_((Duration2 &&) maxDelay)
+    , makeBuffer_((MakeBuffer2 &&) makeBuffer) {
+    UNIFEX_ASSERT(maxCount > 0);
+  }
+
+  ~type() { UNIFEX_ASSERT(pending_ == 0); }
+
+  // Consumer side. Called with the lock held; moves a finished chunk, if
+  // there is one, into 'chunk' or the final error into 'error'.
+  outcome take_locked(
+      std::optional<values_type>& chunk, std::exception_ptr& error) noexcept {
+    if (finished_) {
+      return outcome::done;
+    }
+    if (buffer_.has_value() && !buffer_->empty() &&
+        (closed_ || sourceFinished_)) {
+      chunk.emplace(std::move(*buffer_));
+      buffer_.reset();
+      closed_ = false;
+      return outcome::value;
+    }
+    if (sourceFinished_) {
+      finished_ = true;
+      if (error_) {
+        error = std::exchange(error_, nullptr);
+        return outcome::error;
+      }
+      return outcome::done;
+    }
+    return outcome::pending;
+  }
+
+  // Ask the stream for its next value if the current chunk has room for it.
+  void pull() noexcept {
+    {
+      std::lock_guard lock{mutex_};
+      if (sourceRunning_ || sourceFinished_ || closed_ || stopping_) {
+        return;
+      }
+      sourceRunning_ = true;
+      ++pending_;
+    }
+    UNIFEX_TRY {
+      sourceOp_.construct_with([&] {
+        return unifex::connect(next(stream_), source_receiver<type>{*this});
+      });
+    }
+    UNIFEX_CATCH(...) {
+      finish_source(std::current_exception());
+      return;
+    }
+    unifex::start(sourceOp_.get());
+  }
+
+  std::mutex& mutex() noexcept { return mutex_; }
+
+  // Cleanup side.
+
+  // Returns true if the stream can be cleaned up right away; otherwise
+  // 'cleanup' is started once the outstanding next() and timer complete.
+  bool stop(cleanup_base* cleanup) noexcept {
+    {
+      std::lock_guard lock{mutex_};
+      stopping_ = true;
+    }
+    stopSource_.request_stop();
+
+    std::lock_guard lock{mutex_};
+    if (pending_ == 0) {
+      return true;
+    }
+    cleanup_ = cleanup;
+    return false;
+  }
+
+  // Drops the chunk nobody will consume now and returns the sender that
+  // cleans up the stream.
+  cleanup_sender_t<Stream> cleanup_source() {
+    buffer_.reset();
+    return cleanup(stream_);
+  }
+
+  inplace_stop_token get_stop_token() noexcept {
+    return stopSource_.get_token();
+  }
+
+private:
+  friend source_receiver<type>;
+  friend timer_receiver<type>;
+
+  using value_type = value_t<Stream>;
+
+  template <typename Value>
+  void on_value(Value&& value) noexcept {
+    consumer_base* consumer = nullptr;
+    bool startTimer = false;
+    // Take a copy in case 'value' refers to the operation state.
+    std::optional<value_type> copy;
+    UNIFEX_TRY {
+      copy.emplace((Value &&) value);
+    }
+    UNIFEX_CATCH(...) {
+      sourceOp_.destruct();
+      finish_source(std::current_exception());
+      return;
+    }
+    sourceOp_.destruct();
+
+    std::exception_ptr ex;
+    UNIFEX_TRY {
+      std::lock_guard lock{mutex_};
+      sourceRunning_ = false;
+      if (!buffer_.has_value()) {
+        buffer_.emplace(makeBuffer_(maxCount_));
+      }
+      buffer_->push_back(std::move(*copy));
+      if (buffer_->size() == 1) {
+        deadline_ = now(scheduler_) + maxDelay_;
+        // A timer left over from an earlier chunk re-arms itself for this
+        // one when it completes.
+        if (!timerRunning_) {
+          timerRunning_ = true;
+          ++pending_;
+          startTimer = true;
+        }
+      }
+      if (buffer_->size() >= maxCount_) {
+        closed_ = true;
+        consumer = std::exchange(consumer_, nullptr);
+      }
+    }
+    UNIFEX_CATCH(...) {
+      ex = std::current_exception();
+    }
+    if (ex) {
+      finish_source(std::move(ex));
+      return;
+    }
+
+    if (startTimer) {
+      start_timer();
+    }
+    if (consumer != nullptr) {
+      consumer->resume_(consumer);
+    }
+    pull();
+    release();
+  }
+
+  void on_source_finished(std::exception_ptr ex) noexcept {
+    sourceOp_.destruct();
+    finish_source(std::move(ex));
+  }
+
+  void finish_source(std::exception_ptr ex) noexcept {
+    consumer_base* consumer;
+    {
+      std::lock_guard lock{mutex_};
+      sourceRunning_ = false;
+      sourceFinished_ = true;
+      error_ = std::move(ex);
+      consumer = std::exchange(consumer_, nullptr);
+    }
+    if (consumer != nullptr) {
+      consumer->resume_(consumer);
+    }
+    release();
+  }
+
+  void start_timer() noexcept {
+    UNIFEX_TRY {
+      timerOp_.construct_with([&] {
+        return unifex::connect(
+            schedule_at(scheduler_, deadline_), timer_receiver<type>{*this});
+      });
+    }
+    UNIFEX_CATCH(...) {
+      // Without a timer the chunk is only sent once it is full or the
+      // stream ends.
+      std::lock_guard lock{mutex_};
+      timerRunning_ = false;
+      --pending_;
+      return;
+    }
+    unifex::start(timerOp_.get());
+  }
+
+  void on_timer() noexcept {
+    timerOp_.destruct();
+
+    consumer_base* consumer = nullptr;
+    bool restart = false;
+    {
+      std::lock_guard lock{mutex_};
+      if (buffer_.has_value() && !closed_ && !stopping_) {
+        if (now(scheduler_) >= deadline_) {
+          closed_ = true;
+          consumer = std::exchange(consumer_, nullptr);
+        } else {
+          // This timer was for an earlier chunk.
+          restart = true;
+        }
+      }
+      if (!restart) {
+        timerRunning_ = false;
+      }
+    }
+
+    if (restart) {
+      start_timer();
+      return;
+    }
+    if (consumer != nullptr) {
+      consumer->resume_(consumer);
+    }
+    release();
+  }
+
+  // Called once the source or the timer is done with the state, so that a
+  // waiting cleanup can go ahead.
+  void release() noexcept {
+    cleanup_base* cleanup = nullptr;
+    {
+      std::lock_guard lock{mutex_};
+      if (--pending_ == 0) {
+        cleanup = std::exchange(cleanup_, nullptr);
+      }
+    }
+    if (cleanup != nullptr) {
+      cleanup->start_(cleanup);
+    }
+  }
+
+  Stream stream_;
+  Scheduler scheduler_;
+  const std::size_t maxCount_;
+  Duration maxDelay_;
+  MakeBuffer makeBuffer_;
+
+  std::mutex mutex_;
+  // The chunk being filled, if it has any values yet.
+  std::optional<buffer_type> buffer_;
+  time_point deadline_{};
+  // The current chunk is full or due; stop pulling until it's taken.
+  bool closed_ = false;
+  // Outstanding source next() and timer.
+  std::size_t pending_ = 0;
+  bool sourceRunning_ = false;
+  bool sourceFinished_ = false;
+  bool timerRunning_ = false;
+  std::exception_ptr error_;
+  bool finished_ = false;
+  bool stopping_ = false;
+  cleanup_base* cleanup_ = nullptr;
+  inplace_stop_source stopSource_;
+  manual_lifetime<next_operation_t<Stream, source_receiver<type>>> sourceOp_;
+  manual_lifetime<connect_result_t<timer_sender, timer_receiver<type>>>
+      timerOp_;
+};
+
+template <
+    typename Stream,
+    typename Scheduler,
+    typename Duration,
+    typename MakeBuffer>
+struct _stream {
+  class type;
+};
+template <
+    typename Stream,
+    typename Scheduler,
+    typename Duration,
+    typename MakeBuffer>
+using stream = typename _stream<
+    remove_cvref_t<Stream>,
+    remove_cvref_t<Scheduler>,
+    remove_cvref_t<Duration>,
+    remove_cvref_t<MakeBuffer>>::type;
+
+template <
+    typename Stream,
+    typename Scheduler,
+    typename Duration,
+    typename MakeBuffer>
+class _stream<Stream, Scheduler, Duration, MakeBuffer>::type {
+  using state_type = state<Stream, Scheduler, Duration, MakeBuffer>;
+
+public:
+  template <
+      typename Stream2,
+      typename Scheduler2,
+      typename Duration2,
+      typename MakeBuffer2>
+  explicit type(
+      Stream2&& stream,
+      Scheduler2&& scheduler,
+      std::size_t maxCount,
+      Duration2&& maxDelay,
+      MakeBuffer2&& makeBuffer)
+    : state_(std::make_unique<state_type>(
+          (Stream2 &&) stream,
+          (Scheduler2 &&) scheduler,
+          maxCount,
+          (Duration2 &&) maxDelay,
+          (MakeBuffer2 &&) makeBuffer)) {}
+
+  friend _locked_stream::next_sender<state_type>
+  tag_invoke(tag_t<next>, type& s) noexcept {
+    return _locked_stream::next_sender<state_type>{*s.state_};
+  }
+
+  friend _locked_stream::cleanup_sender<state_type>
+  tag_invoke(tag_t<cleanup>, type& s) noexcept {
+    return _locked_stream::cleanup_sender<state_type>{*s.state_};
+  }
+
+private:
+  // The outstanding next() and timer refer to the state, so keep it at a
+  // fixed address even if the stream is moved.
+  std::unique_ptr<state_type> state_;
+};
+}  // namespace _chunk_stream
+
+namespace _chunk_stream_cpo {
+inline const struct _fn {
+  template(
+      typename Stream,
+      typename Scheduler,
+      typename Duration,
+      typename MakeBuffer)                             //
+      (requires scheduler<Scheduler>)  //
+      auto
+      operator()(
+          Stream&& stream,
+          Scheduler&& scheduler,
+          std::size_t maxCount,
+          Duration&& maxDelay,
+          MakeBuffer&& makeBuffer) const
+      -> _chunk_stream::stream<Stream, Scheduler, Duration, MakeBuffer> {
+    return _chunk_stream::stream<Stream, Scheduler, Duration, MakeBuffer>{
+        (Stream &&) stream,
+        (Scheduler &&) scheduler,
+        maxCount,
+        (Duration &&) maxDelay,
+        (MakeBuffer &&) makeBuffer};
+  }
+  template(typename Stream, typename Scheduler, typename Duration)  //
+      (requires scheduler<Scheduler>)          //
+      auto
+      operator()(
+          Stream&& stream,
+          Scheduler&& scheduler,
+          std::size_t maxCount,
+          Duration&& maxDelay) const
+      -> _chunk_stream::stream<
+          Stream,
+          Scheduler,
+          Duration,
+          _chunk_stream::make_vector<
+              _chunk_stream::value_t<remove_cvref_t<Stream>>>> {
+    return (*this)(
+        (Stream &&) stream,
+        (Scheduler &&) scheduler,
+        maxCount,
+        (Duration &&) maxDelay,
+        _chunk_stream::make_vector<
+            _chunk_stream::value_t<remove_cvref_t<Stream>>>{});
+  }
+  template(typename Scheduler, typename Duration)            //
+      (requires scheduler<Scheduler>)  //
+      constexpr auto
+      operator()(
+          Scheduler&& scheduler,
+          std::size_t maxCount,
+          Duration&& maxDelay) const
+      noexcept(std::is_nothrow_invocable_v<
+               tag_t<bind_back>,
+               _fn,
+               Scheduler,
+               std::size_t,
+               Duration>)
+          -> bind_back_result_t<_fn, Scheduler, std::size_t, Duration> {
+    return bind_back(
+        *this, (Scheduler &&) scheduler, maxCount, (Duration &&) maxDelay);
+  }
+} chunk_stream{};
+}  // namespace _chunk_stream_cpo
+using _chunk_stream_cpo::chunk_stream;
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
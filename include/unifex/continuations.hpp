@@ -215,11 +215,16 @@ struct continuation_handle<void> {
 
   coro::coroutine_handle<> handle() const noexcept { return handle_; }
 
-  coro::coroutine_handle<> done_handle() const noexcept { return doneHandle_; }
+  // The done handle is only looked up when it's needed, which lets promise
+  // types create their unhandled_done() coroutine lazily.
+  coro::coroutine_handle<> done_handle() const noexcept {
+    return doneHandle_ ? doneHandle_(handle_.address())
+                       : coro::coroutine_handle<>{};
+  }
 
   void resume() { handle_.resume(); }
 
-  void resume_done() { doneHandle_.resume(); }
+  void resume_done() { done_handle().resume(); }
 
   continuation_info info() const noexcept {
     return continuation_info::from_continuation(*this);
@@ -232,8 +237,15 @@ private:
   continuation_handle(
       int, coro::coroutine_handle<Promise> continuation) noexcept;
 
+  template <typename Promise>
+  static coro::coroutine_handle<> _done_handle_for(void* address) noexcept {
+    return coro::coroutine_handle<Promise>::from_address(address)
+        .promise()
+        .unhandled_done();
+  }
+
   coro::coroutine_handle<> handle_{};
-  coro::coroutine_handle<> doneHandle_{};
+  coro::coroutine_handle<> (*doneHandle_)(void*) noexcept = nullptr;
 #  if UNIFEX_ENABLE_CONTINUATION_VISITATIONS
   inline static constexpr _ci::_continuation_info_vtable default_vtable_{
       &_ci::_default_type_index_getter,
@@ -281,7 +293,7 @@ template <typename Promise>
 continuation_handle<void>::continuation_handle(
     int, coro::coroutine_handle<Promise> continuation) noexcept
   : handle_(continuation)
-  , doneHandle_(continuation.promise().unhandled_done()) {
+  , doneHandle_(&_done_handle_for<Promise>) {
 #  if UNIFEX_ENABLE_CONTINUATION_VISITATIONS
   vtable_ = &_vtable_for<Promise>;
 #  endif
@@ -17,6 +17,7 @@
 
 #include <atomic>
 #include <cstdint>
+#include <memory>
 #include <type_traits>
 
 #include <unifex/detail/prologue.hpp>
@@ -79,6 +80,8 @@ protected:
 //   push_front  O(1)  locks head
 //   push_back   O(1)  locks tail
 //   pop_front   O(1)  locks head + first item's rest
+//   pop_front_if O(1) as pop_front; the predicate sees the first
+//                     item while head is locked
 //   try_remove  O(1)  locks predecessor + item's rest
 //   drain_into  O(1)  locks head + tail; moves all items
 //
@@ -114,6 +117,8 @@ protected:
   void push_front_impl(node* item) noexcept;
   void push_back_impl(node* item) noexcept;
   node* pop_front_impl() noexcept;
+  node*
+  pop_front_if_impl(bool (*pred)(node*, void*) noexcept, void* ctx) noexcept;
   bool try_remove_impl(node* item) noexcept;
   void drain_into_impl(atomic_intrusive_list_impl& target) noexcept;
 
@@ -170,6 +175,20 @@ public:
     return static_cast<Item*>(base::pop_front_impl());
   }
 
+  // Pops the first item only if pred(item) returns true.  pred runs
+  // with head locked, so the item can't be removed concurrently and
+  // pred may claim a resource on its behalf.  pred must not touch
+  // this list.
+  template <typename Pred>
+  [[nodiscard]] Item* pop_front_if(Pred&& pred) noexcept {
+    using pred_t = std::remove_reference_t<Pred>;
+    return static_cast<Item*>(base::pop_front_if_impl(
+        [](atomic_intrusive_list_node* n, void* p) noexcept -> bool {
+          return (*static_cast<pred_t*>(p))(static_cast<Item*>(n));
+        },
+        const_cast<std::remove_const_t<pred_t>*>(std::addressof(pred))));
+  }
+
   [[nodiscard]] bool try_remove(Item* item) noexcept {
     return base::try_remove_impl(item);
   }
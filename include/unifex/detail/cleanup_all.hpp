@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/exception.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/stream_concepts.hpp>
+
+#include <cstddef>
+#include <exception>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace _cleanup_all {
+
+// Cleans up each of a tuple of streams in turn, whether or not cleaning up
+// the ones before it failed, and then completes with the first error, if
+// any, or with done.
+
+template <typename Receiver, typename... Streams>
+struct _op {
+  class type;
+};
+template <typename Receiver, typename... Streams>
+using operation = typename _op<remove_cvref_t<Receiver>, Streams...>::type;
+
+template <typename Receiver, typename... Streams>
+class _op<Receiver, Streams...>::type {
+  template <std::size_t Index>
+  struct cleanup_receiver {
+    type& op_;
+
+    void set_done() && noexcept {
+      auto& op = op_;
+      std::get<Index>(op.ops_).destruct();
+      op.template start_at<Index + 1>();
+    }
+
+    void set_error(std::exception_ptr ex) && noexcept {
+      auto& op = op_;
+      if (!op.error_) {
+        op.error_ = std::move(ex);
+      }
+      std::get<Index>(op.ops_).destruct();
+      op.template start_at<Index + 1>();
+    }
+
+    template <typename Error>
+    void set_error(Error&& error) && noexcept {
+      std::move(*this).set_error(make_exception_ptr((Error &&) error));
+    }
+
+    template(typename CPO)                       //
+        (requires is_receiver_query_cpo_v<CPO>)  //
+        friend auto tag_invoke(CPO cpo, const cleanup_receiver& r) noexcept(
+            std::is_nothrow_invocable_v<CPO, const Receiver&>)
+            -> std::invoke_result_t<CPO, const Receiver&> {
+      return std::move(cpo)(r.get_receiver());
+    }
+
+    const Receiver& get_receiver() const noexcept { return op_.receiver_; }
+  };
+
+  template <std::size_t... Indices>
+  static auto make_ops(std::index_sequence<Indices...>) -> std::tuple<
+      manual_lifetime<
+          cleanup_operation_t<Streams, cleanup_receiver<Indices>>>...>;
+
+public:
+  template <typename Receiver2>
+  explicit type(std::tuple<Streams...>& streams, Receiver2&& receiver)
+    : streams_(streams)
+    , receiver_((Receiver2 &&) receiver) {}
+
+  void start() noexcept { start_at<0>(); }
+
+private:
+  template <std::size_t Index>
+  void start_at() noexcept {
+    if constexpr (Index == sizeof...(Streams)) {
+      if (error_) {
+        unifex::set_error(std::move(receiver_), std::move(error_));
+      } else {
+        unifex::set_done(std::move(receiver_));
+      }
+    } else {
+      auto& op = std::get<Index>(ops_);
+      UNIFEX_TRY {
+        op.construct_with([&] {
+          return unifex::connect(
+              cleanup(std::get<Index>(streams_)),
+              cleanup_receiver<Index>{*this});
+        });
+      }
+      UNIFEX_CATCH(...) {
+        if (!error_) {
+          error_ = std::current_exception();
+        }
+        start_at<Index + 1>();
+        return;
+      }
+      unifex::start(op.get());
+    }
+  }
+
+  std::tuple<Streams...>& streams_;
+  Receiver receiver_;
+  std::exception_ptr error_;
+  decltype(make_ops(std::index_sequence_for<Streams...>{})) ops_;
+};
+
+template <typename... Streams>
+struct _sender {
+  class type;
+};
+template <typename... Streams>
+using sender = typename _sender<Streams...>::type;
+
+template <typename... Streams>
+class _sender<Streams...>::type {
+public:
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::exception_ptr>;
+
+  static constexpr bool sends_done = true;
+
+  explicit type(std::tuple<Streams...>& streams) noexcept
+    : streams_(streams) {}
+
+  template(typename Receiver)        //
+      (requires receiver<Receiver>)  //
+      friend operation<Receiver, Streams...> tag_invoke(
+          tag_t<connect>, const type& s, Receiver&& r) {
+    return operation<Receiver, Streams...>{s.streams_, (Receiver &&) r};
+  }
+
+private:
+  std::tuple<Streams...>& streams_;
+};
+}  // namespace _cleanup_all
+
+// Sender that cleans up all of 'streams', one after the other.
+template <typename... Streams>
+_cleanup_all::sender<Streams...>
+cleanup_all(std::tuple<Streams...>& streams) noexcept {
+  return _cleanup_all::sender<Streams...>{streams};
+}
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
@@ -17,6 +17,7 @@
 
 #include <unifex/manual_lifetime.hpp>
 #include <unifex/receiver_concepts.hpp>
+#include <unifex/running_in_this_thread.hpp>
 #include <unifex/scheduler_concepts.hpp>
 #include <unifex/type_traits.hpp>
 
@@ -24,12 +25,39 @@
 
 namespace unifex {
 
+namespace _completion_forwarder {
+// Set while a completion is being delivered inline so that anything it
+// resumes in turn goes through schedule() instead of growing the stack.
+inline thread_local bool completingInline = false;
+}  // namespace _completion_forwarder
+
+// If the calling thread already belongs to get_scheduler(receiver),
+// invokes complete() right here, skipping the schedule() round trip,
+// and returns true.  Otherwise returns false without calling complete().
+// At most one such completion is ever active on a thread.
+template <typename Receiver, typename Complete>
+bool complete_inline_if_on_scheduler(
+    const Receiver& receiver, Complete&& complete) noexcept {
+  using _completion_forwarder::completingInline;
+  if (completingInline ||
+      !running_in_this_thread(get_scheduler(receiver))) {
+    return false;
+  }
+  completingInline = true;
+  static_assert(noexcept(complete()));
+  complete();
+  completingInline = false;
+  return true;
+}
+
 // When started with start(outer), will call outer.forward_set_value() on the
 // execution context obtained by scheduling on
 // get_scheduler(outer.get_receiver()). If schedule() fails or is cancelled,
 // will forward set_error()/set_done() to outer.get_receiver().
 // outer.get_receiver() must return FinalReceiver&.
 // outer.forward_set_value must not throw.
+// If start() is called on a thread owned by that scheduler,
+// outer.forward_set_value() is called inline instead.
 template <typename OpState, typename FinalReceiver>
 class completion_forwarder {
 public:
@@ -42,6 +70,11 @@ public:
   void start(OpState& outer) noexcept {
     static_assert(
         std::is_same_v<FinalReceiver&, decltype(outer.get_receiver())>);
+    if (complete_inline_if_on_scheduler(
+            outer.get_receiver(),
+            [&outer]() noexcept { outer.forward_set_value(); })) {
+      return;
+    }
     inner_.construct_with([&outer]() noexcept {
       return unifex::connect(
           schedule(get_scheduler(outer.get_receiver())), receiver{outer});
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/config.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace _coro_frame {
+// Allocates 'size' bytes from the calling thread's pool of recycled
+// coroutine frames, which keeps a free list per size class. Blocks may be
+// returned from any thread; they are recycled by the thread that frees them.
+void* pool_allocate(std::size_t size);
+void pool_deallocate(void* p, std::size_t size) noexcept;
+
+inline constexpr std::size_t frame_align = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+// Every frame is followed by a trailer that records how to free it, so that
+// operator delete() need not know which operator new() allocated the frame.
+struct trailer {
+  void (*deallocate_)(void* frame, std::size_t frameSize) noexcept;
+};
+
+template <typename T>
+constexpr std::size_t trailer_offset(std::size_t frameSize) noexcept {
+  return (frameSize + alignof(T) - 1) & ~(alignof(T) - 1);
+}
+
+inline trailer* get_trailer(void* frame, std::size_t frameSize) noexcept {
+  return reinterpret_cast<trailer*>(
+      static_cast<std::byte*>(frame) + trailer_offset<trailer>(frameSize));
+}
+
+template <typename Allocator>
+struct allocator_trailer : trailer {
+  struct alignas(frame_align) block {
+    std::byte bytes_[frame_align];
+  };
+  using allocator_type =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<block>;
+  using traits = std::allocator_traits<allocator_type>;
+
+  static std::size_t blocks(std::size_t frameSize) noexcept {
+    return (trailer_offset<allocator_trailer>(frameSize) +
+            sizeof(allocator_trailer) + sizeof(block) - 1) /
+        sizeof(block);
+  }
+
+  static void* allocate(const Allocator& alloc, std::size_t frameSize) {
+    static_assert(
+        alignof(allocator_trailer) == alignof(trailer),
+        "Over-aligned frame allocators are not supported");
+    allocator_type blockAlloc{alloc};
+    void* frame = traits::allocate(blockAlloc, blocks(frameSize));
+    ::new (static_cast<std::byte*>(frame) +
+           trailer_offset<allocator_trailer>(frameSize))
+        allocator_trailer{{&deallocate}, std::move(blockAlloc)};
+    return frame;
+  }
+
+  static void deallocate(void* frame, std::size_t frameSize) noexcept {
+    auto* self =
+        static_cast<allocator_trailer*>(get_trailer(frame, frameSize));
+    allocator_type blockAlloc{std::move(self->alloc_)};
+    self->~allocator_trailer();
+    traits::deallocate(
+        blockAlloc, static_cast<block*>(frame), blocks(frameSize));
+  }
+
+  UNIFEX_NO_UNIQUE_ADDRESS allocator_type alloc_;
+};
+
+inline void pooled_deallocate(void* frame, std::size_t frameSize) noexcept {
+  pool_deallocate(frame, trailer_offset<trailer>(frameSize) + sizeof(trailer));
+}
+
+// A base for promise types whose coroutine frames are allocated from the
+// thread-local frame pool, or with the allocator passed to the coroutine
+// as 'std::allocator_arg, alloc' at the start of its parameter list (after
+// the object parameter for member functions).
+//
+// GCC (seen with GCC 12) reports -Wmismatched-new-delete at every
+// coroutine that takes 'std::allocator_arg, alloc': it pairs the frame's
+// operator new with its operator delete by name, and the allocator-aware
+// overloads below are templates while the sized operator delete that the
+// standard requires coroutines to use cannot be. The warning is a false
+// positive. Code that defines such coroutines and builds with
+// -Werror on GCC has to compile them with -Wno-mismatched-new-delete; a
+// '#pragma GCC diagnostic' here doesn't help, because the warning is
+// reported at the coroutine.
+struct frame_allocator_promise {
+  static void* operator new(std::size_t frameSize) {
+    void* frame =
+        pool_allocate(trailer_offset<trailer>(frameSize) + sizeof(trailer));
+    ::new (get_trailer(frame, frameSize)) trailer{&pooled_deallocate};
+    return frame;
+  }
+
+  template <typename Allocator, typename... Args>
+  static void* operator new(
+      std::size_t frameSize,
+      std::allocator_arg_t,
+      const Allocator& alloc,
+      const Args&...) {
+    return allocator_trailer<Allocator>::allocate(alloc, frameSize);
+  }
+
+  template <typename Self, typename Allocator, typename... Args>
+  static void* operator new(
+      std::size_t frameSize,
+      const Self&,
+      std::allocator_arg_t,
+      const Allocator& alloc,
+      const Args&...) {
+    return allocator_trailer<Allocator>::allocate(alloc, frameSize);
+  }
+
+  // Coroutine frames are always freed with the sized operator delete, even
+  // when they were allocated with one of the overloads above.
+  static void operator delete(void* frame, std::size_t frameSize) noexcept {
+    get_trailer(frame, frameSize)->deallocate_(frame, frameSize);
+  }
+};
+}  // namespace _coro_frame
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
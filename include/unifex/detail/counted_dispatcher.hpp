@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+
+// Lets many threads ask for a dispatch without a lock.
+//
+// Every state change that may unblock a waiter (a release, an enqueue,
+// cancelling a waiter) calls dispatch().  Requests are counted: the
+// thread that takes the count from 0 runs 'drain', and keeps running it
+// until it has accounted for every request made in the meantime, so no
+// wakeup is lost.  Everyone else returns right away.
+//
+// 'drain' should collect the waiters it serves in a ready_waiters and
+// the caller resume them after dispatch() returns.
+class counted_dispatcher {
+public:
+  template <typename Drain>
+  void dispatch(Drain&& drain) noexcept {
+    std::uint32_t requests = 1;
+    if (requests_.fetch_add(requests, std::memory_order_acq_rel) != 0) {
+      // The current dispatcher will account for this request.
+      return;
+    }
+
+    while (true) {
+      drain();
+
+      // Other threads asked for a dispatch while we were draining; what
+      // they changed may have arrived after we looked, so drain again.
+      auto remaining =
+          requests_.fetch_sub(requests, std::memory_order_acq_rel) - requests;
+      if (remaining == 0) {
+        return;
+      }
+      requests = remaining;
+    }
+  }
+
+private:
+  std::atomic<std::uint32_t> requests_{0};
+};
+
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
@@ -0,0 +1,348 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/config.hpp>
+#include <unifex/blocking.hpp>
+#include <unifex/continuations.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/std_concepts.hpp>
+#include <unifex/stream_concepts.hpp>
+#include <unifex/type_list.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <exception>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace _fused {
+// A fused stream applies a chain of synchronous per-value stages to the
+// values of a source stream within a single next() operation.
+//
+// A stage is called as 'stage(emit, values...)' and returns whether it
+// passed anything on to 'emit', which it calls at most once. Its nested
+// 'output<Values...>' lists the argument lists it may call 'emit' with,
+// in the same form as then()'s result overloads.
+//
+// transform_stream() and filter_stream() produce fused streams. Applied to
+// a fused stream, they extend its chain of stages instead of adding another
+// layer of operations: the stream's tag_invoke() overload picks up any
+// adaptor CPO that exposes a nested 'stage<Func>'. reduce_stream() runs the
+// stages directly in its reduction loop when the source is batched.
+
+template <typename Stage, typename Overloads>
+struct _stage_output;
+
+template <typename Stage, typename... Overloads>
+struct _stage_output<Stage, type_list<Overloads...>> {
+  using type = concat_type_lists_unique_t<
+      apply_to_type_list_t<Stage::template output, Overloads>...>;
+};
+
+template <typename Stage, typename Overloads>
+using stage_output_t = typename _stage_output<Stage, Overloads>::type;
+
+template <typename Result, typename = void>
+struct _result_overload {
+  using type = type_list<Result>;
+};
+template <typename Result>
+struct _result_overload<Result, std::enable_if_t<std::is_void_v<Result>>> {
+  using type = type_list<>;
+};
+
+// Calls 'func' with each value and passes the result on.
+template <typename Func>
+struct transform_stage {
+  UNIFEX_NO_UNIQUE_ADDRESS Func func_;
+
+  template <typename... Values>
+  using output = type_list<
+      typename _result_overload<std::invoke_result_t<Func&, Values...>>::type>;
+
+  template <typename Emit, typename... Values>
+  bool operator()(Emit& emit, Values&&... values) {
+    if constexpr (std::is_void_v<std::invoke_result_t<Func&, Values...>>) {
+      std::invoke(func_, (Values &&) values...);
+      return emit();
+    } else {
+      return emit(std::invoke(func_, (Values &&) values...));
+    }
+  }
+};
+
+// Passes on the values for which 'pred' returns true.
+template <typename Pred>
+struct filter_stage {
+  UNIFEX_NO_UNIQUE_ADDRESS Pred pred_;
+
+  template <typename... Values>
+  using output = type_list<type_list<Values...>>;
+
+  template <typename Emit, typename... Values>
+  bool operator()(Emit& emit, Values&&... values) {
+    if (!std::invoke(pred_, std::as_const(values)...)) {
+      return false;
+    }
+    return emit((Values &&) values...);
+  }
+};
+
+// Runs 'First' and then 'Second' on whatever 'First' passes on.
+template <typename First, typename Second>
+struct compose_stage {
+  UNIFEX_NO_UNIQUE_ADDRESS First first_;
+  UNIFEX_NO_UNIQUE_ADDRESS Second second_;
+
+  template <typename... Values>
+  using output =
+      stage_output_t<Second, typename First::template output<Values...>>;
+
+  template <typename Emit, typename... Values>
+  bool operator()(Emit& emit, Values&&... values) {
+    auto passOn = [&](auto&&... mid) -> bool {
+      return second_(emit, static_cast<decltype(mid)>(mid)...);
+    };
+    return first_(passOn, (Values &&) values...);
+  }
+};
+
+template <typename Stream, typename Stage, typename Receiver>
+struct _op {
+  struct type;
+};
+template <typename Stream, typename Stage, typename Receiver>
+using operation = typename _op<Stream, Stage, remove_cvref_t<Receiver>>::type;
+
+template <typename Stream, typename Stage, typename Receiver>
+struct _next_receiver {
+  struct type;
+};
+template <typename Stream, typename Stage, typename Receiver>
+using next_receiver =
+    typename _next_receiver<Stream, Stage, remove_cvref_t<Receiver>>::type;
+
+template <typename Stream, typename Stage, typename Receiver>
+struct _next_receiver<Stream, Stage, Receiver>::type {
+  operation<Stream, Stage, Receiver>& op_;
+
+  template(typename CPO)                       //
+      (requires is_receiver_query_cpo_v<CPO>)  //
+      friend auto tag_invoke(CPO cpo, const type& r) noexcept(
+          std::is_nothrow_invocable_v<CPO, const Receiver&>)
+          -> std::invoke_result_t<CPO, const Receiver&> {
+    return std::move(cpo)(std::as_const(r.op_.receiver_));
+  }
+
+#if UNIFEX_ENABLE_CONTINUATION_VISITATIONS
+  template <typename Func>
+  friend void
+  tag_invoke(tag_t<visit_continuations>, const type& r, Func&& func) {
+    std::invoke(func, r.op_.receiver_);
+  }
+#endif
+
+  template <typename... Values>
+  void set_value(Values&&... values) && noexcept {
+    auto& op = op_;
+    UNIFEX_TRY {
+      auto emit = [&](auto&&... results) -> bool {
+        unifex::set_value(
+            std::move(op.receiver_),
+            static_cast<decltype(results)>(results)...);
+        return true;
+      };
+      if (!op.stage_(emit, (Values &&) values...)) {
+        // Nothing was passed on; pull the next value from the source.
+        op.next_.destruct();
+        op.nextEngaged_ = false;
+        op.next_.construct_with([&] {
+          return unifex::connect(next(op.stream_), type{op});
+        });
+        op.nextEngaged_ = true;
+        unifex::start(op.next_.get());
+      }
+    }
+    UNIFEX_CATCH(...) {
+      unifex::set_error(std::move(op.receiver_), std::current_exception());
+    }
+  }
+
+  void set_done() && noexcept { unifex::set_done(std::move(op_.receiver_)); }
+
+  template <typename Error>
+  void set_error(Error&& e) && noexcept {
+    unifex::set_error(std::move(op_.receiver_), (Error &&) e);
+  }
+};
+
+template <typename Stream, typename Stage, typename Receiver>
+struct _op<Stream, Stage, Receiver>::type {
+  using next_receiver_t = next_receiver<Stream, Stage, Receiver>;
+
+  Stream& stream_;
+  Stage& stage_;
+  Receiver receiver_;
+  manual_lifetime<next_operation_t<Stream, next_receiver_t>> next_;
+  bool nextEngaged_{false};
+
+  template <typename Receiver2>
+  explicit type(Stream& stream, Stage& stage, Receiver2&& receiver) noexcept(
+      std::is_nothrow_constructible_v<Receiver, Receiver2>&&
+          is_nothrow_connectable_v<next_sender_t<Stream>, next_receiver_t>)
+    : stream_(stream)
+    , stage_(stage)
+    , receiver_((Receiver2 &&) receiver) {
+    next_.construct_with(
+        [&] { return unifex::connect(next(stream_), next_receiver_t{*this}); });
+    nextEngaged_ = true;
+  }
+
+  ~type() {
+    if (nextEngaged_) {
+      next_.destruct();
+    }
+  }
+
+  void start() noexcept { unifex::start(next_.get()); }
+};
+
+template <typename Stream, typename Stage>
+struct _sender {
+  struct type;
+};
+template <typename Stream, typename Stage>
+using sender = typename _sender<Stream, Stage>::type;
+
+template <typename Stream, typename Stage>
+struct _sender<Stream, Stage>::type {
+  Stream& stream_;
+  Stage& stage_;
+
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = type_list_nested_apply_t<
+      sender_value_types_t<
+          next_sender_t<Stream>,
+          concat_type_lists_unique_t,
+          Stage::template output>,
+      Variant,
+      Tuple>;
+
+  template <template <typename...> class Variant>
+  using error_types = typename concat_type_lists_unique_t<
+      sender_error_types_t<next_sender_t<Stream>, type_list>,
+      type_list<std::exception_ptr>>::template apply<Variant>;
+
+  static constexpr bool sends_done =
+      sender_traits<next_sender_t<Stream>>::sends_done;
+
+  static constexpr auto blocking =
+      sender_traits<next_sender_t<Stream>>::blocking;
+
+  template(typename Receiver)                //
+      (requires receiver<Receiver> AND       //
+           sender_to<
+               next_sender_t<Stream>,
+               next_receiver<Stream, Stage, Receiver>>)  //
+      friend operation<Stream, Stage, Receiver> tag_invoke(
+          tag_t<connect>, const type& s, Receiver&& r) {
+    return operation<Stream, Stage, Receiver>{
+        s.stream_, s.stage_, (Receiver &&) r};
+  }
+};
+
+template <typename CPO, typename Func, typename = void>
+struct _has_stage : std::false_type {};
+template <typename CPO, typename Func>
+struct _has_stage<
+    CPO,
+    Func,
+    std::void_t<typename CPO::template stage<std::decay_t<Func>>>>
+  : std::true_type {};
+
+template <typename Stream, typename Stage>
+struct _stream {
+  struct type;
+};
+template <typename Stream, typename Stage>
+using stream = typename _stream<remove_cvref_t<Stream>, Stage>::type;
+
+template <typename Stream, typename Stage>
+struct _stream<Stream, Stage>::type {
+  UNIFEX_NO_UNIQUE_ADDRESS Stream source_;
+  UNIFEX_NO_UNIQUE_ADDRESS Stage stage_;
+
+  friend sender<Stream, Stage> tag_invoke(tag_t<next>, type& s) noexcept {
+    return sender<Stream, Stage>{s.source_, s.stage_};
+  }
+
+  friend auto tag_invoke(tag_t<cleanup>, type& s) noexcept(
+      noexcept(cleanup(s.source_))) -> cleanup_sender_t<Stream> {
+    return cleanup(s.source_);
+  }
+
+  // Adding another stage to a fused stream fuses it into this one.
+  template(typename CPO, typename Self, typename Func)            //
+      (requires _has_stage<CPO, Func>::value AND                   //
+           same_as<remove_cvref_t<Self>, type>)                    //
+      friend auto tag_invoke(CPO, Self&& self, Func&& func)
+          -> stream<
+              Stream,
+              compose_stage<
+                  Stage,
+                  typename CPO::template stage<std::decay_t<Func>>>> {
+    using next_stage = typename CPO::template stage<std::decay_t<Func>>;
+    return stream<Stream, compose_stage<Stage, next_stage>>{
+        static_cast<Self&&>(self).source_,
+        compose_stage<Stage, next_stage>{
+            static_cast<Self&&>(self).stage_, next_stage{(Func &&) func}}};
+  }
+};
+
+// Whether reduce_stream() can pull batches from the source of a fused stream
+// and run the stages itself.
+template <typename Stream, typename = void>
+inline constexpr bool is_fused_over_batched_v = false;
+template <typename Stream>
+inline constexpr bool is_fused_over_batched_v<
+    Stream,
+    std::enable_if_t<
+        std::is_same_v<
+            Stream,
+            typename _stream<
+                decltype(std::declval<Stream&>().source_),
+                decltype(std::declval<Stream&>().stage_)>::type>>> =
+    is_batched_stream_v<decltype(std::declval<Stream&>().source_)>;
+
+// Wraps 'stream' in a fused stream with a single stage.
+template <typename Stream, typename Stage>
+stream<Stream, Stage> make_stream(Stream&& source, Stage stage) {
+  return stream<Stream, Stage>{(Stream &&) source, std::move(stage)};
+}
+}  // namespace _fused
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
@@ -0,0 +1,380 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/config.hpp>
+#include <unifex/exception.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/stop_token_concepts.hpp>
+#include <unifex/type_list.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace _locked_stream {
+
+// The next() and cleanup() senders of the stream adaptors that keep their
+// state behind a mutex (transform_stream_async, merge_streams, chunk_stream,
+// read_ahead_stream). Each adaptor only provides its state, which must have:
+//
+//   values_type
+//     A std::tuple of the values sent by next().
+//   std::mutex& mutex()
+//   outcome take_locked(std::optional<values_type>&, std::exception_ptr&)
+//     Moves the next value or the final error out, or returns
+//     outcome::pending if there is none yet.
+//   void park_locked(consumer_base*)
+//   bool withdraw_locked(consumer_base*)
+//     Provided by deriving from single_consumer.
+//   void pull()
+//     Starts the work that produces the next value, if there is room for
+//     it. Called without the lock held.
+//   bool stop(cleanup_base*)
+//     Stops the in-flight work. Returns true if cleanup can go ahead right
+//     away; otherwise starts the cleanup_base once that work has completed.
+//   cleanup_source()
+//     Drops any values still held and returns the sender that cleans up
+//     whatever the state reads from.
+//
+// The *_locked() functions are called with the mutex held.
+
+struct consumer_base {
+  void (*resume_)(consumer_base*) noexcept;
+};
+
+struct cleanup_base {
+  void (*start_)(cleanup_base*) noexcept;
+};
+
+enum class outcome { pending, value, error, done, stopped };
+
+// The slot for the one next() operation that can be waiting on a state at a
+// time. The state resumes consumer_, after taking it out with the lock held,
+// once take_locked() has something for it.
+class single_consumer {
+public:
+  // Resume 'consumer' once take_locked() has something for it. Called with
+  // the lock held.
+  void park_locked(consumer_base* consumer) noexcept {
+    UNIFEX_ASSERT(consumer_ == nullptr);
+    consumer_ = consumer;
+  }
+
+  // Returns true if 'consumer' was still parked. Called with the lock held.
+  bool withdraw_locked(consumer_base* consumer) noexcept {
+    if (consumer_ != consumer) {
+      return false;
+    }
+    consumer_ = nullptr;
+    return true;
+  }
+
+protected:
+  consumer_base* consumer_ = nullptr;
+};
+
+template <typename Values>
+struct _value_types;
+template <typename... Values>
+struct _value_types<std::tuple<Values...>> {
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using apply = Variant<Tuple<Values...>>;
+};
+
+template <typename State>
+using cleanup_source_t = decltype(std::declval<State&>().cleanup_source());
+
+template <typename State, typename Receiver>
+struct _next_op {
+  class type;
+};
+template <typename State, typename Receiver>
+using next_operation = typename _next_op<State, remove_cvref_t<Receiver>>::type;
+
+template <typename State, typename Receiver>
+class _next_op<State, Receiver>::type : consumer_base {
+public:
+  template <typename Receiver2>
+  explicit type(State& state, Receiver2&& receiver)
+    : state_(state)
+    , receiver_((Receiver2 &&) receiver) {
+    this->resume_ = &type::resume;
+  }
+
+  void start() noexcept {
+    outcome result;
+    {
+      std::lock_guard lock{state_.mutex()};
+      result = state_.take_locked(value_, error_);
+    }
+    state_.pull();
+    if (result != outcome::pending) {
+      complete(result);
+      return;
+    }
+
+    stopCallback_.construct(get_stop_token(receiver_), cancel_callback{*this});
+    {
+      std::lock_guard lock{state_.mutex()};
+      if (stopRequested_) {
+        result = outcome::stopped;
+      } else {
+        result = state_.take_locked(value_, error_);
+        if (result == outcome::pending) {
+          state_.park_locked(this);
+          return;
+        }
+      }
+    }
+    stopCallback_.destruct();
+    if (result != outcome::stopped) {
+      state_.pull();
+    }
+    complete(result);
+  }
+
+private:
+  using values_type = typename State::values_type;
+  using stop_token_type = stop_token_type_t<Receiver&>;
+
+  struct cancel_callback {
+    type& op_;
+    void operator()() noexcept { op_.request_stop(); }
+  };
+
+  static void resume(consumer_base* base) noexcept {
+    auto& op = *static_cast<type*>(base);
+    outcome result;
+    {
+      std::lock_guard lock{op.state_.mutex()};
+      result = op.state_.take_locked(op.value_, op.error_);
+    }
+    UNIFEX_ASSERT(result != outcome::pending);
+    op.stopCallback_.destruct();
+    op.state_.pull();
+    op.complete(result);
+  }
+
+  void request_stop() noexcept {
+    bool withdrawn;
+    {
+      std::lock_guard lock{state_.mutex()};
+      stopRequested_ = true;
+      withdrawn = state_.withdraw_locked(this);
+    }
+    if (withdrawn) {
+      stopCallback_.destruct();
+      complete(outcome::stopped);
+    }
+  }
+
+  void complete(outcome result) noexcept {
+    switch (result) {
+      case outcome::value:
+        UNIFEX_TRY {
+          std::apply(
+              [&](auto&&... values) {
+                unifex::set_value(std::move(receiver_), std::move(values)...);
+              },
+              std::move(*value_));
+        }
+        UNIFEX_CATCH(...) {
+          unifex::set_error(std::move(receiver_), std::current_exception());
+        }
+        break;
+      case outcome::error:
+        unifex::set_error(std::move(receiver_), std::move(error_));
+        break;
+      default:
+        unifex::set_done(std::move(receiver_));
+        break;
+    }
+  }
+
+  State& state_;
+  Receiver receiver_;
+  std::optional<values_type> value_;
+  std::exception_ptr error_;
+  bool stopRequested_ = false;
+  manual_lifetime<
+      typename stop_token_type::template callback_type<cancel_callback>>
+      stopCallback_;
+};
+
+template <typename State>
+struct _next_sender {
+  class type;
+};
+template <typename State>
+using next_sender = typename _next_sender<State>::type;
+
+template <typename State>
+class _next_sender<State>::type {
+public:
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = typename _value_types<
+      typename State::values_type>::template apply<Variant, Tuple>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::exception_ptr>;
+
+  static constexpr bool sends_done = true;
+
+  explicit type(State& state) noexcept : state_(state) {}
+
+  template(typename Receiver)        //
+      (requires receiver<Receiver>)  //
+      friend next_operation<State, Receiver> tag_invoke(
+          tag_t<connect>, const type& s, Receiver&& r) {
+    return next_operation<State, Receiver>{s.state_, (Receiver &&) r};
+  }
+
+private:
+  State& state_;
+};
+
+template <typename State, typename Receiver>
+struct _cleanup_op {
+  class type;
+};
+template <typename State, typename Receiver>
+using cleanup_operation =
+    typename _cleanup_op<State, remove_cvref_t<Receiver>>::type;
+
+template <typename State, typename Receiver>
+class _cleanup_op<State, Receiver>::type : cleanup_base {
+public:
+  template <typename Receiver2>
+  explicit type(State& state, Receiver2&& receiver)
+    : state_(state)
+    , receiver_((Receiver2 &&) receiver) {
+    this->start_ = &type::start_cleanup;
+  }
+
+  void start() noexcept {
+    if (state_.stop(this)) {
+      start_cleanup(this);
+    }
+  }
+
+private:
+  struct cleanup_receiver {
+    type& op_;
+
+    void set_done() && noexcept {
+      auto& op = op_;
+      op.cleanupOp_.destruct();
+      unifex::set_done(std::move(op.receiver_));
+    }
+
+    template <typename Error>
+    void set_error(Error&& error) && noexcept {
+      auto& op = op_;
+      op.cleanupOp_.destruct();
+      unifex::set_error(std::move(op.receiver_), (Error &&) error);
+    }
+
+    template(typename CPO)                       //
+        (requires is_receiver_query_cpo_v<CPO>)  //
+        friend auto tag_invoke(CPO cpo, const cleanup_receiver& r) noexcept(
+            std::is_nothrow_invocable_v<CPO, const Receiver&>)
+            -> std::invoke_result_t<CPO, const Receiver&> {
+      return std::move(cpo)(r.get_receiver());
+    }
+
+    const Receiver& get_receiver() const noexcept { return op_.receiver_; }
+  };
+
+  static void start_cleanup(cleanup_base* base) noexcept {
+    auto& op = *static_cast<type*>(base);
+    UNIFEX_TRY {
+      op.cleanupOp_.construct_with([&] {
+        return unifex::connect(
+            op.state_.cleanup_source(), cleanup_receiver{op});
+      });
+    }
+    UNIFEX_CATCH(...) {
+      unifex::set_error(std::move(op.receiver_), std::current_exception());
+      return;
+    }
+    unifex::start(op.cleanupOp_.get());
+  }
+
+  State& state_;
+  Receiver receiver_;
+  manual_lifetime<connect_result_t<cleanup_source_t<State>, cleanup_receiver>>
+      cleanupOp_;
+};
+
+template <typename State>
+struct _cleanup_sender {
+  class type;
+};
+template <typename State>
+using cleanup_sender = typename _cleanup_sender<State>::type;
+
+template <typename State>
+class _cleanup_sender<State>::type {
+public:
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<>;
+
+  template <template <typename...> class Variant>
+  using error_types = typename concat_type_lists_unique_t<
+      sender_error_types_t<cleanup_source_t<State>, type_list>,
+      type_list<std::exception_ptr>>::template apply<Variant>;
+
+  static constexpr bool sends_done = true;
+
+  explicit type(State& state) noexcept : state_(state) {}
+
+  template(typename Receiver)        //
+      (requires receiver<Receiver>)  //
+      friend cleanup_operation<State, Receiver> tag_invoke(
+          tag_t<connect>, const type& s, Receiver&& r) {
+    return cleanup_operation<State, Receiver>{s.state_, (Receiver &&) r};
+  }
+
+private:
+  State& state_;
+};
+}  // namespace _locked_stream
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
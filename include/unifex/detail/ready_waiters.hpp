@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/detail/intrusive_queue.hpp>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+
+// Waiters that a dispatcher has served but not yet resumed.
+//
+// A resumed waiter may go on to destroy the primitive it was waiting
+// on, so a dispatcher collects waiters here while it still touches its
+// own state, and calls resume_all() as the very last thing it does.
+template <typename Waiter>
+class ready_waiters {
+public:
+  void push_back(Waiter* waiter) noexcept { queue_.push_back(waiter); }
+
+  void resume_all() noexcept {
+    while (!queue_.empty()) {
+      auto* waiter = queue_.pop_front();
+      waiter->resume_(waiter);
+    }
+  }
+
+private:
+  intrusive_queue<Waiter, &Waiter::nextReady_> queue_;
+};
+
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
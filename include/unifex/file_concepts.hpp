@@ -67,11 +67,62 @@ inline const struct open_file_read_write_cpo {
     return unifex::tag_invoke(*this, (Executor &&) executor, path);
   }
 } open_file_read_write{};
+
+// The *_direct variants open the file bypassing the page cache (e.g. O_DIRECT
+// on Linux). Reads and writes issued on the returned file must use offsets,
+// lengths and buffer addresses that are multiples of the file's alignment().
+inline const struct open_file_read_only_direct_cpo {
+  template <typename Executor>
+  auto operator()(Executor&& executor, const filesystem::path& path) const
+      noexcept(is_nothrow_tag_invocable_v<
+               open_file_read_only_direct_cpo,
+               Executor,
+               const filesystem::path&>)
+          -> tag_invoke_result_t<
+              open_file_read_only_direct_cpo,
+              Executor,
+              const filesystem::path&> {
+    return unifex::tag_invoke(*this, (Executor &&) executor, path);
+  }
+} open_file_read_only_direct{};
+
+inline const struct open_file_write_only_direct_cpo {
+  template <typename Executor>
+  auto operator()(Executor&& executor, const filesystem::path& path) const
+      noexcept(is_nothrow_tag_invocable_v<
+               open_file_write_only_direct_cpo,
+               Executor,
+               const filesystem::path&>)
+          -> tag_invoke_result_t<
+              open_file_write_only_direct_cpo,
+              Executor,
+              const filesystem::path&> {
+    return unifex::tag_invoke(*this, (Executor &&) executor, path);
+  }
+} open_file_write_only_direct{};
+
+inline const struct open_file_read_write_direct_cpo {
+  template <typename Executor>
+  auto operator()(Executor&& executor, const filesystem::path& path) const
+      noexcept(is_nothrow_tag_invocable_v<
+               open_file_read_write_direct_cpo,
+               Executor,
+               const filesystem::path&>)
+          -> tag_invoke_result_t<
+              open_file_read_write_direct_cpo,
+              Executor,
+              const filesystem::path&> {
+    return unifex::tag_invoke(*this, (Executor &&) executor, path);
+  }
+} open_file_read_write_direct{};
 }  // namespace _filesystem
 
 using _filesystem::open_file_read_only;
+using _filesystem::open_file_read_only_direct;
 using _filesystem::open_file_read_write;
+using _filesystem::open_file_read_write_direct;
 using _filesystem::open_file_write_only;
+using _filesystem::open_file_write_only_direct;
 }  // namespace unifex
 
 #include <unifex/detail/epilogue.hpp>
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/span.hpp>
+
+#include <unifex/linux/mmap_region.hpp>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace linuxos {
+
+// A pool of fixed-size buffers whose addresses and sizes are multiples of
+// a given alignment, suitable for use with files opened for direct I/O
+// (see open_file_read_only_direct()).
+//
+// All of the memory is reserved up-front in a single anonymous mapping so
+// that acquiring and releasing buffers never allocates.
+//
+// The pool is not thread-safe. Buffers should be acquired and released from
+// one thread at a time, and must be released before the pool is destroyed.
+class aligned_buffer_pool {
+public:
+  class buffer {
+  public:
+    buffer() noexcept : pool_(nullptr), data_(nullptr) {}
+
+    buffer(buffer&& other) noexcept
+      : pool_(std::exchange(other.pool_, nullptr))
+      , data_(std::exchange(other.data_, nullptr)) {}
+
+    ~buffer() {
+      if (data_ != nullptr) {
+        pool_->release(data_);
+      }
+    }
+
+    buffer& operator=(buffer other) noexcept {
+      std::swap(pool_, other.pool_);
+      std::swap(data_, other.data_);
+      return *this;
+    }
+
+    explicit operator bool() const noexcept { return data_ != nullptr; }
+
+    std::byte* data() const noexcept { return data_; }
+
+    std::size_t size() const noexcept {
+      return data_ != nullptr ? pool_->buffer_size() : 0;
+    }
+
+    span<std::byte> bytes() const noexcept { return span{data_, size()}; }
+
+  private:
+    friend aligned_buffer_pool;
+
+    explicit buffer(aligned_buffer_pool& pool, std::byte* data) noexcept
+      : pool_(&pool)
+      , data_(data) {}
+
+    aligned_buffer_pool* pool_;
+    std::byte* data_;
+  };
+
+  static constexpr std::size_t default_alignment = 4096;
+
+  // Reserves 'bufferCount' buffers of at least 'bufferSize' bytes each.
+  // The buffer size is rounded up to a multiple of 'alignment', which must
+  // be a power of two.
+  explicit aligned_buffer_pool(
+      std::size_t bufferSize,
+      std::size_t bufferCount,
+      std::size_t alignment = default_alignment);
+
+  aligned_buffer_pool(aligned_buffer_pool&&) = delete;
+
+  ~aligned_buffer_pool() { UNIFEX_ASSERT(free_.size() == capacity_); }
+
+  // Returns an empty buffer if all buffers are currently in use.
+  buffer try_acquire() noexcept {
+    if (free_.empty()) {
+      return buffer{};
+    }
+    std::byte* data = free_.back();
+    free_.pop_back();
+    return buffer{*this, data};
+  }
+
+  // Throws std::bad_alloc if all buffers are currently in use.
+  buffer acquire();
+
+  std::size_t buffer_size() const noexcept { return bufferSize_; }
+
+  std::size_t alignment() const noexcept { return alignment_; }
+
+  std::size_t capacity() const noexcept { return capacity_; }
+
+  std::size_t available() const noexcept { return free_.size(); }
+
+private:
+  void release(std::byte* data) noexcept {
+    UNIFEX_ASSERT(free_.size() < capacity_);
+    free_.push_back(data);
+  }
+
+  std::size_t bufferSize_;
+  std::size_t alignment_;
+  std::size_t capacity_;
+  mmap_region region_;
+  std::vector<std::byte*> free_;
+};
+
+}  // namespace linuxos
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
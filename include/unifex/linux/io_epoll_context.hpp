@@ -20,9 +20,12 @@
 
 #  include <unifex/get_stop_token.hpp>
 #  include <unifex/io_concepts.hpp>
+#  include <unifex/just_done.hpp>
 #  include <unifex/manual_lifetime.hpp>
 #  include <unifex/pipe_concepts.hpp>
 #  include <unifex/receiver_concepts.hpp>
+#  include <unifex/running_in_this_thread.hpp>
+#  include <unifex/socket_concepts.hpp>
 #  include <unifex/span.hpp>
 #  include <unifex/stop_token_concepts.hpp>
 #  include <unifex/detail/atomic_intrusive_queue.hpp>
@@ -33,13 +36,17 @@
 #  include <unifex/linux/safe_file_descriptor.hpp>
 
 #  include <atomic>
+#  include <cerrno>
 #  include <cstddef>
 #  include <cstdint>
+#  include <cstring>
+#  include <memory>
 #  include <optional>
 #  include <system_error>
 #  include <utility>
 
 #  include <sys/epoll.h>
+#  include <sys/socket.h>
 #  include <sys/uio.h>
 
 #  include <unifex/detail/prologue.hpp>
@@ -51,13 +58,16 @@ class io_epoll_context {
 public:
   class schedule_sender;
   class schedule_at_sender;
-  template <typename Duration>
   class schedule_after_sender;
   class scheduler;
   class read_sender;
   class write_sender;
   class async_reader;
   class async_writer;
+  class async_socket;
+  class accept_sender;
+  class accept_stream;
+  class connect_sender;
 
   io_epoll_context();
 
@@ -81,6 +91,10 @@ private:
   };
 
   struct completion_base : operation_base {};
+  struct cancel_base : operation_base {};
+
+  template <typename IO, typename Receiver>
+  class io_operation;
 
   struct stop_operation : operation_base {
     stop_operation() noexcept {
@@ -91,21 +105,71 @@ private:
     bool shouldStop_ = false;
   };
 
+  // A file descriptor that stays registered with the epoll instance for its
+  // whole lifetime, in edge-triggered mode for both directions.
+  //
+  // I/O operations always attempt the non-blocking syscall first and only
+  // park themselves in 'reader_'/'writer_' when it fails with EAGAIN. The
+  // next readiness edge then enqueues whichever operation is parked, which
+  // retries the syscall. Both fields are only accessed on the I/O thread.
+  //
+  // Owners may drop a registration from any thread while the I/O thread
+  // still holds an event for it from the current epoll_wait() batch. So
+  // dropping one only deregisters and closes the fd, and retires the
+  // registration to the context. The I/O thread frees retired registrations
+  // before its next epoll_wait(), and the context frees any that are left
+  // when it is destroyed.
+  struct fd_registration {
+    explicit fd_registration(
+        io_epoll_context& context, safe_file_descriptor fd);
+
+    fd_registration(fd_registration&&) = delete;
+
+    void retire() noexcept;
+
+    struct deleter {
+      void operator()(fd_registration* registration) const noexcept {
+        registration->retire();
+      }
+    };
+
+    io_epoll_context& context_;
+    safe_file_descriptor fd_;
+    completion_base* reader_ = nullptr;
+    completion_base* writer_ = nullptr;
+    fd_registration* nextRetired_ = nullptr;
+  };
+
+  using fd_registration_ptr =
+      std::unique_ptr<fd_registration, fd_registration::deleter>;
+
+  static fd_registration_ptr
+  make_fd_registration(io_epoll_context& context, safe_file_descriptor fd) {
+    return fd_registration_ptr{new fd_registration(context, std::move(fd))};
+  }
+
   using time_point = linuxos::monotonic_clock::time_point;
 
+  using duration = linuxos::monotonic_clock::duration;
+
   struct schedule_at_operation : operation_base {
     explicit schedule_at_operation(
         io_epoll_context& context,
         const time_point& dueTime,
+        duration slack,
         bool canBeCancelled) noexcept
       : context_(context)
       , dueTime_(dueTime)
+      , latestTime_(dueTime + slack)
       , canBeCancelled_(canBeCancelled) {}
 
     schedule_at_operation* timerNext_;
     schedule_at_operation* timerPrev_;
     io_epoll_context& context_;
+    // The timer may complete at any point in [dueTime_, latestTime_]. This
+    // lets timers that expire close together share a single OS timer.
     time_point dueTime_;
+    time_point latestTime_;
     bool canBeCancelled_;
 
     static constexpr std::uint32_t timer_elapsed_flag = 1;
@@ -121,7 +185,7 @@ private:
       &schedule_at_operation::timerNext_,
       &schedule_at_operation::timerPrev_,
       time_point,
-      &schedule_at_operation::dueTime_>;
+      &schedule_at_operation::latestTime_>;
 
   bool is_running_on_io_thread() const noexcept;
   void run_impl(const bool& shouldStop);
@@ -164,6 +228,10 @@ private:
   void update_timers() noexcept;
   bool try_submit_timer_io(const time_point& dueTime) noexcept;
 
+  // Frees the registrations retired so far. None of them can be returned
+  // by an epoll_wait() that starts after this.
+  void free_retired_registrations() noexcept;
+
   void* timer_user_data() const {
     return const_cast<void*>(static_cast<const void*>(&timers_));
   }
@@ -197,6 +265,9 @@ private:
 
   // Queue of operations enqueued by remote threads.
   atomic_intrusive_queue<operation_base, &operation_base::next_> remoteQueue_;
+
+  // Registrations dropped by their owners, waiting to be freed.
+  std::atomic<fd_registration*> retiredRegistrations_{nullptr};
 };
 
 template <typename StopToken>
@@ -284,6 +355,8 @@ private:
 };
 
 class io_epoll_context::schedule_at_sender {
+  friend io_epoll_context::schedule_after_sender;
+
   template <typename Receiver>
   struct operation : schedule_at_operation {
     static constexpr bool is_stop_ever_possible =
@@ -291,9 +364,12 @@ class io_epoll_context::schedule_at_sender {
 
   public:
     explicit operation(
-        io_epoll_context& context, const time_point& dueTime, Receiver&& r)
+        io_epoll_context& context,
+        const time_point& dueTime,
+        duration slack,
+        Receiver&& r)
       : schedule_at_operation(
-            context, dueTime, get_stop_token(r).stop_possible())
+            context, dueTime, slack, get_stop_token(r).stop_possible())
       , receiver_((Receiver &&) r) {}
 
     void start() noexcept {
@@ -455,19 +531,75 @@ public:
   static constexpr bool sends_done = true;
 
   explicit schedule_at_sender(
-      io_epoll_context& context, const time_point& dueTime) noexcept
+      io_epoll_context& context,
+      const time_point& dueTime,
+      duration slack = duration::zero()) noexcept
     : context_(context)
-    , dueTime_(dueTime) {}
+    , dueTime_(dueTime)
+    , slack_(slack) {}
 
   template <typename Receiver>
   operation<remove_cvref_t<Receiver>> connect(Receiver&& r) const& {
     return operation<remove_cvref_t<Receiver>>{
-        context_, dueTime_, (Receiver &&) r};
+        context_, dueTime_, slack_, (Receiver &&) r};
   }
 
 private:
   io_epoll_context& context_;
   time_point dueTime_;
+  duration slack_;
+};
+
+class io_epoll_context::schedule_after_sender {
+  template <typename Receiver>
+  struct operation : schedule_at_sender::operation<Receiver> {
+    explicit operation(
+        io_epoll_context& context, duration delay, duration slack, Receiver&& r)
+      : schedule_at_sender::operation<Receiver>(
+            context, time_point{}, slack, (Receiver &&) r)
+      , delay_(delay)
+      , slack_(slack) {}
+
+    void start() noexcept {
+      this->dueTime_ = monotonic_clock::now() + delay_;
+      this->latestTime_ = this->dueTime_ + slack_;
+      schedule_at_sender::operation<Receiver>::start();
+    }
+
+  private:
+    duration delay_;
+    duration slack_;
+  };
+
+public:
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<Tuple<>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::exception_ptr>;
+
+  static constexpr bool sends_done = true;
+
+  explicit schedule_after_sender(
+      io_epoll_context& context, duration delay, duration slack) noexcept
+    : context_(context)
+    , delay_(delay)
+    , slack_(slack) {}
+
+  template <typename Receiver>
+  operation<remove_cvref_t<Receiver>> connect(Receiver&& r) const& {
+    return operation<remove_cvref_t<Receiver>>{
+        context_, delay_, slack_, (Receiver &&) r};
+  }
+
+private:
+  io_epoll_context& context_;
+  duration delay_;
+  duration slack_;
 };
 
 class io_epoll_context::scheduler {
@@ -482,8 +614,18 @@ public:
 
   time_point now() const noexcept { return monotonic_clock::now(); }
 
-  schedule_at_sender schedule_at(const time_point& dueTime) const noexcept {
-    return schedule_at_sender{*context_, dueTime};
+  // A non-zero 'slack' allows the timer to complete up to that long after
+  // 'dueTime', so that it can be batched with other timers expiring in the
+  // same window instead of reprogramming the OS timer for it.
+  schedule_at_sender schedule_at(
+      const time_point& dueTime,
+      duration slack = duration::zero()) const noexcept {
+    return schedule_at_sender{*context_, dueTime, slack};
+  }
+
+  schedule_after_sender schedule_after(
+      duration delay, duration slack = duration::zero()) const noexcept {
+    return schedule_after_sender{*context_, delay, slack};
   }
 
 private:
@@ -492,6 +634,15 @@ private:
   friend std::pair<async_reader, async_writer>
   tag_invoke(tag_t<open_pipe>, scheduler s);
 
+  friend accept_stream
+  tag_invoke(tag_t<open_listening_socket>, scheduler s, port_t port);
+
+  friend connect_sender tag_invoke(
+      tag_t<async_connect>,
+      scheduler s,
+      const sockaddr* address,
+      socklen_t addressLength) noexcept;
+
   friend bool operator==(scheduler a, scheduler b) noexcept {
     return a.context_ == b.context_;
   }
@@ -499,8 +650,17 @@ private:
     return a.context_ != b.context_;
   }
 
+  friend bool
+  tag_invoke(tag_t<running_in_this_thread>, const scheduler& s) noexcept {
+    return s.is_running_on_io_thread_();
+  }
+
   explicit scheduler(io_epoll_context& context) noexcept : context_(&context) {}
 
+  bool is_running_on_io_thread_() const noexcept {
+    return context_->is_running_on_io_thread();
+  }
+
   io_epoll_context* context_;
 };
 
@@ -508,201 +668,224 @@ inline io_epoll_context::scheduler io_epoll_context::get_scheduler() noexcept {
   return scheduler{*this};
 }
 
-class io_epoll_context::read_sender {
-  struct done_op : operation_base {};
-
-  template <typename Receiver>
-  class operation
-    : private completion_base
-    , private done_op {
-    friend io_epoll_context;
+// Drives a non-blocking syscall on a registered fd to completion.
+//
+// 'IO' describes the syscall. It provides:
+//  - 'waiter', the fd_registration slot to park in while the fd would block,
+//  - 'registration()', the fd_registration to park on,
+//  - 'try_io()', which performs the syscall and returns its result or -errno,
+//  - 'set_value(receiver, result)', which delivers a non-negative result.
+template <typename IO, typename Receiver>
+class io_epoll_context::io_operation
+  : private completion_base
+  , private cancel_base {
+  friend io_epoll_context;
 
-    static constexpr bool is_stop_ever_possible =
-        !is_stop_never_possible_v<stop_token_type_t<Receiver>>;
+  static constexpr bool is_stop_ever_possible =
+      !is_stop_never_possible_v<stop_token_type_t<Receiver>>;
 
-  public:
-    template <typename Receiver2>
-    explicit operation(const read_sender& sender, Receiver2&& r)
-      : context_(sender.context_)
-      , fd_(sender.fd_)
-      , receiver_((Receiver2 &&) r) {
-      buffer_[0].iov_base = sender.buffer_.data();
-      buffer_[0].iov_len = sender.buffer_.size();
+public:
+  template <typename IO2, typename Receiver2>
+  explicit io_operation(io_epoll_context& context, IO2&& io, Receiver2&& r)
+    : context_(context)
+    , io_((IO2 &&) io)
+    , receiver_((Receiver2 &&) r) {}
+
+  void start() noexcept {
+    if (!context_.is_running_on_io_thread()) {
+      static_cast<completion_base*>(this)->execute_ =
+          &io_operation::on_schedule_complete;
+      context_.schedule_remote(static_cast<completion_base*>(this));
+    } else {
+      start_io();
     }
+  }
 
-    void start() noexcept {
-      if (!context_.is_running_on_io_thread()) {
-        static_cast<completion_base*>(this)->execute_ =
-            &operation::on_schedule_complete;
-        context_.schedule_remote(static_cast<completion_base*>(this));
-      } else {
-        start_io();
-      }
-    }
+private:
+  static void on_schedule_complete(operation_base* op) noexcept {
+    auto& self =
+        *static_cast<io_operation*>(static_cast<completion_base*>(op));
+    self.start_io();
+  }
 
-  private:
-    static void on_schedule_complete(operation_base* op) noexcept {
-      auto& self = *static_cast<operation*>(static_cast<completion_base*>(op));
-      self.start_io();
+  void start_io() noexcept {
+    UNIFEX_ASSERT(context_.is_running_on_io_thread());
+
+    ssize_t result;
+    if (!try_io(result)) {
+      return;
     }
 
-    void start_io() noexcept {
-      UNIFEX_ASSERT(context_.is_running_on_io_thread());
+    if (result == -EAGAIN || result == -EWOULDBLOCK) {
+      wait_until_ready();
+      return;
+    }
 
-      auto result = readv(fd_, buffer_, 1);
+    complete(result);
+  }
 
-      if (result == -EAGAIN || result == -EWOULDBLOCK || result == -EPERM) {
-        if constexpr (is_stop_ever_possible) {
-          stopCallback_.construct(
-              get_stop_token(receiver_), cancel_callback{*this});
-        }
-        UNIFEX_ASSERT(
-            static_cast<completion_base*>(this)->enqueued_.load() == 0);
-        static_cast<completion_base*>(this)->execute_ =
-            &operation::on_read_complete;
-        epoll_event event;
-        event.data.ptr = static_cast<completion_base*>(this);
-        event.events = EPOLLIN | EPOLLRDHUP | EPOLLHUP;
-        (void)epoll_ctl(context_.epollFd_.get(), EPOLL_CTL_ADD, fd_, &event);
-        return;
+  // Returns false if the attempt threw and the receiver has been completed.
+  bool try_io(ssize_t& result) noexcept {
+    if constexpr (noexcept(io_.try_io())) {
+      result = io_.try_io();
+      return true;
+    } else {
+      UNIFEX_TRY {
+        result = io_.try_io();
+        return true;
       }
-
-      auto oldState = state_.fetch_add(
-          io_epoll_context::read_sender::operation<Receiver>::io_flag,
-          std::memory_order_acq_rel);
-      if ((oldState &
-           io_epoll_context::read_sender::operation<
-               Receiver>::cancel_pending_mask) != 0) {
-        // io has been cancelled by a remote thread.
-        // The other thread is responsible for enqueueing the operation
-        // completion
-        return;
+      UNIFEX_CATCH(...) {
+        unifex::set_error(std::move(receiver_), std::current_exception());
+        return false;
       }
+    }
+  }
 
-      if (result == -ECANCELED) {
-        unifex::set_done(std::move(receiver_));
-      } else if (result >= 0) {
-        if constexpr (is_nothrow_receiver_of_v<Receiver, ssize_t>) {
-          unifex::set_value(std::move(receiver_), ssize_t(result));
-        } else {
-          UNIFEX_TRY {
-            unifex::set_value(std::move(receiver_), ssize_t(result));
-          }
-          UNIFEX_CATCH(...) {
-            unifex::set_error(std::move(receiver_), std::current_exception());
-          }
-        }
-      } else {
-        unifex::set_error(
-            std::move(receiver_),
-            std::error_code{-int(result), std::system_category()});
-      }
+  // Park this operation on the registration until the next readiness edge.
+  void wait_until_ready() noexcept {
+    UNIFEX_ASSERT(context_.is_running_on_io_thread());
+    UNIFEX_ASSERT(io_.registration().*IO::waiter == nullptr);
+    UNIFEX_ASSERT(static_cast<completion_base*>(this)->enqueued_.load() == 0);
+
+    static_cast<completion_base*>(this)->execute_ = &io_operation::on_ready;
+    io_.registration().*IO::waiter = static_cast<completion_base*>(this);
+
+    if constexpr (is_stop_ever_possible) {
+      stopCallback_.construct(
+          get_stop_token(receiver_), cancel_callback{*this});
     }
+  }
 
-    static void on_read_complete(operation_base* op) noexcept {
-      auto& self = *static_cast<operation*>(static_cast<completion_base*>(op));
+  static void on_ready(operation_base* op) noexcept {
+    auto& self =
+        *static_cast<io_operation*>(static_cast<completion_base*>(op));
 
-      UNIFEX_ASSERT(static_cast<completion_base&>(self).enqueued_.load() == 0);
+    UNIFEX_ASSERT(static_cast<completion_base&>(self).enqueued_.load() == 0);
 
+    if constexpr (is_stop_ever_possible) {
       self.stopCallback_.destruct();
+    }
 
-      auto oldState = self.state_.fetch_add(
-          io_epoll_context::read_sender::operation<Receiver>::io_flag,
-          std::memory_order_acq_rel);
-      if ((oldState &
-           io_epoll_context::read_sender::operation<
-               Receiver>::cancel_pending_mask) != 0) {
-        // io has been cancelled by a remote thread.
-        // The other thread is responsible for enqueueing the operation
-        // completion
-        return;
-      }
+    auto oldState = self.state_.fetch_add(
+        io_operation::io_flag, std::memory_order_acq_rel);
+    if ((oldState & io_operation::cancel_pending_mask) != 0) {
+      // io has been cancelled by a remote thread.
+      // The other thread is responsible for enqueueing the operation
+      // completion
+      return;
+    }
 
-      epoll_event event = {};
-      (void)epoll_ctl(
-          self.context_.epollFd_.get(), EPOLL_CTL_DEL, self.fd_, &event);
+    ssize_t result;
+    if (!self.try_io(result)) {
+      return;
+    }
 
-      auto result = readv(self.fd_, self.buffer_, 1);
-      UNIFEX_ASSERT(result != -EAGAIN);
-      UNIFEX_ASSERT(result != -EWOULDBLOCK);
-      if (result == -ECANCELED) {
-        unifex::set_done(std::move(self.receiver_));
-      } else if (result >= 0) {
-        if constexpr (is_nothrow_receiver_of_v<Receiver, ssize_t>) {
-          unifex::set_value(std::move(self).receiver_, ssize_t(result));
-        } else {
-          UNIFEX_TRY {
-            unifex::set_value(std::move(self).receiver_, ssize_t(result));
-          }
-          UNIFEX_CATCH(...) {
-            unifex::set_error(
-                std::move(self).receiver_, std::current_exception());
-          }
-        }
-      } else {
-        unifex::set_error(
-            std::move(self.receiver_),
-            std::error_code{-int(result), std::system_category()});
+    if (result == -EAGAIN || result == -EWOULDBLOCK) {
+      // Woken by an edge that was raised before the last attempt drained
+      // the fd. Wait for the next one.
+      self.state_.fetch_sub(io_operation::io_flag, std::memory_order_relaxed);
+      self.wait_until_ready();
+      return;
+    }
+
+    self.complete(result);
+  }
+
+  void complete(ssize_t result) noexcept {
+    if (result >= 0) {
+      UNIFEX_TRY { io_.set_value(std::move(receiver_), result); }
+      UNIFEX_CATCH(...) {
+        unifex::set_error(std::move(receiver_), std::current_exception());
       }
+    } else if (result == -ECANCELED) {
+      unifex::set_done(std::move(receiver_));
+    } else {
+      unifex::set_error(
+          std::move(receiver_),
+          std::error_code{-int(result), std::system_category()});
     }
+  }
 
-    static void complete_with_done(operation_base* op) noexcept {
-      auto& self = *static_cast<operation*>(static_cast<done_op*>(op));
+  static void complete_with_done(operation_base* op) noexcept {
+    auto& self = *static_cast<io_operation*>(static_cast<cancel_base*>(op));
 
-      UNIFEX_ASSERT(static_cast<done_op&>(self).enqueued_.load() == 0);
+    UNIFEX_ASSERT(static_cast<cancel_base&>(self).enqueued_.load() == 0);
 
-      if (static_cast<completion_base&>(self).enqueued_.load() == 0) {
-        // Avoid instantiating set_done() if we're not going to call it.
-        if constexpr (is_stop_ever_possible) {
-          unifex::set_done(std::move(self.receiver_));
-        } else {
-          // This should never be called if stop is not possible.
-          UNIFEX_ASSERT(false);
+    if (static_cast<completion_base&>(self).enqueued_.load() == 0) {
+      // Avoid instantiating set_done() if we're not going to call it.
+      if constexpr (is_stop_ever_possible) {
+        auto* waiting = static_cast<completion_base*>(&self);
+        auto& slot = self.io_.registration().*IO::waiter;
+        if (slot == waiting) {
+          // Still waiting for readiness, stop waiting. on_ready() won't run,
+          // so destroy the stop callback here; this also waits for
+          // request_stop() to return on the thread that requested stop.
+          self.stopCallback_.destruct();
+          slot = nullptr;
         }
+        unifex::set_done(std::move(self.receiver_));
       } else {
-        // reschedule after queued io is cleared
-        static_cast<done_op&>(self).execute_ = &operation::complete_with_done;
-        self.context_.schedule_local(static_cast<done_op*>(&self));
+        // This should never be called if stop is not possible.
+        UNIFEX_ASSERT(false);
       }
+    } else {
+      // reschedule after queued io is cleared
+      static_cast<cancel_base&>(self).execute_ =
+          &io_operation::complete_with_done;
+      self.context_.schedule_local(static_cast<cancel_base*>(&self));
     }
+  }
 
-    void request_stop() noexcept {
-      auto oldState = this->state_.fetch_add(
-          io_epoll_context::read_sender::operation<
-              Receiver>::cancel_pending_flag,
-          std::memory_order_acq_rel);
-      if ((oldState &
-           io_epoll_context::read_sender::operation<Receiver>::io_mask) == 0) {
-        // IO not yet completed.
-        epoll_event event = {};
-        (void)epoll_ctl(
-            this->context_.epollFd_.get(), EPOLL_CTL_DEL, this->fd_, &event);
-
-        // We are responsible for scheduling the completion of this io
-        // operation.
-        static_cast<done_op&>(*this).execute_ = &operation::complete_with_done;
-        this->context_.schedule_remote(static_cast<done_op*>(this));
-      }
+  void request_stop() noexcept {
+    auto oldState = this->state_.fetch_add(
+        io_operation::cancel_pending_flag, std::memory_order_acq_rel);
+    if ((oldState & io_operation::io_mask) == 0) {
+      // IO not yet completed.
+      // We are responsible for scheduling the completion of this io
+      // operation.
+      static_cast<cancel_base&>(*this).execute_ =
+          &io_operation::complete_with_done;
+      this->context_.schedule_remote(static_cast<cancel_base*>(this));
     }
+  }
 
-    struct cancel_callback {
-      operation& op_;
+  struct cancel_callback {
+    io_operation& op_;
 
-      void operator()() noexcept { op_.request_stop(); }
-    };
+    void operator()() noexcept { op_.request_stop(); }
+  };
 
-    io_epoll_context& context_;
-    int fd_;
+  io_epoll_context& context_;
+  IO io_;
+  Receiver receiver_;
+  manual_lifetime<typename stop_token_type_t<
+      Receiver>::template callback_type<cancel_callback>>
+      stopCallback_;
+  static constexpr std::uint32_t io_flag = 0x00010000;
+  static constexpr std::uint32_t io_mask = 0xFFFF0000;
+  static constexpr std::uint32_t cancel_pending_flag = 1;
+  static constexpr std::uint32_t cancel_pending_mask = 0xFFFF;
+  std::atomic<std::uint32_t> state_ = 0;
+};
+
+class io_epoll_context::read_sender {
+  struct read_io {
+    static constexpr auto waiter = &fd_registration::reader_;
+
+    fd_registration& registration() const noexcept { return registration_; }
+
+    ssize_t try_io() noexcept {
+      auto result = readv(registration_.fd_.get(), buffer_, 1);
+      return result < 0 ? -errno : result;
+    }
+
+    template <typename Receiver>
+    static void set_value(Receiver&& r, ssize_t result) {
+      unifex::set_value((Receiver &&) r, ssize_t(result));
+    }
+
+    fd_registration& registration_;
     iovec buffer_[1];
-    Receiver receiver_;
-    manual_lifetime<typename stop_token_type_t<
-        Receiver>::template callback_type<cancel_callback>>
-        stopCallback_;
-    static constexpr std::uint32_t io_flag = 0x00010000;
-    static constexpr std::uint32_t io_mask = 0xFFFF0000;
-    static constexpr std::uint32_t cancel_pending_flag = 1;
-    static constexpr std::uint32_t cancel_pending_mask = 0xFFFF;
-    std::atomic<std::uint32_t> state_ = 0;
   };
 
 public:
@@ -720,222 +903,45 @@ public:
   static constexpr bool sends_done = true;
 
   explicit read_sender(
-      io_epoll_context& context, int fd, span<std::byte> buffer) noexcept
-    : context_(context)
-    , fd_(fd)
+      fd_registration& registration, span<std::byte> buffer) noexcept
+    : registration_(registration)
     , buffer_(buffer) {}
 
   template <typename Receiver>
-  operation<std::decay_t<Receiver>> connect(Receiver&& r) && {
-    return operation<std::decay_t<Receiver>>{*this, (Receiver &&) r};
+  io_operation<read_io, std::decay_t<Receiver>> connect(Receiver&& r) && {
+    return io_operation<read_io, std::decay_t<Receiver>>{
+        registration_.context_,
+        read_io{registration_, {{buffer_.data(), buffer_.size()}}},
+        (Receiver &&) r};
   }
 
 private:
-  io_epoll_context& context_;
-  int fd_;
+  fd_registration& registration_;
   span<std::byte> buffer_;
 };
 
 class io_epoll_context::write_sender {
-  struct done_op : operation_base {};
-
-  template <typename Receiver>
-  class operation
-    : private completion_base
-    , private done_op {
-    friend io_epoll_context;
+  struct write_io {
+    static constexpr auto waiter = &fd_registration::writer_;
 
-    static constexpr bool is_stop_ever_possible =
-        !is_stop_never_possible_v<stop_token_type_t<Receiver>>;
-
-  public:
-    template <typename Receiver2>
-    explicit operation(const write_sender& sender, Receiver2&& r)
-      : context_(sender.context_)
-      , fd_(sender.fd_)
-      , receiver_((Receiver2 &&) r) {
-      buffer_[0].iov_base = (void*)sender.buffer_.data();
-      buffer_[0].iov_len = sender.buffer_.size();
-    }
+    fd_registration& registration() const noexcept { return registration_; }
 
-    void start() noexcept {
-      if (!context_.is_running_on_io_thread()) {
-        static_cast<completion_base*>(this)->execute_ =
-            &operation::on_schedule_complete;
-        context_.schedule_remote(static_cast<completion_base*>(this));
-      } else {
-        start_io();
-      }
+    ssize_t try_io() noexcept {
+      auto result = writev(registration_.fd_.get(), buffer_, 1);
+      return result < 0 ? -errno : result;
     }
 
-  private:
-    static void on_schedule_complete(operation_base* op) noexcept {
-      auto& self = *static_cast<operation*>(static_cast<completion_base*>(op));
-      self.start_io();
+    template <typename Receiver>
+    static void set_value(Receiver&& r, ssize_t result) {
+      unifex::set_value((Receiver &&) r, ssize_t(result));
     }
 
-    void start_io() noexcept {
-      UNIFEX_ASSERT(context_.is_running_on_io_thread());
-
-      auto result = writev(fd_, buffer_, 1);
-
-      if (result == -EAGAIN || result == -EWOULDBLOCK || result == -EPERM) {
-        if constexpr (is_stop_ever_possible) {
-          stopCallback_.construct(
-              get_stop_token(receiver_), cancel_callback{*this});
-        }
-
-        UNIFEX_ASSERT(
-            static_cast<completion_base*>(this)->enqueued_.load() == 0);
-        static_cast<completion_base*>(this)->execute_ =
-            &operation::on_write_complete;
-        epoll_event event;
-        event.data.ptr = static_cast<completion_base*>(this);
-        event.events = EPOLLOUT | EPOLLRDHUP | EPOLLHUP;
-        (void)epoll_ctl(context_.epollFd_.get(), EPOLL_CTL_ADD, fd_, &event);
-        return;
-      }
-
-      auto oldState = state_.fetch_add(
-          io_epoll_context::write_sender::operation<Receiver>::io_flag,
-          std::memory_order_acq_rel);
-      if ((oldState &
-           io_epoll_context::write_sender::operation<
-               Receiver>::cancel_pending_mask) != 0) {
-        // io has been cancelled by a remote thread.
-        // The other thread is responsible for enqueueing the operation
-        // completion
-        return;
-      }
-
-      if (result == -ECANCELED) {
-        unifex::set_done(std::move(receiver_));
-      } else if (result >= 0) {
-        if constexpr (is_nothrow_receiver_of_v<Receiver, ssize_t>) {
-          unifex::set_value(std::move(receiver_), ssize_t(result));
-        } else {
-          UNIFEX_TRY {
-            unifex::set_value(std::move(receiver_), ssize_t(result));
-          }
-          UNIFEX_CATCH(...) {
-            unifex::set_error(std::move(receiver_), std::current_exception());
-          }
-        }
-      } else {
-        unifex::set_error(
-            std::move(receiver_),
-            std::error_code{-int(result), std::system_category()});
-      }
-    }
-
-    static void on_write_complete(operation_base* op) noexcept {
-      auto& self = *static_cast<operation*>(static_cast<completion_base*>(op));
-
-      UNIFEX_ASSERT(static_cast<completion_base&>(self).enqueued_.load() == 0);
-
-      self.stopCallback_.destruct();
-
-      epoll_event event = {};
-      (void)epoll_ctl(
-          self.context_.epollFd_.get(), EPOLL_CTL_DEL, self.fd_, &event);
-
-      auto oldState = self.state_.fetch_add(
-          io_epoll_context::write_sender::operation<Receiver>::io_flag,
-          std::memory_order_acq_rel);
-      if ((oldState &
-           io_epoll_context::write_sender::operation<
-               Receiver>::cancel_pending_mask) != 0) {
-        // io has been cancelled by a remote thread.
-        // The other thread is responsible for enqueueing the operation
-        // completion
-        return;
-      }
-
-      auto result = writev(self.fd_, self.buffer_, 1);
-      UNIFEX_ASSERT(result != -EAGAIN);
-      UNIFEX_ASSERT(result != -EWOULDBLOCK);
-      if (result == -ECANCELED) {
-        unifex::set_done(std::move(self.receiver_));
-      } else if (result >= 0) {
-        if constexpr (is_nothrow_receiver_of_v<Receiver, ssize_t>) {
-          unifex::set_value(std::move(self).receiver_, ssize_t(result));
-        } else {
-          UNIFEX_TRY {
-            unifex::set_value(std::move(self).receiver_, ssize_t(result));
-          }
-          UNIFEX_CATCH(...) {
-            unifex::set_error(
-                std::move(self).receiver_, std::current_exception());
-          }
-        }
-      } else {
-        unifex::set_error(
-            std::move(self.receiver_),
-            std::error_code{-int(result), std::system_category()});
-      }
-    }
-
-    static void complete_with_done(operation_base* op) noexcept {
-      auto& self = *static_cast<operation*>(static_cast<done_op*>(op));
-
-      UNIFEX_ASSERT(static_cast<done_op&>(self).enqueued_.load() == 0);
-
-      if (static_cast<completion_base&>(self).enqueued_.load() == 0) {
-        // Avoid instantiating set_done() if we're not going to call it.
-        if constexpr (is_stop_ever_possible) {
-          unifex::set_done(std::move(self.receiver_));
-        } else {
-          // This should never be called if stop is not possible.
-          UNIFEX_ASSERT(false);
-        }
-      } else {
-        // reschedule after queued io is cleared
-        static_cast<done_op&>(self).execute_ = &operation::complete_with_done;
-        self.context_.schedule_local(static_cast<done_op*>(&self));
-      }
-    }
-
-    void request_stop() noexcept {
-      auto oldState = this->state_.fetch_add(
-          io_epoll_context::write_sender::operation<
-              Receiver>::cancel_pending_flag,
-          std::memory_order_acq_rel);
-      if ((oldState &
-           io_epoll_context::write_sender::operation<Receiver>::io_mask) == 0) {
-        // IO not yet completed.
-        epoll_event event = {};
-        (void)epoll_ctl(
-            this->context_.epollFd_.get(), EPOLL_CTL_DEL, this->fd_, &event);
-
-        // We are responsible for scheduling the completion of this io
-        // operation.
-        static_cast<done_op&>(*this).execute_ = &operation::complete_with_done;
-        this->context_.schedule_remote(static_cast<done_op*>(this));
-      }
-    }
-
-    struct cancel_callback {
-      operation& op_;
-
-      void operator()() noexcept { op_.request_stop(); }
-    };
-
-    io_epoll_context& context_;
-    int fd_;
+    fd_registration& registration_;
     iovec buffer_[1];
-    Receiver receiver_;
-    manual_lifetime<typename stop_token_type_t<
-        Receiver>::template callback_type<cancel_callback>>
-        stopCallback_;
-    static constexpr std::uint32_t io_flag = 0x00010000;
-    static constexpr std::uint32_t io_mask = 0xFFFF0000;
-    static constexpr std::uint32_t cancel_pending_flag = 1;
-    static constexpr std::uint32_t cancel_pending_mask = 0xFFFF;
-    std::atomic<std::uint32_t> state_ = 0;
   };
 
 public:
-  // Produces number of bytes read.
+  // Produces number of bytes written.
   template <
       template <typename...>
       class Variant,
@@ -949,27 +955,29 @@ public:
   static constexpr bool sends_done = true;
 
   explicit write_sender(
-      io_epoll_context& context, int fd, span<const std::byte> buffer) noexcept
-    : context_(context)
-    , fd_(fd)
+      fd_registration& registration, span<const std::byte> buffer) noexcept
+    : registration_(registration)
     , buffer_(buffer) {}
 
   template <typename Receiver>
-  operation<std::decay_t<Receiver>> connect(Receiver&& r) && {
-    return operation<std::decay_t<Receiver>>{*this, (Receiver &&) r};
+  io_operation<write_io, std::decay_t<Receiver>> connect(Receiver&& r) && {
+    return io_operation<write_io, std::decay_t<Receiver>>{
+        registration_.context_,
+        write_io{
+            registration_, {{(void*)buffer_.data(), buffer_.size()}}},
+        (Receiver &&) r};
   }
 
 private:
-  io_epoll_context& context_;
-  int fd_;
+  fd_registration& registration_;
   span<const std::byte> buffer_;
 };
 
 class io_epoll_context::async_reader {
 public:
-  explicit async_reader(io_epoll_context& context, int fd) noexcept
-    : context_(context)
-    , fd_(fd) {}
+  explicit async_reader(io_epoll_context& context, int fd)
+    : registration_(
+          make_fd_registration(context, safe_file_descriptor{fd})) {}
 
 private:
   friend scheduler;
@@ -978,18 +986,17 @@ private:
       tag_t<async_read_some>,
       async_reader& reader,
       span<std::byte> buffer) noexcept {
-    return read_sender{reader.context_, reader.fd_.get(), buffer};
+    return read_sender{*reader.registration_, buffer};
   }
 
-  io_epoll_context& context_;
-  safe_file_descriptor fd_;
+  fd_registration_ptr registration_;
 };
 
 class io_epoll_context::async_writer {
 public:
-  explicit async_writer(io_epoll_context& context, int fd) noexcept
-    : context_(context)
-    , fd_(fd) {}
+  explicit async_writer(io_epoll_context& context, int fd)
+    : registration_(
+          make_fd_registration(context, safe_file_descriptor{fd})) {}
 
 private:
   friend scheduler;
@@ -998,13 +1005,234 @@ private:
       tag_t<async_write_some>,
       async_writer& writer,
       span<const std::byte> buffer) noexcept {
-    return write_sender{writer.context_, writer.fd_.get(), buffer};
+    return write_sender{*writer.registration_, buffer};
+  }
+
+  fd_registration_ptr registration_;
+};
+
+// A connected stream socket.
+//
+// The '_at' overloads exist so that code written against io_uring_context's
+// accepted sockets also works here; the offset is ignored as it is for any
+// non-seekable file.
+class io_epoll_context::async_socket {
+public:
+  using offset_t = std::int64_t;
+
+  explicit async_socket(io_epoll_context& context, int fd)
+    : async_socket(context, safe_file_descriptor{fd}) {}
+
+  explicit async_socket(io_epoll_context& context, safe_file_descriptor fd)
+    : registration_(make_fd_registration(context, std::move(fd))) {}
+
+private:
+  friend read_sender tag_invoke(
+      tag_t<async_read_some>,
+      async_socket& socket,
+      span<std::byte> buffer) noexcept {
+    return read_sender{*socket.registration_, buffer};
+  }
+
+  friend write_sender tag_invoke(
+      tag_t<async_write_some>,
+      async_socket& socket,
+      span<const std::byte> buffer) noexcept {
+    return write_sender{*socket.registration_, buffer};
+  }
+
+  friend read_sender tag_invoke(
+      tag_t<async_read_some_at>,
+      async_socket& socket,
+      offset_t,
+      span<std::byte> buffer) noexcept {
+    return read_sender{*socket.registration_, buffer};
+  }
+
+  friend write_sender tag_invoke(
+      tag_t<async_write_some_at>,
+      async_socket& socket,
+      offset_t,
+      span<const std::byte> buffer) noexcept {
+    return write_sender{*socket.registration_, buffer};
   }
 
+  friend connect_sender;
+
+  fd_registration_ptr registration_;
+};
+
+class io_epoll_context::accept_sender {
+  struct accept_io {
+    static constexpr auto waiter = &fd_registration::reader_;
+
+    fd_registration& registration() const noexcept { return registration_; }
+
+    ssize_t try_io() noexcept {
+      int result = accept4(
+          registration_.fd_.get(),
+          nullptr,
+          nullptr,
+          SOCK_NONBLOCK | SOCK_CLOEXEC);
+      return result < 0 ? -errno : result;
+    }
+
+    template <typename Receiver>
+    void set_value(Receiver&& r, ssize_t result) {
+      // Owns the accepted fd even if registering it throws.
+      safe_file_descriptor fd{static_cast<int>(result)};
+      async_socket socket{registration_.context_, std::move(fd)};
+      unifex::set_value((Receiver &&) r, std::move(socket));
+    }
+
+    fd_registration& registration_;
+  };
+
+public:
+  // Produces the connected socket.
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<Tuple<async_socket>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::error_code, std::exception_ptr>;
+
+  static constexpr bool sends_done = true;
+
+  explicit accept_sender(fd_registration& registration) noexcept
+    : registration_(registration) {}
+
+  template <typename Receiver>
+  io_operation<accept_io, std::decay_t<Receiver>> connect(Receiver&& r) && {
+    return io_operation<accept_io, std::decay_t<Receiver>>{
+        registration_.context_, accept_io{registration_}, (Receiver &&) r};
+  }
+
+private:
+  fd_registration& registration_;
+};
+
+// A listening socket, as a stream of connected sockets.
+class io_epoll_context::accept_stream {
+public:
+  explicit accept_stream(io_epoll_context& context, int fd)
+    : registration_(
+          make_fd_registration(context, safe_file_descriptor{fd})) {}
+
+  accept_sender next() noexcept { return accept_sender{*registration_}; }
+
+  // The listening socket is closed when the stream is destroyed.
+  auto cleanup() noexcept { return just_done(); }
+
+  // The port the socket is bound to. Useful after listening on port 0.
+  port_t port() const;
+
+private:
+  fd_registration_ptr registration_;
+};
+
+class io_epoll_context::connect_sender {
+  struct connect_io {
+    static constexpr auto waiter = &fd_registration::writer_;
+
+    fd_registration& registration() const noexcept {
+      return *socket_->registration_;
+    }
+
+    // The first attempt creates the socket and starts connecting. Calling
+    // connect() again on a socket that is still connecting fails with
+    // EALREADY, and with EISCONN once it has succeeded, which tells us
+    // whether a wake-up was for completion of the handshake.
+    ssize_t try_io() {
+      if (addressLength_ > sizeof(address_)) {
+        return -EINVAL;
+      }
+      if (!socket_) {
+        safe_file_descriptor fd{socket(
+            address_.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)};
+        if (!fd.valid()) {
+          return -errno;
+        }
+        socket_.emplace(context_, std::move(fd));
+      }
+      int result = ::connect(
+          socket_->registration_->fd_.get(),
+          reinterpret_cast<const sockaddr*>(&address_),
+          addressLength_);
+      if (result == 0) {
+        return 0;
+      }
+      switch (int errorCode = errno) {
+        case EISCONN: return 0;
+        case EINPROGRESS:
+        case EALREADY: return -EAGAIN;
+        default: return -errorCode;
+      }
+    }
+
+    template <typename Receiver>
+    void set_value(Receiver&& r, ssize_t) {
+      unifex::set_value((Receiver &&) r, std::move(*socket_));
+    }
+
+    io_epoll_context& context_;
+    sockaddr_storage address_;
+    socklen_t addressLength_;
+    std::optional<async_socket> socket_;
+  };
+
+public:
+  // Produces the connected socket.
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<Tuple<async_socket>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::error_code, std::exception_ptr>;
+
+  static constexpr bool sends_done = true;
+
+  // An address longer than sockaddr_storage completes with EINVAL.
+  explicit connect_sender(
+      io_epoll_context& context,
+      const sockaddr* address,
+      socklen_t addressLength) noexcept
+    : context_(context)
+    , addressLength_(addressLength) {
+    if (addressLength <= sizeof(address_)) {
+      std::memcpy(&address_, address, addressLength);
+    }
+  }
+
+  template <typename Receiver>
+  io_operation<connect_io, std::decay_t<Receiver>> connect(Receiver&& r) && {
+    return io_operation<connect_io, std::decay_t<Receiver>>{
+        context_,
+        connect_io{context_, address_, addressLength_, std::nullopt},
+        (Receiver &&) r};
+  }
+
+private:
   io_epoll_context& context_;
-  safe_file_descriptor fd_;
+  sockaddr_storage address_;
+  socklen_t addressLength_;
 };
 
+inline io_epoll_context::connect_sender tag_invoke(
+    tag_t<async_connect>,
+    io_epoll_context::scheduler s,
+    const sockaddr* address,
+    socklen_t addressLength) noexcept {
+  return io_epoll_context::connect_sender{
+      *s.context_, address, addressLength};
+}
+
 }  // namespace linuxos
 }  // namespace unifex
 
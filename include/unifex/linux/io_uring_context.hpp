@@ -27,6 +27,7 @@
 #  include <unifex/let_value_with.hpp>
 #  include <unifex/manual_lifetime.hpp>
 #  include <unifex/receiver_concepts.hpp>
+#  include <unifex/running_in_this_thread.hpp>
 #  include <unifex/socket_concepts.hpp>
 #  include <unifex/span.hpp>
 #  include <unifex/stop_token_concepts.hpp>
@@ -65,7 +66,6 @@ class io_uring_context {
 public:
   class schedule_sender;
   class schedule_at_sender;
-  template <typename Duration>
   class schedule_after_sender;
   class read_sender;
   class write_sender;
@@ -76,8 +76,19 @@ public:
   class accept_sender;
   class accept_stream;
 
+  // The clock that the kernel measures timer due-times against.
+  //
+  // Due-times are always expressed as monotonic_clock time points. With
+  // 'boottime' they are converted to CLOCK_BOOTTIME when the kernel timer
+  // is armed, so that time spent suspended counts towards the delay.
+  // Kernels that don't support boottime timeouts (before Linux 5.15) fall
+  // back to 'monotonic'.
+  enum class timer_clock { monotonic, boottime };
+
   io_uring_context();
 
+  explicit io_uring_context(timer_clock clock);
+
   ~io_uring_context();
 
   template <typename StopToken>
@@ -107,19 +118,26 @@ private:
 
   using time_point = linuxos::monotonic_clock::time_point;
 
+  using duration = linuxos::monotonic_clock::duration;
+
   struct schedule_at_operation : operation_base {
     explicit schedule_at_operation(
         io_uring_context& context,
         const time_point& dueTime,
+        duration slack,
         bool canBeCancelled) noexcept
       : context_(context)
       , dueTime_(dueTime)
+      , latestTime_(dueTime + slack)
       , canBeCancelled_(canBeCancelled) {}
 
     schedule_at_operation* timerNext_;
     schedule_at_operation* timerPrev_;
     io_uring_context& context_;
+    // The timer may complete at any point in [dueTime_, latestTime_]. This
+    // lets timers that expire close together share a single OS timer.
     time_point dueTime_;
+    time_point latestTime_;
     bool canBeCancelled_;
 
     static constexpr std::uint32_t timer_elapsed_flag = 1;
@@ -135,7 +153,7 @@ private:
       &schedule_at_operation::timerNext_,
       &schedule_at_operation::timerPrev_,
       time_point,
-      &schedule_at_operation::dueTime_>;
+      &schedule_at_operation::latestTime_>;
 
   bool is_running_on_io_thread() const noexcept;
   void run_impl(const bool& shouldStop);
@@ -192,6 +210,13 @@ private:
   bool try_submit_timer_io(const time_point& dueTime) noexcept;
   bool try_submit_timer_io_cancel() noexcept;
 
+  // Move the due-time of the active kernel timer in place rather than
+  // cancelling it and submitting a new one. Requires Linux 5.11.
+  bool try_submit_timer_io_update(const time_point& dueTime) noexcept;
+
+  // Fill in 'time_' with 'dueTime' expressed in the kernel timer's clock.
+  void set_timer_timespec(const time_point& dueTime) noexcept;
+
   // Try to submit an entry to the submission queue
   //
   // If there is space in the queue then populateSqe
@@ -220,6 +245,28 @@ private:
     return reinterpret_cast<std::uintptr_t>(&currentDueTime_);
   }
 
+  std::uintptr_t update_timer_user_data() const {
+    return reinterpret_cast<std::uintptr_t>(&activeTimerCount_);
+  }
+
+  // Files opened for direct I/O require the file offset, the transfer length
+  // and the buffer address to all be multiples of the file's alignment.
+  // An alignment of zero means the file was opened for buffered I/O.
+  static bool is_aligned_io(
+      std::int64_t offset,
+      const void* data,
+      std::size_t size,
+      std::size_t alignment) noexcept {
+    if (alignment == 0) {
+      return true;
+    }
+    const auto mask = static_cast<std::uintptr_t>(alignment - 1);
+    return ((static_cast<std::uintptr_t>(offset) |
+             reinterpret_cast<std::uintptr_t>(data) |
+             static_cast<std::uintptr_t>(size)) &
+            mask) == 0;
+  }
+
   struct __kernel_timespec {
     int64_t tv_sec;
     long long tv_nsec;
@@ -282,6 +329,14 @@ private:
 
   std::uint32_t activeTimerCount_ = 0;
 
+  timer_clock timerClock_;
+
+  // Cleared if the kernel rejects IORING_TIMEOUT_UPDATE.
+  bool timerUpdateSupported_ = true;
+
+  // The kernel copies the timespec when the submission is consumed and at
+  // most one timer submission is made per event loop iteration, so a single
+  // buffer suffices.
   __kernel_timespec time_;
 
   //////////////////
@@ -428,12 +483,20 @@ class io_uring_context::read_sender {
       : context_(sender.context_)
       , fd_(sender.fd_)
       , offset_(sender.offset_)
+      , misaligned_(sender.misaligned_)
       , receiver_((Receiver2 &&) r) {
       buffer_[0].iov_base = sender.buffer_.data();
       buffer_[0].iov_len = sender.buffer_.size();
     }
 
     void start() noexcept {
+      if (misaligned_) {
+        // Direct I/O request that the kernel would reject with EINVAL.
+        unifex::set_error(
+            std::move(receiver_),
+            std::make_error_code(std::errc::invalid_argument));
+        return;
+      }
       if (!context_.is_running_on_io_thread()) {
         this->execute_ = &operation::on_schedule_complete;
         context_.schedule_remote(this);
@@ -566,6 +629,7 @@ class io_uring_context::read_sender {
     io_uring_context& context_;
     int fd_;
     offset_t offset_;
+    bool misaligned_;
     iovec buffer_[1];
     Receiver receiver_;
     manual_lifetime<typename stop_token_type_t<
@@ -595,11 +659,14 @@ public:
       io_uring_context& context,
       int fd,
       offset_t offset,
-      span<std::byte> buffer) noexcept
+      span<std::byte> buffer,
+      std::size_t alignment = 0) noexcept
     : context_(context)
     , fd_(fd)
     , offset_(offset)
-    , buffer_(buffer) {}
+    , buffer_(buffer)
+    , misaligned_(
+          !is_aligned_io(offset, buffer.data(), buffer.size(), alignment)) {}
 
   template <typename Receiver>
   operation<remove_cvref_t<Receiver>> connect(Receiver&& r) && {
@@ -611,6 +678,7 @@ private:
   int fd_;
   offset_t offset_;
   span<std::byte> buffer_;
+  bool misaligned_;
 };
 
 class io_uring_context::write_sender {
@@ -626,12 +694,20 @@ class io_uring_context::write_sender {
       : context_(sender.context_)
       , fd_(sender.fd_)
       , offset_(sender.offset_)
+      , misaligned_(sender.misaligned_)
       , receiver_((Receiver2 &&) r) {
       buffer_[0].iov_base = (void*)sender.buffer_.data();
       buffer_[0].iov_len = sender.buffer_.size();
     }
 
     void start() noexcept {
+      if (misaligned_) {
+        // Direct I/O request that the kernel would reject with EINVAL.
+        unifex::set_error(
+            std::move(receiver_),
+            std::make_error_code(std::errc::invalid_argument));
+        return;
+      }
       if (!context_.is_running_on_io_thread()) {
         this->execute_ = &operation::on_schedule_complete;
         context_.schedule_remote(this);
@@ -764,6 +840,7 @@ class io_uring_context::write_sender {
     io_uring_context& context_;
     int fd_;
     offset_t offset_;
+    bool misaligned_;
     iovec buffer_[1];
     Receiver receiver_;
     manual_lifetime<typename stop_token_type_t<
@@ -793,11 +870,14 @@ public:
       io_uring_context& context,
       int fd,
       offset_t offset,
-      span<const std::byte> buffer) noexcept
+      span<const std::byte> buffer,
+      std::size_t alignment = 0) noexcept
     : context_(context)
     , fd_(fd)
     , offset_(offset)
-    , buffer_(buffer) {}
+    , buffer_(buffer)
+    , misaligned_(
+          !is_aligned_io(offset, buffer.data(), buffer.size(), alignment)) {}
 
   template <typename Receiver>
   operation<remove_cvref_t<Receiver>> connect(Receiver&& r) {
@@ -809,15 +889,22 @@ private:
   int fd_;
   offset_t offset_;
   span<const std::byte> buffer_;
+  bool misaligned_;
 };
 
 class io_uring_context::async_read_only_file {
 public:
   using offset_t = std::int64_t;
 
-  explicit async_read_only_file(io_uring_context& context, int fd) noexcept
+  explicit async_read_only_file(
+      io_uring_context& context, int fd, std::size_t alignment = 0) noexcept
     : context_(context)
-    , fd_(fd) {}
+    , fd_(fd)
+    , alignment_(alignment) {}
+
+  // Required alignment of offsets, lengths and buffers if the file was
+  // opened for direct I/O, otherwise zero.
+  std::size_t alignment() const noexcept { return alignment_; }
 
 private:
   friend scheduler;
@@ -827,20 +914,28 @@ private:
       async_read_only_file& file,
       offset_t offset,
       span<std::byte> buffer) noexcept {
-    return read_sender{file.context_, file.fd_.get(), offset, buffer};
+    return read_sender{
+        file.context_, file.fd_.get(), offset, buffer, file.alignment_};
   }
 
   io_uring_context& context_;
   safe_file_descriptor fd_;
+  std::size_t alignment_;
 };
 
 class io_uring_context::async_write_only_file {
 public:
   using offset_t = std::int64_t;
 
-  explicit async_write_only_file(io_uring_context& context, int fd) noexcept
+  explicit async_write_only_file(
+      io_uring_context& context, int fd, std::size_t alignment = 0) noexcept
     : context_(context)
-    , fd_(fd) {}
+    , fd_(fd)
+    , alignment_(alignment) {}
+
+  // Required alignment of offsets, lengths and buffers if the file was
+  // opened for direct I/O, otherwise zero.
+  std::size_t alignment() const noexcept { return alignment_; }
 
 private:
   friend scheduler;
@@ -850,20 +945,28 @@ private:
       async_write_only_file& file,
       offset_t offset,
       span<const std::byte> buffer) noexcept {
-    return write_sender{file.context_, file.fd_.get(), offset, buffer};
+    return write_sender{
+        file.context_, file.fd_.get(), offset, buffer, file.alignment_};
   }
 
   io_uring_context& context_;
   safe_file_descriptor fd_;
+  std::size_t alignment_;
 };
 
 class io_uring_context::async_read_write_file {
 public:
   using offset_t = std::int64_t;
 
-  explicit async_read_write_file(io_uring_context& context, int fd) noexcept
+  explicit async_read_write_file(
+      io_uring_context& context, int fd, std::size_t alignment = 0) noexcept
     : context_(context)
-    , fd_(fd) {}
+    , fd_(fd)
+    , alignment_(alignment) {}
+
+  // Required alignment of offsets, lengths and buffers if the file was
+  // opened for direct I/O, otherwise zero.
+  std::size_t alignment() const noexcept { return alignment_; }
 
 private:
   friend scheduler;
@@ -873,7 +976,8 @@ private:
       async_read_write_file& file,
       offset_t offset,
       span<const std::byte> buffer) noexcept {
-    return write_sender{file.context_, file.fd_.get(), offset, buffer};
+    return write_sender{
+        file.context_, file.fd_.get(), offset, buffer, file.alignment_};
   }
 
   friend read_sender tag_invoke(
@@ -881,14 +985,18 @@ private:
       async_read_write_file& file,
       offset_t offset,
       span<std::byte> buffer) noexcept {
-    return read_sender{file.context_, file.fd_.get(), offset, buffer};
+    return read_sender{
+        file.context_, file.fd_.get(), offset, buffer, file.alignment_};
   }
 
   io_uring_context& context_;
   safe_file_descriptor fd_;
+  std::size_t alignment_;
 };
 
 class io_uring_context::schedule_at_sender {
+  friend io_uring_context::schedule_after_sender;
+
   template <typename Receiver>
   struct operation : schedule_at_operation {
     static constexpr bool is_stop_ever_possible =
@@ -896,9 +1004,12 @@ class io_uring_context::schedule_at_sender {
 
   public:
     explicit operation(
-        io_uring_context& context, const time_point& dueTime, Receiver&& r)
+        io_uring_context& context,
+        const time_point& dueTime,
+        duration slack,
+        Receiver&& r)
       : schedule_at_operation(
-            context, dueTime, get_stop_token(r).stop_possible())
+            context, dueTime, slack, get_stop_token(r).stop_possible())
       , receiver_((Receiver &&) r) {}
 
     void start() noexcept {
@@ -1062,19 +1173,75 @@ public:
   static constexpr bool sends_done = true;
 
   explicit schedule_at_sender(
-      io_uring_context& context, const time_point& dueTime) noexcept
+      io_uring_context& context,
+      const time_point& dueTime,
+      duration slack = duration::zero()) noexcept
     : context_(context)
-    , dueTime_(dueTime) {}
+    , dueTime_(dueTime)
+    , slack_(slack) {}
 
   template <typename Receiver>
   operation<remove_cvref_t<Receiver>> connect(Receiver&& r) {
     return operation<remove_cvref_t<Receiver>>{
-        context_, dueTime_, (Receiver &&) r};
+        context_, dueTime_, slack_, (Receiver &&) r};
   }
 
 private:
   io_uring_context& context_;
   time_point dueTime_;
+  duration slack_;
+};
+
+class io_uring_context::schedule_after_sender {
+  template <typename Receiver>
+  struct operation : schedule_at_sender::operation<Receiver> {
+    explicit operation(
+        io_uring_context& context, duration delay, duration slack, Receiver&& r)
+      : schedule_at_sender::operation<Receiver>(
+            context, time_point{}, slack, (Receiver &&) r)
+      , delay_(delay)
+      , slack_(slack) {}
+
+    void start() noexcept {
+      this->dueTime_ = monotonic_clock::now() + delay_;
+      this->latestTime_ = this->dueTime_ + slack_;
+      schedule_at_sender::operation<Receiver>::start();
+    }
+
+  private:
+    duration delay_;
+    duration slack_;
+  };
+
+public:
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<Tuple<>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<std::exception_ptr>;
+
+  static constexpr bool sends_done = true;
+
+  explicit schedule_after_sender(
+      io_uring_context& context, duration delay, duration slack) noexcept
+    : context_(context)
+    , delay_(delay)
+    , slack_(slack) {}
+
+  template <typename Receiver>
+  operation<remove_cvref_t<Receiver>> connect(Receiver&& r) const& {
+    return operation<remove_cvref_t<Receiver>>{
+        context_, delay_, slack_, (Receiver &&) r};
+  }
+
+private:
+  io_uring_context& context_;
+  duration delay_;
+  duration slack_;
 };
 
 class io_uring_context::scheduler {
@@ -1089,8 +1256,18 @@ public:
 
   time_point now() const noexcept { return monotonic_clock::now(); }
 
-  schedule_at_sender schedule_at(const time_point& dueTime) const noexcept {
-    return schedule_at_sender{*context_, dueTime};
+  // A non-zero 'slack' allows the timer to complete up to that long after
+  // 'dueTime', so that it can be batched with other timers expiring in the
+  // same window instead of reprogramming the OS timer for it.
+  schedule_at_sender schedule_at(
+      const time_point& dueTime,
+      duration slack = duration::zero()) const noexcept {
+    return schedule_at_sender{*context_, dueTime, slack};
+  }
+
+  schedule_after_sender schedule_after(
+      duration delay, duration slack = duration::zero()) const noexcept {
+    return schedule_after_sender{*context_, delay, slack};
   }
 
 private:
@@ -1102,6 +1279,18 @@ private:
       tag_t<open_file_read_write>, scheduler s, const filesystem::path& path);
   friend async_write_only_file tag_invoke(
       tag_t<open_file_write_only>, scheduler s, const filesystem::path& path);
+  friend async_read_only_file tag_invoke(
+      tag_t<open_file_read_only_direct>,
+      scheduler s,
+      const filesystem::path& path);
+  friend async_read_write_file tag_invoke(
+      tag_t<open_file_read_write_direct>,
+      scheduler s,
+      const filesystem::path& path);
+  friend async_write_only_file tag_invoke(
+      tag_t<open_file_write_only_direct>,
+      scheduler s,
+      const filesystem::path& path);
   friend accept_stream
   tag_invoke(tag_t<open_listening_socket>, scheduler s, port_t port);
 
@@ -1112,8 +1301,17 @@ private:
     return a.context_ != b.context_;
   }
 
+  friend bool
+  tag_invoke(tag_t<running_in_this_thread>, const scheduler& s) noexcept {
+    return s.is_running_on_io_thread_();
+  }
+
   explicit scheduler(io_uring_context& context) noexcept : context_(&context) {}
 
+  bool is_running_on_io_thread_() const noexcept {
+    return context_->is_running_on_io_thread();
+  }
+
   io_uring_context* context_;
 };
 
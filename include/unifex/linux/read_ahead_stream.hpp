@@ -0,0 +1,400 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/config.hpp>
+#include <unifex/detail/locked_stream.hpp>
+#include <unifex/exception.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/io_concepts.hpp>
+#include <unifex/just_done.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/span.hpp>
+#include <unifex/stream_concepts.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <unifex/linux/aligned_buffer_pool.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace linuxos {
+namespace _read_ahead {
+
+// read_ahead_stream(file, blockSize, readAhead)
+//
+// A stream that reads 'file' from the start in blocks of 'blockSize' bytes,
+// keeping up to 'readAhead' reads in flight ahead of the consumer. Each
+// value is a span<const std::byte> over the next block, in file order, that
+// stays valid until the following call to next() or cleanup().
+//
+// Reads are issued with async_read_some_at(), so any random-access file
+// works; with io_uring_context files they are all submitted to the ring at
+// once. The stream owns readAhead + 1 buffers, aligned to the file's
+// alignment() if it has one so that files opened for direct I/O can be
+// read as long as 'blockSize' is a multiple of that alignment.
+//
+// A read that returns fewer than 'blockSize' bytes is taken to have reached
+// the end of the file: its bytes, if any, are sent as the last value. If a
+// read fails or completes with done, that outcome ends the stream once the
+// blocks before it have been consumed. The file must outlive the stream.
+
+using _locked_stream::cleanup_base;
+using _locked_stream::consumer_base;
+using _locked_stream::outcome;
+using _locked_stream::single_consumer;
+
+enum class status { idle, reading, value, error, done };
+
+template <typename File, typename = void>
+struct _has_alignment : std::false_type {};
+template <typename File>
+struct _has_alignment<
+    File,
+    std::void_t<decltype(std::declval<const File&>().alignment())>>
+  : std::true_type {};
+
+template <typename File>
+std::size_t buffer_alignment(const File& file) noexcept {
+  std::size_t alignment = aligned_buffer_pool::default_alignment;
+  if constexpr (_has_alignment<File>::value) {
+    alignment = (std::max)(alignment, std::size_t(file.alignment()));
+  }
+  return alignment;
+}
+
+template <typename File>
+struct _state {
+  class type;
+};
+template <typename File>
+using state = typename _state<File>::type;
+
+template <typename State>
+struct _read_receiver {
+  struct type;
+};
+template <typename State>
+using read_receiver = typename _read_receiver<State>::type;
+
+template <typename State>
+struct _read_receiver<State>::type {
+  State& state_;
+  std::uint64_t block_;
+
+  template <typename BytesRead>
+  void set_value(BytesRead bytesRead) && noexcept {
+    state_.on_read_complete(
+        block_, status::value, static_cast<std::size_t>(bytesRead), nullptr);
+  }
+
+  void set_done() && noexcept {
+    state_.on_read_complete(block_, status::done, 0, nullptr);
+  }
+
+  void set_error(std::exception_ptr ex) && noexcept {
+    state_.on_read_complete(block_, status::error, 0, std::move(ex));
+  }
+
+  void set_error(std::error_code ec) && noexcept {
+    std::move(*this).set_error(
+        make_exception_ptr(std::system_error{ec, "read_ahead_stream"}));
+  }
+
+  template <typename Error>
+  void set_error(Error&& error) && noexcept {
+    state_.on_read_complete(
+        block_, status::error, 0, make_exception_ptr((Error &&) error));
+  }
+
+  friend inplace_stop_token
+  tag_invoke(tag_t<get_stop_token>, const type& r) noexcept {
+    return r.state_.get_stop_token();
+  }
+};
+
+template <typename File>
+class _state<File>::type : public single_consumer {
+  using offset_t = typename File::offset_t;
+  using read_sender = decltype(async_read_some_at(
+      std::declval<File&>(),
+      std::declval<offset_t>(),
+      std::declval<span<std::byte>>()));
+  using read_op = connect_result_t<read_sender, read_receiver<type>>;
+
+public:
+  using values_type = std::tuple<span<const std::byte>>;
+
+  explicit type(File& file, std::size_t blockSize, std::size_t readAhead)
+    : file_(file)
+    , blockSize_(blockSize)
+    , readAhead_(readAhead)
+    , slotCount_(readAhead + 1)
+    , pool_(blockSize, readAhead + 1, buffer_alignment(file))
+    , slots_(new slot[readAhead + 1]) {
+    UNIFEX_ASSERT(blockSize > 0);
+    UNIFEX_ASSERT(readAhead > 0);
+    for (std::size_t i = 0; i < slotCount_; ++i) {
+      slots_[i].buffer_ = pool_.try_acquire();
+      UNIFEX_ASSERT(slots_[i].buffer_);
+    }
+  }
+
+  ~type() { UNIFEX_ASSERT(pending_ == 0); }
+
+  // Consumer side. Called with the lock held; moves the bytes of the next
+  // block, if it has been read, into 'block' or the final error into
+  // 'error'.
+  outcome take_locked(
+      std::optional<values_type>& block, std::exception_ptr& error) noexcept {
+    if (finished_ || nextBlock_ >= endBlock_) {
+      finished_ = true;
+      return outcome::done;
+    }
+    slot& s = slot_for(nextBlock_);
+    switch (s.status_) {
+      case status::idle:
+      case status::reading:
+        return outcome::pending;
+      case status::value:
+        s.status_ = status::idle;
+        if (s.bytesRead_ == 0) {
+          finished_ = true;
+          return outcome::done;
+        }
+        block.emplace(span<const std::byte>{s.buffer_.data(), s.bytesRead_});
+        ++nextBlock_;
+        return outcome::value;
+      case status::error:
+        s.status_ = status::idle;
+        finished_ = true;
+        error = std::exchange(s.error_, nullptr);
+        return outcome::error;
+      default:
+        s.status_ = status::idle;
+        finished_ = true;
+        return outcome::done;
+    }
+  }
+
+  // Issue reads until 'readAhead' blocks past the one the consumer holds
+  // are in flight or waiting to be consumed.
+  void pull() noexcept {
+    for (;;) {
+      std::uint64_t block;
+      {
+        std::lock_guard lock{mutex_};
+        if (stopping_ || finished_ || nextRead_ >= endBlock_ ||
+            nextRead_ >= nextBlock_ + readAhead_) {
+          return;
+        }
+        block = nextRead_++;
+        slot_for(block).status_ = status::reading;
+        ++pending_;
+      }
+      start_read(block);
+    }
+  }
+
+  std::mutex& mutex() noexcept { return mutex_; }
+
+  // Cleanup side.
+
+  // Returns true if the stream can complete its cleanup right away;
+  // otherwise 'cleanup' is started once the in-flight reads have completed.
+  bool stop(cleanup_base* cleanup) noexcept {
+    {
+      std::lock_guard lock{mutex_};
+      stopping_ = true;
+    }
+    stopSource_.request_stop();
+
+    std::lock_guard lock{mutex_};
+    if (pending_ == 0) {
+      return true;
+    }
+    cleanup_ = cleanup;
+    return false;
+  }
+
+  // There is nothing to clean up once the reads have completed.
+  _just_done::sender cleanup_source() noexcept { return just_done(); }
+
+  inplace_stop_token get_stop_token() noexcept {
+    return stopSource_.get_token();
+  }
+
+private:
+  friend read_receiver<type>;
+
+  struct slot {
+    aligned_buffer_pool::buffer buffer_;
+    manual_lifetime<read_op> op_;
+    status status_ = status::idle;
+    std::size_t bytesRead_ = 0;
+    std::exception_ptr error_;
+  };
+
+  slot& slot_for(std::uint64_t block) noexcept {
+    return slots_[block % slotCount_];
+  }
+
+  void start_read(std::uint64_t block) noexcept {
+    slot& s = slot_for(block);
+    UNIFEX_TRY {
+      s.op_.construct_with([&] {
+        return unifex::connect(
+            async_read_some_at(
+                file_,
+                static_cast<offset_t>(block * blockSize_),
+                span<std::byte>{s.buffer_.data(), blockSize_}),
+            read_receiver<type>{*this, block});
+      });
+    }
+    UNIFEX_CATCH(...) {
+      complete(block, status::error, 0, std::current_exception());
+      return;
+    }
+    unifex::start(s.op_.get());
+  }
+
+  void on_read_complete(
+      std::uint64_t block,
+      status result,
+      std::size_t bytesRead,
+      std::exception_ptr ex) noexcept {
+    slot_for(block).op_.destruct();
+    complete(block, result, bytesRead, std::move(ex));
+  }
+
+  void complete(
+      std::uint64_t block,
+      status result,
+      std::size_t bytesRead,
+      std::exception_ptr ex) noexcept {
+    consumer_base* consumer = nullptr;
+    cleanup_base* cleanup = nullptr;
+    {
+      std::lock_guard lock{mutex_};
+      slot& s = slot_for(block);
+      s.status_ = result;
+      s.bytesRead_ = bytesRead;
+      s.error_ = std::move(ex);
+      if (result != status::value || bytesRead < blockSize_) {
+        // Nothing past this block will be consumed.
+        endBlock_ = (std::min)(endBlock_, block + 1);
+      }
+      if (consumer_ != nullptr && block == nextBlock_) {
+        consumer = std::exchange(consumer_, nullptr);
+      }
+      if (--pending_ == 0) {
+        cleanup = std::exchange(cleanup_, nullptr);
+      }
+    }
+    if (consumer != nullptr) {
+      consumer->resume_(consumer);
+    }
+    if (cleanup != nullptr) {
+      cleanup->start_(cleanup);
+    }
+  }
+
+  File& file_;
+  const std::size_t blockSize_;
+  const std::size_t readAhead_;
+  const std::size_t slotCount_;
+  aligned_buffer_pool pool_;
+
+  // Block 'b' is read into slots_[b % slotCount_]. Reads are only issued up
+  // to 'readAhead' blocks past the one the consumer holds, so a buffer is
+  // never reused while its contents may still be in use.
+  std::unique_ptr<slot[]> slots_;
+
+  std::mutex mutex_;
+  // The next block to issue a read for and to hand to the consumer.
+  std::uint64_t nextRead_ = 0;
+  std::uint64_t nextBlock_ = 0;
+  // One past the last block that can be consumed, once known.
+  std::uint64_t endBlock_ = (std::numeric_limits<std::uint64_t>::max)();
+  // Reads that have been issued but have not completed yet.
+  std::size_t pending_ = 0;
+  bool finished_ = false;
+  bool stopping_ = false;
+  cleanup_base* cleanup_ = nullptr;
+  inplace_stop_source stopSource_;
+};
+
+template <typename File>
+struct _stream {
+  class type;
+};
+template <typename File>
+using stream = typename _stream<File>::type;
+
+template <typename File>
+class _stream<File>::type {
+  using state_type = state<File>;
+
+public:
+  explicit type(File& file, std::size_t blockSize, std::size_t readAhead)
+    : state_(std::make_unique<state_type>(file, blockSize, readAhead)) {}
+
+  friend _locked_stream::next_sender<state_type>
+  tag_invoke(tag_t<next>, type& s) noexcept {
+    return _locked_stream::next_sender<state_type>{*s.state_};
+  }
+
+  friend _locked_stream::cleanup_sender<state_type>
+  tag_invoke(tag_t<cleanup>, type& s) noexcept {
+    return _locked_stream::cleanup_sender<state_type>{*s.state_};
+  }
+
+private:
+  // In-flight reads refer to the state, so keep it at a fixed address even
+  // if the stream is moved.
+  std::unique_ptr<state_type> state_;
+};
+
+struct _fn {
+  template <typename File>
+  stream<File>
+  operator()(File& file, std::size_t blockSize, std::size_t readAhead) const {
+    return stream<File>{file, blockSize, readAhead};
+  }
+};
+}  // namespace _read_ahead
+
+inline constexpr _read_ahead::_fn read_ahead_stream{};
+}  // namespace linuxos
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
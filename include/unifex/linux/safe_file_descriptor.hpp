@@ -46,6 +46,9 @@ public:
 
   int get() const noexcept { return fd_; }
 
+  // Give up ownership of the file descriptor without closing it.
+  int release() noexcept { return std::exchange(fd_, -1); }
+
   void close() noexcept;
 
 private:
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/config.hpp>
+#if !UNIFEX_NO_EPOLL
+
+#  include <unifex/socket_concepts.hpp>
+
+#  include <unifex/linux/io_epoll_context.hpp>
+
+#  include <atomic>
+#  include <cstddef>
+#  include <memory>
+#  include <thread>
+#  include <vector>
+
+#  include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace linuxos {
+
+// Runs N io_epoll_contexts, each on its own thread.
+//
+// Every shard has its own epoll instance, timers and remote queue, so work
+// started on a shard's scheduler, and any I/O it performs, stays on that
+// shard's thread.
+//
+// To spread a server across the shards, give each shard its own listening
+// socket on the same port (see open_listening_sockets()). The sockets share
+// an SO_REUSEPORT group, so the kernel load-balances incoming connections
+// between them and each connection is served by the shard that accepted it.
+class sharded_io_epoll_context {
+public:
+  using scheduler = io_epoll_context::scheduler;
+
+  explicit sharded_io_epoll_context(
+      std::size_t shardCount = std::thread::hardware_concurrency());
+
+  // Stops and joins all of the shard threads.
+  ~sharded_io_epoll_context();
+
+  sharded_io_epoll_context(sharded_io_epoll_context&&) = delete;
+
+  std::size_t shard_count() const noexcept { return shards_.size(); }
+
+  scheduler get_scheduler(std::size_t shard) noexcept;
+
+  // Hands out the shards' schedulers in round-robin order.
+  scheduler get_scheduler() noexcept;
+
+  // Opens one listening socket per shard, all bound to 'port'. Element i is
+  // registered with shard i. When 'port' is 0 the sockets share whichever
+  // port the kernel picked for the first one.
+  std::vector<io_epoll_context::accept_stream>
+  open_listening_sockets(port_t port);
+
+private:
+  struct shard;
+
+  std::vector<std::unique_ptr<shard>> shards_;
+  std::atomic<std::size_t> nextShard_{0};
+};
+
+}  // namespace linuxos
+}  // namespace unifex
+
+#  include <unifex/detail/epilogue.hpp>
+
+#endif  // !UNIFEX_NO_EPOLL
@@ -18,6 +18,7 @@
 #include <unifex/blocking.hpp>
 #include <unifex/get_stop_token.hpp>
 #include <unifex/receiver_concepts.hpp>
+#include <unifex/running_in_this_thread.hpp>
 #include <unifex/stop_token_concepts.hpp>
 
 #include <condition_variable>
@@ -128,6 +129,11 @@ public:
       return a.loop_ != b.loop_;
     }
 
+    friend bool
+    tag_invoke(tag_t<running_in_this_thread>, const scheduler& s) noexcept {
+      return s.loop_->is_running_on_loop_thread();
+    }
+
   private:
     context* loop_;
   };
@@ -138,6 +144,9 @@ public:
 
   void stop();
 
+  // Returns true if called from inside run() on this loop.
+  bool is_running_on_loop_thread() const noexcept;
+
 private:
   void enqueue(task_base* task);
 
@@ -0,0 +1,384 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/config.hpp>
+#include <unifex/detail/cleanup_all.hpp>
+#include <unifex/detail/locked_stream.hpp>
+#include <unifex/exception.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/stream_concepts.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace _merge_streams {
+
+// merge_streams(streams...)
+//
+// Sends the values of all of 'streams' interleaved, in the order they
+// arrive. Each stream has at most one next() in flight plus one value
+// waiting to be consumed, so a slow consumer holds back all of them. Ready
+// values are taken from the streams in round-robin order.
+//
+// The merged stream ends once every stream has ended. If one of them fails,
+// the outstanding next() on the others are cancelled and the error is sent
+// after the values that had already arrived. cleanup() cancels the
+// outstanding next()s, waits for them and then cleans up every stream in
+// turn.
+
+using _locked_stream::cleanup_base;
+using _locked_stream::consumer_base;
+using _locked_stream::outcome;
+using _locked_stream::single_consumer;
+
+template <typename Stream>
+using values_type_t = typename sender_value_types_t<
+    next_sender_t<Stream>,
+    single_overload,
+    decayed_tuple<std::tuple>::template apply>::type;
+
+template <typename... Streams>
+struct _state {
+  class type;
+};
+template <typename... Streams>
+using state = typename _state<Streams...>::type;
+
+template <typename State, std::size_t Index>
+struct _source_receiver {
+  struct type;
+};
+template <typename State, std::size_t Index>
+using source_receiver = typename _source_receiver<State, Index>::type;
+
+template <typename State, std::size_t Index>
+struct _source_receiver<State, Index>::type {
+  State& state_;
+
+  template <typename... Values>
+  void set_value(Values&&... values) && noexcept {
+    state_.template on_value<Index>((Values &&) values...);
+  }
+
+  void set_done() && noexcept {
+    state_.template on_finished<Index>(nullptr);
+  }
+
+  void set_error(std::exception_ptr ex) && noexcept {
+    state_.template on_finished<Index>(std::move(ex));
+  }
+
+  template <typename Error>
+  void set_error(Error&& error) && noexcept {
+    state_.template on_finished<Index>(make_exception_ptr((Error &&) error));
+  }
+
+  friend inplace_stop_token
+  tag_invoke(tag_t<get_stop_token>, const type& r) noexcept {
+    return r.state_.get_stop_token();
+  }
+};
+
+template <typename... Streams>
+class _state<Streams...>::type : public single_consumer {
+  using first_stream = std::tuple_element_t<0, std::tuple<Streams...>>;
+
+public:
+  using values_type = values_type_t<first_stream>;
+
+  static_assert(
+      (std::is_same_v<values_type_t<Streams>, values_type> && ...),
+      "merge_streams requires all streams to send the same values");
+
+  template <typename... Streams2>
+  explicit type(Streams2&&... streams) : streams_((Streams2 &&) streams...) {}
+
+  ~type() { UNIFEX_ASSERT(pending_ == 0); }
+
+  // Consumer side. Called with the lock held; moves the next value, if any,
+  // into 'value' or the final error into 'error'.
+  outcome take_locked(
+      std::optional<values_type>& value, std::exception_ptr& error) noexcept {
+    if (finished_) {
+      return outcome::done;
+    }
+    for (std::size_t i = 0; i < source_count; ++i) {
+      source& src = sources_[(nextSource_ + i) % source_count];
+      if (src.ready_) {
+        value.emplace(std::move(*src.value_));
+        src.value_.reset();
+        src.ready_ = false;
+        nextSource_ = (nextSource_ + i + 1) % source_count;
+        return outcome::value;
+      }
+    }
+    if (finishedCount_ == source_count) {
+      finished_ = true;
+      if (error_) {
+        error = std::exchange(error_, nullptr);
+        return outcome::error;
+      }
+      return outcome::done;
+    }
+    return outcome::pending;
+  }
+
+  // Ask every stream that has room for a value for its next one.
+  void pull() noexcept { pull_all(std::index_sequence_for<Streams...>{}); }
+
+  std::mutex& mutex() noexcept { return mutex_; }
+
+  // Cleanup side.
+
+  // Returns true if the streams can be cleaned up right away; otherwise
+  // 'cleanup' is started once the outstanding next()s have completed.
+  bool stop(cleanup_base* cleanup) noexcept {
+    {
+      std::lock_guard lock{mutex_};
+      stopping_ = true;
+    }
+    stopSource_.request_stop();
+
+    std::lock_guard lock{mutex_};
+    if (pending_ == 0) {
+      return true;
+    }
+    cleanup_ = cleanup;
+    return false;
+  }
+
+  // Drops the values nobody will consume now and returns the sender that
+  // cleans up the streams.
+  _cleanup_all::sender<Streams...> cleanup_source() noexcept {
+    for (source& src : sources_) {
+      src.value_.reset();
+      src.ready_ = false;
+    }
+    return cleanup_all(streams_);
+  }
+
+  inplace_stop_token get_stop_token() noexcept {
+    return stopSource_.get_token();
+  }
+
+private:
+  template <typename State, std::size_t Index>
+  friend struct _source_receiver;
+
+  static constexpr std::size_t source_count = sizeof...(Streams);
+
+  struct source {
+    std::optional<values_type> value_;
+    bool ready_ = false;
+    bool running_ = false;
+    bool finished_ = false;
+  };
+
+  template <std::size_t... Indices>
+  static auto make_ops(std::index_sequence<Indices...>) -> std::tuple<
+      manual_lifetime<
+          next_operation_t<Streams, source_receiver<type, Indices>>>...>;
+
+  template <std::size_t... Indices>
+  void pull_all(std::index_sequence<Indices...>) noexcept {
+    (pull_one<Indices>(), ...);
+  }
+
+  template <std::size_t Index>
+  void pull_one() noexcept {
+    source& src = sources_[Index];
+    {
+      std::lock_guard lock{mutex_};
+      if (src.running_ || src.ready_ || src.finished_ || stopping_) {
+        return;
+      }
+      if (failed_) {
+        // Another stream failed; this one won't be asked for more values.
+        src.finished_ = true;
+        ++finishedCount_;
+        return;
+      }
+      src.running_ = true;
+      ++pending_;
+    }
+    auto& op = std::get<Index>(ops_);
+    UNIFEX_TRY {
+      op.construct_with([&] {
+        return unifex::connect(
+            next(std::get<Index>(streams_)),
+            source_receiver<type, Index>{*this});
+      });
+    }
+    UNIFEX_CATCH(...) {
+      finish<Index>(std::current_exception());
+      return;
+    }
+    unifex::start(op.get());
+  }
+
+  template <std::size_t Index, typename... Values>
+  void on_value(Values&&... values) noexcept {
+    source& src = sources_[Index];
+    UNIFEX_TRY {
+      src.value_.emplace((Values &&) values...);
+    }
+    UNIFEX_CATCH(...) {
+      std::get<Index>(ops_).destruct();
+      finish<Index>(std::current_exception());
+      return;
+    }
+    std::get<Index>(ops_).destruct();
+
+    consumer_base* consumer;
+    {
+      std::lock_guard lock{mutex_};
+      src.running_ = false;
+      src.ready_ = true;
+      consumer = std::exchange(consumer_, nullptr);
+    }
+    if (consumer != nullptr) {
+      consumer->resume_(consumer);
+    }
+    release();
+  }
+
+  template <std::size_t Index>
+  void on_finished(std::exception_ptr ex) noexcept {
+    std::get<Index>(ops_).destruct();
+    finish<Index>(std::move(ex));
+  }
+
+  template <std::size_t Index>
+  void finish(std::exception_ptr ex) noexcept {
+    consumer_base* consumer = nullptr;
+    bool cancelOthers = false;
+    {
+      std::lock_guard lock{mutex_};
+      sources_[Index].running_ = false;
+      sources_[Index].finished_ = true;
+      ++finishedCount_;
+      if (ex && !failed_) {
+        failed_ = true;
+        error_ = std::move(ex);
+        cancelOthers = true;
+      }
+      if (finishedCount_ == source_count) {
+        consumer = std::exchange(consumer_, nullptr);
+      }
+    }
+    if (cancelOthers) {
+      stopSource_.request_stop();
+    }
+    if (consumer != nullptr) {
+      consumer->resume_(consumer);
+    }
+    release();
+  }
+
+  // Called once a next() on one of the streams is done with the state, so
+  // that a waiting cleanup can go ahead.
+  void release() noexcept {
+    cleanup_base* cleanup = nullptr;
+    {
+      std::lock_guard lock{mutex_};
+      if (--pending_ == 0) {
+        cleanup = std::exchange(cleanup_, nullptr);
+      }
+    }
+    if (cleanup != nullptr) {
+      cleanup->start_(cleanup);
+    }
+  }
+
+  std::tuple<Streams...> streams_;
+  source sources_[source_count];
+
+  std::mutex mutex_;
+  // next()s on the streams that have not returned from completing yet.
+  std::size_t pending_ = 0;
+  std::size_t finishedCount_ = 0;
+  std::size_t nextSource_ = 0;
+  std::exception_ptr error_;
+  bool failed_ = false;
+  bool finished_ = false;
+  bool stopping_ = false;
+  cleanup_base* cleanup_ = nullptr;
+  inplace_stop_source stopSource_;
+  decltype(make_ops(std::index_sequence_for<Streams...>{})) ops_;
+};
+
+template <typename... Streams>
+struct _stream {
+  class type;
+};
+template <typename... Streams>
+using stream = typename _stream<remove_cvref_t<Streams>...>::type;
+
+template <typename... Streams>
+class _stream<Streams...>::type {
+  using state_type = state<Streams...>;
+
+public:
+  template <typename... Streams2>
+  explicit type(Streams2&&... streams)
+    : state_(std::make_unique<state_type>((Streams2 &&) streams...)) {}
+
+  friend _locked_stream::next_sender<state_type>
+  tag_invoke(tag_t<next>, type& s) noexcept {
+    return _locked_stream::next_sender<state_type>{*s.state_};
+  }
+
+  friend _locked_stream::cleanup_sender<state_type>
+  tag_invoke(tag_t<cleanup>, type& s) noexcept {
+    return _locked_stream::cleanup_sender<state_type>{*s.state_};
+  }
+
+private:
+  // Outstanding next()s refer to the state, so keep it at a fixed address
+  // even if the stream is moved.
+  std::unique_ptr<state_type> state_;
+};
+}  // namespace _merge_streams
+
+namespace _merge_streams_cpo {
+inline const struct _fn {
+  template <typename... Streams>
+  auto operator()(Streams&&... streams) const
+      -> _merge_streams::stream<Streams...> {
+    static_assert(sizeof...(Streams) > 0);
+    return _merge_streams::stream<Streams...>{(Streams &&) streams...};
+  }
+} merge_streams{};
+}  // namespace _merge_streams_cpo
+using _merge_streams_cpo::merge_streams;
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
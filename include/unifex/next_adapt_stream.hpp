@@ -15,15 +15,36 @@
  */
 #pragma once
 
+#include <unifex/std_concepts.hpp>
 #include <unifex/stream_concepts.hpp>
+#include <unifex/tag_invoke.hpp>
+#include <unifex/type_traits.hpp>
 
 #include <functional>
 #include <type_traits>
+#include <utility>
 
 #include <unifex/detail/prologue.hpp>
 
 namespace unifex {
+namespace _next_adapt_cpo {
+struct _fn;
+}  // namespace _next_adapt_cpo
+
 namespace _next_adapt {
+// Applies 'Second' to the sender produced by 'First'.
+template <typename First, typename Second>
+struct _compose {
+  UNIFEX_NO_UNIQUE_ADDRESS First first_;
+  UNIFEX_NO_UNIQUE_ADDRESS Second second_;
+
+  template <typename Sender>
+  auto operator()(Sender&& sender)
+      -> std::invoke_result_t<Second&, std::invoke_result_t<First&, Sender>> {
+    return std::invoke(second_, std::invoke(first_, (Sender &&) sender));
+  }
+};
+
 template <typename Stream, typename AdaptFunc>
 struct _stream {
   struct type;
@@ -45,17 +66,37 @@ struct _stream<Stream, AdaptFunc>::type {
   friend auto tag_invoke(tag_t<cleanup>, type& s) -> cleanup_sender_t<Stream> {
     return cleanup(s.innerStream_);
   }
+
+  // Adapting an adapted stream composes the two adapters, so that next()
+  // still goes straight to the inner stream.
+  template(typename CPO, typename Self, typename AdaptFunc2)  //
+      (requires same_as<CPO, _next_adapt_cpo::_fn> AND        //
+           same_as<remove_cvref_t<Self>, type>)               //
+      friend auto tag_invoke(CPO, Self&& self, AdaptFunc2&& adapt)
+          -> stream<Stream, _compose<AdaptFunc, remove_cvref_t<AdaptFunc2>>> {
+    return stream<Stream, _compose<AdaptFunc, remove_cvref_t<AdaptFunc2>>>{
+        static_cast<Self&&>(self).innerStream_,
+        _compose<AdaptFunc, remove_cvref_t<AdaptFunc2>>{
+            static_cast<Self&&>(self).adapter_, (AdaptFunc2 &&) adapt}};
+  }
 };
 }  // namespace _next_adapt
 
 namespace _next_adapt_cpo {
-inline const struct _fn {
+struct _fn {
   template <typename Stream, typename AdaptFunc>
   auto operator()(Stream&& stream, AdaptFunc&& adapt) const {
-    return _next_adapt::stream<Stream, AdaptFunc>{
-        (Stream &&) stream, (AdaptFunc &&) adapt};
+    if constexpr (tag_invocable<_fn, Stream, AdaptFunc>) {
+      return unifex::tag_invoke(
+          _fn{}, (Stream &&) stream, (AdaptFunc &&) adapt);
+    } else {
+      return _next_adapt::stream<Stream, AdaptFunc>{
+          (Stream &&) stream, (AdaptFunc &&) adapt};
+    }
   }
-} next_adapt_stream{};
+};
+
+inline const _fn next_adapt_stream{};
 }  // namespace _next_adapt_cpo
 
 using _next_adapt_cpo::next_adapt_stream;
@@ -18,6 +18,7 @@
 #include <unifex/blocking.hpp>
 #include <unifex/just_done.hpp>
 #include <unifex/receiver_concepts.hpp>
+#include <unifex/span.hpp>
 #include <unifex/stream_concepts.hpp>
 
 #include <type_traits>
@@ -44,6 +45,31 @@ struct _op<Receiver>::type {
   void start() noexcept;
 };
 
+template <typename Receiver>
+struct _batch_op {
+  struct type;
+};
+template <typename Receiver>
+using batch_operation = typename _batch_op<remove_cvref_t<Receiver>>::type;
+
+inline constexpr int batch_size = 64;
+
+template <typename Receiver>
+struct _batch_op<Receiver>::type {
+  template <typename Receiver2>
+  explicit type(stream& s, Receiver2&& receiver)
+    : stream_(s)
+    , receiver_((Receiver2 &&) receiver) {}
+
+  stream& stream_;
+  Receiver receiver_;
+  // Lives here rather than in the stream, so streams that are never read
+  // in batches don't pay for it. Left uninitialized; start() fills it.
+  int batch_[batch_size];
+
+  void start() noexcept;
+};
+
 struct next_sender {
   stream& stream_;
 
@@ -69,6 +95,31 @@ struct next_sender {
   void connect(Receiver&& receiver) const& = delete;
 };
 
+struct next_batch_sender {
+  stream& stream_;
+
+  template <
+      template <typename...>
+      class Variant,
+      template <typename...>
+      class Tuple>
+  using value_types = Variant<Tuple<span<const int>>>;
+
+  template <template <typename...> class Variant>
+  using error_types = Variant<>;
+
+  static constexpr bool sends_done = true;
+
+  static constexpr blocking_kind blocking = blocking_kind::always_inline;
+
+  template <typename Receiver>
+  batch_operation<Receiver> connect(Receiver&& receiver) && {
+    return batch_operation<Receiver>{stream_, (Receiver &&) receiver};
+  }
+  template <typename Receiver>
+  void connect(Receiver&& receiver) const& = delete;
+};
+
 struct stream {
   int next_;
   int max_;
@@ -80,6 +131,10 @@ struct stream {
     return next_sender{s};
   }
 
+  friend next_batch_sender tag_invoke(tag_t<next_batch>, stream& s) noexcept {
+    return next_batch_sender{s};
+  }
+
   friend auto tag_invoke(tag_t<cleanup>, stream&) noexcept {
     return just_done();
   }
@@ -93,6 +148,21 @@ void _op<Receiver>::type::start() noexcept {
     unifex::set_done(std::move(receiver_));
   }
 }
+
+template <typename Receiver>
+void _batch_op<Receiver>::type::start() noexcept {
+  if (stream_.next_ < stream_.max_) {
+    int count = 0;
+    while (count < batch_size && stream_.next_ < stream_.max_) {
+      batch_[count++] = stream_.next_++;
+    }
+    unifex::set_value(
+        std::move(receiver_),
+        span<const int>{batch_, static_cast<std::size_t>(count)});
+  } else {
+    unifex::set_done(std::move(receiver_));
+  }
+}
 }  // namespace _range
 
 using range_stream = _range::stream;
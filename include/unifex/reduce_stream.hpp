@@ -22,12 +22,14 @@
 #include <unifex/get_stop_token.hpp>
 #include <unifex/manual_lifetime.hpp>
 #include <unifex/receiver_concepts.hpp>
+#include <unifex/scope_guard.hpp>
 #include <unifex/sender_concepts.hpp>
 #include <unifex/std_concepts.hpp>
 #include <unifex/stream_concepts.hpp>
 #include <unifex/type_list.hpp>
 #include <unifex/type_traits.hpp>
 #include <unifex/unstoppable_token.hpp>
+#include <unifex/detail/fused_stream.hpp>
 
 #include <exception>
 #include <functional>
@@ -38,6 +40,30 @@
 
 namespace unifex {
 namespace _reduce {
+// Streams that support next_batch() are reduced a whole batch of values per
+// operation, others one value per operation. transform_stream() and
+// filter_stream() chains over a batched stream are reduced a batch at a time
+// too, running their stages directly in the reduction loop.
+template <typename StreamSender>
+inline constexpr bool reduces_batches_v =
+    is_batched_stream_v<StreamSender> ||
+    _fused::is_fused_over_batched_v<StreamSender>;
+
+template <typename StreamSender>
+auto next_or_batch(StreamSender& stream) {
+  if constexpr (_fused::is_fused_over_batched_v<StreamSender>) {
+    return next_batch(stream.source_);
+  } else if constexpr (is_batched_stream_v<StreamSender>) {
+    return next_batch(stream);
+  } else {
+    return next(stream);
+  }
+}
+
+template <typename StreamSender>
+using next_or_batch_sender_t =
+    decltype(_reduce::next_or_batch(std::declval<StreamSender&>()));
+
 template <
     typename StreamSender,
     typename State,
@@ -239,12 +265,23 @@ struct _next_receiver<StreamSender, State, ReducerFunc, Receiver>::type {
   template <typename... Values>
   void set_value(Values... values) && noexcept {
     auto& op = op_;
-    unifex::deactivate_union_member(op.next_);
     UNIFEX_TRY {
-      op.state_ =
-          std::invoke(op.reducer_, std::move(op.state_), (Values&&)values...);
+      if constexpr (reduces_batches_v<StreamSender>) {
+        static_assert(sizeof...(Values) == 1);
+        // The batch may live in next_'s operation state, so reduce it
+        // before destroying that.
+        scope_guard destroyNext = [&]() noexcept {
+          unifex::deactivate_union_member(op.next_);
+        };
+        (op.reduce_batch(values), ...);
+      } else {
+        unifex::deactivate_union_member(op.next_);
+        op.state_ =
+            std::invoke(op.reducer_, std::move(op.state_), (Values&&)values...);
+      }
       unifex::activate_union_member_with(op.next_, [&] {
-        return unifex::connect(next(op.stream_), next_receiver_t{op});
+        return unifex::connect(
+            _reduce::next_or_batch(op.stream_), next_receiver_t{op});
       });
       unifex::start(op.next_.get());
     }
@@ -301,8 +338,8 @@ struct _op<StreamSender, State, ReducerFunc, Receiver>::type {
   using done_cleanup_receiver_t =
       done_cleanup_receiver<StreamSender, State, ReducerFunc, Receiver>;
 
-  using next_op =
-      manual_lifetime<next_operation_t<StreamSender, next_receiver_t>>;
+  using next_op = manual_lifetime<
+      connect_result_t<next_or_batch_sender_t<StreamSender>, next_receiver_t>>;
   using error_op = manual_lifetime<
       cleanup_operation_t<StreamSender, error_cleanup_receiver_t>>;
   using done_op = manual_lifetime<
@@ -331,10 +368,32 @@ struct _op<StreamSender, State, ReducerFunc, Receiver>::type {
 
   ~type() {}  // Due to the union member, this is load-bearing. DO NOT DELETE.
 
+  template <typename Batch>
+  void reduce_batch(Batch batch) {
+    if constexpr (_fused::is_fused_over_batched_v<StreamSender>) {
+      auto reduce = [&](auto&&... values) -> bool {
+        state_ = std::invoke(
+            reducer_,
+            std::move(state_),
+            static_cast<decltype(values)>(values)...);
+        return true;
+      };
+      for (auto& value : batch) {
+        // Hand the stages a copy, as next() on the source would.
+        stream_.stage_(reduce, std::decay_t<decltype(value)>(value));
+      }
+    } else {
+      for (auto& value : batch) {
+        state_ = std::invoke(reducer_, std::move(state_), std::move(value));
+      }
+    }
+  }
+
   void start() noexcept {
     UNIFEX_TRY {
       unifex::activate_union_member_with(next_, [&] {
-        return unifex::connect(next(stream_), next_receiver_t{*this});
+        return unifex::connect(
+            _reduce::next_or_batch(stream_), next_receiver_t{*this});
       });
       unifex::start(next_.get());
     }
@@ -371,7 +430,7 @@ struct _sender<StreamSender, State, ReducerFunc>::type {
 
   template <template <typename...> class Variant>
   using error_types = typename concat_type_lists_unique_t<
-      sender_error_types_t<next_sender_t<StreamSender>, type_list>,
+      sender_error_types_t<next_or_batch_sender_t<StreamSender>, type_list>,
       sender_error_types_t<cleanup_sender_t<StreamSender>, type_list>,
       type_list<std::exception_ptr>>::template apply<Variant>;
 
@@ -391,7 +450,9 @@ struct _sender<StreamSender, State, ReducerFunc>::type {
 
   template(typename Self, typename Receiver)  //
       (requires same_as<remove_cvref_t<Self>, type> AND receiver<Receiver> AND
-           sender_to<next_sender_t<StreamSender>, next_receiver_t<Receiver>> AND
+           sender_to<
+               next_or_batch_sender_t<StreamSender>,
+               next_receiver_t<Receiver>> AND
                sender_to<
                    cleanup_sender_t<StreamSender>,
                    error_cleanup_receiver_t<Receiver>> AND
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/tag_invoke.hpp>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace _running_in_this_thread {
+// running_in_this_thread(scheduler) returns true if the calling thread
+// is one of the threads that runs work scheduled on 'scheduler', i.e.
+// code running here already is where schedule(scheduler) would take
+// it.  Schedulers that can't tell answer false, which is always safe.
+struct _fn {
+  template(typename Scheduler)                         //
+      (requires tag_invocable<_fn, const Scheduler&>)  //
+      bool
+      operator()(const Scheduler& s) const noexcept {
+    static_assert(
+        is_nothrow_tag_invocable_v<_fn, const Scheduler&>,
+        "running_in_this_thread() customisations must be noexcept");
+    return tag_invoke(_fn{}, s);
+  }
+
+  template(typename Scheduler)                           //
+      (requires(!tag_invocable<_fn, const Scheduler&>))  //
+      constexpr bool
+      operator()([[maybe_unused]] const Scheduler&) const noexcept {
+    return false;
+  }
+};
+}  // namespace _running_in_this_thread
+
+inline constexpr _running_in_this_thread::_fn running_in_this_thread{};
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
@@ -33,8 +33,24 @@ inline constexpr struct open_listening_socket_cpo final {
     return tag_invoke(*this, static_cast<Scheduler&&>(sched), port);
   }
 } open_listening_socket{};
+
+// Connect a new stream socket to the given address. The address arguments
+// are scheduler-specific, e.g. a (const sockaddr*, socklen_t) pair on POSIX.
+inline constexpr struct async_connect_cpo final {
+  template <typename Scheduler, typename... Address>
+  constexpr auto operator()(Scheduler&& sched, Address&&... address) const
+      noexcept(is_nothrow_tag_invocable_v<
+               async_connect_cpo,
+               Scheduler,
+               Address...>)
+          -> tag_invoke_result_t<async_connect_cpo, Scheduler, Address...> {
+    return tag_invoke(
+        *this, static_cast<Scheduler&&>(sched), (Address &&) address...);
+  }
+} async_connect{};
 }  // namespace _socket
 
+using _socket::async_connect;
 using _socket::open_listening_socket;
 using _socket::port_t;
 }  // namespace unifex
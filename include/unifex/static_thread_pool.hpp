@@ -17,6 +17,7 @@
 
 #include <unifex/get_stop_token.hpp>
 #include <unifex/receiver_concepts.hpp>
+#include <unifex/running_in_this_thread.hpp>
 #include <unifex/scheduler_concepts.hpp>
 #include <unifex/sender_concepts.hpp>
 #include <unifex/stop_token_concepts.hpp>
@@ -112,6 +113,11 @@ public:
       return &a.pool_ != &b.pool_;
     }
 
+    friend bool
+    tag_invoke(tag_t<running_in_this_thread>, const scheduler& s) noexcept {
+      return s.pool_.is_running_on_pool_thread();
+    }
+
     context& pool_;
   };
 
@@ -119,6 +125,9 @@ public:
 
   void request_stop() noexcept;
 
+  // Returns true if called from one of this pool's worker threads.
+  bool is_running_on_pool_thread() const noexcept;
+
 private:
   class thread_state {
   public:
@@ -77,10 +77,34 @@ public:
     return stream.cleanup();
   }
 } cleanup{};
+
+// Optional batched alternative to next(): produces a sender that sends a
+// non-empty span of values, or done once the stream is exhausted. The values
+// may live in the operation state, so they stay valid only until the
+// operation is destroyed. There is no default implementation; consumers check
+// is_batched_stream_v and fall back to next() for other streams.
+inline const struct _next_batch_fn {
+  template(typename Stream)                              //
+      (requires tag_invocable<_next_batch_fn, Stream&>)  //
+      auto
+      operator()(Stream& stream) const
+      noexcept(is_nothrow_tag_invocable_v<_next_batch_fn, Stream&>)
+          -> tag_invoke_result_t<_next_batch_fn, Stream&> {
+    return unifex::tag_invoke(_next_batch_fn{}, stream);
+  }
+} next_batch{};
 }  // namespace _streams
 
 using _streams::cleanup;
 using _streams::next;
+using _streams::next_batch;
+
+template <typename Stream>
+inline constexpr bool is_batched_stream_v =
+    is_tag_invocable_v<tag_t<next_batch>, Stream&>;
+
+template <typename Stream>
+using next_batch_sender_t = decltype(next_batch(std::declval<Stream&>()));
 
 template <typename Stream>
 using next_sender_t = decltype(next(std::declval<Stream&>()));
@@ -24,6 +24,7 @@
 #include <unifex/coroutine.hpp>
 #include <unifex/coroutine_concepts.hpp>
 #include <unifex/defer.hpp>
+#include <unifex/detail/coroutine_frame_allocator.hpp>
 #include <unifex/finally.hpp>
 #include <unifex/inline_scheduler.hpp>
 #include <unifex/inplace_stop_token.hpp>
@@ -156,19 +157,36 @@ struct _final_suspend_awaiter_base {
 
 /**
  * Common behaviour and data for task<> and sr_thunk_task<>'s promise types.
+ *
+ * Coroutine frames come from a thread-local pool of recycled frames unless
+ * the coroutine takes 'std::allocator_arg, alloc' as its first parameters
+ * (after the object parameter of a member function), in which case they
+ * are allocated with 'alloc'. On GCC such coroutines need
+ * -Wno-mismatched-new-delete to build with -Werror; see
+ * frame_allocator_promise.
  */
-struct _promise_base {
-  template(typename Func)                                        //
-      (requires(!same_as<_promise_base, remove_cvref_t<Func>>))  //
-      _promise_base(Func&& onDone)
-    : doneCoro_(unifex::unhandled_done(std::forward<Func>(onDone))) {}
+struct _promise_base : _coro_frame::frame_allocator_promise {
+  using on_done_t = coro::coroutine_handle<> (*)(_promise_base&) noexcept;
+
+  explicit _promise_base(on_done_t onDone) noexcept : onDone_(onDone) {}
 
   /**
    * Our coroutine types are lazy so initial_suspend() returns suspend_always.
    */
   coro::suspend_always initial_suspend() noexcept { return {}; }
 
+  /**
+   * Most coroutines never complete with done so the coroutine that handles
+   * it is only created the first time it's asked for; failing to allocate it
+   * terminates.
+   */
   coro::coroutine_handle<> unhandled_done() noexcept {
+    if (!doneCoro_.handle()) {
+      doneCoro_ = unifex::unhandled_done(
+          [this]() noexcept -> coro::coroutine_handle<> {
+            return onDone_(*this);
+          });
+    }
     return doneCoro_.handle();
   }
 
@@ -205,6 +223,8 @@ struct _promise_base {
   any_scheduler sched_{_default_scheduler};
   // a stop token from our receiver, possibly adapted through an adapter
   inplace_stop_token stoken_;
+  // decides where to go when a child awaitable completes with done
+  on_done_t onDone_;
   // the coroutine to resume when a child awaitable completes with done
   done_coro doneCoro_;
   // gets set to the return address of the ramp function
@@ -219,14 +239,16 @@ struct _promise_base {
  * The parts of a task<T>'s promise that don't depend on T.
  */
 struct _task_promise_base : _promise_base {
-  _task_promise_base()
-    : _promise_base([this]() noexcept {
-      if (frame_) {
-        popAsyncStackFrameFromCaller(*frame_);
-      }
+  _task_promise_base() noexcept : _promise_base(&on_done) {}
+
+  static coro::coroutine_handle<> on_done(_promise_base& base) noexcept {
+    auto& self = static_cast<_task_promise_base&>(base);
+    if (self.frame_) {
+      popAsyncStackFrameFromCaller(*self.frame_);
+    }
 
-      return continuation_.done_handle();
-    }) {}
+    return self.continuation_.done_handle();
+  }
 
   // the implementation of the magic of co_await schedule(s); this is to be
   // ripped out and replaced with something more explicit
@@ -439,10 +461,13 @@ private:
 };
 
 struct _sr_thunk_promise_base : _promise_base {
-  _sr_thunk_promise_base()
-    : _promise_base([this]() noexcept -> coro::coroutine_handle<> {
-      return complete_and_choose_continuation(continuation_.done_handle());
-    }) {}
+  _sr_thunk_promise_base() : _promise_base(&on_done) {}
+
+  static coro::coroutine_handle<> on_done(_promise_base& base) noexcept {
+    auto& self = static_cast<_sr_thunk_promise_base&>(base);
+    return self.complete_and_choose_continuation(
+        self.continuation_.done_handle());
+  }
 
   friend inplace_stop_token
   tag_invoke(tag_t<get_stop_token>, const _sr_thunk_promise_base& p) noexcept {
@@ -521,7 +546,7 @@ struct _sr_thunk_promise_base : _promise_base {
 
   _frame_state ensure_frame_deactivated() noexcept {
     if (frame_ != nullptr) {
-      if (whoToContinue_ == continuation_.done_handle()) {
+      if (whoToContinue_ != continuation_.handle()) {
         popAsyncStackFrameFromCaller(*frame_);
       }
 
@@ -21,8 +21,11 @@
 #include <unifex/receiver_concepts.hpp>
 #include <unifex/stop_token_concepts.hpp>
 
+#include <array>
 #include <chrono>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
 #include <mutex>
 #include <thread>
 #include <type_traits>
@@ -49,10 +52,72 @@ struct task_base {
   task_base** prevNextPtr_ = nullptr;
   execute_fn* execute_;
   time_point dueTime_;
+  // Order of insertion into the timer wheel, to break ties in 'dueTime_'.
+  std::uint64_t sequence_ = 0;
 
   void execute() noexcept { execute_(this); }
 };
 
+// Hierarchical hashed timer wheel holding the tasks that are not yet due.
+//
+// Four levels of 256 slots with a 1ms tick at the lowest level cover ~49 days;
+// tasks further out sit in the last level until they come within range.
+// Inserting or removing a task is O(1) regardless of how many are queued.
+// As time advances the slot for each elapsed tick is moved to a short list
+// sorted by due-time, so tasks still run in due-time order and never early.
+// Tasks with equal due-times run in the order they were inserted, whichever
+// levels they passed through.
+//
+// Tasks are linked through 'next_' and 'prevNextPtr_', the latter being
+// non-null while the task is queued. Not thread-safe.
+class timer_wheel {
+public:
+  using duration = std::chrono::milliseconds;
+
+  explicit timer_wheel(time_point epoch) noexcept;
+
+  bool empty() const noexcept { return size_ == 0 && ready_ == nullptr; }
+
+  void insert(task_base* task) noexcept;
+
+  // Must be called before changing the task's due-time.
+  void remove(task_base* task) noexcept;
+
+  // Dequeue the earliest task due at or before 'now', if there is one.
+  task_base* pop_due(time_point now) noexcept;
+
+  // The earliest time at which pop_due() may return a task, or
+  // time_point::max() if the wheel is empty.
+  time_point next_due_time() const noexcept;
+
+private:
+  static constexpr std::size_t level_count = 4;
+  static constexpr std::size_t slot_bits = 8;
+  static constexpr std::size_t slot_count = std::size_t(1) << slot_bits;
+  static constexpr std::uint64_t slot_mask = slot_count - 1;
+
+  std::uint64_t to_tick(time_point t) const noexcept;
+  time_point to_time_point(std::uint64_t tick) const noexcept;
+
+  std::uint64_t next_tick() const noexcept;
+  void advance(time_point now) noexcept;
+  void cascade() noexcept;
+  void insert_into_slot(task_base* task) noexcept;
+  void insert_ready(task_base* task) noexcept;
+  void move_to_ready(task_base*& slot) noexcept;
+
+  time_point epoch_;
+  // Every tick before this one has been moved out of the wheel.
+  std::uint64_t currentTick_ = 0;
+  // Number of tasks in 'slots_'.
+  std::size_t size_ = 0;
+  // Sequence number for the next inserted task.
+  std::uint64_t nextSequence_ = 0;
+  std::array<std::array<task_base*, slot_count>, level_count> slots_{};
+  // Tasks whose tick has elapsed, in ascending order of due-time.
+  task_base* ready_ = nullptr;
+};
+
 class cancel_callback {
   task_base* const task_;
 
@@ -260,6 +325,8 @@ public:
     return schedule_at_sender{*context_, dueTime};
   }
 
+  clock_t::time_point now() const noexcept { return clock_t::now(); }
+
   auto schedule() const noexcept {
     return schedule_after(std::chrono::milliseconds{0});
   }
@@ -283,8 +350,17 @@ class timed_single_thread_context {
   std::mutex mutex_;
   std::condition_variable cv_;
 
-  // Head of a linked-list in ascending order of due-time.
-  task_base* head_ = nullptr;
+  _timed_single_thread_context::timer_wheel timers_;
+
+  // Cancelled tasks, in the order they were cancelled. These run ahead of
+  // any timers.
+  task_base* cancelled_ = nullptr;
+  task_base** cancelledTail_ = &cancelled_;
+
+  // When the thread is blocked, the time it will next wake up on its own;
+  // time_point::min() while it is running tasks.
+  _timed_single_thread_context::time_point wakeTime_ =
+      _timed_single_thread_context::time_point::min();
   bool stop_ = false;
 
   std::thread thread_;
@@ -16,23 +16,28 @@
 #pragma once
 
 #include <unifex/bind_back.hpp>
-#include <unifex/next_adapt_stream.hpp>
-#include <unifex/then.hpp>
+#include <unifex/tag_invoke.hpp>
+#include <unifex/detail/fused_stream.hpp>
 
-#include <functional>
+#include <type_traits>
 
 #include <unifex/detail/prologue.hpp>
 
 namespace unifex {
 namespace _tfx_stream {
 struct _fn {
+  template <typename Func>
+  using stage = _fused::transform_stage<Func>;
+
   template <typename StreamSender, typename Func>
   auto operator()(StreamSender&& stream, Func&& func) const {
-    return next_adapt_stream(
-        (StreamSender &&) stream,
-        [func = (Func &&) func](auto&& sender) mutable {
-          return then((decltype(sender))sender, std::ref(func));
-        });
+    if constexpr (tag_invocable<_fn, StreamSender, Func>) {
+      return unifex::tag_invoke(
+          _fn{}, (StreamSender &&) stream, (Func &&) func);
+    } else {
+      return _fused::make_stream(
+          (StreamSender &&) stream, stage<std::decay_t<Func>>{(Func &&) func});
+    }
   }
   template <typename Func>
   constexpr auto operator()(Func&& func) const
@@ -0,0 +1,542 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/bind_back.hpp>
+#include <unifex/config.hpp>
+#include <unifex/detail/locked_stream.hpp>
+#include <unifex/exception.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/on.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/stream_concepts.hpp>
+#include <unifex/type_traits.hpp>
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace _tfx_async {
+
+// transform_stream_async(stream, scheduler, concurrency, func)
+// transform_stream_async_unordered(stream, scheduler, concurrency, func)
+//
+// For each value of 'stream', calls 'func' with it to get a sender and runs
+// that sender on 'scheduler'. Up to 'concurrency' of these per-element
+// senders are in flight, or completed but not yet consumed, at once; the
+// underlying stream is only pulled while there is room for another one.
+//
+// transform_stream_async emits the results in the order of the source
+// values, holding back results that complete early. The _unordered variant
+// emits them in the order they complete.
+//
+// If a per-element sender fails or completes with done, no further values
+// are pulled and that outcome ends the stream once it is emitted. cleanup()
+// requests stop on the in-flight work, waits for it to complete and then
+// cleans up the underlying stream.
+
+using _locked_stream::cleanup_base;
+using _locked_stream::consumer_base;
+using _locked_stream::outcome;
+using _locked_stream::single_consumer;
+
+template <typename Scheduler, typename Func>
+struct _element_sender_for {
+  template <typename... Values>
+  using apply = decltype(on(
+      std::declval<Scheduler&>(),
+      std::invoke(std::declval<Func&>(), std::declval<Values>()...)));
+};
+
+template <typename Stream, typename Scheduler, typename Func>
+using element_sender_t = typename sender_value_types_t<
+    next_sender_t<Stream>,
+    single_overload,
+    _element_sender_for<Scheduler, Func>::template apply>::type;
+
+template <typename Stream, typename Scheduler, typename Func, bool Ordered>
+struct _state {
+  class type;
+};
+template <typename Stream, typename Scheduler, typename Func, bool Ordered>
+using state = typename _state<Stream, Scheduler, Func, Ordered>::type;
+
+template <typename State>
+struct _source_receiver {
+  struct type;
+};
+template <typename State>
+using source_receiver = typename _source_receiver<State>::type;
+
+template <typename State>
+struct _source_receiver<State>::type {
+  State& state_;
+
+  template <typename... Values>
+  void set_value(Values&&... values) && noexcept {
+    state_.on_source_value((Values &&) values...);
+  }
+
+  void set_done() && noexcept { state_.on_source_finished(nullptr); }
+
+  void set_error(std::exception_ptr ex) && noexcept {
+    state_.on_source_finished(std::move(ex));
+  }
+
+  template <typename Error>
+  void set_error(Error&& error) && noexcept {
+    state_.on_source_finished(make_exception_ptr((Error &&) error));
+  }
+
+  friend inplace_stop_token
+  tag_invoke(tag_t<get_stop_token>, const type& r) noexcept {
+    return r.state_.get_stop_token();
+  }
+};
+
+template <typename State>
+struct _element_receiver {
+  struct type;
+};
+template <typename State>
+using element_receiver = typename _element_receiver<State>::type;
+
+template <typename State>
+struct _element_receiver<State>::type {
+  State& state_;
+  std::size_t index_;
+
+  template <typename... Values>
+  void set_value(Values&&... values) && noexcept {
+    state_.on_element_value(index_, (Values &&) values...);
+  }
+
+  void set_done() && noexcept { state_.on_element_finished(index_, nullptr); }
+
+  void set_error(std::exception_ptr ex) && noexcept {
+    state_.on_element_finished(index_, std::move(ex));
+  }
+
+  template <typename Error>
+  void set_error(Error&& error) && noexcept {
+    state_.on_element_finished(index_, make_exception_ptr((Error &&) error));
+  }
+
+  friend inplace_stop_token
+  tag_invoke(tag_t<get_stop_token>, const type& r) noexcept {
+    return r.state_.get_stop_token();
+  }
+};
+
+template <typename Stream, typename Scheduler, typename Func, bool Ordered>
+class _state<Stream, Scheduler, Func, Ordered>::type
+  : public single_consumer {
+  using element_sender = element_sender_t<Stream, Scheduler, Func>;
+
+public:
+  using values_type = typename sender_value_types_t<
+      element_sender,
+      single_overload,
+      decayed_tuple<std::tuple>::template apply>::type;
+
+  template <typename Stream2, typename Scheduler2, typename Func2>
+  explicit type(
+      Stream2&& stream,
+      Scheduler2&& scheduler,
+      std::size_t concurrency,
+      Func2&& func)
+    : stream_((Stream2 &&) stream)
+    , scheduler_((Scheduler2 &&) scheduler)
+    , func_((Func2 &&) func)
+    , concurrency_(concurrency)
+    , slots_(new slot[concurrency])
+    , order_(new std::size_t[concurrency])
+    , freeSlots_(new std::size_t[concurrency])
+    , freeCount_(concurrency) {
+    UNIFEX_ASSERT(concurrency > 0);
+    for (std::size_t i = 0; i < concurrency; ++i) {
+      freeSlots_[i] = concurrency - 1 - i;
+    }
+  }
+
+  ~type() { UNIFEX_ASSERT(pending_ == 0); }
+
+  // Consumer side. Called with the lock held; moves a completed result, if
+  // any, into 'value' or 'error'.
+  outcome take_locked(
+      std::optional<values_type>& value, std::exception_ptr& error) noexcept {
+    if (finished_) {
+      return outcome::done;
+    }
+    if (orderCount_ != 0) {
+      const std::size_t index = order_[orderHead_];
+      slot& s = slots_[index];
+      if (s.completed_) {
+        orderHead_ = (orderHead_ + 1) % concurrency_;
+        --orderCount_;
+        s.completed_ = false;
+        freeSlots_[freeCount_++] = index;
+        if (s.value_.has_value()) {
+          value.emplace(std::move(*s.value_));
+          s.value_.reset();
+          return outcome::value;
+        }
+        finished_ = true;
+        if (s.error_) {
+          error = std::exchange(s.error_, nullptr);
+          return outcome::error;
+        }
+        return outcome::done;
+      }
+    }
+    if (sourceFinished_ && freeCount_ == concurrency_) {
+      finished_ = true;
+      if (sourceError_) {
+        error = std::exchange(sourceError_, nullptr);
+        return outcome::error;
+      }
+      return outcome::done;
+    }
+    return outcome::pending;
+  }
+
+  // Start pulling the next source value if there is room for it.
+  void pull() noexcept {
+    {
+      std::lock_guard lock{mutex_};
+      if (sourceRunning_ || sourceFinished_ || failed_ || stopping_ ||
+          freeCount_ == 0) {
+        return;
+      }
+      sourceRunning_ = true;
+      ++pending_;
+    }
+    UNIFEX_TRY {
+      sourceOp_.construct_with([&] {
+        return unifex::connect(next(stream_), source_receiver<type>{*this});
+      });
+    }
+    UNIFEX_CATCH(...) {
+      finish_source(std::current_exception());
+      return;
+    }
+    unifex::start(sourceOp_.get());
+  }
+
+  std::mutex& mutex() noexcept { return mutex_; }
+
+  // Cleanup side.
+
+  // Returns true if the underlying stream can be cleaned up right away;
+  // otherwise 'cleanup' is started once the in-flight work has completed.
+  bool stop(cleanup_base* cleanup) noexcept {
+    {
+      std::lock_guard lock{mutex_};
+      stopping_ = true;
+    }
+    stopSource_.request_stop();
+
+    std::lock_guard lock{mutex_};
+    if (pending_ == 0) {
+      return true;
+    }
+    cleanup_ = cleanup;
+    return false;
+  }
+
+  // Drops the results nobody will consume now and returns the sender that
+  // cleans up the underlying stream.
+  cleanup_sender_t<Stream> cleanup_source() {
+    for (std::size_t i = 0; i < concurrency_; ++i) {
+      slots_[i].value_.reset();
+      slots_[i].error_ = nullptr;
+    }
+    return cleanup(stream_);
+  }
+
+  inplace_stop_token get_stop_token() noexcept {
+    return stopSource_.get_token();
+  }
+
+private:
+  friend source_receiver<type>;
+  friend element_receiver<type>;
+
+  using element_op = connect_result_t<element_sender, element_receiver<type>>;
+
+  struct slot {
+    manual_lifetime<element_op> op_;
+    std::optional<values_type> value_;
+    std::exception_ptr error_;
+    bool completed_ = false;
+  };
+
+  void push_order_locked(std::size_t index) noexcept {
+    order_[(orderHead_ + orderCount_) % concurrency_] = index;
+    ++orderCount_;
+  }
+
+  // Takes the parked consumer if it can make progress. Called with the lock
+  // held.
+  consumer_base* ready_consumer_locked() noexcept {
+    if (consumer_ == nullptr) {
+      return nullptr;
+    }
+    const bool ready =
+        (orderCount_ != 0 && slots_[order_[orderHead_]].completed_) ||
+        (sourceFinished_ && freeCount_ == concurrency_);
+    return ready ? std::exchange(consumer_, nullptr) : nullptr;
+  }
+
+  template <typename... Values>
+  void on_source_value(Values&&... values) noexcept {
+    std::size_t index;
+    {
+      std::lock_guard lock{mutex_};
+      UNIFEX_ASSERT(freeCount_ != 0);
+      index = freeSlots_[--freeCount_];
+      ++pending_;
+      if constexpr (Ordered) {
+        push_order_locked(index);
+      }
+    }
+
+    slot& s = slots_[index];
+    bool constructed = false;
+    UNIFEX_TRY {
+      s.op_.construct_with([&] {
+        return unifex::connect(
+            on(scheduler_, std::invoke(func_, (Values &&) values...)),
+            element_receiver<type>{*this, index});
+      });
+      constructed = true;
+    }
+    UNIFEX_CATCH(...) { s.error_ = std::current_exception(); }
+
+    sourceOp_.destruct();
+    {
+      std::lock_guard lock{mutex_};
+      sourceRunning_ = false;
+    }
+
+    if (constructed) {
+      unifex::start(s.op_.get());
+    } else {
+      complete_element(index);
+    }
+    pull();
+    release();
+  }
+
+  void on_source_finished(std::exception_ptr ex) noexcept {
+    sourceOp_.destruct();
+    finish_source(std::move(ex));
+  }
+
+  void finish_source(std::exception_ptr ex) noexcept {
+    consumer_base* consumer;
+    {
+      std::lock_guard lock{mutex_};
+      sourceRunning_ = false;
+      sourceFinished_ = true;
+      sourceError_ = std::move(ex);
+      consumer = ready_consumer_locked();
+    }
+    if (consumer != nullptr) {
+      consumer->resume_(consumer);
+    }
+    release();
+  }
+
+  template <typename... Values>
+  void on_element_value(std::size_t index, Values&&... values) noexcept {
+    slot& s = slots_[index];
+    UNIFEX_TRY { s.value_.emplace((Values &&) values...); }
+    UNIFEX_CATCH(...) { s.error_ = std::current_exception(); }
+    s.op_.destruct();
+    complete_element(index);
+  }
+
+  void on_element_finished(std::size_t index, std::exception_ptr ex) noexcept {
+    slot& s = slots_[index];
+    s.error_ = std::move(ex);
+    s.op_.destruct();
+    complete_element(index);
+  }
+
+  void complete_element(std::size_t index) noexcept {
+    consumer_base* consumer;
+    {
+      std::lock_guard lock{mutex_};
+      slot& s = slots_[index];
+      s.completed_ = true;
+      if (!s.value_.has_value()) {
+        failed_ = true;
+      }
+      if constexpr (!Ordered) {
+        push_order_locked(index);
+      }
+      consumer = ready_consumer_locked();
+    }
+    if (consumer != nullptr) {
+      consumer->resume_(consumer);
+    }
+    pull();
+    release();
+  }
+
+  // Called once a callback from the source or an element is done with the
+  // state, so that a waiting cleanup can go ahead.
+  void release() noexcept {
+    cleanup_base* cleanup = nullptr;
+    {
+      std::lock_guard lock{mutex_};
+      if (--pending_ == 0) {
+        cleanup = std::exchange(cleanup_, nullptr);
+      }
+    }
+    if (cleanup != nullptr) {
+      cleanup->start_(cleanup);
+    }
+  }
+
+  Stream stream_;
+  Scheduler scheduler_;
+  Func func_;
+  const std::size_t concurrency_;
+  std::unique_ptr<slot[]> slots_;
+
+  // Slots holding a result that has not been consumed yet, in the order
+  // they are consumed: start order if Ordered, completion order otherwise.
+  std::unique_ptr<std::size_t[]> order_;
+  std::size_t orderHead_ = 0;
+  std::size_t orderCount_ = 0;
+
+  std::unique_ptr<std::size_t[]> freeSlots_;
+  std::size_t freeCount_;
+
+  std::mutex mutex_;
+  // Source and element callbacks still referring to the state.
+  std::size_t pending_ = 0;
+  bool sourceRunning_ = false;
+  bool sourceFinished_ = false;
+  std::exception_ptr sourceError_;
+  bool failed_ = false;
+  bool finished_ = false;
+  bool stopping_ = false;
+  cleanup_base* cleanup_ = nullptr;
+  inplace_stop_source stopSource_;
+  manual_lifetime<next_operation_t<Stream, source_receiver<type>>> sourceOp_;
+};
+
+template <typename Stream, typename Scheduler, typename Func, bool Ordered>
+struct _stream {
+  class type;
+};
+template <typename Stream, typename Scheduler, typename Func, bool Ordered>
+using stream = typename _stream<
+    remove_cvref_t<Stream>,
+    remove_cvref_t<Scheduler>,
+    remove_cvref_t<Func>,
+    Ordered>::type;
+
+template <typename Stream, typename Scheduler, typename Func, bool Ordered>
+class _stream<Stream, Scheduler, Func, Ordered>::type {
+  using state_type = state<Stream, Scheduler, Func, Ordered>;
+
+public:
+  template <typename Stream2, typename Scheduler2, typename Func2>
+  explicit type(
+      Stream2&& stream,
+      Scheduler2&& scheduler,
+      std::size_t concurrency,
+      Func2&& func)
+    : state_(std::make_unique<state_type>(
+          (Stream2 &&) stream,
+          (Scheduler2 &&) scheduler,
+          concurrency,
+          (Func2 &&) func)) {}
+
+  friend _locked_stream::next_sender<state_type>
+  tag_invoke(tag_t<next>, type& s) noexcept {
+    return _locked_stream::next_sender<state_type>{*s.state_};
+  }
+
+  friend _locked_stream::cleanup_sender<state_type>
+  tag_invoke(tag_t<cleanup>, type& s) noexcept {
+    return _locked_stream::cleanup_sender<state_type>{*s.state_};
+  }
+
+private:
+  // In-flight work refers to the state, so keep it at a fixed address even
+  // if the stream is moved.
+  std::unique_ptr<state_type> state_;
+};
+}  // namespace _tfx_async
+
+namespace _tfx_async_cpo {
+template <bool Ordered>
+struct _fn {
+  template(typename Stream, typename Scheduler, typename Func)  //
+      (requires scheduler<Scheduler>)                           //
+      auto
+      operator()(
+          Stream&& stream,
+          Scheduler&& scheduler,
+          std::size_t concurrency,
+          Func&& func) const
+      -> _tfx_async::stream<Stream, Scheduler, Func, Ordered> {
+    return _tfx_async::stream<Stream, Scheduler, Func, Ordered>{
+        (Stream &&) stream,
+        (Scheduler &&) scheduler,
+        concurrency,
+        (Func &&) func};
+  }
+  template(typename Scheduler, typename Func)  //
+      (requires scheduler<Scheduler>)          //
+      constexpr auto
+      operator()(Scheduler&& scheduler, std::size_t concurrency, Func&& func)
+          const noexcept(std::is_nothrow_invocable_v<
+                         tag_t<bind_back>,
+                         _fn,
+                         Scheduler,
+                         std::size_t,
+                         Func>)
+              -> bind_back_result_t<_fn, Scheduler, std::size_t, Func> {
+    return bind_back(
+        *this, (Scheduler &&) scheduler, concurrency, (Func &&) func);
+  }
+};
+}  // namespace _tfx_async_cpo
+
+inline constexpr _tfx_async_cpo::_fn<true> transform_stream_async{};
+inline constexpr _tfx_async_cpo::_fn<false> transform_stream_async_unordered{};
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
@@ -29,21 +29,52 @@
 #include <unifex/stream_concepts.hpp>
 
 #include <atomic>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 #include <unifex/detail/prologue.hpp>
 
 namespace unifex {
 namespace _type_erase {
 
-template <typename... Values>
+// Storage for a type-erased stream that fits within InlineSize bytes; with
+// an InlineSize of zero every stream is heap-allocated.
+template <std::size_t InlineSize, std::size_t InlineAlignment>
+struct _inline_storage final {
+  void* get() noexcept { return &storage_; }
+
+  alignas(InlineAlignment) std::byte storage_[InlineSize];
+};
+
+template <std::size_t InlineAlignment>
+struct _inline_storage<0, InlineAlignment> final {
+  void* get() noexcept { return nullptr; }
+};
+
+template <
+    std::size_t InlineSize,
+    std::size_t InlineAlignment,
+    typename... Values>
 struct _stream final {
   struct type;
 };
+template <
+    std::size_t InlineSize,
+    std::size_t InlineAlignment,
+    typename... Values>
+using basic_stream =
+    typename _stream<InlineSize, InlineAlignment, Values...>::type;
 template <typename... Values>
-using stream = typename _stream<Values...>::type;
+using stream = basic_stream<0, alignof(void*), Values...>;
 
-template <typename... Values>
-struct _stream<Values...>::type final {
+template <
+    std::size_t InlineSize,
+    std::size_t InlineAlignment,
+    typename... Values>
+struct _stream<InlineSize, InlineAlignment, Values...>::type final {
   struct next_receiver_base {
     virtual void set_value(Values&&... values) noexcept = 0;
     virtual void set_done() noexcept = 0;
@@ -99,6 +130,9 @@ struct _stream<Values...>::type final {
 
   struct stream_base {
     virtual ~stream_base() {}
+    // Move-constructs the stream into 'storage'; only used for streams that
+    // are stored inline.
+    virtual stream_base* move_to(void* storage) noexcept = 0;
     virtual void start_next(
         next_receiver_base& receiver,
         inplace_stop_token stopToken) noexcept = 0;
@@ -297,8 +331,21 @@ struct _stream<Values...>::type final {
       template <typename Stream2>
       explicit type(Stream2&& strm) : stream_((Stream2&&)strm) {}
 
+      // Only valid while no next() or cleanup() is in flight.
+      type(type&& other) noexcept(std::is_nothrow_move_constructible_v<Stream>)
+        : stream_(std::move(other.stream_)) {}
+
       ~type() {}
 
+      stream_base* move_to(void* storage) noexcept override {
+        if constexpr (std::is_nothrow_move_constructible_v<Stream>) {
+          return ::new (storage) type(std::move(*this));
+        } else {
+          // Streams that can throw on move are always heap-allocated.
+          std::terminate();
+        }
+      }
+
       union {
         manual_lifetime<next_operation_t<Stream, next_receiver_wrapper>> next_;
         manual_lifetime<cleanup_operation_t<Stream, cleanup_receiver_wrapper>>
@@ -444,12 +491,36 @@ struct _stream<Values...>::type final {
     }
   };
 
-  std::unique_ptr<stream_base> stream_;
+  template <typename Stream>
+  static constexpr bool can_be_stored_inline_v =
+      sizeof(Stream) <= InlineSize && alignof(Stream) <= InlineAlignment &&
+      std::is_nothrow_move_constructible_v<Stream>;
+
+  UNIFEX_NO_UNIQUE_ADDRESS _inline_storage<InlineSize, InlineAlignment>
+      storage_;
+  stream_base* stream_;
 
   template <typename ConcreteStream>
-  explicit type(ConcreteStream&& strm)
-    : stream_(std::make_unique<type::stream<ConcreteStream>>(
-          (ConcreteStream&&)strm)) {}
+  explicit type(ConcreteStream&& strm) {
+    using concrete_stream = type::stream<ConcreteStream>;
+    if constexpr (can_be_stored_inline_v<concrete_stream>) {
+      stream_ = ::new (storage_.get()) concrete_stream((ConcreteStream&&)strm);
+    } else {
+      stream_ = new concrete_stream((ConcreteStream&&)strm);
+    }
+  }
+
+  type(type&& other) noexcept : stream_(other.release_to(storage_.get())) {}
+
+  type& operator=(type&& other) noexcept {
+    if (this != &other) {
+      destroy();
+      stream_ = other.release_to(storage_.get());
+    }
+    return *this;
+  }
+
+  ~type() { destroy(); }
 
   friend next_sender tag_invoke(tag_t<next>, type& s) noexcept {
     return next_sender{*s.stream_};
@@ -458,15 +529,50 @@ struct _stream<Values...>::type final {
   friend cleanup_sender tag_invoke(tag_t<cleanup>, type& s) noexcept {
     return cleanup_sender{*s.stream_};
   }
+
+private:
+  // With no inline storage, storage_.get() is null too, so check for an
+  // empty (moved-from) stream first.
+  bool is_inline() noexcept {
+    return stream_ != nullptr && static_cast<void*>(stream_) == storage_.get();
+  }
+
+  // Hands the stream over to another instance whose inline storage is
+  // 'storage', leaving this one empty.
+  stream_base* release_to(void* storage) noexcept {
+    if (!is_inline()) {
+      return std::exchange(stream_, nullptr);
+    }
+    stream_base* moved = stream_->move_to(storage);
+    destroy();
+    return moved;
+  }
+
+  void destroy() noexcept {
+    if (stream_ == nullptr) {
+      return;
+    }
+    if (is_inline()) {
+      stream_->~stream_base();
+    } else {
+      delete stream_;
+    }
+    stream_ = nullptr;
+  }
 };
 }  // namespace _type_erase
 
 namespace _type_erase_cpo {
-template <typename... Ts>
+template <
+    std::size_t InlineSize,
+    std::size_t InlineAlignment,
+    typename... Ts>
 struct _fn final {
   template <typename Stream>
-  _type_erase::stream<Ts...> operator()(Stream&& strm) const {
-    return _type_erase::stream<Ts...>{(Stream&&)strm};
+  _type_erase::basic_stream<InlineSize, InlineAlignment, Ts...>
+  operator()(Stream&& strm) const {
+    return _type_erase::basic_stream<InlineSize, InlineAlignment, Ts...>{
+        (Stream&&)strm};
   }
   constexpr auto operator()() const
       noexcept(std::is_nothrow_invocable_v<tag_t<bind_back>, _fn>)
@@ -477,11 +583,27 @@ struct _fn final {
 }  // namespace _type_erase_cpo
 
 template <typename... Ts>
-inline constexpr _type_erase_cpo::_fn<Ts...> type_erase{};
+inline constexpr _type_erase_cpo::_fn<0, alignof(void*), Ts...> type_erase{};
+
+// Like type_erase, but streams of up to InlineSize bytes (once wrapped) are
+// stored within the type-erased stream instead of on the heap.
+template <
+    std::size_t InlineSize,
+    std::size_t InlineAlignment,
+    typename... Ts>
+inline constexpr _type_erase_cpo::_fn<InlineSize, InlineAlignment, Ts...>
+    basic_type_erase{};
 
 template <typename... Ts>
 using type_erased_stream = typename _type_erase::stream<Ts...>;
 
+template <
+    std::size_t InlineSize,
+    std::size_t InlineAlignment,
+    typename... Ts>
+using basic_type_erased_stream =
+    _type_erase::basic_stream<InlineSize, InlineAlignment, Ts...>;
+
 }  // namespace unifex
 
 #include <unifex/detail/epilogue.hpp>
@@ -20,6 +20,7 @@
 #if !UNIFEX_NO_COROUTINES
 
 #  include <unifex/coroutine.hpp>
+#  include <unifex/detail/coroutine_frame_allocator.hpp>
 #  include <unifex/std_concepts.hpp>
 
 #  include <exception>
@@ -52,7 +53,9 @@ struct _func_awaiter final : _func_awaiter_base {
 };
 
 struct _done_coro {
-  struct promise_type {
+  // Every task promise creates one of these, so its frame is recycled
+  // through the same thread-local pool as the task's.
+  struct promise_type : _coro_frame::frame_allocator_promise {
     _done_coro get_return_object() noexcept {
       return _done_coro{
           coro::coroutine_handle<promise_type>::from_promise(*this)};
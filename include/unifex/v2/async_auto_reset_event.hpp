@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/cancellable.hpp>
+#include <unifex/defer.hpp>
+#include <unifex/just_done.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/tag_invoke.hpp>
+#include <unifex/detail/completion_forwarder.hpp>
+
+#include <unifex/detail/prologue.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+
+namespace unifex::v2 {
+
+// Lock-free async auto-reset event, consumed as a *Stream*.
+//
+// The whole event is one atomic word: unset, set, done, or the
+// address of the single outstanding next() operation.  set()
+// either hands the signal to that waiter or leaves the event
+// set; next() either consumes a pending signal or parks itself
+// in the word.  Because there is at most one waiter, no list is
+// needed and every transition is a single CAS or exchange.
+//
+// Scheduler-affine: completions reschedule onto the receiver's
+// scheduler.  Cancelling a next() puts the event in the done
+// state, like the mutex-based unifex::async_auto_reset_event.
+class async_auto_reset_event {
+  class next_raw_sender;
+
+public:
+  async_auto_reset_event() noexcept = default;
+
+  explicit async_auto_reset_event(bool startReady) noexcept
+    : state_(startReady ? set_state : unset_state) {}
+
+  // Puts the event in the set state if it's not in the done state,
+  // waking the waiting next() if there is one.
+  void set() noexcept;
+
+  // Puts the event in the done state, waking the waiting next() if
+  // there is one.
+  void set_done() noexcept;
+
+  class stream_view;
+
+  // Retrieves a *Stream*-shaped view of the event.  Only one next()
+  // may be outstanding at a time across all views of an event.
+  stream_view stream() noexcept;
+
+private:
+  struct waiter_base {
+    void (*resume_)(waiter_base*, bool done) noexcept;
+  };
+
+  static constexpr std::uintptr_t unset_state = 0;
+  static constexpr std::uintptr_t set_state = 1;
+  static constexpr std::uintptr_t done_state = 2;
+
+  static_assert(
+      alignof(waiter_base) > done_state,
+      "waiter addresses must not collide with the state values");
+
+  static void resume(std::uintptr_t waiter, bool done) noexcept {
+    auto* w = reinterpret_cast<waiter_base*>(waiter);
+    w->resume_(w, done);
+  }
+
+  std::atomic<std::uintptr_t> state_{unset_state};
+
+  class next_raw_sender {
+  public:
+    template <
+        template <typename...> class Variant,
+        template <typename...> class Tuple>
+    using value_types = Variant<Tuple<>>;
+
+    template <template <typename...> class Variant>
+    using error_types = Variant<std::exception_ptr>;
+
+    static constexpr bool sends_done = true;
+    static constexpr blocking_kind blocking = blocking_kind::maybe;
+    static constexpr bool is_always_scheduler_affine = true;
+
+    next_raw_sender(const next_raw_sender&) = delete;
+    next_raw_sender(next_raw_sender&&) = default;
+
+  private:
+    friend async_auto_reset_event;
+
+    explicit next_raw_sender(async_auto_reset_event& evt) noexcept
+      : evt_(evt) {}
+
+    template <typename Receiver>
+    struct _op {
+      class type : waiter_base {
+        friend next_raw_sender;
+
+      public:
+        explicit type(async_auto_reset_event& evt, Receiver&& r) noexcept
+          : evt_(evt)
+          , receiver_(std::forward<Receiver>(r)) {
+          this->resume_ = [](waiter_base* self, bool done) noexcept {
+            auto* op = static_cast<type*>(self);
+            if (try_complete(op)) {
+              op->done_ = done;
+              op->forwardingOp_.start(*op);
+            }
+          };
+        }
+
+        type(type&&) = delete;
+
+        Receiver& get_receiver() noexcept { return receiver_; }
+
+        void forward_set_value() noexcept {
+          if (done_) {
+            unifex::set_done(std::move(receiver_));
+            return;
+          }
+#if !UNIFEX_NO_EXCEPTIONS
+          try {
+            unifex::set_value(std::move(receiver_));
+          } catch (...) {
+            unifex::set_error(std::move(receiver_), std::current_exception());
+          }
+#else
+          unifex::set_value(std::move(receiver_));
+#endif
+        }
+
+        void start() noexcept;
+        void stop() noexcept;
+
+      private:
+        async_auto_reset_event& evt_;
+        Receiver receiver_;
+        completion_forwarder<type, Receiver> forwardingOp_;
+        bool done_{false};
+      };
+    };
+
+    template <typename Receiver>
+    using operation = typename _op<Receiver>::type;
+
+    template(typename Receiver)                                            //
+        (requires receiver_of<Receiver> AND scheduler_provider<Receiver>)  //
+        friend operation<Receiver> tag_invoke(
+            tag_t<connect>, next_raw_sender&& s, Receiver&& r) noexcept {
+      return operation<Receiver>{s.evt_, std::forward<Receiver>(r)};
+    }
+
+    async_auto_reset_event& evt_;
+  };
+};
+
+class async_auto_reset_event::stream_view {
+public:
+  explicit stream_view(async_auto_reset_event* evt) noexcept : evt_(evt) {
+    UNIFEX_ASSERT(evt_ != nullptr);
+  }
+
+  // Returns a *Sender* that completes with set_value when the event is
+  // set, or with set_done once it's done.
+  auto next() noexcept {
+    return cancellable<next_raw_sender, false>{next_raw_sender{*evt_}};
+  }
+
+  // Returns a *Sender* that puts the event in the done state and then
+  // completes with set_done.
+  auto cleanup() noexcept {
+    return unifex::defer([evt = evt_]() noexcept {
+      evt->set_done();
+      return unifex::just_done();
+    });
+  }
+
+private:
+  async_auto_reset_event* evt_;
+};
+
+inline async_auto_reset_event::stream_view
+async_auto_reset_event::stream() noexcept {
+  return stream_view{this};
+}
+
+template <typename Receiver>
+void async_auto_reset_event::next_raw_sender::_op<
+    Receiver>::type::start() noexcept {
+  auto& state = evt_.state_;
+  auto expected = state.load(std::memory_order_acquire);
+  while (true) {
+    if (expected == set_state) {
+      // Consume the pending signal.
+      if (state.compare_exchange_weak(
+              expected, unset_state, std::memory_order_acq_rel)) {
+        break;
+      }
+    } else if (expected == done_state) {
+      done_ = true;
+      break;
+    } else {
+      UNIFEX_ASSERT(
+          expected == unset_state &&
+          "only one next() may be outstanding at a time");
+      // Once parked, set()/set_done()/stop() may complete and destroy
+      // *this on another thread.
+      if (state.compare_exchange_weak(
+              expected,
+              reinterpret_cast<std::uintptr_t>(
+                  static_cast<waiter_base*>(this)),
+              std::memory_order_acq_rel)) {
+        return;
+      }
+    }
+  }
+
+  if (try_complete(this)) {
+    forwardingOp_.start(*this);
+  }
+}
+
+template <typename Receiver>
+void async_auto_reset_event::next_raw_sender::_op<
+    Receiver>::type::stop() noexcept {
+  // Cancelling next() cancels the whole stream.  If this operation is
+  // still parked, the exchange unparks it and it completes with done on
+  // this thread; otherwise set() has already taken it.
+  auto self = reinterpret_cast<std::uintptr_t>(static_cast<waiter_base*>(this));
+  if (evt_.state_.exchange(done_state, std::memory_order_acq_rel) == self) {
+    if (try_complete(this)) {
+      unifex::set_done(std::move(receiver_));
+    }
+  }
+}
+
+}  // namespace unifex::v2
+
+#include <unifex/detail/epilogue.hpp>
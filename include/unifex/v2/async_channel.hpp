@@ -0,0 +1,615 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/cancellable.hpp>
+#include <unifex/defer.hpp>
+#include <unifex/just_done.hpp>
+#include <unifex/manual_lifetime.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/tag_invoke.hpp>
+#include <unifex/detail/atomic_intrusive_list.hpp>
+#include <unifex/detail/completion_forwarder.hpp>
+#include <unifex/detail/counted_dispatcher.hpp>
+#include <unifex/detail/ready_waiters.hpp>
+
+#include <unifex/detail/prologue.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+namespace unifex::v2 {
+
+// Lock-free bounded multi-producer multi-consumer channel.
+//
+// Buffered values live in a fixed ring of cells, each tagged with a
+// sequence number (Vyukov's bounded MPMC queue), so a send or receive
+// that finds room or a value claims its cell with a single CAS.  A
+// cell's sequence is 2 * pos while it's free for the value at ring
+// position pos and 2 * pos + 1 once that value is in it, which keeps
+// the two states apart for any capacity, including 1.  Only
+// operations that have to wait touch the two FIFO waiter lists.
+//
+// Waiters are served by a dispatcher that moves values between the
+// ring and the heads of the lists; requests for it go through a
+// counted_dispatcher, as in async_semaphore.
+// The fast paths only request a dispatch when they see a waiter on
+// the other side; a fence on each side ensures that either the fast
+// path sees the waiter or the waiter's own dispatch sees the value.
+//
+// close() makes pending and future sends complete with done.
+// Receives keep draining buffered values and complete with done once
+// the channel is closed and empty.  The closed flag lives in the top
+// bit of enqueuePos_, so a send either claims its cell before close()
+// or fails; receives only see the channel as empty once every cell
+// claimed before close() has been taken.
+//
+// Scheduler-affine: completions reschedule onto the receiver's
+// scheduler, or run inline when the dispatching thread is already one
+// of its threads.  Cancellation: via try_remove on the waiter lists; a
+// cancelled send never enqueues its value.
+template <typename T>
+class async_channel {
+  static_assert(
+      std::is_nothrow_move_constructible_v<T>,
+      "async_channel values are moved under the waiter list's lock");
+
+  class send_raw_sender;
+  class receive_raw_sender;
+
+public:
+  explicit async_channel(std::size_t capacity);
+  ~async_channel();
+
+  async_channel(const async_channel&) = delete;
+  async_channel& operator=(const async_channel&) = delete;
+
+  // Buffers value if there's room and no sender is queued ahead.
+  // value is only moved from on success.
+  [[nodiscard]] bool try_send(T&& value) noexcept;
+
+  // Takes the oldest buffered value if no receiver is queued ahead.
+  [[nodiscard]] std::optional<T> try_receive() noexcept;
+
+  // Completes once value is buffered, or with done if the channel is
+  // closed first.
+  [[nodiscard]] auto async_send(T value) noexcept;
+
+  // Completes with the oldest buffered value, or with done once the
+  // channel is closed and empty.
+  [[nodiscard]] auto async_receive() noexcept;
+
+  // Stops accepting values and wakes every waiter that can't make
+  // progress anymore.
+  void close() noexcept;
+
+  [[nodiscard]] bool is_closed() const noexcept {
+    return (enqueuePos_.load(std::memory_order_acquire) & closed_bit) != 0;
+  }
+
+  [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+
+  class stream_view;
+
+  // Retrieves a *Stream*-shaped view of the receiving end.
+  stream_view stream() noexcept;
+
+private:
+  struct cell {
+    std::atomic<std::size_t> sequence_;
+    manual_lifetime<T> value_;
+  };
+
+  struct send_waiter : atomic_intrusive_list_node {
+    void (*resume_)(send_waiter*) noexcept;
+    T* item_;
+    bool done_{false};
+    send_waiter* nextReady_{nullptr};
+  };
+
+  struct receive_waiter : atomic_intrusive_list_node {
+    void (*resume_)(receive_waiter*) noexcept;
+    std::optional<T> item_;
+    bool done_{false};
+    receive_waiter* nextReady_{nullptr};
+  };
+
+  static constexpr std::size_t closed_bit = ~(~std::size_t{0} >> 1);
+
+  // Fails once the channel is closed.
+  bool try_push(T& value) noexcept;
+  bool try_pop(std::optional<T>& out) noexcept;
+
+  // True once the channel is closed and every value sent before that
+  // has been received.
+  bool is_closed_and_drained() const noexcept;
+
+  // Called by whoever just freed a cell or filled one.
+  void wake_senders() noexcept;
+  void wake_receivers() noexcept;
+
+  void dispatch() noexcept;
+
+  const std::size_t capacity_;
+  std::unique_ptr<cell[]> cells_;
+  alignas(64) std::atomic<std::size_t> enqueuePos_{0};
+  alignas(64) std::atomic<std::size_t> dequeuePos_{0};
+  alignas(64) counted_dispatcher dispatcher_;
+  atomic_intrusive_list<send_waiter> senders_;
+  atomic_intrusive_list<receive_waiter> receivers_;
+
+  class send_raw_sender {
+  public:
+    template <
+        template <typename...> class Variant,
+        template <typename...> class Tuple>
+    using value_types = Variant<Tuple<>>;
+
+    template <template <typename...> class Variant>
+    using error_types = Variant<std::exception_ptr>;
+
+    static constexpr bool sends_done = true;
+    static constexpr blocking_kind blocking = blocking_kind::maybe;
+    static constexpr bool is_always_scheduler_affine = true;
+
+    send_raw_sender(const send_raw_sender&) = delete;
+    send_raw_sender(send_raw_sender&&) = default;
+
+  private:
+    friend async_channel;
+
+    explicit send_raw_sender(async_channel& channel, T&& value) noexcept
+      : channel_(channel)
+      , value_(std::move(value)) {}
+
+    template <typename Receiver>
+    struct _op {
+      class type : send_waiter {
+        friend send_raw_sender;
+
+      public:
+        explicit type(async_channel& channel, T&& value, Receiver&& r) noexcept
+          : channel_(channel)
+          , value_(std::move(value))
+          , receiver_(std::forward<Receiver>(r)) {
+          this->item_ = &value_;
+          this->resume_ = [](send_waiter* self) noexcept {
+            auto* op = static_cast<type*>(self);
+            if (try_complete(op)) {
+              op->forwardingOp_.start(*op);
+            }
+          };
+        }
+
+        type(type&&) = delete;
+
+        Receiver& get_receiver() noexcept { return receiver_; }
+
+        void forward_set_value() noexcept {
+          if (this->done_) {
+            unifex::set_done(std::move(receiver_));
+            return;
+          }
+#if !UNIFEX_NO_EXCEPTIONS
+          try {
+            unifex::set_value(std::move(receiver_));
+          } catch (...) {
+            unifex::set_error(std::move(receiver_), std::current_exception());
+          }
+#else
+          unifex::set_value(std::move(receiver_));
+#endif
+        }
+
+        void start() noexcept;
+        void stop() noexcept;
+
+      private:
+        async_channel& channel_;
+        T value_;
+        Receiver receiver_;
+        completion_forwarder<type, Receiver> forwardingOp_;
+        bool started_{false};
+      };
+    };
+
+    template <typename Receiver>
+    using operation = typename _op<Receiver>::type;
+
+    template(typename Receiver)                                            //
+        (requires receiver_of<Receiver> AND scheduler_provider<Receiver>)  //
+        friend operation<Receiver> tag_invoke(
+            tag_t<connect>, send_raw_sender&& s, Receiver&& r) noexcept {
+      return operation<Receiver>{
+          s.channel_, std::move(s.value_), std::forward<Receiver>(r)};
+    }
+
+    async_channel& channel_;
+    T value_;
+  };
+
+  class receive_raw_sender {
+  public:
+    template <
+        template <typename...> class Variant,
+        template <typename...> class Tuple>
+    using value_types = Variant<Tuple<T>>;
+
+    template <template <typename...> class Variant>
+    using error_types = Variant<std::exception_ptr>;
+
+    static constexpr bool sends_done = true;
+    static constexpr blocking_kind blocking = blocking_kind::maybe;
+    static constexpr bool is_always_scheduler_affine = true;
+
+    receive_raw_sender(const receive_raw_sender&) = delete;
+    receive_raw_sender(receive_raw_sender&&) = default;
+
+  private:
+    friend async_channel;
+
+    explicit receive_raw_sender(async_channel& channel) noexcept
+      : channel_(channel) {}
+
+    template <typename Receiver>
+    struct _op {
+      class type : receive_waiter {
+        friend receive_raw_sender;
+
+      public:
+        explicit type(async_channel& channel, Receiver&& r) noexcept
+          : channel_(channel)
+          , receiver_(std::forward<Receiver>(r)) {
+          this->resume_ = [](receive_waiter* self) noexcept {
+            auto* op = static_cast<type*>(self);
+            if (try_complete(op)) {
+              op->forwardingOp_.start(*op);
+            }
+          };
+        }
+
+        type(type&&) = delete;
+
+        Receiver& get_receiver() noexcept { return receiver_; }
+
+        void forward_set_value() noexcept {
+          if (this->done_) {
+            unifex::set_done(std::move(receiver_));
+            return;
+          }
+#if !UNIFEX_NO_EXCEPTIONS
+          try {
+            unifex::set_value(std::move(receiver_), std::move(*this->item_));
+          } catch (...) {
+            unifex::set_error(std::move(receiver_), std::current_exception());
+          }
+#else
+          unifex::set_value(std::move(receiver_), std::move(*this->item_));
+#endif
+        }
+
+        void start() noexcept;
+        void stop() noexcept;
+
+      private:
+        async_channel& channel_;
+        Receiver receiver_;
+        completion_forwarder<type, Receiver> forwardingOp_;
+        bool started_{false};
+      };
+    };
+
+    template <typename Receiver>
+    using operation = typename _op<Receiver>::type;
+
+    template(typename Receiver)                                            //
+        (requires receiver_of<Receiver, T> AND scheduler_provider<Receiver>)  //
+        friend operation<Receiver> tag_invoke(
+            tag_t<connect>, receive_raw_sender&& s, Receiver&& r) noexcept {
+      return operation<Receiver>{s.channel_, std::forward<Receiver>(r)};
+    }
+
+    async_channel& channel_;
+  };
+};
+
+template <typename T>
+class async_channel<T>::stream_view {
+public:
+  explicit stream_view(async_channel* channel) noexcept : channel_(channel) {
+    UNIFEX_ASSERT(channel_ != nullptr);
+  }
+
+  // Returns a *Sender* that completes with the next value, or with
+  // set_done once the channel is closed and drained.
+  auto next() noexcept { return channel_->async_receive(); }
+
+  // Returns a *Sender* that closes the channel and then completes with
+  // set_done.
+  auto cleanup() noexcept {
+    return unifex::defer([channel = channel_]() noexcept {
+      channel->close();
+      return unifex::just_done();
+    });
+  }
+
+private:
+  async_channel* channel_;
+};
+
+template <typename T>
+async_channel<T>::async_channel(std::size_t capacity)
+  : capacity_(capacity)
+  , cells_(new cell[capacity]) {
+  UNIFEX_ASSERT(capacity > 0);
+  for (std::size_t i = 0; i < capacity; ++i) {
+    cells_[i].sequence_.store(2 * i, std::memory_order_relaxed);
+  }
+}
+
+template <typename T>
+async_channel<T>::~async_channel() {
+  UNIFEX_ASSERT(senders_.empty() && receivers_.empty());
+  std::optional<T> value;
+  while (try_pop(value)) {
+    value.reset();
+  }
+}
+
+template <typename T>
+inline typename async_channel<T>::stream_view
+async_channel<T>::stream() noexcept {
+  return stream_view{this};
+}
+
+template <typename T>
+inline auto async_channel<T>::async_send(T value) noexcept {
+  return cancellable<send_raw_sender, true>{
+      send_raw_sender{*this, std::move(value)}};
+}
+
+template <typename T>
+inline auto async_channel<T>::async_receive() noexcept {
+  return cancellable<receive_raw_sender, true>{receive_raw_sender{*this}};
+}
+
+template <typename T>
+bool async_channel<T>::try_push(T& value) noexcept {
+  auto pos = enqueuePos_.load(std::memory_order_relaxed);
+  while (true) {
+    if ((pos & closed_bit) != 0) {
+      return false;
+    }
+    cell& c = cells_[pos % capacity_];
+    auto seq = c.sequence_.load(std::memory_order_acquire);
+    auto diff =
+        static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(2 * pos);
+    if (diff == 0) {
+      if (enqueuePos_.compare_exchange_weak(
+              pos, pos + 1, std::memory_order_relaxed)) {
+        c.value_.construct(std::move(value));
+        c.sequence_.store(2 * pos + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      // The cell still holds the value from the previous lap.
+      return false;
+    } else {
+      pos = enqueuePos_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+template <typename T>
+bool async_channel<T>::try_pop(std::optional<T>& out) noexcept {
+  auto pos = dequeuePos_.load(std::memory_order_relaxed);
+  while (true) {
+    cell& c = cells_[pos % capacity_];
+    auto seq = c.sequence_.load(std::memory_order_acquire);
+    auto diff = static_cast<std::intptr_t>(seq) -
+        static_cast<std::intptr_t>(2 * pos + 1);
+    if (diff == 0) {
+      if (dequeuePos_.compare_exchange_weak(
+              pos, pos + 1, std::memory_order_relaxed)) {
+        out.emplace(std::move(c.value_).get());
+        c.value_.destruct();
+        c.sequence_.store(2 * (pos + capacity_), std::memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      // Nothing has been written to the cell on this lap yet.
+      return false;
+    } else {
+      pos = dequeuePos_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+template <typename T>
+bool async_channel<T>::is_closed_and_drained() const noexcept {
+  auto end = enqueuePos_.load(std::memory_order_acquire);
+  return (end & closed_bit) != 0 &&
+      dequeuePos_.load(std::memory_order_relaxed) == (end & ~closed_bit);
+}
+
+template <typename T>
+void async_channel<T>::wake_senders() noexcept {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!senders_.empty()) {
+    dispatch();
+  }
+}
+
+template <typename T>
+void async_channel<T>::wake_receivers() noexcept {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!receivers_.empty()) {
+    dispatch();
+  }
+}
+
+template <typename T>
+bool async_channel<T>::try_send(T&& value) noexcept {
+  // Don't overtake queued senders.
+  if (senders_.empty() && try_push(value)) {
+    wake_receivers();
+    return true;
+  }
+  return false;
+}
+
+template <typename T>
+std::optional<T> async_channel<T>::try_receive() noexcept {
+  std::optional<T> value;
+  // Don't overtake queued receivers.
+  if (receivers_.empty() && try_pop(value)) {
+    wake_senders();
+  }
+  return value;
+}
+
+template <typename T>
+void async_channel<T>::close() noexcept {
+  enqueuePos_.fetch_or(closed_bit, std::memory_order_acq_rel);
+  dispatch();
+}
+
+template <typename T>
+void async_channel<T>::dispatch() noexcept {
+  auto serveReceiver = [this](receive_waiter* w) noexcept {
+    if (try_pop(w->item_)) {
+      return true;
+    }
+    // A cell claimed before close() but not filled yet keeps us
+    // waiting; its sender dispatches again once it's filled.
+    w->done_ = is_closed_and_drained();
+    return w->done_;
+  };
+
+  auto serveSender = [this](send_waiter* w) noexcept {
+    if (is_closed()) {
+      w->done_ = true;
+      return true;
+    }
+    return try_push(*w->item_);
+  };
+
+  // A resumed waiter may destroy the channel, so resume only once
+  // we're done with it.
+  ready_waiters<receive_waiter> readyReceivers;
+  ready_waiters<send_waiter> readySenders;
+
+  dispatcher_.dispatch([&]() noexcept {
+    // Serving one side frees cells or fills them for the other, so
+    // go round until neither side makes progress.
+    bool progress;
+    do {
+      progress = false;
+      while (auto* w = receivers_.pop_front_if(serveReceiver)) {
+        readyReceivers.push_back(w);
+        progress = true;
+      }
+      while (auto* w = senders_.pop_front_if(serveSender)) {
+        readySenders.push_back(w);
+        progress = true;
+      }
+    } while (progress);
+  });
+  readyReceivers.resume_all();
+  readySenders.resume_all();
+}
+
+template <typename T>
+template <typename Receiver>
+void async_channel<T>::send_raw_sender::_op<Receiver>::type::start() noexcept {
+  started_ = true;
+
+  if (channel_.is_closed()) {
+    this->done_ = true;
+  } else if (!channel_.try_send(std::move(value_))) {
+    // Save ref: after push_back, the dispatcher on another thread may
+    // take our value and complete us, potentially destroying *this.
+    async_channel& channel = channel_;
+
+    channel.senders_.push_back(this);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    channel.dispatch();
+    return;
+  }
+
+  if (try_complete(this)) {
+    forwardingOp_.start(*this);
+  }
+}
+
+template <typename T>
+template <typename Receiver>
+void async_channel<T>::send_raw_sender::_op<Receiver>::type::stop() noexcept {
+  // Either never enqueued (StopsEarly) or still queued: the value was
+  // not sent.  Otherwise the dispatcher has taken it and resume_ will
+  // complete us.
+  if (!started_ || channel_.senders_.try_remove(this)) {
+    this->done_ = true;
+    if (try_complete(this)) {
+      forwardingOp_.start(*this);
+    }
+  }
+}
+
+template <typename T>
+template <typename Receiver>
+void async_channel<T>::receive_raw_sender::_op<
+    Receiver>::type::start() noexcept {
+  started_ = true;
+
+  if (channel_.receivers_.empty() && channel_.try_pop(this->item_)) {
+    channel_.wake_senders();
+    if (try_complete(this)) {
+      forwardingOp_.start(*this);
+    }
+    return;
+  }
+
+  // Also covers a closed, empty channel: the dispatch completes us
+  // with done.
+  async_channel& channel = channel_;
+
+  channel.receivers_.push_back(this);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  channel.dispatch();
+}
+
+template <typename T>
+template <typename Receiver>
+void async_channel<T>::receive_raw_sender::_op<
+    Receiver>::type::stop() noexcept {
+  if (!started_ || channel_.receivers_.try_remove(this)) {
+    this->done_ = true;
+    if (try_complete(this)) {
+      forwardingOp_.start(*this);
+    }
+  }
+}
+
+}  // namespace unifex::v2
+
+#include <unifex/detail/epilogue.hpp>
@@ -25,6 +25,7 @@
 #include <unifex/tag_invoke.hpp>
 #include <unifex/unstoppable_token.hpp>
 #include <unifex/detail/atomic_intrusive_list.hpp>
+#include <unifex/detail/completion_forwarder.hpp>
 
 #include <unifex/detail/prologue.hpp>
 
@@ -40,7 +41,8 @@ namespace unifex::v2 {
 // draining.
 //
 // Scheduler-affine: completions reschedule onto the receiver's
-// scheduler.  Cancellation: via try_remove on the waiter list.
+// scheduler, or run inline when set() is already called on one of
+// its threads.  Cancellation: via try_remove on the waiter list.
 class async_manual_reset_event {
   class wait_raw_sender;
 
@@ -165,6 +167,10 @@ private:
 
       private:
         void reschedule() noexcept {
+          if (complete_inline_if_on_scheduler(
+                  receiver_, [this]() noexcept { complete_value(); })) {
+            return;
+          }
           reschedule_op_.construct_with([this]() noexcept {
             return unifex::connect(
                 schedule(get_scheduler(receiver_)), reschedule_receiver{*this});
@@ -41,10 +41,25 @@ namespace unifex::v2 {
 // Unlike async_manual_reset_event, the mutex has no
 // concurrent-reset problem: only the lock holder (a single
 // thread) transitions locked_ from true to false.
+//
+// unlock() always hands the mutex straight to the oldest
+// waiter.  By default a lock attempt that finds the mutex
+// momentarily free may still take it ahead of queued waiters:
+// while process_queue() has released locked_ and not yet
+// re-checked the queue, or while a waiter has been pushed but
+// not yet tried locked_.  fairness::handoff closes that window
+// so that no lock attempt overtakes a queued waiter.
 class async_mutex {
   class lock_raw_sender;
 
 public:
+  enum class fairness : bool { barging, handoff };
+
+  async_mutex() noexcept = default;
+
+  explicit async_mutex(fairness f) noexcept
+    : handoff_(f == fairness::handoff) {}
+
   [[nodiscard]] bool try_lock() noexcept;
 
   [[nodiscard]] auto async_lock() noexcept;
@@ -60,6 +75,13 @@ private:
 
   atomic_intrusive_list<waiter_base> queue_;
   std::atomic<bool> locked_{false};
+  bool handoff_{false};
+
+#if defined(UNIFEX_UNIT_TEST)
+  // Lets tests hold the mutex in states that otherwise only last for a
+  // moment, such as a queued waiter while locked_ is false.
+  friend struct async_mutex_test_access;
+#endif
 
   class lock_raw_sender {
   public:
@@ -147,6 +169,11 @@ inline auto async_mutex::async_lock() noexcept {
 }
 
 inline bool async_mutex::try_lock() noexcept {
+  if (handoff_ && !queue_.empty()) {
+    // Whoever queued them, or process_queue(), will hand the
+    // mutex to the oldest.
+    return false;
+  }
   return !locked_.exchange(true, std::memory_order_acquire);
 }
 
@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/cancellable.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/tag_invoke.hpp>
+#include <unifex/detail/atomic_intrusive_list.hpp>
+#include <unifex/detail/completion_forwarder.hpp>
+#include <unifex/detail/counted_dispatcher.hpp>
+#include <unifex/detail/ready_waiters.hpp>
+
+#include <unifex/detail/prologue.hpp>
+
+#include <atomic>
+#include <cstddef>
+
+namespace unifex::v2 {
+
+// Lock-free async counting semaphore.  Cancellation via try_remove.
+//
+// count_ holds the available units; waiters queue FIFO in queue_.
+// Waiters are only granted units by the dispatcher, which pops the
+// head of the queue while count_ covers its request (the check and
+// the claim happen under the list's head lock, so a concurrent
+// try_remove can't free the waiter mid-check).  A large request at
+// the head blocks smaller ones behind it, so nobody starves.
+//
+// Every state change that can unblock the head (release, enqueue,
+// cancelling a waiter) requests a dispatch through a
+// counted_dispatcher, so no wakeup is lost without a second lock.
+class async_semaphore {
+  class acquire_raw_sender;
+
+public:
+  explicit async_semaphore(std::size_t initialCount = 0) noexcept
+    : count_(initialCount) {}
+
+  // Takes n units if they're available and nobody is queued ahead.
+  [[nodiscard]] bool try_acquire(std::size_t n = 1) noexcept;
+
+  // Completes once n units have been taken from the semaphore.
+  [[nodiscard]] auto async_acquire(std::size_t n = 1) noexcept;
+
+  // Returns n units to the semaphore, waking waiters they satisfy.
+  void release(std::size_t n = 1) noexcept;
+
+  [[nodiscard]] std::size_t available() const noexcept {
+    return count_.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct waiter_base : atomic_intrusive_list_node {
+    void (*resume_)(waiter_base*) noexcept;
+    waiter_base* nextReady_{nullptr};
+    std::size_t n_;
+  };
+
+  bool try_take(std::size_t n) noexcept;
+  void dispatch() noexcept;
+
+  atomic_intrusive_list<waiter_base> queue_;
+  std::atomic<std::size_t> count_;
+  counted_dispatcher dispatcher_;
+
+  class acquire_raw_sender {
+  public:
+    template <
+        template <typename...> class Variant,
+        template <typename...> class Tuple>
+    using value_types = Variant<Tuple<>>;
+
+    template <template <typename...> class Variant>
+    using error_types = Variant<>;
+
+    static constexpr bool sends_done = true;
+    static constexpr blocking_kind blocking = blocking_kind::maybe;
+    static constexpr bool is_always_scheduler_affine = true;
+
+    acquire_raw_sender(const acquire_raw_sender&) = delete;
+    acquire_raw_sender(acquire_raw_sender&&) = default;
+
+  private:
+    friend async_semaphore;
+
+    explicit acquire_raw_sender(async_semaphore& sem, std::size_t n) noexcept
+      : sem_(sem)
+      , n_(n) {}
+
+    template <typename Receiver>
+    struct _op {
+      class type : waiter_base {
+        friend acquire_raw_sender;
+
+      public:
+        explicit type(
+            async_semaphore& sem, std::size_t n, Receiver&& r) noexcept
+          : sem_(sem)
+          , receiver_(std::forward<Receiver>(r)) {
+          this->n_ = n;
+          this->resume_ = [](waiter_base* self) noexcept {
+            auto* op = static_cast<type*>(self);
+            if (try_complete(op)) {
+              op->forwardingOp_.start(*op);
+            } else {
+              // The dispatcher granted us units but stop already
+              // completed us.  Give them back.
+              op->sem_.release(op->n_);
+            }
+          };
+        }
+
+        type(type&&) = delete;
+
+        Receiver& get_receiver() noexcept { return receiver_; }
+
+        void forward_set_value() noexcept {
+          if (cancelled_) {
+            unifex::set_done(std::move(receiver_));
+          } else {
+            unifex::set_value(std::move(receiver_));
+          }
+        }
+
+        void start() noexcept;
+        void stop() noexcept;
+
+      private:
+        async_semaphore& sem_;
+        Receiver receiver_;
+        completion_forwarder<type, Receiver> forwardingOp_;
+        bool cancelled_{false};
+        bool started_{false};
+      };
+    };
+
+    template <typename Receiver>
+    using operation = typename _op<Receiver>::type;
+
+    template(typename Receiver)                                            //
+        (requires receiver_of<Receiver> AND scheduler_provider<Receiver>)  //
+        friend operation<Receiver> tag_invoke(
+            tag_t<connect>, acquire_raw_sender&& s, Receiver&& r) noexcept {
+      return operation<Receiver>{s.sem_, s.n_, std::forward<Receiver>(r)};
+    }
+
+    async_semaphore& sem_;
+    std::size_t n_;
+  };
+};
+
+inline auto async_semaphore::async_acquire(std::size_t n) noexcept {
+  return cancellable<acquire_raw_sender, true>{acquire_raw_sender{*this, n}};
+}
+
+inline bool async_semaphore::try_acquire(std::size_t n) noexcept {
+  // Don't overtake queued waiters.
+  return queue_.empty() && try_take(n);
+}
+
+inline bool async_semaphore::try_take(std::size_t n) noexcept {
+  auto count = count_.load(std::memory_order_relaxed);
+  while (count >= n) {
+    if (count_.compare_exchange_weak(
+            count, count - n, std::memory_order_acquire)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+inline void async_semaphore::release(std::size_t n) noexcept {
+  count_.fetch_add(n, std::memory_order_release);
+  dispatch();
+}
+
+template <typename Receiver>
+void async_semaphore::acquire_raw_sender::_op<Receiver>::type::start() noexcept {
+  started_ = true;
+
+  if (sem_.try_acquire(this->n_)) {
+    if (try_complete(this)) {
+      forwardingOp_.start(*this);
+    }
+    return;
+  }
+
+  // Save ref: after push_back, the dispatcher on another thread may
+  // grant and complete us, potentially destroying *this.
+  async_semaphore& sem = sem_;
+
+  sem.queue_.push_back(this);
+  sem.dispatch();
+}
+
+template <typename Receiver>
+void async_semaphore::acquire_raw_sender::_op<Receiver>::type::stop() noexcept {
+  if (!started_) {
+    // StopsEarly: never enqueued, holds no units.
+    cancelled_ = true;
+    if (try_complete(this)) {
+      forwardingOp_.start(*this);
+    }
+    return;
+  }
+  if (sem_.queue_.try_remove(this)) {
+    // We may have been the head, blocking smaller requests behind us.
+    sem_.dispatch();
+    cancelled_ = true;
+    if (try_complete(this)) {
+      forwardingOp_.start(*this);
+    }
+  }
+  // else: already granted by the dispatcher; resume_ handles it.
+}
+
+}  // namespace unifex::v2
+
+#include <unifex/detail/epilogue.hpp>
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/cancellable.hpp>
+#include <unifex/get_stop_token.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sender_concepts.hpp>
+#include <unifex/tag_invoke.hpp>
+#include <unifex/detail/atomic_intrusive_list.hpp>
+#include <unifex/detail/completion_forwarder.hpp>
+#include <unifex/detail/counted_dispatcher.hpp>
+#include <unifex/detail/ready_waiters.hpp>
+
+#include <unifex/detail/prologue.hpp>
+
+#include <atomic>
+#include <cstdint>
+
+namespace unifex::v2 {
+
+// Lock-free async reader/writer mutex with writer preference.
+// Cancellation via try_remove.
+//
+// state_ packs the owner bit, the number of readers holding the
+// lock and the number of queued writers into one word.  Readers
+// may only enter while there is neither an owner nor a queued
+// writer, so a steady stream of readers can't starve writers;
+// queued readers are admitted together once no writer is left.
+//
+// Queued waiters are granted the lock by the dispatcher, which
+// claims state_ for the head of writers_ (or readers_) while
+// holding that list's head lock.  Dispatch requests go through a
+// counted_dispatcher so no wakeup is lost.
+class async_shared_mutex {
+  template <bool Shared>
+  class lock_raw_sender;
+
+public:
+  [[nodiscard]] bool try_lock() noexcept;
+
+  [[nodiscard]] bool try_lock_shared() noexcept;
+
+  [[nodiscard]] auto async_lock() noexcept;
+
+  [[nodiscard]] auto async_lock_shared() noexcept;
+
+  void unlock() noexcept;
+
+  void unlock_shared() noexcept;
+
+private:
+  struct waiter_base : atomic_intrusive_list_node {
+    void (*resume_)(waiter_base*) noexcept;
+    waiter_base* nextReady_{nullptr};
+  };
+
+  static constexpr std::uint64_t owner_bit = 1;
+  static constexpr std::uint64_t reader_one = 2;
+  static constexpr std::uint64_t reader_mask = 0xffff'fffe;
+  static constexpr std::uint64_t writer_one = std::uint64_t{1} << 32;
+
+  bool try_claim_exclusive() noexcept;
+  void dispatch() noexcept;
+
+  atomic_intrusive_list<waiter_base> writers_;
+  atomic_intrusive_list<waiter_base> readers_;
+  std::atomic<std::uint64_t> state_{0};
+  counted_dispatcher dispatcher_;
+
+  template <bool Shared>
+  class lock_raw_sender {
+  public:
+    template <
+        template <typename...> class Variant,
+        template <typename...> class Tuple>
+    using value_types = Variant<Tuple<>>;
+
+    template <template <typename...> class Variant>
+    using error_types = Variant<>;
+
+    static constexpr bool sends_done = true;
+    static constexpr blocking_kind blocking = blocking_kind::maybe;
+    static constexpr bool is_always_scheduler_affine = true;
+
+    lock_raw_sender(const lock_raw_sender&) = delete;
+    lock_raw_sender(lock_raw_sender&&) = default;
+
+  private:
+    friend async_shared_mutex;
+
+    explicit lock_raw_sender(async_shared_mutex& mutex) noexcept
+      : mutex_(mutex) {}
+
+    template <typename Receiver>
+    struct _op {
+      class type : waiter_base {
+        friend lock_raw_sender;
+
+      public:
+        explicit type(async_shared_mutex& mutex, Receiver&& r) noexcept
+          : mutex_(mutex)
+          , receiver_(std::forward<Receiver>(r)) {
+          this->resume_ = [](waiter_base* self) noexcept {
+            auto* op = static_cast<type*>(self);
+            if (try_complete(op)) {
+              op->forwardingOp_.start(*op);
+            } else if constexpr (Shared) {
+              // The dispatcher let us in but stop already completed
+              // us.  Leave again to avoid deadlock.
+              op->mutex_.unlock_shared();
+            } else {
+              op->mutex_.unlock();
+            }
+          };
+        }
+
+        type(type&&) = delete;
+
+        Receiver& get_receiver() noexcept { return receiver_; }
+
+        void forward_set_value() noexcept {
+          if (cancelled_) {
+            unifex::set_done(std::move(receiver_));
+          } else {
+            unifex::set_value(std::move(receiver_));
+          }
+        }
+
+        void start() noexcept;
+        void stop() noexcept;
+
+      private:
+        async_shared_mutex& mutex_;
+        Receiver receiver_;
+        completion_forwarder<type, Receiver> forwardingOp_;
+        bool cancelled_{false};
+        bool started_{false};
+      };
+    };
+
+    template <typename Receiver>
+    using operation = typename _op<Receiver>::type;
+
+    template(typename Receiver)                                            //
+        (requires receiver_of<Receiver> AND scheduler_provider<Receiver>)  //
+        friend operation<Receiver> tag_invoke(
+            tag_t<connect>, lock_raw_sender&& s, Receiver&& r) noexcept {
+      return operation<Receiver>{s.mutex_, std::forward<Receiver>(r)};
+    }
+
+    async_shared_mutex& mutex_;
+  };
+};
+
+inline auto async_shared_mutex::async_lock() noexcept {
+  return cancellable<lock_raw_sender<false>, true>{
+      lock_raw_sender<false>{*this}};
+}
+
+inline auto async_shared_mutex::async_lock_shared() noexcept {
+  return cancellable<lock_raw_sender<true>, true>{lock_raw_sender<true>{*this}};
+}
+
+inline bool async_shared_mutex::try_lock() noexcept {
+  // Only from fully idle: no owner, no readers, no queued writers.
+  std::uint64_t expected = 0;
+  return state_.compare_exchange_strong(
+      expected, owner_bit, std::memory_order_acquire);
+}
+
+inline bool async_shared_mutex::try_lock_shared() noexcept {
+  auto state = state_.load(std::memory_order_relaxed);
+  while ((state & ~reader_mask) == 0) {
+    if (state_.compare_exchange_weak(
+            state, state + reader_one, std::memory_order_acquire)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <bool Shared>
+template <typename Receiver>
+void async_shared_mutex::lock_raw_sender<Shared>::_op<
+    Receiver>::type::start() noexcept {
+  started_ = true;
+
+  if (Shared ? mutex_.try_lock_shared() : mutex_.try_lock()) {
+    if (try_complete(this)) {
+      forwardingOp_.start(*this);
+    }
+    return;
+  }
+
+  // Save ref: after push_back, the dispatcher on another thread may
+  // grant and complete us, potentially destroying *this.
+  async_shared_mutex& mutex = mutex_;
+
+  if constexpr (Shared) {
+    mutex.readers_.push_back(this);
+  } else {
+    // Announce the writer before queueing it so that new readers
+    // stop entering right away.
+    mutex.state_.fetch_add(writer_one, std::memory_order_relaxed);
+    mutex.writers_.push_back(this);
+  }
+  mutex.dispatch();
+}
+
+template <bool Shared>
+template <typename Receiver>
+void async_shared_mutex::lock_raw_sender<Shared>::_op<
+    Receiver>::type::stop() noexcept {
+  if (!started_) {
+    // StopsEarly: never enqueued, doesn't hold the lock.
+    cancelled_ = true;
+    if (try_complete(this)) {
+      forwardingOp_.start(*this);
+    }
+    return;
+  }
+  auto& queue = Shared ? mutex_.readers_ : mutex_.writers_;
+  if (queue.try_remove(this)) {
+    if constexpr (!Shared) {
+      // Readers held back for us may now be admitted.
+      mutex_.state_.fetch_sub(writer_one, std::memory_order_relaxed);
+      mutex_.dispatch();
+    }
+    cancelled_ = true;
+    if (try_complete(this)) {
+      forwardingOp_.start(*this);
+    }
+  }
+  // else: already granted by the dispatcher; resume_ handles it.
+}
+
+}  // namespace unifex::v2
+
+#include <unifex/detail/epilogue.hpp>
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unifex/detail/cleanup_all.hpp>
+#include <unifex/just.hpp>
+#include <unifex/let_value.hpp>
+#include <unifex/stream_concepts.hpp>
+#include <unifex/type_traits.hpp>
+#include <unifex/when_all.hpp>
+
+#include <tuple>
+#include <utility>
+#include <variant>
+
+#include <unifex/detail/prologue.hpp>
+
+namespace unifex {
+namespace _zip_streams {
+
+// zip_streams(streams...)
+//
+// Each next() asks every stream for its next value concurrently and sends
+// all of them together, in the order of the streams. If one of them fails
+// or completes with done, the others are cancelled through when_all's stop
+// source and the zipped stream completes the same way. cleanup() cleans up
+// every stream in turn.
+
+template <typename... Streams>
+struct _stream {
+  class type;
+};
+template <typename... Streams>
+using stream = typename _stream<remove_cvref_t<Streams>...>::type;
+
+template <typename... Streams>
+class _stream<Streams...>::type {
+  static_assert(sizeof...(Streams) > 0);
+  static_assert(
+      ((std::variant_size_v<_when_all::value_variant_for_sender<
+            next_sender_t<Streams>>> == 1) &&
+       ...),
+      "zip_streams requires every stream to send a single set of values");
+
+public:
+  template <typename... Streams2>
+  explicit type(Streams2&&... streams) : streams_((Streams2 &&) streams...) {}
+
+  friend auto tag_invoke(tag_t<next>, type& s) {
+    return std::apply(
+        [](auto&... streams) {
+          return let_value(
+              when_all(next(streams)...), [](auto&... valueVariants) {
+                return std::apply(
+                    [](auto&&... values) { return just(std::move(values)...); },
+                    std::tuple_cat(std::get<0>(std::move(valueVariants))...));
+              });
+        },
+        s.streams_);
+  }
+
+  friend auto tag_invoke(tag_t<cleanup>, type& s) noexcept {
+    return cleanup_all(s.streams_);
+  }
+
+private:
+  std::tuple<Streams...> streams_;
+};
+}  // namespace _zip_streams
+
+namespace _zip_streams_cpo {
+inline const struct _fn {
+  template <typename... Streams>
+  auto operator()(Streams&&... streams) const
+      -> _zip_streams::stream<Streams...> {
+    return _zip_streams::stream<Streams...>{(Streams &&) streams...};
+  }
+} zip_streams{};
+}  // namespace _zip_streams_cpo
+using _zip_streams_cpo::zip_streams;
+}  // namespace unifex
+
+#include <unifex/detail/epilogue.hpp>
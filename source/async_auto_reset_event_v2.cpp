@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unifex/v2/async_auto_reset_event.hpp>
+
+namespace unifex::v2 {
+
+void async_auto_reset_event::set() noexcept {
+  auto expected = state_.load(std::memory_order_acquire);
+  while (true) {
+    if (expected == set_state || expected == done_state) {
+      return;
+    }
+    // Either latch the signal or take the parked waiter; in both
+    // cases the event ends up unset/set with no waiter recorded.
+    auto desired = expected == unset_state ? set_state : unset_state;
+    if (state_.compare_exchange_weak(
+            expected, desired, std::memory_order_acq_rel)) {
+      break;
+    }
+  }
+
+  if (expected != unset_state) {
+    // The waiter is no longer reachable from state_, so a concurrent
+    // stop() can't complete it; the event isn't touched again.
+    resume(expected, false);
+  }
+}
+
+void async_auto_reset_event::set_done() noexcept {
+  auto prev = state_.exchange(done_state, std::memory_order_acq_rel);
+  if (prev != unset_state && prev != set_state && prev != done_state) {
+    resume(prev, true);
+  }
+}
+
+}  // namespace unifex::v2
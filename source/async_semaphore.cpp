@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unifex/v2/async_semaphore.hpp>
+
+namespace unifex::v2 {
+
+void async_semaphore::dispatch() noexcept {
+  // A resumed waiter may destroy the semaphore, so resume only once
+  // we're done with it.
+  ready_waiters<waiter_base> ready;
+
+  dispatcher_.dispatch([&]() noexcept {
+    while (auto* w = queue_.pop_front_if(
+               [this](waiter_base* w) noexcept { return try_take(w->n_); })) {
+      ready.push_back(w);
+    }
+  });
+  ready.resume_all();
+}
+
+}  // namespace unifex::v2
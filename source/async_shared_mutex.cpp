@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unifex/v2/async_shared_mutex.hpp>
+
+namespace unifex::v2 {
+
+bool async_shared_mutex::try_claim_exclusive() noexcept {
+  // Called for the head of writers_, which is already counted in the
+  // queued-writer bits.
+  auto state = state_.load(std::memory_order_relaxed);
+  while ((state & (owner_bit | reader_mask)) == 0) {
+    if (state_.compare_exchange_weak(
+            state,
+            state - writer_one + owner_bit,
+            std::memory_order_acquire)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void async_shared_mutex::unlock() noexcept {
+  state_.fetch_sub(owner_bit, std::memory_order_release);
+  dispatch();
+}
+
+void async_shared_mutex::unlock_shared() noexcept {
+  auto prev = state_.fetch_sub(reader_one, std::memory_order_release);
+  if ((prev & reader_mask) == reader_one) {
+    // Last reader out; a queued writer may go in.
+    dispatch();
+  }
+}
+
+void async_shared_mutex::dispatch() noexcept {
+  // A resumed waiter may destroy the mutex, so resume only once we're
+  // done with it.
+  ready_waiters<waiter_base> ready;
+
+  dispatcher_.dispatch([&]() noexcept {
+    // Writers first.  Once one is in, or while any is queued, the
+    // reader claim fails.
+    if (auto* w = writers_.pop_front_if(
+            [this](waiter_base*) noexcept { return try_claim_exclusive(); })) {
+      ready.push_back(w);
+    }
+    while (auto* r = readers_.pop_front_if(
+               [this](waiter_base*) noexcept { return try_lock_shared(); })) {
+      ready.push_back(r);
+    }
+  });
+  ready.resume_all();
+}
+
+}  // namespace unifex::v2
@@ -180,6 +180,30 @@ node* atomic_intrusive_list_impl<Latch>::pop_front_impl() noexcept {
   return first;
 }
 
+template <bool Latch>
+node* atomic_intrusive_list_impl<Latch>::pop_front_if_impl(
+    bool (*pred)(node*, void*) noexcept, void* ctx) noexcept {
+  uintptr_t old_head = lock(head_);
+  node* first = to_node(old_head);
+
+  // Holding head_ keeps try_remove(first) out until we're done.
+  if (is_sentinel(first) || !pred(first, ctx)) {
+    unlock(head_, old_head);
+    return nullptr;
+  }
+
+  uintptr_t rest_val = lock(first->rest);
+  node* second = to_node(rest_val);
+  UNIFEX_ASSERT(second != nullptr);
+
+  second->self.store(&head_, std::memory_order_release);
+  first->self.store(nullptr, std::memory_order_relaxed);
+
+  unlock(head_, rest_val);
+  unlock(first->rest, 0);
+  return first;
+}
+
 template <bool Latch>
 bool atomic_intrusive_list_impl<Latch>::try_remove_impl(node* item) noexcept {
   UNIFEX_ASSERT(item != nullptr);
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/detail/coroutine_frame_allocator.hpp>
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace unifex::_coro_frame {
+namespace {
+constexpr std::size_t size_class_granularity = 64;
+constexpr std::size_t size_class_count = 16;
+// Bounds how much memory a thread holds on to per size class.
+constexpr std::size_t max_free_bytes = 64 * 1024;
+
+struct free_block {
+  free_block* next_;
+};
+
+struct frame_pool {
+  struct size_class {
+    free_block* head_ = nullptr;
+    std::size_t count_ = 0;
+  };
+
+  ~frame_pool() {
+    for (auto& sizeClass : classes_) {
+      while (sizeClass.head_ != nullptr) {
+        ::operator delete(
+            std::exchange(sizeClass.head_, sizeClass.head_->next_));
+      }
+    }
+    destroyed_ = true;
+  }
+
+  size_class classes_[size_class_count];
+  // Blocks freed during thread exit, after the pool has been destroyed, go
+  // straight back to the heap.
+  static thread_local bool destroyed_;
+};
+
+thread_local bool frame_pool::destroyed_ = false;
+thread_local frame_pool currentThreadPool;
+
+std::size_t size_class_index(std::size_t size) noexcept {
+  return (size - 1) / size_class_granularity;
+}
+}  // namespace
+
+void* pool_allocate(std::size_t size) {
+  std::size_t index = size_class_index(size);
+  if (index >= size_class_count || frame_pool::destroyed_) {
+    return ::operator new(size);
+  }
+  auto& sizeClass = currentThreadPool.classes_[index];
+  if (free_block* block = sizeClass.head_) {
+    sizeClass.head_ = block->next_;
+    --sizeClass.count_;
+    return block;
+  }
+  return ::operator new((index + 1) * size_class_granularity);
+}
+
+void pool_deallocate(void* p, std::size_t size) noexcept {
+  std::size_t index = size_class_index(size);
+  if (index >= size_class_count || frame_pool::destroyed_) {
+    ::operator delete(p);
+    return;
+  }
+  auto& sizeClass = currentThreadPool.classes_[index];
+  if ((sizeClass.count_ + 1) * (index + 1) * size_class_granularity >
+      max_free_bytes) {
+    ::operator delete(p);
+    return;
+  }
+  sizeClass.head_ = ::new (p) free_block{sizeClass.head_};
+  ++sizeClass.count_;
+}
+}  // namespace unifex::_coro_frame
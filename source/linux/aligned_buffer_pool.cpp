@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/linux/aligned_buffer_pool.hpp>
+
+#include <unifex/exception.hpp>
+
+#include <cerrno>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+
+#include <sys/mman.h>
+
+namespace unifex::linuxos {
+
+aligned_buffer_pool::aligned_buffer_pool(
+    std::size_t bufferSize, std::size_t bufferCount, std::size_t alignment)
+  : bufferSize_(0)
+  , alignment_(alignment)
+  , capacity_(bufferCount) {
+  if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+    throw_(std::invalid_argument{"alignment must be a power of two"});
+  }
+
+  bufferSize_ = (bufferSize + alignment - 1) & ~(alignment - 1);
+  if (bufferSize_ == 0 || bufferCount == 0) {
+    capacity_ = 0;
+    return;
+  }
+
+  // mmap() only guarantees page alignment, so over-reserve by one alignment
+  // unit to be able to align the start of the first buffer.
+  const std::size_t mappingSize = bufferSize_ * bufferCount + alignment;
+  void* ptr = ::mmap(
+      nullptr,
+      mappingSize,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS,
+      -1,
+      0);
+  if (ptr == MAP_FAILED) {
+    int errorCode = errno;
+    throw_(std::system_error{errorCode, std::system_category()});
+  }
+  region_ = mmap_region{ptr, mappingSize};
+
+  auto address = reinterpret_cast<std::uintptr_t>(ptr);
+  auto* first = reinterpret_cast<std::byte*>(
+      (address + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1));
+
+  // Hand out buffers lowest-address first.
+  free_.reserve(bufferCount);
+  for (std::size_t i = bufferCount; i > 0; --i) {
+    free_.push_back(first + (i - 1) * bufferSize_);
+  }
+}
+
+aligned_buffer_pool::buffer aligned_buffer_pool::acquire() {
+  buffer result = try_acquire();
+  if (!result) {
+    throw_(std::bad_alloc{});
+  }
+  return result;
+}
+
+}  // namespace unifex::linuxos
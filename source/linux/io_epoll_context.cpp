@@ -26,7 +26,9 @@
 #  include <system_error>
 #  include <thread>
 
+#  include <arpa/inet.h>
 #  include <fcntl.h>
+#  include <netinet/in.h>
 #  include <sys/epoll.h>
 #  include <sys/eventfd.h>
 #  include <sys/mman.h>
@@ -148,9 +150,53 @@ io_epoll_context::~io_epoll_context() {
   (void)epoll_ctl(
       epollFd_.get(), EPOLL_CTL_DEL, remoteQueueEventFd_.get(), &event);
   (void)epoll_ctl(epollFd_.get(), EPOLL_CTL_DEL, timerFd_.get(), &event);
+  free_retired_registrations();
   LOG("io_epoll_context destructor done");
 }
 
+io_epoll_context::fd_registration::fd_registration(
+    io_epoll_context& context, safe_file_descriptor fd)
+  : context_(context)
+  , fd_(std::move(fd)) {
+  epoll_event event = {};
+  event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+  event.data.ptr = this;
+  int result =
+      epoll_ctl(context_.epollFd_.get(), EPOLL_CTL_ADD, fd_.get(), &event);
+  if (result < 0) {
+    int errorCode = errno;
+    LOGX(
+        "epoll_ctl EPOLL_CTL_ADD fd %i failed with %i\n",
+        fd_.get(),
+        errorCode);
+    throw_(std::system_error{
+        errorCode, std::system_category(), "epoll_ctl EPOLL_CTL_ADD"});
+  }
+}
+
+void io_epoll_context::fd_registration::retire() noexcept {
+  epoll_event event = {};
+  (void)epoll_ctl(context_.epollFd_.get(), EPOLL_CTL_DEL, fd_.get(), &event);
+  fd_.close();
+
+  auto& retired = context_.retiredRegistrations_;
+  nextRetired_ = retired.load(std::memory_order_relaxed);
+  while (!retired.compare_exchange_weak(
+      nextRetired_,
+      this,
+      std::memory_order_release,
+      std::memory_order_relaxed)) {
+  }
+}
+
+void io_epoll_context::free_retired_registrations() noexcept {
+  auto* registration =
+      retiredRegistrations_.exchange(nullptr, std::memory_order_acquire);
+  while (registration != nullptr) {
+    delete std::exchange(registration, registration->nextRetired_);
+  }
+}
+
 void io_epoll_context::run_impl(const bool& shouldStop) {
   LOG("run loop started");
 
@@ -264,6 +310,10 @@ void io_epoll_context::execute_pending_local() noexcept {
 }
 
 void io_epoll_context::acquire_completion_queue_items() {
+  // The previous batch is done with, so nothing refers to registrations
+  // retired until now.
+  free_retired_registrations();
+
   LOG("epoll_wait()");
 
   epoll_event completions[io_epoll_max_event_count];
@@ -327,17 +377,25 @@ void io_epoll_context::acquire_completion_queue_items() {
     }
 
     LOGX("completion event %i\n", completed.events);
-    auto& completionState =
-        *reinterpret_cast<completion_base*>(completed.data.ptr);
-
-    UNIFEX_ASSERT(completionState.enqueued_.load() == 0);
-    ++completionState.enqueued_;
-
-    // Save the result in the completion state.
-    // completionState.result_ = cqe.res;
-
-    // Add it to a temporary queue of newly completed items.
-    completionQueue.push_back(&completionState);
+    auto& registration = *static_cast<fd_registration*>(completed.data.ptr);
+
+    // Wake whichever operations are parked on this fd. They will retry
+    // their syscall and park again if the fd turns out not to be ready.
+    auto wake = [&](completion_base*& waiting) noexcept {
+      if (auto* op = std::exchange(waiting, nullptr)) {
+        UNIFEX_ASSERT(op->enqueued_.load() == 0);
+        ++op->enqueued_;
+        // Add it to a temporary queue of newly completed items.
+        completionQueue.push_back(op);
+      }
+    };
+    if ((completed.events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) !=
+        0) {
+      wake(registration.reader_);
+    }
+    if ((completed.events & (EPOLLOUT | EPOLLHUP | EPOLLERR)) != 0) {
+      wake(registration.writer_);
+    }
   }
 
   schedule_local(std::move(completionQueue));
@@ -388,6 +446,8 @@ void io_epoll_context::update_timers() noexcept {
   // Reap any elapsed timers.
   if (!timers_.empty()) {
     time_point now = monotonic_clock::now();
+    // The heap is ordered by latest completion time; also take along any
+    // timers at the front that are already allowed to complete.
     while (!timers_.empty() && timers_.top()->dueTime_ <= now) {
       schedule_at_operation* item = timers_.pop();
 
@@ -422,22 +482,24 @@ void io_epoll_context::update_timers() noexcept {
       timersAreDirty_ = false;
     }
   } else {
-    const auto earliestDueTime = timers_.top()->dueTime_;
+    // Arm the OS timer for the latest time at which the front timer may
+    // complete; timers that become due before then complete along with it.
+    const auto wakeTime = timers_.top()->latestTime_;
     LOGX(
         "next timer in %i ms\n",
         (int)std::chrono::duration_cast<std::chrono::milliseconds>(
-            earliestDueTime - monotonic_clock::now())
+            wakeTime - monotonic_clock::now())
             .count());
     if (currentDueTime_) {
       constexpr auto threshold = std::chrono::microseconds(1);
-      if (earliestDueTime < (*currentDueTime_ - threshold)) {
+      if (wakeTime < (*currentDueTime_ - threshold)) {
         LOG("active timer, need to cancel and submit an earlier one");
 
         // An earlier time has been scheduled.
         // Cancel the old timer before submitting a new one.
         currentDueTime_.reset();
-        if (try_submit_timer_io(earliestDueTime)) {
-          currentDueTime_ = earliestDueTime;
+        if (try_submit_timer_io(wakeTime)) {
+          currentDueTime_ = wakeTime;
           timersAreDirty_ = false;
         }
       } else {
@@ -447,8 +509,8 @@ void io_epoll_context::update_timers() noexcept {
     } else {
       // No active timer, submit a new timer
       LOG("no active timer, trying to submit a new one");
-      if (try_submit_timer_io(earliestDueTime)) {
-        currentDueTime_ = earliestDueTime;
+      if (try_submit_timer_io(wakeTime)) {
+        currentDueTime_ = wakeTime;
         timersAreDirty_ = false;
       }
     }
@@ -479,11 +541,71 @@ tag_invoke(tag_t<open_pipe>, io_epoll_context::scheduler scheduler) {
     throw_(std::system_error{errorCode, std::system_category(), "pipe2"});
   }
 
+  // Registering the fds with epoll can fail; don't leak the write end
+  // if registering the read end throws.
+  scope_guard closeWriteEnd = [&]() noexcept {
+    ::close(fd[1]);
+  };
+  io_epoll_context::async_reader reader{*scheduler.context_, fd[0]};
+  closeWriteEnd.release();
+
   return {
-      io_epoll_context::async_reader{*scheduler.context_, fd[0]},
+      std::move(reader),
       io_epoll_context::async_writer{*scheduler.context_, fd[1]}};
 }
 
+io_epoll_context::accept_stream
+tag_invoke(tag_t<open_listening_socket>, io_epoll_context::scheduler scheduler,
+    port_t port) {
+  auto check = [](int result, const char* what) {
+    if (result < 0) {
+      int errorCode = errno;
+      throw_(std::system_error{errorCode, std::system_category(), what});
+    }
+  };
+
+  // Dual-stack, so this accepts both IPv4 and IPv6 connections.
+  safe_file_descriptor fd{
+      socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)};
+  check(fd.get(), "socket");
+
+  int enable = 1;
+  check(
+      setsockopt(fd.get(), SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)),
+      "setsockopt SO_REUSEADDR");
+  check(
+      setsockopt(fd.get(), SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)),
+      "setsockopt SO_REUSEPORT");
+
+  sockaddr_in6 address = {};
+  address.sin6_family = AF_INET6;
+  address.sin6_port = htons(port);
+  address.sin6_addr = in6addr_any;
+  check(
+      bind(fd.get(), reinterpret_cast<const sockaddr*>(&address),
+           sizeof(address)),
+      "bind");
+  check(listen(fd.get(), SOMAXCONN), "listen");
+
+  return io_epoll_context::accept_stream{*scheduler.context_, fd.release()};
+}
+
+port_t io_epoll_context::accept_stream::port() const {
+  sockaddr_storage address = {};
+  socklen_t length = sizeof(address);
+  if (getsockname(
+          registration_->fd_.get(),
+          reinterpret_cast<sockaddr*>(&address),
+          &length) < 0) {
+    int errorCode = errno;
+    throw_(std::system_error{errorCode, std::system_category(), "getsockname"});
+  }
+  if (address.ss_family == AF_INET6) {
+    return ntohs(reinterpret_cast<const sockaddr_in6&>(address).sin6_port);
+  }
+  return ntohs(reinterpret_cast<const sockaddr_in&>(address).sin_port);
+}
+
 }  // namespace unifex::linuxos
 
 #endif  // !UNIFEX_NO_EPOLL
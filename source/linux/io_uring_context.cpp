@@ -277,7 +277,18 @@ static thread_local io_uring_context* currentThreadContext;
 
 static constexpr __u64 remote_queue_event_user_data = 0;
 
-io_uring_context::io_uring_context() {
+io_uring_context::io_uring_context()
+  : io_uring_context(timer_clock::monotonic) {
+}
+
+io_uring_context::io_uring_context(timer_clock clock) : timerClock_(clock) {
+#  ifndef IORING_TIMEOUT_UPDATE
+  timerUpdateSupported_ = false;
+#  endif
+#  ifndef IORING_TIMEOUT_BOOTTIME
+  timerClock_ = timer_clock::monotonic;
+#  endif
+
   io_uring_params params;
   std::memset(&params, 0, sizeof(params));
 
@@ -598,7 +609,11 @@ void io_uring_context::acquire_completion_queue_items() noexcept {
         --activeTimerCount_;
 
         LOGX("now %u active timers\n", activeTimerCount_);
-        if (cqe.res != ECANCELED) {
+        if (cqe.res == -EINVAL && timerClock_ != timer_clock::monotonic) {
+          LOG("boottime timers not supported, using monotonic clock");
+          timerClock_ = timer_clock::monotonic;
+        }
+        if (cqe.res != -ECANCELED) {
           LOG("timer not cancelled, marking timers as dirty");
           timersAreDirty_ = true;
         }
@@ -611,6 +626,22 @@ void io_uring_context::acquire_completion_queue_items() noexcept {
       } else if (cqe.user_data == remove_timer_user_data()) {
         // Ignore timer cancellation completion.
         continue;
+      } else if (cqe.user_data == update_timer_user_data()) {
+        LOGX("got timer update result %i\n", cqe.res);
+        if (cqe.res == -EINVAL) {
+          LOG("timer update not supported, falling back to cancellation");
+          timerUpdateSupported_ = false;
+
+          // The kernel timer, if it has not completed yet, is still due at
+          // its old time. Force it to be cancelled and resubmitted.
+          if (activeTimerCount_ > 0) {
+            currentDueTime_ = time_point::max();
+          }
+          timersAreDirty_ = true;
+        }
+        // Otherwise either the update succeeded or the timer had already
+        // elapsed, in which case its own completion marks timers as dirty.
+        continue;
       }
 
       auto& completionState = *reinterpret_cast<completion_base*>(
@@ -699,6 +730,8 @@ void io_uring_context::update_timers() noexcept {
   // Reap any elapsed timers.
   if (!timers_.empty()) {
     time_point now = monotonic_clock::now();
+    // The heap is ordered by latest completion time; also take along any
+    // timers at the front that are already allowed to complete.
     while (!timers_.empty() && timers_.top()->dueTime_ <= now) {
       schedule_at_operation* item = timers_.pop();
 
@@ -736,19 +769,27 @@ void io_uring_context::update_timers() noexcept {
       }
     }
   } else {
-    const auto earliestDueTime = timers_.top()->dueTime_;
+    // Arm the OS timer for the latest time at which the front timer may
+    // complete; timers that become due before then complete along with it.
+    const auto wakeTime = timers_.top()->latestTime_;
 
     if (currentDueTime_) {
       constexpr auto threshold = std::chrono::microseconds(1);
-      if (earliestDueTime < (*currentDueTime_ - threshold)) {
-        LOG("active timer, need to cancel and submit an earlier one");
-
+      if (wakeTime < (*currentDueTime_ - threshold)) {
         // An earlier time has been scheduled.
-        // Cancel the old timer before submitting a new one.
-        if (try_submit_timer_io_cancel()) {
+        if (timerUpdateSupported_) {
+          LOG("active timer, need to move it earlier");
+          if (try_submit_timer_io_update(wakeTime)) {
+            currentDueTime_ = wakeTime;
+            timersAreDirty_ = false;
+          }
+        } else if (try_submit_timer_io_cancel()) {
+          LOG("active timer, need to cancel and submit an earlier one");
+
+          // Cancel the old timer before submitting a new one.
           currentDueTime_.reset();
-          if (try_submit_timer_io(earliestDueTime)) {
-            currentDueTime_ = earliestDueTime;
+          if (try_submit_timer_io(wakeTime)) {
+            currentDueTime_ = wakeTime;
             timersAreDirty_ = false;
           }
         }
@@ -758,25 +799,44 @@ void io_uring_context::update_timers() noexcept {
     } else {
       // No active timer, submit a new timer
       LOG("no active timer, trying to submit a new one");
-      if (try_submit_timer_io(earliestDueTime)) {
-        currentDueTime_ = earliestDueTime;
+      if (try_submit_timer_io(wakeTime)) {
+        currentDueTime_ = wakeTime;
         timersAreDirty_ = false;
       }
     }
   }
 }
 
+void io_uring_context::set_timer_timespec(
+    const time_point& dueTime) noexcept {
+  time_point kernelDueTime = dueTime;
+  if (timerClock_ == timer_clock::boottime) {
+    // CLOCK_BOOTTIME runs ahead of CLOCK_MONOTONIC by the total time spent
+    // suspended so far.
+    timespec boottimeNow;
+    ::clock_gettime(CLOCK_BOOTTIME, &boottimeNow);
+    kernelDueTime += (time_point::from_seconds_and_nanoseconds(
+                          boottimeNow.tv_sec, boottimeNow.tv_nsec) -
+                      monotonic_clock::now());
+  }
+  time_.tv_sec = kernelDueTime.seconds_part();
+  time_.tv_nsec = kernelDueTime.nanoseconds_part();
+}
+
 bool io_uring_context::try_submit_timer_io(const time_point& dueTime) noexcept {
   auto populateSqe = [&](io_uring_sqe& sqe) noexcept {
     sqe.opcode = IORING_OP_TIMEOUT;
     sqe.addr = reinterpret_cast<std::uintptr_t>(&time_);
     sqe.len = 1;
-    sqe.rw_flags =
-        1;  // HACK: Should be 'sqe.timeout_flags = IORING_TIMEOUT_ABS'
+    sqe.timeout_flags = IORING_TIMEOUT_ABS;
+#  ifdef IORING_TIMEOUT_BOOTTIME
+    if (timerClock_ == timer_clock::boottime) {
+      sqe.timeout_flags |= IORING_TIMEOUT_BOOTTIME;
+    }
+#  endif
     sqe.user_data = timer_user_data();
 
-    time_.tv_sec = dueTime.seconds_part();
-    time_.tv_nsec = dueTime.nanoseconds_part();
+    set_timer_timespec(dueTime);
   };
 
   if (try_submit_io(populateSqe)) {
@@ -789,7 +849,7 @@ bool io_uring_context::try_submit_timer_io(const time_point& dueTime) noexcept {
 
 bool io_uring_context::try_submit_timer_io_cancel() noexcept {
   auto populateSqe = [&](io_uring_sqe& sqe) noexcept {
-    sqe.opcode = 12;  // IORING_OP_TIMEOUT_REMOVE;
+    sqe.opcode = IORING_OP_TIMEOUT_REMOVE;
     sqe.addr = timer_user_data();
     sqe.user_data = remove_timer_user_data();
   };
@@ -797,6 +857,27 @@ bool io_uring_context::try_submit_timer_io_cancel() noexcept {
   return try_submit_io(populateSqe);
 }
 
+bool io_uring_context::try_submit_timer_io_update(
+    [[maybe_unused]] const time_point& dueTime) noexcept {
+#  ifdef IORING_TIMEOUT_UPDATE
+  auto populateSqe = [&](io_uring_sqe& sqe) noexcept {
+    sqe.opcode = IORING_OP_TIMEOUT_REMOVE;
+    sqe.addr = timer_user_data();
+    sqe.addr2 = reinterpret_cast<std::uintptr_t>(&time_);
+    // The clock can't be changed by an update; the timer keeps the one it
+    // was submitted with.
+    sqe.timeout_flags = IORING_TIMEOUT_UPDATE | IORING_TIMEOUT_ABS;
+    sqe.user_data = update_timer_user_data();
+
+    set_timer_timespec(dueTime);
+  };
+
+  return try_submit_io(populateSqe);
+#  else
+  return false;
+#  endif
+}
+
 io_uring_context::async_read_only_file tag_invoke(
     tag_t<open_file_read_only>,
     io_uring_context::scheduler scheduler,
@@ -836,6 +917,64 @@ io_uring_context::async_read_write_file tag_invoke(
   return io_uring_context::async_read_write_file{*scheduler.context_, result};
 }
 
+namespace {
+struct direct_file_handle {
+  int fd;
+  std::size_t alignment;
+};
+
+direct_file_handle
+open_direct(const filesystem::path& path, int flags, mode_t mode = 0) {
+  int result = ::open(path.c_str(), flags | O_DIRECT | O_CLOEXEC, mode);
+  if (result < 0) {
+    int errorCode = errno;
+    throw_(std::system_error{errorCode, std::system_category()});
+  }
+
+  // st_blksize is the preferred I/O size of the filesystem, which is always
+  // a multiple of the logical block size that O_DIRECT actually requires.
+  // Using it is conservative but avoids device-specific ioctls.
+  struct stat st;
+  if (::fstat(result, &st) < 0) {
+    int errorCode = errno;
+    ::close(result);
+    throw_(std::system_error{errorCode, std::system_category()});
+  }
+
+  std::size_t alignment = st.st_blksize > 0
+      ? static_cast<std::size_t>(st.st_blksize)
+      : std::size_t(4096);
+  return direct_file_handle{result, alignment};
+}
+}  // namespace
+
+io_uring_context::async_read_only_file tag_invoke(
+    tag_t<open_file_read_only_direct>,
+    io_uring_context::scheduler scheduler,
+    const filesystem::path& path) {
+  auto [fd, alignment] = open_direct(path, O_RDONLY);
+  return io_uring_context::async_read_only_file{
+      *scheduler.context_, fd, alignment};
+}
+
+io_uring_context::async_write_only_file tag_invoke(
+    tag_t<open_file_write_only_direct>,
+    io_uring_context::scheduler scheduler,
+    const filesystem::path& path) {
+  auto [fd, alignment] = open_direct(path, O_WRONLY | O_CREAT, 0644);
+  return io_uring_context::async_write_only_file{
+      *scheduler.context_, fd, alignment};
+}
+
+io_uring_context::async_read_write_file tag_invoke(
+    tag_t<open_file_read_write_direct>,
+    io_uring_context::scheduler scheduler,
+    const filesystem::path& path) {
+  auto [fd, alignment] = open_direct(path, O_RDWR | O_CREAT, 0644);
+  return io_uring_context::async_read_write_file{
+      *scheduler.context_, fd, alignment};
+}
+
 io_uring_context::accept_stream tag_invoke(
     tag_t<open_listening_socket>,
     io_uring_context::scheduler scheduler,
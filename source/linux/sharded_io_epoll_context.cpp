@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/config.hpp>
+#if !UNIFEX_NO_EPOLL
+
+#  include <unifex/linux/sharded_io_epoll_context.hpp>
+
+#  include <unifex/inplace_stop_token.hpp>
+
+#  include <algorithm>
+
+namespace unifex::linuxos {
+
+struct sharded_io_epoll_context::shard {
+  shard() : thread_([this] { context_.run(stopSource_.get_token()); }) {}
+
+  ~shard() {
+    stopSource_.request_stop();
+    thread_.join();
+  }
+
+  io_epoll_context context_;
+  inplace_stop_source stopSource_;
+  std::thread thread_;
+};
+
+sharded_io_epoll_context::sharded_io_epoll_context(std::size_t shardCount) {
+  shardCount = std::max<std::size_t>(shardCount, 1);
+  shards_.reserve(shardCount);
+  for (std::size_t i = 0; i < shardCount; ++i) {
+    shards_.push_back(std::make_unique<shard>());
+  }
+}
+
+sharded_io_epoll_context::~sharded_io_epoll_context() = default;
+
+sharded_io_epoll_context::scheduler
+sharded_io_epoll_context::get_scheduler(std::size_t shard) noexcept {
+  UNIFEX_ASSERT(shard < shards_.size());
+  return shards_[shard]->context_.get_scheduler();
+}
+
+sharded_io_epoll_context::scheduler
+sharded_io_epoll_context::get_scheduler() noexcept {
+  auto shard = nextShard_.fetch_add(1, std::memory_order_relaxed);
+  return get_scheduler(shard % shards_.size());
+}
+
+std::vector<io_epoll_context::accept_stream>
+sharded_io_epoll_context::open_listening_sockets(port_t port) {
+  std::vector<io_epoll_context::accept_stream> listeners;
+  listeners.reserve(shards_.size());
+  for (std::size_t i = 0; i < shards_.size(); ++i) {
+    listeners.push_back(open_listening_socket(get_scheduler(i), port));
+    if (port == 0) {
+      port = listeners.back().port();
+    }
+  }
+  return listeners;
+}
+
+}  // namespace unifex::linuxos
+
+#endif  // !UNIFEX_NO_EPOLL
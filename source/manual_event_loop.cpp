@@ -14,11 +14,22 @@
  * limitations under the License.
  */
 #include <unifex/manual_event_loop.hpp>
+#include <unifex/scope_guard.hpp>
+
+#include <utility>
 
 namespace unifex {
 namespace _manual_event_loop {
 
+namespace {
+thread_local const context* currentThreadContext = nullptr;
+}  // namespace
+
 void context::run() {
+  const context* oldContext = std::exchange(currentThreadContext, this);
+  scope_guard restoreContext{
+      [oldContext]() noexcept { currentThreadContext = oldContext; }};
+
   std::unique_lock lock{mutex_};
   while (true) {
     while (head_ == nullptr) {
@@ -43,6 +54,10 @@ void context::stop() {
   cv_.notify_all();
 }
 
+bool context::is_running_on_loop_thread() const noexcept {
+  return currentThreadContext == this;
+}
+
 void context::enqueue(task_base* task) {
   std::unique_lock lock{mutex_};
   bool wasEmpty = (head_ == nullptr);
@@ -51,7 +51,12 @@ void context::request_stop() noexcept {
   }
 }
 
+namespace {
+thread_local const context* currentThreadContext = nullptr;
+}  // namespace
+
 void context::run(std::uint32_t index) noexcept {
+  currentThreadContext = this;
   while (true) {
     task_base* task = nullptr;
     for (std::uint32_t i = 0; i < threadCount_; ++i) {
@@ -76,6 +81,10 @@ void context::run(std::uint32_t index) noexcept {
   }
 }
 
+bool context::is_running_on_pool_thread() const noexcept {
+  return currentThreadContext == this;
+}
+
 void context::join() noexcept {
   for (auto& t : threads_) {
     t.join();
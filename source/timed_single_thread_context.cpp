@@ -15,10 +15,253 @@
  */
 #include <unifex/timed_single_thread_context.hpp>
 
+#include <algorithm>
+#include <utility>
+
 namespace unifex {
+namespace _timed_single_thread_context {
+
+namespace {
+bool runs_before(const task_base* a, const task_base* b) noexcept {
+  return a->dueTime_ < b->dueTime_ ||
+      (a->dueTime_ == b->dueTime_ && a->sequence_ < b->sequence_);
+}
+
+// Merge of two lists sorted by due-time then sequence, linked through
+// 'next_'.
+task_base* merge(task_base* a, task_base* b) noexcept {
+  task_base* head = nullptr;
+  task_base** tail = &head;
+  while (a != nullptr && b != nullptr) {
+    if (runs_before(b, a)) {
+      *tail = b;
+      b = b->next_;
+    } else {
+      *tail = a;
+      a = a->next_;
+    }
+    tail = &(*tail)->next_;
+  }
+  *tail = a != nullptr ? a : b;
+  return head;
+}
+
+// Merge sort of a list linked through 'next_'.
+task_base* sort(task_base* list) noexcept {
+  if (list == nullptr || list->next_ == nullptr) {
+    return list;
+  }
+  // Split in half with the slow/fast pointer walk.
+  task_base* slow = list;
+  for (task_base* fast = list->next_; fast != nullptr && fast->next_ != nullptr;
+       fast = fast->next_->next_) {
+    slow = slow->next_;
+  }
+  task_base* second = slow->next_;
+  slow->next_ = nullptr;
+  return merge(sort(list), sort(second));
+}
+}  // namespace
+
+timer_wheel::timer_wheel(time_point epoch) noexcept : epoch_(epoch) {
+}
+
+std::uint64_t timer_wheel::to_tick(time_point t) const noexcept {
+  if (t <= epoch_) {
+    return 0;
+  }
+  return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<duration>(t - epoch_).count());
+}
+
+time_point timer_wheel::to_time_point(std::uint64_t tick) const noexcept {
+  return epoch_ + duration{static_cast<duration::rep>(tick)};
+}
+
+void timer_wheel::insert(task_base* task) noexcept {
+  task->sequence_ = nextSequence_++;
+  if (to_tick(task->dueTime_) < currentTick_) {
+    insert_ready(task);
+  } else {
+    insert_into_slot(task);
+  }
+}
+
+void timer_wheel::insert_into_slot(task_base* task) noexcept {
+  const std::uint64_t tick = to_tick(task->dueTime_);
+  UNIFEX_ASSERT(tick >= currentTick_);
+  const std::uint64_t delta = tick - currentTick_;
+
+  // Pick the lowest level whose span covers the delay. A slot at level L is
+  // emptied (cascaded) when the current tick reaches the start of its range,
+  // which is never later than any task in it is due.
+  std::size_t level = 0;
+  while (level + 1 < level_count &&
+         delta >= (std::uint64_t(1) << (slot_bits * (level + 1)))) {
+    ++level;
+  }
+  const std::uint64_t levelShift = slot_bits * level;
+  std::uint64_t slotTick = tick;
+  if (delta >= (std::uint64_t(1) << (slot_bits * level_count))) {
+    // Beyond the wheel's range: park it in the furthest slot of the last
+    // level. It is re-inserted from there when that slot is cascaded.
+    slotTick = ((currentTick_ >> levelShift) + slot_mask) << levelShift;
+  }
+  task_base*& slot = slots_[level][(slotTick >> levelShift) & slot_mask];
+
+  task->next_ = slot;
+  task->prevNextPtr_ = &slot;
+  if (slot != nullptr) {
+    slot->prevNextPtr_ = &task->next_;
+  }
+  slot = task;
+  ++size_;
+}
+
+void timer_wheel::insert_ready(task_base* task) noexcept {
+  task_base** prevNextPtr = &ready_;
+  while (*prevNextPtr != nullptr && runs_before(*prevNextPtr, task)) {
+    prevNextPtr = &(*prevNextPtr)->next_;
+  }
+  task->next_ = *prevNextPtr;
+  task->prevNextPtr_ = prevNextPtr;
+  if (task->next_ != nullptr) {
+    task->next_->prevNextPtr_ = &task->next_;
+  }
+  *prevNextPtr = task;
+}
+
+void timer_wheel::remove(task_base* task) noexcept {
+  UNIFEX_ASSERT(task->prevNextPtr_ != nullptr);
+  if (to_tick(task->dueTime_) >= currentTick_) {
+    // Still in a slot rather than in 'ready_'.
+    --size_;
+  }
+  *task->prevNextPtr_ = task->next_;
+  if (task->next_ != nullptr) {
+    task->next_->prevNextPtr_ = task->prevNextPtr_;
+  }
+  task->prevNextPtr_ = nullptr;
+  task->next_ = nullptr;
+}
+
+void timer_wheel::move_to_ready(task_base*& slot) noexcept {
+  // Slots are in no particular order: cascading re-inserts tasks, and tasks
+  // with the same due-time may arrive through different levels. Sorting by
+  // sequence as well keeps equal due-times in insertion order.
+  task_base* list = std::exchange(slot, nullptr);
+  for (task_base* task = list; task != nullptr; task = task->next_) {
+    --size_;
+  }
+
+  ready_ = merge(ready_, sort(list));
+
+  task_base** prevNextPtr = &ready_;
+  for (task_base* task = ready_; task != nullptr; task = task->next_) {
+    task->prevNextPtr_ = prevNextPtr;
+    prevNextPtr = &task->next_;
+  }
+}
+
+void timer_wheel::cascade() noexcept {
+  // Empty the higher-level slots whose range starts at the current tick,
+  // highest level first, re-inserting their tasks closer to the bottom.
+  for (std::size_t level = level_count - 1; level > 0; --level) {
+    const std::uint64_t levelShift = slot_bits * level;
+    if ((currentTick_ & ((std::uint64_t(1) << levelShift) - 1)) != 0) {
+      continue;
+    }
+    task_base*& slot = slots_[level][(currentTick_ >> levelShift) & slot_mask];
+    for (task_base* task = std::exchange(slot, nullptr); task != nullptr;) {
+      task_base* next = task->next_;
+      --size_;
+      insert_into_slot(task);
+      task = next;
+    }
+  }
+}
+
+std::uint64_t timer_wheel::next_tick() const noexcept {
+  UNIFEX_ASSERT(size_ != 0);
+
+  // The first tick at which advance() has any work to do: either a
+  // non-empty level 0 slot or the cascade of a non-empty higher-level slot.
+  std::uint64_t nextTick = ~std::uint64_t(0);
+  for (std::uint64_t k = 0; k < slot_count; ++k) {
+    if (slots_[0][(currentTick_ + k) & slot_mask] != nullptr) {
+      nextTick = currentTick_ + k;
+      break;
+    }
+  }
+  for (std::size_t level = 1; level < level_count; ++level) {
+    const std::uint64_t levelShift = slot_bits * level;
+    const std::uint64_t base = currentTick_ >> levelShift;
+    // The slot containing the current tick has already been cascaded (or
+    // skipped while empty) unless the current tick is its very first one.
+    const std::uint64_t first =
+        (currentTick_ & ((std::uint64_t(1) << levelShift) - 1)) == 0 ? 0 : 1;
+    if (((base + first) << levelShift) >= nextTick) {
+      break;
+    }
+    for (std::uint64_t k = first; k <= slot_count; ++k) {
+      if (slots_[level][(base + k) & slot_mask] != nullptr) {
+        nextTick = std::min(nextTick, (base + k) << levelShift);
+        break;
+      }
+    }
+  }
+  UNIFEX_ASSERT(nextTick != ~std::uint64_t(0));
+  return nextTick;
+}
+
+void timer_wheel::advance(time_point now) noexcept {
+  const std::uint64_t nowTick = to_tick(now);
+  // Jump straight to each tick with work to do; the ones in between hold
+  // nothing and need no cascading.
+  while (size_ != 0) {
+    const std::uint64_t tick = next_tick();
+    if (tick > nowTick) {
+      break;
+    }
+    currentTick_ = tick;
+    if ((currentTick_ & slot_mask) == 0) {
+      cascade();
+    }
+    task_base*& slot = slots_[0][currentTick_ & slot_mask];
+    if (slot != nullptr) {
+      move_to_ready(slot);
+    }
+    ++currentTick_;
+  }
+  currentTick_ = std::max(currentTick_, nowTick + 1);
+}
+
+task_base* timer_wheel::pop_due(time_point now) noexcept {
+  advance(now);
+  if (ready_ == nullptr || now < ready_->dueTime_) {
+    return nullptr;
+  }
+  task_base* task = ready_;
+  remove(task);
+  return task;
+}
+
+time_point timer_wheel::next_due_time() const noexcept {
+  if (ready_ != nullptr) {
+    // Everything still in the wheel is due in a later tick.
+    return ready_->dueTime_;
+  }
+  if (size_ == 0) {
+    return time_point::max();
+  }
+  return to_time_point(next_tick());
+}
+
+}  // namespace _timed_single_thread_context
 
 timed_single_thread_context::timed_single_thread_context()
-  : thread_([this] { this->run(); }) {
+  : timers_(clock_t::now())
+  , thread_([this] { this->run(); }) {
 }
 
 timed_single_thread_context::~timed_single_thread_context() {
@@ -29,37 +272,18 @@ timed_single_thread_context::~timed_single_thread_context() {
   }
   thread_.join();
 
-  UNIFEX_ASSERT(head_ == nullptr);
+  UNIFEX_ASSERT(timers_.empty());
+  UNIFEX_ASSERT(cancelled_ == nullptr);
 }
 
 void timed_single_thread_context::enqueue(task_base* task) noexcept {
   std::lock_guard lock{mutex_};
 
-  if (head_ == nullptr || task->dueTime_ < head_->dueTime_) {
-    // Insert at the head of the queue.
-    task->next_ = head_;
-    task->prevNextPtr_ = &head_;
-    if (head_ != nullptr) {
-      head_->prevNextPtr_ = &task->next_;
-    }
-    head_ = task;
+  timers_.insert(task);
 
-    // New minimum due-time has changed, wake the thread.
+  if (task->dueTime_ < wakeTime_) {
+    // The thread is asleep and would wake too late for this task.
     cv_.notify_one();
-  } else {
-    auto* queuedTask = head_;
-    while (queuedTask->next_ != nullptr &&
-           queuedTask->next_->dueTime_ <= task->dueTime_) {
-      queuedTask = queuedTask->next_;
-    }
-
-    // Insert after queuedTask
-    task->prevNextPtr_ = &queuedTask->next_;
-    task->next_ = queuedTask->next_;
-    if (task->next_ != nullptr) {
-      task->next_->prevNextPtr_ = &task->next_;
-    }
-    queuedTask->next_ = task;
   }
 }
 
@@ -67,57 +291,57 @@ void timed_single_thread_context::run() {
   std::unique_lock lock{mutex_};
 
   while (!stop_) {
-    if (head_ != nullptr) {
-      auto now = clock_t::now();
-      auto nextDueTime = head_->dueTime_;
-      if (nextDueTime <= now) {
-        // Ready to run
-
-        // Dequeue item
-        auto* task = head_;
-        head_ = task->next_;
-        if (head_ != nullptr) {
-          head_->prevNextPtr_ = &head_;
-        }
-
-        // Flag the task as dequeued.
-        task->prevNextPtr_ = nullptr;
-        lock.unlock();
-
-        task->execute();
-
-        lock.lock();
-      } else {
-        // Not yet ready to run. Sleep until it's ready.
-        cv_.wait_until(lock, nextDueTime);
+    task_base* task = cancelled_;
+    if (task != nullptr) {
+      cancelled_ = task->next_;
+      if (cancelled_ == nullptr) {
+        cancelledTail_ = &cancelled_;
       }
     } else {
-      // Queue is empty.
+      task = timers_.pop_due(clock_t::now());
+    }
+
+    if (task != nullptr) {
+      // Flag the task as dequeued.
+      task->prevNextPtr_ = nullptr;
+      lock.unlock();
+
+      task->execute();
+
+      lock.lock();
+      continue;
+    }
+
+    // Not yet ready to run. Sleep until something is.
+    wakeTime_ = timers_.next_due_time();
+    if (wakeTime_ == time_point::max()) {
       cv_.wait(lock);
+    } else {
+      cv_.wait_until(lock, wakeTime_);
     }
+    wakeTime_ = time_point::min();
   }
 }
 
 void _timed_single_thread_context::cancel_callback::operator()() noexcept {
-  std::unique_lock lock{task_->context_->mutex_};
+  auto& context = *task_->context_;
+  std::lock_guard lock{context.mutex_};
   auto now = clock_t::now();
   if (now < task_->dueTime_) {
-    task_->dueTime_ = now;
-
     if (task_->prevNextPtr_ != nullptr) {
-      // Task is still in the queue, dequeue and requeue it.
+      // Task is still waiting on a timer; move it to the cancelled queue
+      // so it completes promptly.
+      context.timers_.remove(task_);
+      task_->dueTime_ = now;
+      task_->prevNextPtr_ = context.cancelledTail_;
+      *context.cancelledTail_ = task_;
+      context.cancelledTail_ = &task_->next_;
 
-      // Remove from the queue.
-      *task_->prevNextPtr_ = task_->next_;
-      if (task_->next_ != nullptr) {
-        task_->next_->prevNextPtr_ = task_->prevNextPtr_;
+      if (context.wakeTime_ != time_point::min()) {
+        context.cv_.notify_one();
       }
-      task_->prevNextPtr_ = nullptr;
-      lock.unlock();
-
-      // And requeue with an updated time.
+    } else {
       task_->dueTime_ = now;
-      task_->context_->enqueue(task_);
     }
   }
 }
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/any_scheduler.hpp>
+
+#include <unifex/inline_scheduler.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/static_thread_pool.hpp>
+
+#include "allocation_counter.hpp"
+
+#include <array>
+#include <atomic>
+#include <exception>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+using unifex_test::allocation_count;
+
+namespace {
+struct flag_receiver {
+  std::atomic<bool>* done_;
+
+  void set_value() && noexcept { done_->store(true); }
+  void set_error(std::exception_ptr) && noexcept {}
+  void set_done() && noexcept {}
+};
+
+// Too large to be stored inline in an any_scheduler.
+struct big_scheduler {
+  std::array<int, 16> id_{};
+
+  auto schedule() const noexcept { return unifex::schedule(inline_scheduler{}); }
+
+  friend bool
+  operator==(const big_scheduler& a, const big_scheduler& b) noexcept {
+    return a.id_ == b.id_;
+  }
+  friend bool
+  operator!=(const big_scheduler& a, const big_scheduler& b) noexcept {
+    return !(a == b);
+  }
+};
+
+template <typename Scheduler>
+std::size_t allocations_to_schedule(const Scheduler& sched) {
+  std::atomic<bool> done{false};
+  auto before = allocation_count();
+  {
+    auto op = connect(schedule(sched), flag_receiver{&done});
+    start(op);
+    while (!done.load()) {
+      std::this_thread::yield();
+    }
+  }
+  return allocation_count() - before;
+}
+}  // namespace
+
+TEST(any_scheduler_alloc, CopyDoesNotAllocate) {
+  static_thread_pool pool{1};
+  any_scheduler sched = pool.get_scheduler();
+
+  auto before = allocation_count();
+  any_scheduler copy = sched;
+  EXPECT_EQ(allocation_count() - before, 0u);
+  EXPECT_EQ(copy, sched);
+}
+
+TEST(any_scheduler_alloc, ScheduleOnInlineSchedulerDoesNotAllocate) {
+  any_scheduler sched = inline_scheduler{};
+  EXPECT_EQ(allocations_to_schedule(sched), 0u);
+}
+
+TEST(any_scheduler_alloc, ScheduleOnThreadPoolDoesNotAllocate) {
+  static_thread_pool pool{1};
+  any_scheduler sched = pool.get_scheduler();
+  EXPECT_EQ(allocations_to_schedule(sched), 0u);
+}
+
+TEST(any_scheduler_alloc, ScheduleThroughRefDoesNotAllocate) {
+  static_thread_pool pool{1};
+  auto poolSched = pool.get_scheduler();
+  any_scheduler_ref sched = poolSched;
+  EXPECT_EQ(allocations_to_schedule(sched), 0u);
+}
+
+TEST(any_scheduler_alloc, LargeSchedulerIsStoredOnHeap) {
+  big_scheduler big;
+  big.id_[3] = 42;
+
+  auto before = allocation_count();
+  any_scheduler sched = big;
+  any_scheduler copy = sched;
+  EXPECT_EQ(allocation_count() - before, 2u);
+
+  EXPECT_EQ(copy, sched);
+  big.id_[3] = 43;
+  EXPECT_NE(any_scheduler{big}, sched);
+  EXPECT_NE(any_scheduler{inline_scheduler{}}, sched);
+}
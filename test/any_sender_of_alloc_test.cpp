@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/any_sender_of.hpp>
+
+#include <unifex/get_allocator.hpp>
+#include <unifex/inline_scheduler.hpp>
+#include <unifex/just.hpp>
+#include <unifex/receiver_concepts.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/then.hpp>
+
+#include "allocation_counter.hpp"
+
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+using unifex_test::allocation_count;
+
+namespace {
+struct int_receiver {
+  int* result_;
+
+  void set_value(int value) && noexcept { *result_ = value; }
+  void set_error(std::exception_ptr) && noexcept {}
+  void set_done() && noexcept {}
+};
+
+struct allocator_stats {
+  std::size_t allocations_{0};
+  std::size_t deallocations_{0};
+};
+
+template <typename T>
+struct counting_allocator {
+  using value_type = T;
+
+  explicit counting_allocator(allocator_stats* stats) noexcept
+    : stats_(stats) {}
+
+  template <typename U>
+  counting_allocator(const counting_allocator<U>& other) noexcept
+    : stats_(other.stats_) {}
+
+  T* allocate(std::size_t n) {
+    ++stats_->allocations_;
+    return static_cast<T*>(std::malloc(n * sizeof(T)));
+  }
+
+  void deallocate(T* p, std::size_t) noexcept {
+    ++stats_->deallocations_;
+    std::free(p);
+  }
+
+  friend bool
+  operator==(const counting_allocator& a, const counting_allocator& b) {
+    return a.stats_ == b.stats_;
+  }
+  friend bool
+  operator!=(const counting_allocator& a, const counting_allocator& b) {
+    return !(a == b);
+  }
+
+  allocator_stats* stats_;
+};
+
+struct allocating_int_receiver : int_receiver {
+  allocator_stats* stats_;
+
+  friend counting_allocator<std::byte>
+  tag_invoke(tag_t<get_allocator>, const allocating_int_receiver& r) noexcept {
+    return counting_allocator<std::byte>{r.stats_};
+  }
+};
+
+struct scheduler_int_receiver : int_receiver {
+  friend inline_scheduler
+  tag_invoke(tag_t<get_scheduler>, const scheduler_int_receiver&) noexcept {
+    return {};
+  }
+};
+
+template <typename Sender, typename Receiver>
+std::size_t allocations_to_run(Sender&& sender, Receiver receiver) {
+  auto before = allocation_count();
+  {
+    auto op = connect((Sender &&) sender, std::move(receiver));
+    start(op);
+  }
+  return allocation_count() - before;
+}
+}  // namespace
+
+TEST(any_sender_of_alloc, ConnectAllocatesOperationState) {
+  int result = 0;
+  any_sender_of<int> sender = just(42);
+  EXPECT_EQ(allocations_to_run(std::move(sender), int_receiver{&result}), 1u);
+  EXPECT_EQ(result, 42);
+}
+
+TEST(any_sender_of_alloc, InplaceConnectDoesNotAllocate) {
+  int result = 0;
+  any_sender_of_inplace<128, int> sender =
+      just(20) | then([](int value) { return value + 22; });
+  EXPECT_EQ(allocations_to_run(std::move(sender), int_receiver{&result}), 0u);
+  EXPECT_EQ(result, 42);
+}
+
+TEST(any_sender_of_alloc, TooSmallInlineBufferFallsBackToHeap) {
+  int result = 0;
+  any_sender_of_inplace<1, int> sender = just(42);
+  EXPECT_EQ(allocations_to_run(std::move(sender), int_receiver{&result}), 1u);
+  EXPECT_EQ(result, 42);
+}
+
+TEST(any_sender_of_alloc, ConnectUsesReceiverAllocator) {
+  int result = 0;
+  allocator_stats stats;
+  any_sender_of<int> sender = just(42);
+  EXPECT_EQ(
+      allocations_to_run(
+          std::move(sender), allocating_int_receiver{{&result}, &stats}),
+      0u);
+  EXPECT_EQ(result, 42);
+  EXPECT_EQ(stats.allocations_, 1u);
+  EXPECT_EQ(stats.deallocations_, 1u);
+}
+
+TEST(any_sender_of_alloc, InplaceWithReceiverQueries) {
+  using sender_t = with_receiver_queries<overload<inline_scheduler(
+      const this_&)>(get_scheduler)>::any_sender_of_inplace<64, int>;
+  int result = 0;
+  sender_t sender = just(42);
+  EXPECT_EQ(
+      allocations_to_run(std::move(sender), scheduler_int_receiver{{&result}}),
+      0u);
+  EXPECT_EQ(result, 42);
+}
@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <unifex/v2/async_auto_reset_event.hpp>
+#include <unifex/inline_scheduler.hpp>
+#include <unifex/inplace_stop_token.hpp>
+#include <unifex/next_adapt_stream.hpp>
+#include <unifex/reduce_stream.hpp>
+#include <unifex/scope_guard.hpp>
+#include <unifex/stop_on_request.hpp>
+#include <unifex/stop_when.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/with_query_value.hpp>
+
+#include <atomic>
+#include <thread>
+
+using event = unifex::v2::async_auto_reset_event;
+
+struct AsyncAutoResetEventV2Tests : testing::Test {};
+
+namespace {
+
+template <typename Stream>
+auto countElements(Stream&& stream) noexcept {
+  return unifex::sync_wait(unifex::reduce_stream(
+      (Stream&)stream, 0, [](int count) noexcept { return ++count; }));
+}
+
+}  // namespace
+
+TEST_F(AsyncAutoResetEventV2Tests, canConstructAnEvent) {
+  event evt;
+}
+
+TEST_F(
+    AsyncAutoResetEventV2Tests,
+    reducingStream_thatIsImmediatelySetDone_producesNoSums) {
+  event evt;
+
+  evt.set_done();
+
+  auto result = countElements(evt.stream());
+
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, 0);
+}
+
+TEST_F(AsyncAutoResetEventV2Tests, queueNext_respondsToStopRequests) {
+  event evt;
+
+  unifex::inplace_stop_source stopSource;
+
+  stopSource.request_stop();
+
+  auto result = countElements(unifex::next_adapt_stream(
+      evt.stream(), [&stopSource](auto&& next) noexcept {
+        return unifex::with_query_value(
+            std::move(next), unifex::get_stop_token, stopSource.get_token());
+      }));
+
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, 0);
+}
+
+TEST_F(AsyncAutoResetEventV2Tests, reducingStream_thatHasAValue_generatesASum) {
+  event evt;
+
+  evt.set();
+
+  auto result = unifex::sync_wait(
+      unifex::reduce_stream(evt.stream(), 0, [&](int count) noexcept {
+        evt.set_done();
+        return ++count;
+      }));
+
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, 1);
+}
+
+TEST_F(
+    AsyncAutoResetEventV2Tests, reducingStream_thatWasBornReady_generatesASum) {
+  event evt{true};
+
+  auto result = unifex::sync_wait(
+      unifex::reduce_stream(evt.stream(), 0, [&](int count) noexcept {
+        evt.set_done();
+        return ++count;
+      }));
+
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, 1);
+}
+
+TEST_F(
+    AsyncAutoResetEventV2Tests,
+    callingSet_afterResettingTheEvent_createsAnotherStreamElement) {
+  event evt;
+
+  evt.set();
+
+  auto result = unifex::sync_wait(
+      unifex::reduce_stream(evt.stream(), 0, [&](int count) noexcept {
+        if (count < 2) {
+          evt.set();
+        } else {
+          evt.set_done();
+        }
+        return ++count;
+      }));
+
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, 3);
+}
+
+TEST_F(AsyncAutoResetEventV2Tests, repeatedCallsToSet_areIdempotent) {
+  event evt;
+
+  evt.set();
+  evt.set();
+
+  auto result = unifex::sync_wait(
+      unifex::reduce_stream(evt.stream(), 0, [&](int count) noexcept {
+        if (count < 2) {
+          evt.set();
+          evt.set();
+        } else {
+          evt.set_done();
+        }
+        return ++count;
+      }));
+
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, 3);
+}
+
+TEST_F(
+    AsyncAutoResetEventV2Tests,
+    eventNext_respondsToStopRequests_afterProducingElements) {
+  event evt;
+
+  unifex::inplace_stop_source stopSource;
+
+  evt.set();
+
+  auto adapt = [&] {
+    return unifex::next_adapt_stream(
+        evt.stream(), [&stopSource](auto&& next) noexcept {
+          return unifex::with_query_value(
+              std::move(next), unifex::get_stop_token, stopSource.get_token());
+        });
+  };
+
+  auto result = unifex::sync_wait(
+      unifex::reduce_stream(adapt(), 0, [&](int count) noexcept {
+        if (count < 2) {
+          evt.set();
+        } else {
+          stopSource.request_stop();
+        }
+        return ++count;
+      }));
+
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, 3);
+}
+
+TEST_F(AsyncAutoResetEventV2Tests, nextWrappedInStopWhen_doesNotCancelTheStream) {
+  event evt;
+  auto stream = evt.stream();
+
+  auto consumeOneEvent = [&] {
+    evt.set();
+    auto ret = unifex::sync_wait(
+        unifex::stop_when(unifex::next(stream), unifex::stop_on_request()));
+
+    return ret.has_value();
+  };
+
+  ASSERT_TRUE(consumeOneEvent());
+  ASSERT_TRUE(consumeOneEvent());
+
+  unifex::sync_wait(unifex::cleanup(stream));
+}
+
+TEST_F(AsyncAutoResetEventV2Tests, setDone_fromAnotherThread_wakesAWaitingNext) {
+  event evt;
+
+  std::thread producer([&] { evt.set_done(); });
+
+  auto result = countElements(evt.stream());
+  producer.join();
+
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, 0);
+}
+
+TEST_F(
+    AsyncAutoResetEventV2Tests,
+    setFromAnotherThread_producesOneElementPerHandshake) {
+  // The producer waits for each element to be consumed before setting
+  // the event again, so no set() is coalesced with another.
+  constexpr int iterations = 1000;
+  event evt;
+  std::atomic<int> consumed{0};
+
+  std::thread producer([&] {
+    for (int i = 0; i < iterations; ++i) {
+      while (consumed.load(std::memory_order_acquire) != i) {
+        std::this_thread::yield();
+      }
+      evt.set();
+    }
+    while (consumed.load(std::memory_order_acquire) != iterations) {
+      std::this_thread::yield();
+    }
+    evt.set_done();
+  });
+
+  auto result = unifex::sync_wait(
+      unifex::reduce_stream(evt.stream(), 0, [&](int count) noexcept {
+        consumed.store(count + 1, std::memory_order_release);
+        return count + 1;
+      }));
+  producer.join();
+
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, iterations);
+}
+
+TEST_F(AsyncAutoResetEventV2Tests, concurrentSets_coalesceIntoFewerElements) {
+  constexpr int iterations = 1000;
+  event evt;
+
+  std::thread producer([&] {
+    for (int i = 0; i < iterations; ++i) {
+      evt.set();
+    }
+    evt.set_done();
+  });
+
+  auto result = countElements(evt.stream());
+  producer.join();
+
+  ASSERT_TRUE(result);
+  EXPECT_LE(*result, iterations);
+}
+
+TEST_F(AsyncAutoResetEventV2Tests, concurrentSetAndStop_completeNextOnce) {
+  // Races set() against a stop request; next() must complete exactly
+  // once, with either a value or done.
+  for (int i = 0; i < 100; ++i) {
+    event evt;
+    unifex::inplace_stop_source stopSource;
+    auto stream = evt.stream();
+
+    std::thread setter([&] { evt.set(); });
+    std::thread canceller([&] { stopSource.request_stop(); });
+
+    unifex::sync_wait(unifex::with_query_value(
+        unifex::next(stream), unifex::get_stop_token, stopSource.get_token()));
+
+    setter.join();
+    canceller.join();
+
+    evt.set_done();
+    EXPECT_EQ(countElements(stream).value(), 0);
+  }
+}
@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unifex/coroutine.hpp>
+
+#if !UNIFEX_NO_COROUTINES
+
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/just.hpp>
+#  include <unifex/let_done.hpp>
+#  include <unifex/reduce_stream.hpp>
+#  include <unifex/scheduler_concepts.hpp>
+#  include <unifex/static_thread_pool.hpp>
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/task.hpp>
+#  include <unifex/then.hpp>
+#  include <unifex/v2/async_channel.hpp>
+#  include <unifex/when_all.hpp>
+#  include <unifex/with_query_value.hpp>
+
+#  include "async_primitive_helpers.hpp"
+
+#  include <atomic>
+#  include <memory>
+#  include <string>
+
+#  include <gtest/gtest.h>
+
+using namespace unifex;
+using v2::async_channel;
+using unifex_test::cancelled_as;
+using unifex_test::yield;
+
+TEST(async_channel, try_send_and_try_receive_are_fifo_and_bounded) {
+  async_channel<int> channel{2};
+  EXPECT_EQ(channel.capacity(), 2u);
+  EXPECT_TRUE(channel.try_send(1));
+  EXPECT_TRUE(channel.try_send(2));
+  EXPECT_FALSE(channel.try_send(3));
+  EXPECT_EQ(channel.try_receive(), 1);
+  EXPECT_TRUE(channel.try_send(3));
+  EXPECT_EQ(channel.try_receive(), 2);
+  EXPECT_EQ(channel.try_receive(), 3);
+  EXPECT_EQ(channel.try_receive(), std::nullopt);
+}
+
+TEST(async_channel, failed_try_send_keeps_the_value) {
+  async_channel<std::unique_ptr<int>> channel{1};
+  auto first = std::make_unique<int>(1);
+  auto second = std::make_unique<int>(2);
+  EXPECT_TRUE(channel.try_send(std::move(first)));
+  EXPECT_FALSE(channel.try_send(std::move(second)));
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ(*second, 2);
+  EXPECT_EQ(**channel.try_receive(), 1);
+}
+
+TEST(async_channel, receive_waits_for_send) {
+  async_channel<std::string> channel{1};
+  std::string log;
+
+  sync_wait(when_all(
+      [&]() -> task<void> {
+        log += co_await channel.async_receive();
+        log += co_await channel.async_receive();
+      }(),
+      [&]() -> task<void> {
+        co_await yield();
+        EXPECT_EQ(log, "");
+        co_await channel.async_send("a");
+        co_await yield();
+        EXPECT_EQ(log, "a");
+        co_await channel.async_send("b");
+      }()));
+
+  EXPECT_EQ(log, "ab");
+}
+
+TEST(async_channel, send_waits_for_room) {
+  async_channel<int> channel{1};
+  std::string log;
+
+  sync_wait(when_all(
+      [&]() -> task<void> {
+        co_await channel.async_send(1);
+        log += 'a';
+        co_await channel.async_send(2);
+        log += 'b';
+        co_await channel.async_send(3);
+        log += 'c';
+      }(),
+      [&]() -> task<void> {
+        co_await yield();
+        EXPECT_EQ(log, "a");
+        EXPECT_EQ(co_await channel.async_receive(), 1);
+        co_await yield();
+        EXPECT_EQ(log, "ab");
+        EXPECT_EQ(co_await channel.async_receive(), 2);
+        EXPECT_EQ(co_await channel.async_receive(), 3);
+      }()));
+
+  EXPECT_EQ(log, "abc");
+}
+
+TEST(async_channel, close_drains_buffered_values_then_completes_with_done) {
+  async_channel<int> channel{4};
+  bool sendCancelled = false;
+  bool receiveCancelled = false;
+
+  EXPECT_TRUE(channel.try_send(1));
+  EXPECT_TRUE(channel.try_send(2));
+  channel.close();
+  EXPECT_TRUE(channel.is_closed());
+  EXPECT_FALSE(channel.try_send(3));
+
+  sync_wait(channel.async_send(4) | cancelled_as(sendCancelled));
+  EXPECT_TRUE(sendCancelled);
+
+  EXPECT_EQ(sync_wait(channel.async_receive()), 1);
+  EXPECT_EQ(sync_wait(channel.async_receive()), 2);
+  sync_wait(
+      channel.async_receive() | then([](int) {}) |
+      cancelled_as(receiveCancelled));
+  EXPECT_TRUE(receiveCancelled);
+}
+
+TEST(async_channel, close_wakes_queued_senders_and_receivers) {
+  async_channel<int> full{1};
+  async_channel<int> empty{1};
+  bool sendCancelled = false;
+  bool receiveCancelled = false;
+
+  EXPECT_TRUE(full.try_send(1));
+  sync_wait(when_all(
+      full.async_send(2) | cancelled_as(sendCancelled),
+      empty.async_receive() | then([](int) {}) |
+          cancelled_as(receiveCancelled),
+      [&]() -> task<void> {
+        co_await yield();
+        EXPECT_FALSE(sendCancelled);
+        EXPECT_FALSE(receiveCancelled);
+        full.close();
+        empty.close();
+      }()));
+
+  EXPECT_TRUE(sendCancelled);
+  EXPECT_TRUE(receiveCancelled);
+  // The cancelled send never made it into the channel.
+  EXPECT_EQ(full.try_receive(), 1);
+  EXPECT_EQ(full.try_receive(), std::nullopt);
+}
+
+TEST(async_channel, cancelling_a_send_leaves_the_channel_usable) {
+  async_channel<int> channel{1};
+  inplace_stop_source stopSource;
+  bool cancelled = false;
+
+  EXPECT_TRUE(channel.try_send(1));
+  sync_wait(when_all(
+      with_query_value(
+          channel.async_send(2) | cancelled_as(cancelled),
+          get_stop_token,
+          stopSource.get_token()),
+      [&]() -> task<void> {
+        co_await yield();
+        stopSource.request_stop();
+        co_await yield();
+        EXPECT_EQ(co_await channel.async_receive(), 1);
+        co_await channel.async_send(3);
+        EXPECT_EQ(co_await channel.async_receive(), 3);
+      }()));
+
+  EXPECT_TRUE(cancelled);
+  EXPECT_EQ(channel.try_receive(), std::nullopt);
+}
+
+TEST(async_channel, cancelling_a_receive_does_not_lose_values) {
+  async_channel<int> channel{1};
+  inplace_stop_source stopSource;
+  bool cancelled = false;
+  int received = 0;
+
+  sync_wait(when_all(
+      with_query_value(
+          channel.async_receive() | then([](int) {}) |
+              cancelled_as(cancelled),
+          get_stop_token,
+          stopSource.get_token()),
+      [&]() -> task<void> { received = co_await channel.async_receive(); }(),
+      [&]() -> task<void> {
+        co_await yield();
+        stopSource.request_stop();
+        co_await yield();
+        co_await channel.async_send(42);
+      }()));
+
+  EXPECT_TRUE(cancelled);
+  EXPECT_EQ(received, 42);
+}
+
+TEST(async_channel, stream_yields_values_until_closed) {
+  async_channel<int> channel{2};
+
+  int sum = 0;
+
+  sync_wait(when_all(
+      reduce_stream(
+          channel.stream(),
+          0,
+          [](int acc, int value) noexcept { return acc + value; }) |
+          then([&](int result) noexcept { sum = result; }),
+      [&]() -> task<void> {
+        for (int i = 1; i <= 10; ++i) {
+          co_await channel.async_send(i);
+        }
+        channel.close();
+      }()));
+
+  EXPECT_EQ(sum, 55);
+}
+
+TEST(async_channel, mpmc_across_a_thread_pool) {
+  constexpr int producers = 4;
+  constexpr int perProducer = 5'000;
+  async_channel<int> channel{8};
+  static_thread_pool pool{4};
+  std::atomic<long> sum{0};
+  std::atomic<int> count{0};
+  std::atomic<int> producersLeft{producers};
+
+  auto producer = [&](int id) -> task<void> {
+    co_await schedule(pool.get_scheduler());
+    for (int i = 0; i < perProducer; ++i) {
+      co_await channel.async_send(id * perProducer + i);
+    }
+    if (producersLeft.fetch_sub(1) == 1) {
+      channel.close();
+    }
+  };
+
+  auto consumer = [&]() -> task<void> {
+    co_await schedule(pool.get_scheduler());
+    while (auto value = co_await let_done(
+               channel.async_receive() |
+                   then([](int v) { return std::optional<int>{v}; }),
+               [] { return just(std::optional<int>{}); })) {
+      sum.fetch_add(*value);
+      count.fetch_add(1);
+    }
+  };
+
+  sync_wait(when_all(
+      when_all(producer(0), producer(1), producer(2), producer(3)),
+      when_all(consumer(), consumer(), consumer(), consumer())));
+
+  constexpr long total = long{producers} * perProducer;
+  EXPECT_EQ(count.load(), total);
+  EXPECT_EQ(sum.load(), total * (total - 1) / 2);
+}
+
+TEST(async_channel, try_send_racing_close_is_received_or_rejected) {
+  for (int round = 0; round < 200; ++round) {
+    async_channel<int> channel{64};
+    static_thread_pool pool{3};
+    std::atomic<int> sent{0};
+    std::atomic<int> received{0};
+
+    auto producer = [&]() -> task<void> {
+      co_await schedule(pool.get_scheduler());
+      for (int i = 0; i < 32; ++i) {
+        if (channel.try_send(int{i})) {
+          sent.fetch_add(1);
+        }
+      }
+    };
+
+    auto closer = [&]() -> task<void> {
+      co_await schedule(pool.get_scheduler());
+      channel.close();
+    };
+
+    auto consumer = [&]() -> task<void> {
+      co_await schedule(pool.get_scheduler());
+      while (co_await let_done(
+          channel.async_receive() | then([](int) noexcept { return true; }),
+          [] { return just(false); })) {
+        received.fetch_add(1);
+      }
+    };
+
+    sync_wait(when_all(producer(), closer(), consumer()));
+
+    EXPECT_EQ(received.load(), sent.load());
+  }
+}
+
+#endif  // !UNIFEX_NO_COROUTINES
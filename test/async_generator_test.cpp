@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unifex/coroutine.hpp>
+
+#if !UNIFEX_NO_COROUTINES
+
+#  include <unifex/async_generator.hpp>
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/just.hpp>
+#  include <unifex/let_done.hpp>
+#  include <unifex/reduce_stream.hpp>
+#  include <unifex/scheduler_concepts.hpp>
+#  include <unifex/single_thread_context.hpp>
+#  include <unifex/stop_if_requested.hpp>
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/task.hpp>
+#  include <unifex/with_query_value.hpp>
+
+#  include <cstddef>
+#  include <cstdlib>
+#  include <memory>
+#  include <stdexcept>
+#  include <string>
+#  include <thread>
+#  include <vector>
+
+#  include <gtest/gtest.h>
+
+using namespace unifex;
+
+namespace {
+async_generator<int> count_to(int n) {
+  for (int i = 0; i < n; ++i) {
+    co_yield i;
+  }
+}
+
+auto sum = [](long long state, int value) {
+  return state + value;
+};
+
+// Neither copyable nor movable, so it can only be yielded by reference.
+struct pinned {
+  explicit pinned(int value) noexcept : value_(value) {}
+  pinned(pinned&&) = delete;
+
+  int value_;
+};
+
+struct destructor_counter {
+  int* count_;
+  ~destructor_counter() { ++*count_; }
+};
+
+struct allocator_stats {
+  std::size_t allocations_{0};
+  std::size_t deallocations_{0};
+};
+
+template <typename T>
+struct counting_allocator {
+  using value_type = T;
+
+  explicit counting_allocator(allocator_stats* stats) noexcept
+    : stats_(stats) {}
+
+  template <typename U>
+  counting_allocator(const counting_allocator<U>& other) noexcept
+    : stats_(other.stats_) {}
+
+  T* allocate(std::size_t n) {
+    ++stats_->allocations_;
+    return static_cast<T*>(std::malloc(n * sizeof(T)));
+  }
+
+  void deallocate(T* p, std::size_t) noexcept {
+    ++stats_->deallocations_;
+    std::free(p);
+  }
+
+  friend bool
+  operator==(const counting_allocator& a, const counting_allocator& b) {
+    return a.stats_ == b.stats_;
+  }
+  friend bool
+  operator!=(const counting_allocator& a, const counting_allocator& b) {
+    return !(a == b);
+  }
+
+  allocator_stats* stats_;
+};
+
+template <typename Allocator>
+async_generator<int> count_to(std::allocator_arg_t, Allocator, int n) {
+  for (int i = 0; i < n; ++i) {
+    co_yield i;
+  }
+}
+}  // namespace
+
+TEST(async_generator, ReduceStream) {
+  EXPECT_EQ(sync_wait(reduce_stream(count_to(10), 0LL, sum)), 45);
+}
+
+TEST(async_generator, EmptyGenerator) {
+  EXPECT_EQ(sync_wait(reduce_stream(count_to(0), 0LL, sum)), 0);
+}
+
+TEST(async_generator, SynchronousConsumerDoesNotGrowTheStack) {
+  // reduce_stream() asks for the next value from within set_value().
+  constexpr int n = 200'000;
+  EXPECT_EQ(
+      sync_wait(reduce_stream(count_to(n), 0LL, sum)),
+      static_cast<long long>(n) * (n - 1) / 2);
+}
+
+TEST(async_generator, AwaitNextFromTask) {
+  auto consume = []() -> task<std::vector<int>> {
+    auto gen = count_to(3);
+    std::vector<int> values;
+    for (int i = 0; i < 3; ++i) {
+      values.push_back(co_await next(gen));
+    }
+    co_await let_done(cleanup(gen), [] { return just(); });
+    co_return values;
+  };
+  EXPECT_EQ(sync_wait(consume()), (std::vector<int>{0, 1, 2}));
+}
+
+TEST(async_generator, AwaitingFinishedGeneratorCompletesTaskWithDone) {
+  auto consume = []() -> task<int> {
+    auto gen = count_to(2);
+    int count = 0;
+    while (true) {
+      co_await next(gen);
+      ++count;
+    }
+  };
+  EXPECT_FALSE(sync_wait(consume()).has_value());
+}
+
+TEST(async_generator, YieldsLvaluesByReference) {
+  pinned first{1};
+  pinned second{2};
+  auto gen = [](pinned& a, pinned& b) -> async_generator<pinned> {
+    co_yield a;
+    co_yield b;
+  }(first, second);
+
+  auto consume = [&]() -> task<void> {
+    pinned& a = co_await next(gen);
+    EXPECT_EQ(&a, &first);
+    pinned& b = co_await next(gen);
+    EXPECT_EQ(&b, &second);
+    ++b.value_;
+  };
+  sync_wait(consume());
+  EXPECT_EQ(second.value_, 3);
+}
+
+TEST(async_generator, YieldedTemporariesLiveUntilNextValueIsRequested) {
+  auto gen = []() -> async_generator<const std::string&> {
+    co_yield std::string(32, 'a');
+    std::string local(32, 'b');
+    co_yield local;
+    co_yield "converted";
+  }();
+
+  auto consume = [&]() -> task<std::vector<std::string>> {
+    std::vector<std::string> values;
+    for (int i = 0; i < 3; ++i) {
+      const std::string& value = co_await next(gen);
+      values.push_back(value);
+    }
+    co_return values;
+  };
+  EXPECT_EQ(
+      sync_wait(consume()),
+      (std::vector<std::string>{
+          std::string(32, 'a'), std::string(32, 'b'), "converted"}));
+}
+
+#  if !UNIFEX_NO_EXCEPTIONS
+TEST(async_generator, ExceptionCompletesNextWithError) {
+  auto gen = []() -> async_generator<int> {
+    co_yield 1;
+    throw std::runtime_error("failed");
+  };
+  EXPECT_THROW(
+      sync_wait(reduce_stream(gen(), 0LL, sum)), std::runtime_error);
+}
+
+TEST(async_generator, AwaitedExceptionIsRethrown) {
+  auto consume = []() -> task<int> {
+    auto gen = []() -> async_generator<int> {
+      co_yield 1;
+      throw std::runtime_error("failed");
+    }();
+    int value = co_await next(gen);
+    try {
+      co_await next(gen);
+    } catch (const std::runtime_error&) {
+      co_return value;
+    }
+    co_return -1;
+  };
+  EXPECT_EQ(sync_wait(consume()), 1);
+}
+#  endif  // !UNIFEX_NO_EXCEPTIONS
+
+TEST(async_generator, CleanupDestroysSuspendedGenerator) {
+  int destroyed = 0;
+  auto gen = [](int* destroyed) -> async_generator<int> {
+    destructor_counter counter{destroyed};
+    for (int i = 0;; ++i) {
+      co_yield i;
+    }
+  }(&destroyed);
+
+  auto consume = [&]() -> task<int> {
+    int value = co_await next(gen);
+    EXPECT_EQ(destroyed, 0);
+    co_await let_done(cleanup(gen), [] { return just(); });
+    co_return value;
+  };
+  EXPECT_EQ(sync_wait(consume()), 0);
+  EXPECT_EQ(destroyed, 1);
+}
+
+TEST(async_generator, AwaitsResumeOnConsumersScheduler) {
+  single_thread_context other;
+  auto gen = [](auto scheduler) -> async_generator<std::thread::id> {
+    for (int i = 0; i < 3; ++i) {
+      co_await schedule(scheduler);
+      co_yield std::this_thread::get_id();
+    }
+  }(other.get_scheduler());
+
+  auto threads = sync_wait(reduce_stream(
+      std::move(gen),
+      std::vector<std::thread::id>{},
+      [](std::vector<std::thread::id> ids, std::thread::id id) {
+        ids.push_back(id);
+        return ids;
+      }));
+  ASSERT_TRUE(threads.has_value());
+  EXPECT_EQ(
+      *threads, std::vector<std::thread::id>(3, std::this_thread::get_id()));
+}
+
+TEST(async_generator, StopRequestReachesGenerator) {
+  inplace_stop_source stopSource;
+  auto gen = []() -> async_generator<int> {
+    for (int i = 0;; ++i) {
+      co_await stop_if_requested();
+      co_yield i;
+    }
+  };
+  auto result = sync_wait(with_query_value(
+      reduce_stream(
+          gen(),
+          0LL,
+          [&](long long state, int value) {
+            if (value == 4) {
+              stopSource.request_stop();
+            }
+            return state + value;
+          }),
+      get_stop_token,
+      stopSource.get_token()));
+  EXPECT_EQ(result, 10);
+}
+
+TEST(async_generator, FrameComesFromAllocatorArgument) {
+  allocator_stats stats;
+  counting_allocator<std::byte> alloc{&stats};
+
+  EXPECT_EQ(
+      sync_wait(
+          reduce_stream(count_to(std::allocator_arg, alloc, 1000), 0LL, sum)),
+      499500);
+  EXPECT_EQ(stats.allocations_, 1u);
+  EXPECT_EQ(stats.deallocations_, 1u);
+}
+
+TEST(async_generator, UnstartedGeneratorReturnsFrame) {
+  allocator_stats stats;
+  counting_allocator<std::byte> alloc{&stats};
+  {
+    auto gen = count_to(std::allocator_arg, alloc, 3);
+    EXPECT_EQ(stats.allocations_, 1u);
+  }
+  EXPECT_EQ(stats.deallocations_, 1u);
+}
+
+#endif  // !UNIFEX_NO_COROUTINES
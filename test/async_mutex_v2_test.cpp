@@ -35,6 +35,25 @@
 using namespace unifex;
 using v2::async_mutex;
 
+// Reproduces the window in which a waiter has been queued but locked_ is
+// false: after start() pushes the waiter and before it tries locked_, or
+// after process_queue() releases locked_ and before it re-checks the queue.
+namespace unifex::v2 {
+struct async_mutex_test_access {
+  static void open_window(async_mutex& mutex) noexcept {
+    mutex.locked_.store(false);
+  }
+
+  // What start() or process_queue() does once the window closes.
+  static void close_window(async_mutex& mutex) noexcept {
+    if (!mutex.locked_.exchange(true)) {
+      mutex.process_queue();
+    }
+  }
+};
+}  // namespace unifex::v2
+using v2::async_mutex_test_access;
+
 TEST(async_mutex_v2, multiple_threads) {
 #  if !defined(UNIFEX_TEST_LIMIT_ASYNC_MUTEX_ITERATIONS)
   constexpr int iterations = 100'000;
@@ -65,6 +84,36 @@ TEST(async_mutex_v2, multiple_threads) {
   EXPECT_EQ(2 * iterations, sharedState);
 }
 
+TEST(async_mutex_v2, handoff_multiple_threads) {
+#  if !defined(UNIFEX_TEST_LIMIT_ASYNC_MUTEX_ITERATIONS)
+  constexpr int iterations = 100'000;
+#  else
+  constexpr int iterations = UNIFEX_TEST_LIMIT_ASYNC_MUTEX_ITERATIONS;
+#  endif
+
+  async_mutex mutex{async_mutex::fairness::handoff};
+
+  int sharedState = 0;
+
+  auto makeTask = [&](manual_event_loop::scheduler scheduler) -> task<int> {
+    for (int i = 0; i < iterations; ++i) {
+      co_await mutex.async_lock();
+      co_await schedule(scheduler);
+      ++sharedState;
+      mutex.unlock();
+    }
+    co_return 0;
+  };
+
+  single_thread_context ctx1;
+  single_thread_context ctx2;
+
+  sync_wait(
+      when_all(makeTask(ctx1.get_scheduler()), makeTask(ctx2.get_scheduler())));
+
+  EXPECT_EQ(2 * iterations, sharedState);
+}
+
 TEST(async_mutex_v2, try_lock_succeeds_when_unlocked) {
   async_mutex mutex;
   ASSERT_TRUE(mutex.try_lock());
@@ -312,6 +361,69 @@ TEST_F(async_mutex_v2_test, try_lock_then_async_lock_waiter) {
   EXPECT_TRUE(waiter_acquired);
 }
 
+TEST(async_mutex_v2, unlock_hands_ownership_to_queued_waiter) {
+  for (auto fairness :
+       {async_mutex::fairness::barging, async_mutex::fairness::handoff}) {
+    async_mutex mutex{fairness};
+    async_manual_reset_event queued;
+    async_manual_reset_event checked;
+    ASSERT_TRUE(mutex.try_lock());
+
+    sync_wait(when_all(
+        [&]() -> task<void> {
+          queued.set();
+          co_await mutex.async_lock();
+          co_await checked.async_wait();
+          mutex.unlock();
+        }(),
+        [&]() -> task<void> {
+          co_await queued.async_wait();
+          mutex.unlock();
+          // The waiter owns the mutex now, whether or not it has been
+          // resumed yet.
+          EXPECT_FALSE(mutex.try_lock());
+          checked.set();
+        }()));
+
+    ASSERT_TRUE(mutex.try_lock());
+    mutex.unlock();
+  }
+}
+
+TEST(async_mutex_v2, try_lock_overtakes_queued_waiter_only_when_barging) {
+  for (auto fairness :
+       {async_mutex::fairness::barging, async_mutex::fairness::handoff}) {
+    const bool handoff = fairness == async_mutex::fairness::handoff;
+    async_mutex mutex{fairness};
+    bool waiterAcquired = false;
+    ASSERT_TRUE(mutex.try_lock());
+
+    sync_wait(when_all(
+        [&]() -> task<void> {
+          co_await mutex.async_lock();
+          waiterAcquired = true;
+          mutex.unlock();
+        }(),
+        [&]() -> task<void> {
+          // The waiter is queued behind the try_lock() above.
+          async_mutex_test_access::open_window(mutex);
+          const bool overtook = mutex.try_lock();
+          EXPECT_EQ(overtook, !handoff);
+          EXPECT_FALSE(waiterAcquired);
+          if (overtook) {
+            mutex.unlock();
+          } else {
+            async_mutex_test_access::close_window(mutex);
+          }
+          co_return;
+        }()));
+
+    EXPECT_TRUE(waiterAcquired);
+    ASSERT_TRUE(mutex.try_lock());
+    mutex.unlock();
+  }
+}
+
 TEST_F(async_mutex_v2_test, dekker_pattern) {
   // Exercises Dekker lost-wakeup prevention: holder unlocks on a
   // separate thread while the waiter enqueues, creating a tight race
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <unifex/coroutine.hpp>
+
+#if !UNIFEX_NO_COROUTINES
+
+#  include <unifex/just.hpp>
+#  include <unifex/let_done.hpp>
+#  include <unifex/scheduler_concepts.hpp>
+#  include <unifex/task.hpp>
+
+namespace unifex_test {
+
+using namespace unifex;
+
+// Lets everything already queued on the current run loop go first.
+inline task<void> yield(int times = 4) {
+  for (int i = 0; i < times; ++i) {
+    co_await schedule();
+  }
+}
+
+// Turns done into a value, setting 'cancelled' if it was done.
+inline auto cancelled_as(bool& cancelled) {
+  cancelled = false;
+  return let_done([&cancelled]() {
+    cancelled = true;
+    return just();
+  });
+}
+
+}  // namespace unifex_test
+
+#endif  // !UNIFEX_NO_COROUTINES
@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unifex/coroutine.hpp>
+
+#if !UNIFEX_NO_COROUTINES
+
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/scheduler_concepts.hpp>
+#  include <unifex/single_thread_context.hpp>
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/task.hpp>
+#  include <unifex/v2/async_semaphore.hpp>
+#  include <unifex/when_all.hpp>
+#  include <unifex/with_query_value.hpp>
+
+#  include "async_primitive_helpers.hpp"
+
+#  include <algorithm>
+#  include <atomic>
+#  include <string>
+
+#  include <gtest/gtest.h>
+
+using namespace unifex;
+using v2::async_semaphore;
+using unifex_test::cancelled_as;
+using unifex_test::yield;
+
+TEST(async_semaphore, try_acquire_takes_available_units) {
+  async_semaphore sem{2};
+  EXPECT_TRUE(sem.try_acquire());
+  EXPECT_TRUE(sem.try_acquire());
+  EXPECT_FALSE(sem.try_acquire());
+  sem.release();
+  EXPECT_TRUE(sem.try_acquire());
+  sem.release(2);
+  EXPECT_EQ(sem.available(), 2u);
+}
+
+TEST(async_semaphore, try_acquire_n_is_all_or_nothing) {
+  async_semaphore sem{3};
+  EXPECT_FALSE(sem.try_acquire(4));
+  EXPECT_EQ(sem.available(), 3u);
+  EXPECT_TRUE(sem.try_acquire(3));
+  EXPECT_EQ(sem.available(), 0u);
+  sem.release(3);
+}
+
+TEST(async_semaphore, async_acquire_no_contention) {
+  async_semaphore sem{1};
+  bool acquired = false;
+  sync_wait([&]() -> task<void> {
+    co_await sem.async_acquire();
+    acquired = true;
+    EXPECT_FALSE(sem.try_acquire());
+    sem.release();
+  }());
+  EXPECT_TRUE(acquired);
+  EXPECT_EQ(sem.available(), 1u);
+}
+
+TEST(async_semaphore, release_wakes_waiters_in_order) {
+  async_semaphore sem{0};
+  std::string log;
+
+  auto waiter = [&](char name, std::size_t n) -> task<void> {
+    co_await sem.async_acquire(n);
+    log += name;
+  };
+
+  sync_wait(when_all(waiter('a', 1), waiter('b', 1), [&]() -> task<void> {
+    co_await yield();
+    EXPECT_EQ(log, "");
+    sem.release();
+    co_await yield();
+    EXPECT_EQ(log, "a");
+    sem.release();
+    co_await yield();
+    EXPECT_EQ(log, "ab");
+  }()));
+  EXPECT_EQ(sem.available(), 0u);
+}
+
+TEST(async_semaphore, large_request_blocks_smaller_ones_behind_it) {
+  async_semaphore sem{0};
+  std::string log;
+
+  auto waiter = [&](char name, std::size_t n) -> task<void> {
+    co_await sem.async_acquire(n);
+    log += name;
+  };
+
+  sync_wait(when_all(waiter('a', 3), waiter('b', 1), [&]() -> task<void> {
+    co_await yield();
+    sem.release();
+    co_await yield();
+    // b must not overtake a, and try_acquire mustn't either.
+    EXPECT_EQ(log, "");
+    EXPECT_FALSE(sem.try_acquire());
+    sem.release(2);
+    co_await yield();
+    EXPECT_EQ(log, "a");
+    sem.release();
+    co_await yield();
+    EXPECT_EQ(log, "ab");
+  }()));
+}
+
+TEST(async_semaphore, cancelling_the_head_unblocks_waiters_behind_it) {
+  async_semaphore sem{0};
+  inplace_stop_source stopSource;
+  bool cancelled = false;
+  bool acquired = false;
+
+  sync_wait(when_all(
+      with_query_value(
+          sem.async_acquire(5) | cancelled_as(cancelled),
+          get_stop_token,
+          stopSource.get_token()),
+      [&]() -> task<void> {
+        co_await sem.async_acquire(1);
+        acquired = true;
+      }(),
+      [&]() -> task<void> {
+        co_await yield();
+        sem.release();
+        co_await yield();
+        EXPECT_FALSE(acquired);
+        stopSource.request_stop();
+        co_await yield();
+        EXPECT_TRUE(acquired);
+      }()));
+
+  EXPECT_TRUE(cancelled);
+  EXPECT_EQ(sem.available(), 0u);
+}
+
+TEST(async_semaphore, cancel_before_start_takes_nothing) {
+  async_semaphore sem{1};
+  inplace_stop_source stopSource;
+  stopSource.request_stop();
+  bool cancelled = false;
+
+  sync_wait(with_query_value(
+      sem.async_acquire() | cancelled_as(cancelled),
+      get_stop_token,
+      stopSource.get_token()));
+
+  EXPECT_TRUE(cancelled);
+  EXPECT_EQ(sem.available(), 1u);
+}
+
+TEST(async_semaphore, limits_concurrency_across_threads) {
+  constexpr int iterations = 10'000;
+  constexpr std::size_t limit = 2;
+  async_semaphore sem{limit};
+  std::atomic<std::size_t> inside{0};
+  std::atomic<std::size_t> maxInside{0};
+  std::atomic<int> total{0};
+
+  auto worker = [&](manual_event_loop::scheduler scheduler) -> task<void> {
+    for (int i = 0; i < iterations; ++i) {
+      co_await sem.async_acquire();
+      auto now = inside.fetch_add(1) + 1;
+      auto seen = maxInside.load();
+      while (now > seen && !maxInside.compare_exchange_weak(seen, now)) {
+      }
+      co_await schedule(scheduler);
+      total.fetch_add(1);
+      inside.fetch_sub(1);
+      sem.release();
+    }
+  };
+
+  single_thread_context ctx[4];
+  sync_wait(when_all(
+      worker(ctx[0].get_scheduler()),
+      worker(ctx[1].get_scheduler()),
+      worker(ctx[2].get_scheduler()),
+      worker(ctx[3].get_scheduler())));
+
+  EXPECT_EQ(total.load(), 4 * iterations);
+  EXPECT_LE(maxInside.load(), limit);
+  EXPECT_EQ(sem.available(), limit);
+}
+
+#endif  // UNIFEX_NO_COROUTINES
@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unifex/coroutine.hpp>
+
+#if !UNIFEX_NO_COROUTINES
+
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/scheduler_concepts.hpp>
+#  include <unifex/single_thread_context.hpp>
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/task.hpp>
+#  include <unifex/v2/async_shared_mutex.hpp>
+#  include <unifex/when_all.hpp>
+#  include <unifex/with_query_value.hpp>
+
+#  include "async_primitive_helpers.hpp"
+
+#  include <algorithm>
+#  include <atomic>
+#  include <string>
+
+#  include <gtest/gtest.h>
+
+using namespace unifex;
+using v2::async_shared_mutex;
+using unifex_test::cancelled_as;
+using unifex_test::yield;
+
+TEST(async_shared_mutex, readers_share_the_lock) {
+  async_shared_mutex mutex;
+  ASSERT_TRUE(mutex.try_lock_shared());
+  ASSERT_TRUE(mutex.try_lock_shared());
+  EXPECT_FALSE(mutex.try_lock());
+  mutex.unlock_shared();
+  EXPECT_FALSE(mutex.try_lock());
+  mutex.unlock_shared();
+  ASSERT_TRUE(mutex.try_lock());
+  mutex.unlock();
+}
+
+TEST(async_shared_mutex, writer_excludes_everyone) {
+  async_shared_mutex mutex;
+  ASSERT_TRUE(mutex.try_lock());
+  EXPECT_FALSE(mutex.try_lock());
+  EXPECT_FALSE(mutex.try_lock_shared());
+  mutex.unlock();
+  ASSERT_TRUE(mutex.try_lock_shared());
+  mutex.unlock_shared();
+}
+
+TEST(async_shared_mutex, async_lock_no_contention) {
+  async_shared_mutex mutex;
+  sync_wait([&]() -> task<void> {
+    co_await mutex.async_lock_shared();
+    co_await mutex.async_lock_shared();
+    mutex.unlock_shared();
+    mutex.unlock_shared();
+    co_await mutex.async_lock();
+    EXPECT_FALSE(mutex.try_lock_shared());
+    mutex.unlock();
+  }());
+  ASSERT_TRUE(mutex.try_lock());
+  mutex.unlock();
+}
+
+TEST(async_shared_mutex, queued_writer_goes_before_later_readers) {
+  async_shared_mutex mutex;
+  std::string log;
+  ASSERT_TRUE(mutex.try_lock_shared());
+
+  sync_wait(when_all(
+      [&]() -> task<void> {
+        co_await mutex.async_lock();
+        log += 'w';
+        co_await yield();
+        mutex.unlock();
+      }(),
+      [&]() -> task<void> {
+        co_await yield(1);
+        // A writer is queued, so new readers wait behind it.
+        EXPECT_FALSE(mutex.try_lock_shared());
+        co_await mutex.async_lock_shared();
+        log += 'r';
+        mutex.unlock_shared();
+      }(),
+      [&]() -> task<void> {
+        co_await yield();
+        EXPECT_EQ(log, "");
+        mutex.unlock_shared();
+      }()));
+
+  EXPECT_EQ(log, "wr");
+}
+
+TEST(async_shared_mutex, queued_readers_are_admitted_together) {
+  async_shared_mutex mutex;
+  std::atomic<int> inside{0};
+  int maxInside = 0;
+  ASSERT_TRUE(mutex.try_lock());
+
+  auto reader = [&]() -> task<void> {
+    co_await mutex.async_lock_shared();
+    maxInside = std::max(maxInside, ++inside);
+    co_await yield();
+    --inside;
+    mutex.unlock_shared();
+  };
+
+  sync_wait(when_all(reader(), reader(), reader(), [&]() -> task<void> {
+    co_await yield();
+    mutex.unlock();
+  }()));
+
+  EXPECT_EQ(maxInside, 3);
+}
+
+TEST(async_shared_mutex, cancelling_queued_writer_admits_readers) {
+  async_shared_mutex mutex;
+  inplace_stop_source stopSource;
+  bool writerCancelled = false;
+  bool readerAcquired = false;
+  ASSERT_TRUE(mutex.try_lock_shared());
+
+  sync_wait(when_all(
+      with_query_value(
+          mutex.async_lock() | cancelled_as(writerCancelled),
+          get_stop_token,
+          stopSource.get_token()),
+      [&]() -> task<void> {
+        co_await yield(1);
+        co_await mutex.async_lock_shared();
+        readerAcquired = true;
+        mutex.unlock_shared();
+      }(),
+      [&]() -> task<void> {
+        co_await yield();
+        EXPECT_FALSE(readerAcquired);
+        stopSource.request_stop();
+        co_await yield();
+        // Admitted while the first reader still holds the lock.
+        EXPECT_TRUE(readerAcquired);
+        mutex.unlock_shared();
+      }()));
+
+  EXPECT_TRUE(writerCancelled);
+  ASSERT_TRUE(mutex.try_lock());
+  mutex.unlock();
+}
+
+TEST(async_shared_mutex, cancel_before_start_takes_nothing) {
+  async_shared_mutex mutex;
+  inplace_stop_source stopSource;
+  stopSource.request_stop();
+  bool cancelled = false;
+
+  sync_wait(with_query_value(
+      mutex.async_lock() | cancelled_as(cancelled),
+      get_stop_token,
+      stopSource.get_token()));
+
+  EXPECT_TRUE(cancelled);
+  ASSERT_TRUE(mutex.try_lock());
+  mutex.unlock();
+}
+
+TEST(async_shared_mutex, readers_and_writers_across_threads) {
+  constexpr int iterations = 5'000;
+  async_shared_mutex mutex;
+  std::atomic<int> readers{0};
+  std::atomic<int> writers{0};
+  std::atomic<bool> violated{false};
+  int sharedState = 0;
+
+  auto reader = [&](manual_event_loop::scheduler scheduler) -> task<void> {
+    for (int i = 0; i < iterations; ++i) {
+      co_await mutex.async_lock_shared();
+      ++readers;
+      if (writers.load() != 0) {
+        violated = true;
+      }
+      co_await schedule(scheduler);
+      --readers;
+      mutex.unlock_shared();
+    }
+  };
+
+  auto writer = [&](manual_event_loop::scheduler scheduler) -> task<void> {
+    for (int i = 0; i < iterations; ++i) {
+      co_await mutex.async_lock();
+      if (++writers != 1 || readers.load() != 0) {
+        violated = true;
+      }
+      co_await schedule(scheduler);
+      ++sharedState;
+      --writers;
+      mutex.unlock();
+    }
+  };
+
+  single_thread_context ctx[4];
+  sync_wait(when_all(
+      reader(ctx[0].get_scheduler()),
+      reader(ctx[1].get_scheduler()),
+      writer(ctx[2].get_scheduler()),
+      writer(ctx[3].get_scheduler())));
+
+  EXPECT_FALSE(violated.load());
+  EXPECT_EQ(sharedState, 2 * iterations);
+}
+
+#endif  // UNIFEX_NO_COROUTINES
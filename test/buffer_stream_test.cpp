@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/buffer_stream.hpp>
+
+#include <unifex/async_scope.hpp>
+#include <unifex/for_each.hpp>
+#include <unifex/range_stream.hpp>
+#include <unifex/reduce_stream.hpp>
+#include <unifex/single_thread_context.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/then.hpp>
+#include <unifex/timed_single_thread_context.hpp>
+#include <unifex/transform_stream.hpp>
+#include <unifex/via_stream.hpp>
+
+#include "slow_stream.hpp"
+
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+using namespace std::chrono_literals;
+using unifex_test::slow_stream;
+
+namespace {
+// Counts how many values have been pulled from 'inner_'.
+struct counting_stream {
+  range_stream inner_;
+  int& pulled_;
+
+  friend auto tag_invoke(tag_t<next>, counting_stream& s) {
+    return then(next(s.inner_), [&pulled = s.pulled_](int value) {
+      ++pulled;
+      return value;
+    });
+  }
+  friend auto tag_invoke(tag_t<cleanup>, counting_stream& s) {
+    return cleanup(s.inner_);
+  }
+};
+}  // namespace
+
+TEST(buffer_stream, Smoke) {
+  std::optional<int> result = sync_wait(
+      range_stream{0, 100} | buffer_stream(8) |
+      reduce_stream(0, [](int state, int value) { return state + value; }));
+
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(*result, 4950);
+}
+
+TEST(buffer_stream, ProducerOnAnotherThread) {
+  single_thread_context producer;
+  std::vector<int> values;
+
+  sync_wait(for_each(
+      buffer_stream(
+          via_stream(producer.get_scheduler(), range_stream{0, 1000}), 16),
+      [&](int value) { values.push_back(value); }));
+
+  ASSERT_EQ(values.size(), 1000u);
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(values[i], i);
+  }
+}
+
+TEST(buffer_stream, StopsPullingWhenFull) {
+  int pulled = 0;
+  auto stream = buffer_stream(counting_stream{range_stream{0, 100}, pulled}, 4);
+
+  std::optional<int> first = sync_wait(next(stream));
+  ASSERT_TRUE(first.has_value());
+  EXPECT_EQ(*first, 0);
+  // The value that was handed out, plus a full buffer behind it.
+  EXPECT_EQ(pulled, 5);
+
+  sync_wait(cleanup(stream));
+  EXPECT_EQ(pulled, 5);
+}
+
+TEST(buffer_stream, ForwardsErrorAfterBufferedValues) {
+  std::vector<int> values;
+  bool caughtError = false;
+
+  try {
+    sync_wait(for_each(
+        range_stream{0, 10} | transform_stream([](int value) {
+          if (value == 5) {
+            throw std::runtime_error{"five"};
+          }
+          return value;
+        }) | buffer_stream(8),
+        [&](int value) { values.push_back(value); }));
+  } catch (const std::runtime_error&) {
+    caughtError = true;
+  }
+
+  EXPECT_TRUE(caughtError);
+  EXPECT_EQ(values, (std::vector<int>{0, 1, 2, 3, 4}));
+}
+
+TEST(buffer_stream, CleanupCancelsPendingNext) {
+  timed_single_thread_context context;
+  int cleanups = 0;
+  auto stream =
+      buffer_stream(slow_stream{context.get_scheduler(), cleanups}, 4);
+
+  // Start the producer, then give up on the value.
+  bool gotValue = false;
+  async_scope scope;
+  scope.detached_spawn(
+      next(stream) | then([&](int) noexcept { gotValue = true; }));
+  sync_wait(scope.cleanup());
+  EXPECT_FALSE(gotValue);
+
+  auto start = std::chrono::steady_clock::now();
+  sync_wait(cleanup(stream));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 1min);
+  EXPECT_EQ(cleanups, 1);
+}
@@ -33,6 +33,7 @@
 
 #include <atomic>
 #include <memory>
+#include <thread>
 
 namespace {
 
@@ -105,6 +106,56 @@ struct test_opstate {
   bool& stopped_;
 };
 
+// Completes each op handed to it from its own thread, as soon as it
+// sees it.
+struct racing_completer {
+  struct op_base {
+    void (*complete_)(op_base*) noexcept;
+  };
+
+  racing_completer()
+    : thread_([this] {
+      while (!done_.load(std::memory_order_acquire)) {
+        if (auto* op = pending_.exchange(nullptr, std::memory_order_acq_rel)) {
+          op->complete_(op);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    }) {}
+
+  ~racing_completer() {
+    done_.store(true, std::memory_order_release);
+    thread_.join();
+  }
+
+  std::atomic<op_base*> pending_{nullptr};
+  std::atomic<bool> done_{false};
+  std::thread thread_;
+};
+
+template <typename Receiver>
+struct racing_opstate : racing_completer::op_base {
+  explicit racing_opstate(Receiver&& receiver, racing_completer& completer)
+    : op_base{[](op_base* base) noexcept {
+      auto* self = static_cast<racing_opstate*>(base);
+      if (try_complete(self)) {
+        set_value(std::move(self->receiver_), 1);
+      }
+    }}
+    , receiver_(std::forward<Receiver>(receiver))
+    , completer_(completer) {}
+
+  void start() noexcept {
+    completer_.pending_.store(this, std::memory_order_release);
+  }
+
+  void stop() noexcept {}
+
+  Receiver receiver_;
+  racing_completer& completer_;
+};
+
 struct test_inplace_sender {
   template <
       template <typename...> class Variant,
@@ -379,6 +430,32 @@ TEST(cancellable_lambda_test, event_probe_fields) {
   static_assert(_stop_probe::is_stop);
 }
 
+TEST(cancellable_test, completion_on_another_thread_racing_start) {
+  // The nested op completes on another thread right after it starts,
+  // and completing destroys the op, possibly while cancellable's
+  // start() is still running.  Best run under a sanitizer.
+  racing_completer completer;
+  async_scope scope;
+  std::atomic<int> completed{0};
+
+  for (int i = 0; i < 10'000; ++i) {
+    scope.detached_spawn(
+        cancellable{create_raw_sender<int>([&completer](auto&& receiver) {
+          return racing_opstate{
+              std::forward<decltype(receiver)>(receiver), completer};
+        })} |
+        then([&completed](int value) noexcept {
+          completed.fetch_add(value, std::memory_order_release);
+        }));
+    while (completed.load(std::memory_order_acquire) <= i) {
+      std::this_thread::yield();
+    }
+  }
+
+  sync_wait(scope.complete());
+  EXPECT_EQ(completed.load(), 10'000);
+}
+
 #  if defined(_MSC_VER)
 
 TEST(cancellable_test, recursive_pipeline) {
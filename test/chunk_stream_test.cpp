@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/chunk_stream.hpp>
+
+#include <unifex/delay.hpp>
+#include <unifex/for_each.hpp>
+#include <unifex/just.hpp>
+#include <unifex/merge_streams.hpp>
+#include <unifex/range_stream.hpp>
+#include <unifex/stop_when.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/then.hpp>
+#include <unifex/timed_single_thread_context.hpp>
+#include <unifex/transform_stream.hpp>
+
+#include "slow_stream.hpp"
+
+#include <chrono>
+#include <deque>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+using namespace std::chrono_literals;
+using unifex_test::slow_stream;
+
+TEST(chunk_stream, FullChunks) {
+  timed_single_thread_context context;
+  std::vector<std::vector<int>> chunks;
+
+  sync_wait(for_each(
+      chunk_stream(range_stream{0, 10}, context.get_scheduler(), 4, 1h),
+      [&](std::vector<int> chunk) { chunks.push_back(std::move(chunk)); }));
+
+  EXPECT_EQ(
+      chunks,
+      (std::vector<std::vector<int>>{{0, 1, 2, 3}, {4, 5, 6, 7}, {8, 9}}));
+}
+
+TEST(chunk_stream, FlushesAfterMaxDelay) {
+  timed_single_thread_context context;
+  std::vector<std::vector<int>> chunks;
+
+  // Values arrive far apart, so each chunk is sent before the next value.
+  sync_wait(for_each(
+      delay(range_stream{0, 3}, context.get_scheduler(), 50ms) |
+          chunk_stream(context.get_scheduler(), 100, 1ms),
+      [&](std::vector<int> chunk) { chunks.push_back(std::move(chunk)); }));
+
+  EXPECT_EQ(chunks, (std::vector<std::vector<int>>{{0}, {1}, {2}}));
+}
+
+TEST(chunk_stream, ErrorAfterPartialChunk) {
+  timed_single_thread_context context;
+  std::vector<std::vector<int>> chunks;
+  bool caughtError = false;
+
+  try {
+    sync_wait(for_each(
+        chunk_stream(
+            transform_stream(
+                range_stream{0, 5},
+                [](int value) {
+                  if (value == 3) {
+                    throw std::runtime_error{"three"};
+                  }
+                  return value;
+                }),
+            context.get_scheduler(),
+            10,
+            1h),
+        [&](std::vector<int> chunk) { chunks.push_back(std::move(chunk)); }));
+  } catch (const std::runtime_error&) {
+    caughtError = true;
+  }
+
+  EXPECT_TRUE(caughtError);
+  EXPECT_EQ(chunks, (std::vector<std::vector<int>>{{0, 1, 2}}));
+}
+
+TEST(chunk_stream, CleanupCancelsTimerAndNext) {
+  timed_single_thread_context context;
+  int cleanups = 0;
+  auto stream = chunk_stream(
+      merge_streams(
+          range_stream{0, 1}, slow_stream{context.get_scheduler(), cleanups}),
+      context.get_scheduler(),
+      4,
+      1h);
+
+  // Leaves a one-value chunk waiting on its timer and a next() outstanding
+  // on the slow stream.
+  EXPECT_FALSE(sync_wait(stop_when(next(stream), just())).has_value());
+
+  auto start = std::chrono::steady_clock::now();
+  sync_wait(cleanup(stream));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 1min);
+  EXPECT_EQ(cleanups, 1);
+}
+
+TEST(chunk_stream, CallerProvidedBuffers) {
+  timed_single_thread_context context;
+  int buffersMade = 0;
+  std::vector<std::deque<int>> chunks;
+
+  sync_wait(for_each(
+      chunk_stream(
+          range_stream{0, 5},
+          context.get_scheduler(),
+          2,
+          1h,
+          [&](std::size_t) {
+            ++buffersMade;
+            return std::deque<int>{};
+          }),
+      [&](std::deque<int> chunk) { chunks.push_back(std::move(chunk)); }));
+
+  EXPECT_EQ(buffersMade, 3);
+  EXPECT_EQ(chunks, (std::vector<std::deque<int>>{{0, 1}, {2, 3}, {4}}));
+}
@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_EPOLL && !UNIFEX_NO_EXCEPTIONS
+
+#  include <unifex/linux/io_epoll_context.hpp>
+
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/let_value.hpp>
+#  include <unifex/scheduler_concepts.hpp>
+#  include <unifex/socket_concepts.hpp>
+#  include <unifex/stop_when.hpp>
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/then.hpp>
+#  include <unifex/when_all.hpp>
+
+#  include <array>
+#  include <chrono>
+#  include <exception>
+#  include <future>
+#  include <cstring>
+#  include <system_error>
+#  include <thread>
+
+#  include <netinet/in.h>
+
+#  include <gtest/gtest.h>
+
+using namespace unifex;
+using namespace unifex::linuxos;
+using namespace std::chrono_literals;
+
+namespace {
+struct IOEpollTest : testing::Test {
+  ~IOEpollTest() {
+    stopSource_.request_stop();
+    t_.join();
+  }
+
+  io_epoll_context ctx_;
+  inplace_stop_source stopSource_;
+  std::thread t_{[&] {
+    ctx_.run(stopSource_.get_token());
+  }};
+};
+
+// Records when the operation completed with a value.
+struct completion_time_receiver {
+  std::promise<monotonic_clock::time_point>* completed_;
+
+  void set_value() && noexcept {
+    completed_->set_value(monotonic_clock::now());
+  }
+  void set_error(std::exception_ptr) && noexcept {
+    ADD_FAILURE() << "unexpected error";
+    completed_->set_value(monotonic_clock::time_point{});
+  }
+  void set_done() && noexcept {
+    ADD_FAILURE() << "unexpected done";
+    completed_->set_value(monotonic_clock::time_point{});
+  }
+};
+
+constexpr unsigned char data[6] = {'h', 'e', 'l', 'l', 'o', '\n'};
+
+sockaddr_in6 loopback(port_t port) {
+  sockaddr_in6 address = {};
+  address.sin6_family = AF_INET6;
+  address.sin6_port = htons(port);
+  address.sin6_addr = in6addr_loopback;
+  return address;
+}
+}  // namespace
+
+TEST_F(IOEpollTest, ReadWaitsForWrite) {
+  auto s = ctx_.get_scheduler();
+  auto [reader, writer] = open_pipe(s);
+
+  std::array<char, sizeof(data)> buffer{};
+  auto result = sync_wait(when_all(
+      async_read_some(reader, as_writable_bytes(span{buffer})),
+      // By the time the timer fires the read has found the pipe empty and
+      // is parked on the fd registration.
+      let_value(schedule_at(s, now(s) + 10ms), [&, &writer = writer] {
+        return async_write_some(writer, as_bytes(span{data}));
+      })));
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(
+      std::get<0>(std::get<0>(std::get<0>(*result))), ssize_t(sizeof(data)));
+  EXPECT_EQ(0, std::memcmp(buffer.data(), data, sizeof(data)));
+}
+
+TEST_F(IOEpollTest, RepeatedReadsReuseRegistration) {
+  auto s = ctx_.get_scheduler();
+  auto [reader, writer] = open_pipe(s);
+
+  for (int i = 0; i < 100; ++i) {
+    std::array<char, sizeof(data)> buffer{};
+    auto written = sync_wait(async_write_some(writer, as_bytes(span{data})));
+    ASSERT_TRUE(written.has_value());
+    auto read =
+        sync_wait(async_read_some(reader, as_writable_bytes(span{buffer})));
+    ASSERT_TRUE(read.has_value());
+    EXPECT_EQ(*read, ssize_t(sizeof(data)));
+  }
+}
+
+TEST_F(IOEpollTest, CancelParkedReadThenReadAgain) {
+  auto s = ctx_.get_scheduler();
+  auto [reader, writer] = open_pipe(s);
+
+  std::array<char, sizeof(data)> buffer{};
+  // Nothing is ever written, so the read parks until the timer cancels it.
+  auto cancelled = sync_wait(stop_when(
+      async_read_some(reader, as_writable_bytes(span{buffer})),
+      schedule_at(s, now(s) + 10ms)));
+  EXPECT_FALSE(cancelled.has_value());
+
+  // The registration must be usable again after the cancelled read left it.
+  ASSERT_TRUE(
+      sync_wait(async_write_some(writer, as_bytes(span{data}))).has_value());
+  auto read =
+      sync_wait(async_read_some(reader, as_writable_bytes(span{buffer})));
+  ASSERT_TRUE(read.has_value());
+  EXPECT_EQ(*read, ssize_t(sizeof(data)));
+}
+
+TEST_F(IOEpollTest, AcceptConnectAndEcho) {
+  auto s = ctx_.get_scheduler();
+  auto listener = open_listening_socket(s, 0);
+  auto address = loopback(listener.port());
+
+  auto connected = sync_wait(when_all(
+      listener.next(),
+      async_connect(
+          s,
+          reinterpret_cast<const sockaddr*>(&address),
+          socklen_t(sizeof(address)))));
+  ASSERT_TRUE(connected.has_value());
+  auto& server = std::get<0>(std::get<0>(std::get<0>(*connected)));
+  auto& client = std::get<0>(std::get<0>(std::get<1>(*connected)));
+
+  std::array<char, sizeof(data)> buffer{};
+  auto echoed = sync_wait(when_all(
+      async_write_some(client, as_bytes(span{data})),
+      let_value(
+          async_read_some(server, as_writable_bytes(span{buffer})),
+          [&](ssize_t bytesRead) {
+            return async_write_some(
+                server, as_bytes(span{buffer.data(), size_t(bytesRead)}));
+          })));
+  ASSERT_TRUE(echoed.has_value());
+
+  std::array<char, sizeof(data)> reply{};
+  auto read =
+      sync_wait(async_read_some(client, as_writable_bytes(span{reply})));
+  ASSERT_TRUE(read.has_value());
+  EXPECT_EQ(*read, ssize_t(sizeof(data)));
+  EXPECT_EQ(0, std::memcmp(reply.data(), data, sizeof(data)));
+}
+
+TEST_F(IOEpollTest, ConnectRefused) {
+  auto s = ctx_.get_scheduler();
+  port_t port;
+  {
+    // Grab a free port, then stop listening on it.
+    port = open_listening_socket(s, 0).port();
+  }
+  auto address = loopback(port);
+  try {
+    sync_wait(async_connect(
+        s,
+        reinterpret_cast<const sockaddr*>(&address),
+        socklen_t(sizeof(address))));
+    ADD_FAILURE() << "expected connect to fail";
+  } catch (const std::system_error& e) {
+    EXPECT_EQ(e.code(), std::errc::connection_refused);
+  }
+}
+
+TEST_F(IOEpollTest, ConnectWithOversizedAddressFailsWithEinval) {
+  auto s = ctx_.get_scheduler();
+  std::array<unsigned char, sizeof(sockaddr_storage) + 16> address = {};
+  try {
+    sync_wait(async_connect(
+        s,
+        reinterpret_cast<const sockaddr*>(address.data()),
+        socklen_t(address.size())));
+    ADD_FAILURE() << "expected connect to fail";
+  } catch (const std::system_error& e) {
+    EXPECT_EQ(e.code(), std::errc::invalid_argument);
+  }
+}
+
+TEST_F(IOEpollTest, TimerWithSlackCompletesWithEarlierTimer) {
+  auto s = ctx_.get_scheduler();
+  auto start = now(s);
+  monotonic_clock::time_point lazyDone, eagerDone;
+  // The OS timer is armed for the timer without slack; by then the lazy
+  // timer is due too and completes long before its latest time.
+  sync_wait(when_all(
+      s.schedule_at(start + 10ms, 500ms) |
+          then([&] { lazyDone = monotonic_clock::now(); }),
+      s.schedule_after(30ms) |
+          then([&] { eagerDone = monotonic_clock::now(); })));
+  EXPECT_GE(lazyDone - start, 10ms);
+  EXPECT_GE(eagerDone - start, 30ms);
+  EXPECT_LT(lazyDone - start, 250ms);
+}
+
+TEST_F(IOEpollTest, ScheduleAfterMeasuresDelayFromStart) {
+  auto s = ctx_.get_scheduler();
+  std::promise<monotonic_clock::time_point> completed;
+  auto op = unifex::connect(
+      s.schedule_after(50ms), completion_time_receiver{&completed});
+  std::this_thread::sleep_for(100ms);
+
+  auto start = monotonic_clock::now();
+  unifex::start(op);
+  EXPECT_GE(completed.get_future().get() - start, 50ms);
+}
+
+#endif  // !UNIFEX_NO_EPOLL && !UNIFEX_NO_EXCEPTIONS
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
+
+#  include <unifex/linux/aligned_buffer_pool.hpp>
+#  include <unifex/linux/io_uring_context.hpp>
+
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/sync_wait.hpp>
+
+#  include <algorithm>
+#  include <cstdint>
+#  include <new>
+#  include <optional>
+#  include <stdexcept>
+#  include <system_error>
+#  include <thread>
+
+#  include <unistd.h>
+
+#  include <gtest/gtest.h>
+
+using namespace unifex;
+using namespace unifex::linuxos;
+
+namespace {
+const char* const testFilePath = "io_uring_direct_io_test.dat";
+
+struct IOUringDirectIOTest : testing::Test {
+  ~IOUringDirectIOTest() {
+    stopSource_.request_stop();
+    t_.join();
+    ::unlink(testFilePath);
+  }
+
+  io_uring_context ctx_;
+  inplace_stop_source stopSource_;
+  std::thread t_{[&] {
+    ctx_.run(stopSource_.get_token());
+  }};
+};
+
+bool is_aligned(const void* p, std::size_t alignment) {
+  return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+}
+}  // namespace
+
+TEST(AlignedBufferPool, BuffersAreAligned) {
+  aligned_buffer_pool pool{1000, 4, 512};
+  EXPECT_EQ(pool.buffer_size(), 1024u);
+  EXPECT_EQ(pool.capacity(), 4u);
+
+  auto a = pool.acquire();
+  auto b = pool.acquire();
+  EXPECT_TRUE(is_aligned(a.data(), 512));
+  EXPECT_TRUE(is_aligned(b.data(), 512));
+  EXPECT_NE(a.data(), b.data());
+  EXPECT_EQ(a.size(), 1024u);
+  EXPECT_EQ(pool.available(), 2u);
+}
+
+TEST(AlignedBufferPool, ReleaseReturnsBufferToPool) {
+  aligned_buffer_pool pool{4096, 1};
+  {
+    auto a = pool.try_acquire();
+    EXPECT_TRUE(a);
+    EXPECT_FALSE(pool.try_acquire());
+    EXPECT_THROW(pool.acquire(), std::bad_alloc);
+  }
+  EXPECT_EQ(pool.available(), 1u);
+  EXPECT_TRUE(pool.try_acquire());
+}
+
+TEST(AlignedBufferPool, RejectsNonPowerOfTwoAlignment) {
+  EXPECT_THROW((aligned_buffer_pool{4096, 1, 3000}), std::invalid_argument);
+}
+
+TEST_F(IOUringDirectIOTest, DirectWriteThenRead) {
+  auto s = ctx_.get_scheduler();
+  std::optional<io_uring_context::async_read_write_file> file;
+  try {
+    file.emplace(open_file_read_write_direct(s, testFilePath));
+  } catch (const std::system_error& e) {
+    GTEST_SKIP() << "O_DIRECT not supported here: " << e.what();
+  }
+
+  const std::size_t alignment = file->alignment();
+  ASSERT_GT(alignment, 0u);
+
+  aligned_buffer_pool pool{alignment, 2, alignment};
+  auto out = pool.acquire();
+  auto in = pool.acquire();
+  std::fill_n(out.data(), out.size(), std::byte{42});
+
+  auto written =
+      sync_wait(async_write_some_at(*file, 0, span<const std::byte>{
+          out.data(), out.size()}));
+  ASSERT_TRUE(written.has_value());
+  EXPECT_EQ(static_cast<std::size_t>(*written), out.size());
+
+  auto read = sync_wait(async_read_some_at(*file, 0, in.bytes()));
+  ASSERT_TRUE(read.has_value());
+  EXPECT_EQ(static_cast<std::size_t>(*read), in.size());
+  EXPECT_TRUE(std::equal(in.data(), in.data() + in.size(), out.data()));
+}
+
+TEST_F(IOUringDirectIOTest, MisalignedRequestFailsWithInvalidArgument) {
+  auto s = ctx_.get_scheduler();
+  std::optional<io_uring_context::async_read_write_file> file;
+  try {
+    file.emplace(open_file_read_write_direct(s, testFilePath));
+  } catch (const std::system_error& e) {
+    GTEST_SKIP() << "O_DIRECT not supported here: " << e.what();
+  }
+
+  const std::size_t alignment = file->alignment();
+  aligned_buffer_pool pool{2 * alignment, 1, alignment};
+  auto buffer = pool.acquire();
+
+  auto expectInvalid = [](auto&& sender) {
+    try {
+      sync_wait((decltype(sender)&&)sender);
+      ADD_FAILURE() << "expected misaligned request to fail";
+    } catch (const std::system_error& e) {
+      EXPECT_EQ(e.code(), std::errc::invalid_argument);
+    }
+  };
+
+  // misaligned offset
+  expectInvalid(async_read_some_at(
+      *file, 1, span<std::byte>{buffer.data(), alignment}));
+  // misaligned length
+  expectInvalid(async_read_some_at(
+      *file, 0, span<std::byte>{buffer.data(), alignment - 1}));
+  // misaligned buffer address
+  expectInvalid(async_read_some_at(
+      *file, 0, span<std::byte>{buffer.data() + 1, alignment}));
+}
+
+#endif  // !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
+
+#  include <unifex/linux/io_uring_context.hpp>
+
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/let_value.hpp>
+#  include <unifex/scheduler_concepts.hpp>
+#  include <unifex/stop_when.hpp>
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/then.hpp>
+#  include <unifex/when_all.hpp>
+
+#  include <chrono>
+#  include <exception>
+#  include <future>
+#  include <thread>
+
+#  include <gtest/gtest.h>
+
+using namespace unifex;
+using namespace unifex::linuxos;
+using namespace std::chrono_literals;
+
+namespace {
+struct IOUringTimerTest : testing::Test {
+  ~IOUringTimerTest() {
+    stopSource_.request_stop();
+    t_.join();
+  }
+
+  io_uring_context ctx_;
+  inplace_stop_source stopSource_;
+  std::thread t_{[&] {
+    ctx_.run(stopSource_.get_token());
+  }};
+};
+
+// Records when the operation completed with a value.
+struct completion_time_receiver {
+  std::promise<monotonic_clock::time_point>* completed_;
+
+  void set_value() && noexcept {
+    completed_->set_value(monotonic_clock::now());
+  }
+  void set_error(std::exception_ptr) && noexcept {
+    ADD_FAILURE() << "unexpected error";
+    completed_->set_value(monotonic_clock::time_point{});
+  }
+  void set_done() && noexcept {
+    ADD_FAILURE() << "unexpected done";
+    completed_->set_value(monotonic_clock::time_point{});
+  }
+};
+}  // namespace
+
+TEST_F(IOUringTimerTest, ScheduleAfter) {
+  auto s = ctx_.get_scheduler();
+  auto start = now(s);
+  ASSERT_TRUE(sync_wait(schedule_after(s, 10ms)).has_value());
+  EXPECT_GE(now(s) - start, 10ms);
+}
+
+TEST_F(IOUringTimerTest, ScheduleAfterMeasuresDelayFromStart) {
+  auto s = ctx_.get_scheduler();
+  std::promise<monotonic_clock::time_point> completed;
+  auto op = unifex::connect(
+      s.schedule_after(50ms), completion_time_receiver{&completed});
+  std::this_thread::sleep_for(100ms);
+
+  auto start = monotonic_clock::now();
+  unifex::start(op);
+  EXPECT_GE(completed.get_future().get() - start, 50ms);
+}
+
+TEST_F(IOUringTimerTest, TimerWithSlackCompletesWithEarlierTimer) {
+  auto s = ctx_.get_scheduler();
+  auto start = now(s);
+  monotonic_clock::time_point lazyDone, eagerDone;
+  // The OS timer is armed for the timer without slack; by then the lazy
+  // timer is due too and completes long before its latest time.
+  sync_wait(when_all(
+      s.schedule_at(start + 10ms, 500ms) |
+          then([&] { lazyDone = monotonic_clock::now(); }),
+      s.schedule_after(30ms) |
+          then([&] { eagerDone = monotonic_clock::now(); })));
+  EXPECT_GE(lazyDone - start, 10ms);
+  EXPECT_GE(eagerDone - start, 30ms);
+  EXPECT_LT(lazyDone - start, 250ms);
+}
+
+TEST_F(IOUringTimerTest, CancelTimerWithSlack) {
+  auto s = ctx_.get_scheduler();
+  auto start = now(s);
+  auto result = sync_wait(
+      stop_when(s.schedule_after(10s, 1s), s.schedule_after(10ms)));
+  EXPECT_FALSE(result.has_value());
+  EXPECT_LT(now(s) - start, 5s);
+}
+
+TEST_F(IOUringTimerTest, EarlierTimerMovesKernelTimer) {
+  auto s = ctx_.get_scheduler();
+  auto start = now(s);
+  // Hop through the I/O thread's queue so that the kernel timer is armed
+  // for the far-future timer first and then has to be moved.
+  auto result = sync_wait(stop_when(
+      schedule_at(s, start + 30s),
+      schedule(s) | let_value([s] { return schedule(s); }) |
+          let_value([&] { return schedule_at(s, start + 10ms); })));
+  EXPECT_FALSE(result.has_value());
+  EXPECT_LT(now(s) - start, 5s);
+}
+
+TEST(IOUringBoottimeTimerTest, ScheduleAfter) {
+  io_uring_context ctx{io_uring_context::timer_clock::boottime};
+  inplace_stop_source stopSource;
+  std::thread t{[&] {
+    ctx.run(stopSource.get_token());
+  }};
+
+  auto s = ctx.get_scheduler();
+  auto start = now(s);
+  EXPECT_TRUE(sync_wait(schedule_after(s, 10ms)).has_value());
+  auto elapsed = now(s) - start;
+  EXPECT_GE(elapsed, 10ms);
+  EXPECT_LT(elapsed, 5s);
+
+  stopSource.request_stop();
+  t.join();
+}
+
+#endif  // !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
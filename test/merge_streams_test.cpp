@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/merge_streams.hpp>
+
+#include <unifex/delay.hpp>
+#include <unifex/for_each.hpp>
+#include <unifex/just.hpp>
+#include <unifex/range_stream.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/then.hpp>
+#include <unifex/timed_single_thread_context.hpp>
+#include <unifex/transform_stream.hpp>
+
+#include "slow_stream.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+using namespace std::chrono_literals;
+using unifex_test::slow_stream;
+
+namespace {
+// Keeps the values of 'values' that came from [first, last), in order.
+std::vector<int>
+values_in(const std::vector<int>& values, int first, int last) {
+  std::vector<int> result;
+  std::copy_if(
+      values.begin(),
+      values.end(),
+      std::back_inserter(result),
+      [&](int value) { return value >= first && value < last; });
+  return result;
+}
+}  // namespace
+
+TEST(merge_streams, Smoke) {
+  std::vector<int> values;
+
+  sync_wait(for_each(
+      merge_streams(range_stream{0, 10}, range_stream{100, 110}),
+      [&](int value) { values.push_back(value); }));
+
+  ASSERT_EQ(values.size(), 20u);
+  EXPECT_EQ(
+      values_in(values, 0, 10),
+      (std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+  EXPECT_EQ(
+      values_in(values, 100, 110),
+      (std::vector<int>{100, 101, 102, 103, 104, 105, 106, 107, 108, 109}));
+}
+
+TEST(merge_streams, InterleavesAsValuesArrive) {
+  timed_single_thread_context context;
+  std::vector<int> values;
+
+  // The slow stream's only value arrives long before the fast stream ends.
+  sync_wait(for_each(
+      merge_streams(
+          delay(range_stream{0, 5}, context.get_scheduler(), 20ms),
+          delay(range_stream{10, 11}, context.get_scheduler(), 30ms)),
+      [&](int value) { values.push_back(value); }));
+
+  ASSERT_EQ(values.size(), 6u);
+  EXPECT_EQ(values_in(values, 0, 5), (std::vector<int>{0, 1, 2, 3, 4}));
+  EXPECT_NE(values.back(), 10);
+}
+
+TEST(merge_streams, ErrorCancelsOtherStreams) {
+  timed_single_thread_context context;
+  int cleanups = 0;
+  bool caughtError = false;
+
+  try {
+    sync_wait(for_each(
+        merge_streams(
+            slow_stream{context.get_scheduler(), cleanups},
+            transform_stream(
+                range_stream{0, 3},
+                [](int value) {
+                  if (value == 2) {
+                    throw std::runtime_error{"two"};
+                  }
+                  return value;
+                })),
+        [](int) {}));
+  } catch (const std::runtime_error&) {
+    caughtError = true;
+  }
+
+  EXPECT_TRUE(caughtError);
+  EXPECT_EQ(cleanups, 1);
+}
+
+TEST(merge_streams, CleanupCancelsOutstandingNext) {
+  timed_single_thread_context context;
+  int cleanups = 0;
+  auto stream = merge_streams(
+      slow_stream{context.get_scheduler(), cleanups},
+      slow_stream{context.get_scheduler(), cleanups},
+      transform_stream(range_stream{0, 2}, [](int value) { return value; }));
+
+  EXPECT_EQ(sync_wait(next(stream)), std::optional<int>{0});
+  EXPECT_EQ(sync_wait(next(stream)), std::optional<int>{1});
+
+  auto start = std::chrono::steady_clock::now();
+  sync_wait(cleanup(stream));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 1min);
+  EXPECT_EQ(cleanups, 2);
+}
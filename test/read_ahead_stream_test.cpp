@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
+
+#  include <unifex/linux/io_uring_context.hpp>
+#  include <unifex/linux/read_ahead_stream.hpp>
+
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/reduce_stream.hpp>
+#  include <unifex/scope_guard.hpp>
+#  include <unifex/stream_concepts.hpp>
+#  include <unifex/sync_wait.hpp>
+
+#  include <cstddef>
+#  include <optional>
+#  include <system_error>
+#  include <thread>
+#  include <vector>
+
+#  include <fcntl.h>
+#  include <unistd.h>
+
+#  include <gtest/gtest.h>
+
+using namespace unifex;
+using namespace unifex::linuxos;
+
+namespace {
+const char* const testFilePath = "read_ahead_stream_test.dat";
+
+struct ReadAheadStreamTest : testing::Test {
+  ~ReadAheadStreamTest() {
+    stopSource_.request_stop();
+    t_.join();
+    ::unlink(testFilePath);
+  }
+
+  // Writes 'size' bytes where each byte holds its offset modulo 251, so
+  // that blocks delivered out of order or twice are detected.
+  std::vector<char> write_file(std::size_t size) {
+    std::vector<char> contents(size);
+    for (std::size_t i = 0; i < size; ++i) {
+      contents[i] = static_cast<char>(i % 251);
+    }
+    int fd =
+        ::open(testFilePath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+      throw std::system_error{errno, std::system_category()};
+    }
+    scope_guard closeOnExit = [fd]() noexcept {
+      ::close(fd);
+    };
+    if (::write(fd, contents.data(), size) != static_cast<ssize_t>(size)) {
+      throw std::system_error{errno, std::system_category()};
+    }
+    return contents;
+  }
+
+  template <typename Stream>
+  std::vector<char> read_all(Stream&& stream) {
+    return sync_wait(reduce_stream(
+                         (Stream &&) stream,
+                         std::vector<char>{},
+                         [](std::vector<char> result,
+                            span<const std::byte> block) {
+                           auto* data =
+                               reinterpret_cast<const char*>(block.data());
+                           result.insert(
+                               result.end(), data, data + block.size());
+                           return result;
+                         }))
+        .value();
+  }
+
+  io_uring_context ctx_;
+  inplace_stop_source stopSource_;
+  std::thread t_{[&] {
+    ctx_.run(stopSource_.get_token());
+  }};
+};
+}  // namespace
+
+TEST_F(ReadAheadStreamTest, ReadsWholeFileInOrder) {
+  auto expected = write_file(10 * 4096 + 123);
+  auto file = open_file_read_only(ctx_.get_scheduler(), testFilePath);
+
+  EXPECT_EQ(read_all(read_ahead_stream(file, 4096, 4)), expected);
+}
+
+TEST_F(ReadAheadStreamTest, FileSizeIsMultipleOfBlockSize) {
+  auto expected = write_file(8 * 4096);
+  auto file = open_file_read_only(ctx_.get_scheduler(), testFilePath);
+
+  EXPECT_EQ(read_all(read_ahead_stream(file, 4096, 3)), expected);
+}
+
+TEST_F(ReadAheadStreamTest, SingleReadInFlight) {
+  auto expected = write_file(5 * 1000 + 1);
+  auto file = open_file_read_only(ctx_.get_scheduler(), testFilePath);
+
+  EXPECT_EQ(read_all(read_ahead_stream(file, 1000, 1)), expected);
+}
+
+TEST_F(ReadAheadStreamTest, EmptyFile) {
+  write_file(0);
+  auto file = open_file_read_only(ctx_.get_scheduler(), testFilePath);
+
+  EXPECT_TRUE(read_all(read_ahead_stream(file, 4096, 4)).empty());
+}
+
+TEST_F(ReadAheadStreamTest, CleanupWhileReadsInFlight) {
+  write_file(64 * 4096);
+  auto file = open_file_read_only(ctx_.get_scheduler(), testFilePath);
+  auto stream = read_ahead_stream(file, 4096, 8);
+
+  auto first = sync_wait(next(stream));
+  ASSERT_TRUE(first.has_value());
+  EXPECT_EQ(first->size(), 4096u);
+  EXPECT_EQ(static_cast<char>((*first)[100]), static_cast<char>(100));
+
+  auto second = sync_wait(next(stream));
+  ASSERT_TRUE(second.has_value());
+  EXPECT_EQ(static_cast<char>((*second)[0]), static_cast<char>(4096 % 251));
+
+  // Completes with done once the outstanding reads have finished.
+  EXPECT_FALSE(sync_wait(cleanup(stream)).has_value());
+}
+
+#endif  // !UNIFEX_NO_LIBURING && !UNIFEX_NO_EXCEPTIONS
@@ -21,6 +21,7 @@
 #include <unifex/transform_stream.hpp>
 
 #include <cstdio>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -52,3 +53,59 @@ TEST(reduce_stream, Pipeable) {
   EXPECT_EQ(finalResult, 285);
   std::printf("result = %i\n", finalResult);
 }
+
+namespace {
+// Only exposes next(), hiding range_stream's next_batch().
+struct unbatched_range_stream {
+  range_stream inner_;
+
+  friend auto tag_invoke(tag_t<next>, unbatched_range_stream& s) {
+    return next(s.inner_);
+  }
+  friend auto tag_invoke(tag_t<cleanup>, unbatched_range_stream& s) {
+    return cleanup(s.inner_);
+  }
+};
+}  // namespace
+
+TEST(reduce_stream, BatchedStream) {
+  static_assert(is_batched_stream_v<range_stream>);
+  // The batch buffer lives in the next_batch() operation, not the stream.
+  static_assert(sizeof(range_stream) == 2 * sizeof(int));
+
+  std::vector<int> values;
+  auto result = sync_wait(reduce_stream(
+      range_stream{0, 1000}, 0, [&](int state, int value) {
+        values.push_back(value);
+        return state + value;
+      }));
+
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(*result, 499500);
+  ASSERT_EQ(values.size(), 1000u);
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(values[i], i);
+  }
+}
+
+TEST(reduce_stream, FallsBackToNext) {
+  static_assert(!is_batched_stream_v<unbatched_range_stream>);
+
+  auto result = sync_wait(reduce_stream(
+      unbatched_range_stream{range_stream{0, 1000}},
+      0,
+      [](int state, int value) { return state + value; }));
+
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(*result, 499500);
+}
+
+TEST(reduce_stream, EmptyBatchedStream) {
+  auto result = sync_wait(reduce_stream(
+      range_stream{5, 5}, 42, [](int state, int value) {
+        return state + value;
+      }));
+
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(*result, 42);
+}
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/running_in_this_thread.hpp>
+
+#include <unifex/any_scheduler.hpp>
+#include <unifex/coroutine.hpp>
+#include <unifex/inline_scheduler.hpp>
+#include <unifex/just.hpp>
+#include <unifex/on.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/single_thread_context.hpp>
+#include <unifex/static_thread_pool.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/then.hpp>
+#include <unifex/v2/async_manual_reset_event.hpp>
+#include <unifex/v2/async_mutex.hpp>
+#include <unifex/when_all.hpp>
+
+#if !UNIFEX_NO_COROUTINES
+#  include <unifex/task.hpp>
+#endif
+
+#if !UNIFEX_NO_EPOLL
+#  include <unifex/inplace_stop_token.hpp>
+#  include <unifex/linux/io_epoll_context.hpp>
+
+#  include <thread>
+#endif
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+
+namespace {
+template <typename Scheduler>
+bool running_in_this_thread_after_schedule(Scheduler s) {
+  return sync_wait(then(schedule(s), [s]() noexcept {
+           return running_in_this_thread(s);
+         })).value();
+}
+}  // namespace
+
+TEST(running_in_this_thread, inline_scheduler_never_claims_the_thread) {
+  EXPECT_FALSE(running_in_this_thread(inline_scheduler{}));
+  EXPECT_FALSE(running_in_this_thread_after_schedule(inline_scheduler{}));
+}
+
+TEST(running_in_this_thread, single_thread_context) {
+  single_thread_context ctx;
+  single_thread_context other;
+
+  EXPECT_FALSE(running_in_this_thread(ctx.get_scheduler()));
+  EXPECT_TRUE(running_in_this_thread_after_schedule(ctx.get_scheduler()));
+
+  auto otherScheduler = other.get_scheduler();
+  EXPECT_FALSE(sync_wait(then(schedule(ctx.get_scheduler()), [&]() noexcept {
+                 return running_in_this_thread(otherScheduler);
+               })).value());
+}
+
+TEST(running_in_this_thread, static_thread_pool) {
+  static_thread_pool pool{2};
+  static_thread_pool other{1};
+
+  EXPECT_FALSE(running_in_this_thread(pool.get_scheduler()));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(running_in_this_thread_after_schedule(pool.get_scheduler()));
+  }
+
+  auto otherScheduler = other.get_scheduler();
+  EXPECT_FALSE(sync_wait(then(schedule(pool.get_scheduler()), [&]() noexcept {
+                 return running_in_this_thread(otherScheduler);
+               })).value());
+}
+
+#if !UNIFEX_NO_EPOLL
+TEST(running_in_this_thread, io_epoll_context) {
+  linuxos::io_epoll_context ctx;
+  inplace_stop_source stopSource;
+  std::thread t{[&] {
+    ctx.run(stopSource.get_token());
+  }};
+
+  EXPECT_FALSE(running_in_this_thread(ctx.get_scheduler()));
+  EXPECT_TRUE(running_in_this_thread_after_schedule(ctx.get_scheduler()));
+
+  stopSource.request_stop();
+  t.join();
+}
+#endif
+
+TEST(running_in_this_thread, any_scheduler_forwards_the_query) {
+  single_thread_context ctx;
+  EXPECT_TRUE(running_in_this_thread_after_schedule(
+      any_scheduler{ctx.get_scheduler()}));
+  EXPECT_FALSE(running_in_this_thread(any_scheduler{ctx.get_scheduler()}));
+
+  auto sched = ctx.get_scheduler();
+  EXPECT_TRUE(running_in_this_thread_after_schedule(any_scheduler_ref{sched}));
+  EXPECT_FALSE(running_in_this_thread(any_scheduler_ref{sched}));
+}
+
+TEST(running_in_this_thread, v2_event_resumes_inline_on_setters_thread) {
+  single_thread_context ctx;
+  v2::async_manual_reset_event evt;
+  bool insideSet = false;
+  bool resumedInsideSet = false;
+
+  // single_thread_context runs tasks in FIFO order, so the waiter is
+  // parked before the setter runs.
+  sync_wait(when_all(
+      on(ctx.get_scheduler(), then(evt.async_wait(), [&]() noexcept {
+           resumedInsideSet = insideSet;
+         })),
+      on(ctx.get_scheduler(), then(just(), [&]() noexcept {
+           insideSet = true;
+           evt.set();
+           insideSet = false;
+         }))));
+
+  EXPECT_TRUE(resumedInsideSet);
+}
+
+TEST(running_in_this_thread, v2_event_still_hops_from_a_foreign_thread) {
+  single_thread_context ctx;
+  v2::async_manual_reset_event evt;
+  bool resumedOnCtx = false;
+
+  sync_wait(when_all(
+      on(ctx.get_scheduler(), then(evt.async_wait(), [&]() noexcept {
+           resumedOnCtx = running_in_this_thread(ctx.get_scheduler());
+         })),
+      then(just(), [&]() noexcept { evt.set(); })));
+
+  EXPECT_TRUE(resumedOnCtx);
+}
+
+TEST(running_in_this_thread, v2_mutex_resumes_inline_on_unlockers_thread) {
+  single_thread_context ctx;
+  v2::async_mutex mutex;
+  bool insideUnlock = false;
+  bool resumedInsideUnlock = false;
+
+  ASSERT_TRUE(mutex.try_lock());
+  sync_wait(when_all(
+      on(ctx.get_scheduler(), then(mutex.async_lock(), [&]() noexcept {
+           resumedInsideUnlock = insideUnlock;
+           mutex.unlock();
+         })),
+      on(ctx.get_scheduler(), then(just(), [&]() noexcept {
+           insideUnlock = true;
+           mutex.unlock();
+           insideUnlock = false;
+         }))));
+
+  EXPECT_TRUE(resumedInsideUnlock);
+  EXPECT_TRUE(mutex.try_lock());
+  mutex.unlock();
+}
+
+#if !UNIFEX_NO_COROUTINES
+TEST(running_in_this_thread, v2_event_resumes_task_inline_on_setters_thread) {
+  single_thread_context ctx;
+  v2::async_manual_reset_event evt;
+  bool insideSet = false;
+  bool resumedInsideSet = false;
+
+  // A task<> sees its scheduler as an any_scheduler, so this only resumes
+  // inline if the query makes it through the type erasure.
+  sync_wait(when_all(
+      on(ctx.get_scheduler(),
+         [&]() -> task<void> {
+           co_await evt.async_wait();
+           resumedInsideSet = insideSet;
+         }()),
+      on(ctx.get_scheduler(), [&]() -> task<void> {
+        insideSet = true;
+        evt.set();
+        insideSet = false;
+        co_return;
+      }())));
+
+  EXPECT_TRUE(resumedInsideSet);
+}
+#endif
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unifex/config.hpp>
+
+#if !UNIFEX_NO_EPOLL && !UNIFEX_NO_EXCEPTIONS
+
+#  include <unifex/linux/sharded_io_epoll_context.hpp>
+
+#  include <unifex/scheduler_concepts.hpp>
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/then.hpp>
+
+#  include <set>
+#  include <thread>
+
+#  include <gtest/gtest.h>
+
+using namespace unifex;
+using namespace unifex::linuxos;
+
+TEST(ShardedIOEpollContext, EachShardRunsOnItsOwnThread) {
+  sharded_io_epoll_context ctx{3};
+  ASSERT_EQ(ctx.shard_count(), 3u);
+
+  auto threadOf = [&](auto scheduler) {
+    return *sync_wait(
+        schedule(scheduler) | then([] { return std::this_thread::get_id(); }));
+  };
+
+  std::set<std::thread::id> threads;
+  for (std::size_t i = 0; i < ctx.shard_count(); ++i) {
+    auto id = threadOf(ctx.get_scheduler(i));
+    EXPECT_NE(id, std::this_thread::get_id());
+    // Work on a shard never migrates to another thread.
+    EXPECT_EQ(id, threadOf(ctx.get_scheduler(i)));
+    threads.insert(id);
+  }
+  EXPECT_EQ(threads.size(), 3u);
+}
+
+TEST(ShardedIOEpollContext, RoundRobinCyclesThroughShards) {
+  sharded_io_epoll_context ctx{2};
+  auto a = ctx.get_scheduler();
+  auto b = ctx.get_scheduler();
+  EXPECT_NE(a, b);
+  EXPECT_EQ(a, ctx.get_scheduler());
+  EXPECT_EQ(b, ctx.get_scheduler());
+}
+
+TEST(ShardedIOEpollContext, ListenersShareOnePort) {
+  sharded_io_epoll_context ctx{4};
+  auto listeners = ctx.open_listening_sockets(0);
+  ASSERT_EQ(listeners.size(), 4u);
+  EXPECT_NE(listeners[0].port(), 0);
+  for (auto& listener : listeners) {
+    EXPECT_EQ(listener.port(), listeners[0].port());
+  }
+}
+
+#endif  // !UNIFEX_NO_EPOLL && !UNIFEX_NO_EXCEPTIONS
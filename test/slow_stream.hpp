@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <unifex/just.hpp>
+#include <unifex/just_done.hpp>
+#include <unifex/let_value.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/stream_concepts.hpp>
+#include <unifex/then.hpp>
+#include <unifex/timed_single_thread_context.hpp>
+
+#include <chrono>
+#include <utility>
+
+namespace unifex_test {
+
+using namespace unifex;
+
+using timed_scheduler =
+    decltype(std::declval<timed_single_thread_context&>().get_scheduler());
+
+// Each next() waits for an hour unless cancelled. Counts its cleanups in
+// 'cleanups_'.
+struct slow_stream {
+  timed_scheduler scheduler_;
+  int& cleanups_;
+
+  friend auto tag_invoke(tag_t<next>, slow_stream& s) {
+    return then(
+        schedule_after(s.scheduler_, std::chrono::hours{1}), [] { return 0; });
+  }
+  friend auto tag_invoke(tag_t<cleanup>, slow_stream& s) {
+    return let_value(just(), [&cleanups = s.cleanups_] {
+      ++cleanups;
+      return just_done();
+    });
+  }
+};
+
+}  // namespace unifex_test
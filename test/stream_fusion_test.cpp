@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/filter_stream.hpp>
+#include <unifex/next_adapt_stream.hpp>
+#include <unifex/range_stream.hpp>
+#include <unifex/reduce_stream.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/then.hpp>
+#include <unifex/transform_stream.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace unifex;
+
+namespace {
+// Only exposes next(), so reductions over it go one value at a time.
+struct unbatched_range_stream {
+  range_stream inner_;
+
+  friend auto tag_invoke(tag_t<next>, unbatched_range_stream& s) {
+    return next(s.inner_);
+  }
+  friend auto tag_invoke(tag_t<cleanup>, unbatched_range_stream& s) {
+    return cleanup(s.inner_);
+  }
+};
+
+template <typename Stream>
+using source_t = decltype(std::declval<Stream&>().source_);
+
+auto square = [](int value) {
+  return value * value;
+};
+auto isEven = [](int value) {
+  return value % 2 == 0;
+};
+auto sum = [](long long state, int value) {
+  return state + value;
+};
+}  // namespace
+
+TEST(stream_fusion, AdjacentAdaptorsShareOneSource) {
+  auto fused = range_stream{0, 10} | transform_stream(square) |
+      filter_stream(isEven) | transform_stream([](int value) {
+                 return std::to_string(value);
+               });
+
+  static_assert(std::is_same_v<source_t<decltype(fused)>, range_stream>);
+  static_assert(_fused::is_fused_over_batched_v<decltype(fused)>);
+
+  std::vector<std::string> values;
+  while (auto value = sync_wait(next(fused))) {
+    values.push_back(std::move(*value));
+  }
+  sync_wait(cleanup(fused));
+
+  EXPECT_EQ(
+      values, (std::vector<std::string>{"0", "4", "16", "36", "64"}));
+}
+
+TEST(stream_fusion, ReduceOverBatchedSourceRunsStagesInLoop) {
+  auto result = range_stream{0, 1000} | transform_stream(square) |
+      filter_stream(isEven) | reduce_stream(0LL, sum) | sync_wait();
+
+  long long expected = 0;
+  for (int i = 0; i < 1000; ++i) {
+    if ((i * i) % 2 == 0) {
+      expected += i * i;
+    }
+  }
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(*result, expected);
+}
+
+TEST(stream_fusion, ReduceOverUnbatchedSource) {
+  auto stream = unbatched_range_stream{range_stream{0, 100}} |
+      filter_stream(isEven) | transform_stream(square);
+
+  static_assert(!_fused::is_fused_over_batched_v<decltype(stream)>);
+  static_assert(
+      std::is_same_v<source_t<decltype(stream)>, unbatched_range_stream>);
+
+  auto result = sync_wait(reduce_stream(std::move(stream), 0LL, sum));
+
+  long long expected = 0;
+  for (int i = 0; i < 100; i += 2) {
+    expected += i * i;
+  }
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(*result, expected);
+}
+
+TEST(stream_fusion, VoidTransformSendsNoValues) {
+  int calls = 0;
+  auto stream = range_stream{0, 5} | transform_stream([&](int) { ++calls; });
+
+  int count = 0;
+  while (sync_wait(next(stream))) {
+    ++count;
+  }
+  sync_wait(cleanup(stream));
+
+  EXPECT_EQ(calls, 5);
+  EXPECT_EQ(count, 5);
+}
+
+TEST(stream_fusion, NextAdaptStreamComposesAdapters) {
+  auto stream = next_adapt_stream(
+      next_adapt_stream(
+          range_stream{1, 4},
+          [](auto&& sender) {
+            return then((decltype(sender))sender, [](int v) { return v + 1; });
+          }),
+      [](auto&& sender) {
+        return then((decltype(sender))sender, [](int v) { return v * 10; });
+      });
+
+  static_assert(
+      std::is_same_v<decltype(stream.innerStream_), range_stream>);
+
+  EXPECT_EQ(sync_wait(next(stream)), 20);
+  EXPECT_EQ(sync_wait(next(stream)), 30);
+  EXPECT_EQ(sync_wait(next(stream)), 40);
+  EXPECT_FALSE(sync_wait(next(stream)).has_value());
+}
+
+#if !UNIFEX_NO_EXCEPTIONS
+TEST(stream_fusion, StageThrowsDuringBatchedReduce) {
+  auto sender = range_stream{0, 100} | transform_stream([](int value) {
+                  if (value == 70) {
+                    throw 42;
+                  }
+                  return value;
+                }) |
+      reduce_stream(0LL, sum);
+
+  EXPECT_THROW(sync_wait(std::move(sender)), int);
+}
+#endif
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unifex/coroutine.hpp>
+
+#if !UNIFEX_NO_COROUTINES
+
+#  include <unifex/sync_wait.hpp>
+#  include <unifex/task.hpp>
+
+#  include "allocation_counter.hpp"
+
+#  include <cstdlib>
+#  include <memory>
+#  include <new>
+
+#  include <gtest/gtest.h>
+
+using namespace unifex;
+using unifex_test::allocation_count;
+
+namespace {
+struct allocator_stats {
+  std::size_t allocations_{0};
+  std::size_t deallocations_{0};
+};
+
+template <typename T>
+struct counting_allocator {
+  using value_type = T;
+
+  explicit counting_allocator(allocator_stats* stats) noexcept
+    : stats_(stats) {}
+
+  template <typename U>
+  counting_allocator(const counting_allocator<U>& other) noexcept
+    : stats_(other.stats_) {}
+
+  T* allocate(std::size_t n) {
+    ++stats_->allocations_;
+    return static_cast<T*>(std::malloc(n * sizeof(T)));
+  }
+
+  void deallocate(T* p, std::size_t) noexcept {
+    ++stats_->deallocations_;
+    std::free(p);
+  }
+
+  friend bool
+  operator==(const counting_allocator& a, const counting_allocator& b) {
+    return a.stats_ == b.stats_;
+  }
+  friend bool
+  operator!=(const counting_allocator& a, const counting_allocator& b) {
+    return !(a == b);
+  }
+
+  allocator_stats* stats_;
+};
+
+task<int> leaf(int value) {
+  co_return value;
+}
+
+task<int> sum_to(int n) {
+  if (n == 0) {
+    co_return 0;
+  }
+  co_return n + co_await sum_to(n - 1);
+}
+
+template <typename Allocator>
+task<int> sum_to(std::allocator_arg_t, Allocator alloc, int n) {
+  if (n == 0) {
+    co_return 0;
+  }
+  co_return n + co_await sum_to(std::allocator_arg, alloc, n - 1);
+}
+
+struct adder {
+  int base_;
+
+  template <typename Allocator>
+  task<int> add(std::allocator_arg_t, Allocator, int value) const {
+    co_return base_ + co_await leaf(value);
+  }
+};
+}  // namespace
+
+TEST(task_frame_alloc, FramesComeFromAllocatorArgument) {
+  allocator_stats stats;
+  counting_allocator<std::byte> alloc{&stats};
+
+  EXPECT_EQ(sync_wait(sum_to(std::allocator_arg, alloc, 10)), 55);
+  EXPECT_EQ(stats.allocations_, 11u);
+  EXPECT_EQ(stats.deallocations_, 11u);
+}
+
+TEST(task_frame_alloc, MemberFunctionFrameComesFromAllocatorArgument) {
+  allocator_stats stats;
+  counting_allocator<std::byte> alloc{&stats};
+  adder a{40};
+
+  EXPECT_EQ(sync_wait(a.add(std::allocator_arg, alloc, 2)), 42);
+  // Only the member coroutine's frame; leaf() uses the frame pool.
+  EXPECT_EQ(stats.allocations_, 1u);
+  EXPECT_EQ(stats.deallocations_, 1u);
+}
+
+TEST(task_frame_alloc, DefaultFramesAreRecycled) {
+  // Warm up this thread's frame pool.
+  EXPECT_EQ(sync_wait(sum_to(20)), 210);
+
+  auto before = allocation_count();
+  auto t = sum_to(20);
+  EXPECT_EQ(allocation_count() - before, 0u);
+
+  // Whatever sync_wait() allocates does not depend on how many frames the
+  // task chain goes through.
+  before = allocation_count();
+  EXPECT_EQ(sync_wait(leaf(0)), 0);
+  auto shallow = allocation_count() - before;
+
+  before = allocation_count();
+  EXPECT_EQ(sync_wait(std::move(t)), 210);
+  EXPECT_EQ(allocation_count() - before, shallow);
+}
+
+TEST(task_frame_alloc, UnawaitedTaskReturnsFrame) {
+  allocator_stats stats;
+  counting_allocator<std::byte> alloc{&stats};
+  {
+    auto t = sum_to(std::allocator_arg, alloc, 3);
+    EXPECT_EQ(stats.allocations_, 1u);
+  }
+  EXPECT_EQ(stats.deallocations_, 1u);
+}
+
+#endif  // !UNIFEX_NO_COROUTINES
@@ -18,7 +18,12 @@
 
 #if !UNIFEX_NO_COROUTINES
 
+#  include <unifex/inline_scheduler.hpp>
+#  include <unifex/just.hpp>
+#  include <unifex/just_done.hpp>
+#  include <unifex/just_error.hpp>
 #  include <unifex/just_from.hpp>
+#  include <unifex/scheduler_concepts.hpp>
 #  include <unifex/sync_wait.hpp>
 #  include <unifex/task.hpp>
 
@@ -75,4 +80,57 @@ TEST(Task, AwaitSenderReturningReference) {
   EXPECT_EQ(&ref, &global);
 }
 
+// Long enough to overflow the stack if each iteration were resumed from
+// within the previous one's start().
+constexpr int inline_await_iterations = 200'000;
+
+task<long long> await_just_in_a_loop() {
+  long long total = 0;
+  for (int i = 0; i < inline_await_iterations; ++i) {
+    total += co_await just(i);
+  }
+  co_return total;
+}
+
+task<int> schedule_inline_in_a_loop() {
+  int count = 0;
+  for (int i = 0; i < inline_await_iterations; ++i) {
+    co_await schedule(inline_scheduler{});
+    ++count;
+  }
+  co_return count;
+}
+
+TEST(Task, AwaitingInlineSendersDoesNotGrowTheStack) {
+  long long expected = static_cast<long long>(inline_await_iterations) *
+      (inline_await_iterations - 1) / 2;
+  EXPECT_EQ(sync_wait(await_just_in_a_loop()), expected);
+  EXPECT_EQ(sync_wait(schedule_inline_in_a_loop()), inline_await_iterations);
+}
+
+TEST(Task, InlineSenderCompletingWithDone) {
+  bool resumed = false;
+  auto result = sync_wait([&]() -> task<int> {
+    co_await just_done();
+    resumed = true;
+    co_return 42;
+  }());
+  EXPECT_FALSE(result.has_value());
+  EXPECT_FALSE(resumed);
+}
+
+#  if !UNIFEX_NO_EXCEPTIONS
+TEST(Task, InlineSenderCompletingWithError) {
+  auto t = []() -> task<int> {
+    try {
+      co_await just_error(std::make_exception_ptr(42));
+    } catch (int value) {
+      co_return value;
+    }
+    co_return 0;
+  };
+  EXPECT_EQ(sync_wait(t()), 42);
+}
+#  endif  // !UNIFEX_NO_EXCEPTIONS
+
 #endif  // !UNIFEX_NO_COROUTINES
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/timed_single_thread_context.hpp>
+
+#include <unifex/async_scope.hpp>
+#include <unifex/scheduler_concepts.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/then.hpp>
+#include <unifex/when_all.hpp>
+
+#include <chrono>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+using namespace std::chrono_literals;
+using _timed_single_thread_context::task_base;
+using _timed_single_thread_context::time_point;
+using _timed_single_thread_context::timer_wheel;
+
+TEST(TimerWheel, PopsInDueTimeOrderAcrossLevels) {
+  timed_single_thread_context context;
+  const time_point epoch{};
+  timer_wheel wheel{epoch};
+
+  std::vector<task_base> tasks;
+  using ms = std::chrono::milliseconds;
+  for (ms delay : {ms{24h * 60}, ms{5h}, ms{70s}, 300ms, 5ms, ms{70s}, 0ms}) {
+    tasks.emplace_back(context, nullptr);
+    tasks.back().dueTime_ = epoch + delay;
+  }
+  for (auto& task : tasks) {
+    wheel.insert(&task);
+  }
+
+  // Jump from one wake-up time to the next, as the context's thread does.
+  std::vector<task_base*> popped;
+  int wakeUps = 0;
+  while (!wheel.empty()) {
+    ASSERT_LT(++wakeUps, 10000);
+    auto now = wheel.next_due_time();
+    while (auto* task = wheel.pop_due(now)) {
+      EXPECT_LE(task->dueTime_, now);
+      // Never woken later than necessary.
+      EXPECT_EQ(task->dueTime_, now);
+      popped.push_back(task);
+    }
+  }
+
+  std::vector<task_base*> expected{
+      &tasks[6], &tasks[4], &tasks[3], &tasks[2], &tasks[5], &tasks[1],
+      &tasks[0]};
+  EXPECT_EQ(popped, expected);
+}
+
+TEST(TimerWheel, EqualDueTimesPopInInsertionOrder) {
+  timed_single_thread_context context;
+  const time_point epoch{};
+  timer_wheel wheel{epoch};
+
+  // 'a' and 'b' cascade down from level 1 together. 'c' is inserted once
+  // the same due-time is near enough to go straight into level 0.
+  task_base a{context, nullptr}, b{context, nullptr}, c{context, nullptr};
+  a.dueTime_ = b.dueTime_ = c.dueTime_ = epoch + 300ms;
+  wheel.insert(&a);
+  wheel.insert(&b);
+  EXPECT_EQ(wheel.pop_due(epoch + 100ms), nullptr);
+  wheel.insert(&c);
+
+  EXPECT_EQ(wheel.pop_due(epoch + 300ms), &a);
+  EXPECT_EQ(wheel.pop_due(epoch + 300ms), &b);
+  EXPECT_EQ(wheel.pop_due(epoch + 300ms), &c);
+  EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimerWheel, RemoveUnlinksFromSlot) {
+  timed_single_thread_context context;
+  const time_point epoch{};
+  timer_wheel wheel{epoch};
+
+  task_base a{context, nullptr}, b{context, nullptr};
+  a.dueTime_ = b.dueTime_ = epoch + 10s;
+  wheel.insert(&a);
+  wheel.insert(&b);
+  wheel.remove(&a);
+  EXPECT_EQ(a.prevNextPtr_, nullptr);
+
+  EXPECT_EQ(wheel.pop_due(epoch + 10s), &b);
+  EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimedSingleThreadContext, TimersCompleteInDueTimeOrder) {
+  timed_single_thread_context context;
+  auto s = context.get_scheduler();
+
+  std::vector<int> order;
+  sync_wait(when_all(
+      schedule_after(s, 300ms) | then([&] { order.push_back(3); }),
+      schedule_after(s, 5ms) | then([&] { order.push_back(1); }),
+      // Beyond the span of the lowest level of the wheel.
+      schedule_after(s, 260ms) | then([&] { order.push_back(2); })));
+  EXPECT_EQ(order, (std::vector<int>{1, 2, 3}));
+}
+
+TEST(TimedSingleThreadContext, CancelledTimersCompletePromptly) {
+  timed_single_thread_context context;
+  auto s = context.get_scheduler();
+
+  auto start = std::chrono::steady_clock::now();
+  async_scope scope;
+  for (int i = 0; i < 1000; ++i) {
+    scope.detached_spawn(schedule_after(s, 1h));
+  }
+  // Requests stop on all of the timers, then waits for them.
+  sync_wait(scope.cleanup());
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 10s);
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/transform_stream_async.hpp>
+
+#include <unifex/for_each.hpp>
+#include <unifex/just.hpp>
+#include <unifex/range_stream.hpp>
+#include <unifex/reduce_stream.hpp>
+#include <unifex/static_thread_pool.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/then.hpp>
+#include <unifex/timed_single_thread_context.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+using namespace std::chrono_literals;
+
+TEST(transform_stream_async, Smoke) {
+  static_thread_pool pool{2};
+
+  std::optional<int> result = sync_wait(
+      range_stream{0, 100} |
+      transform_stream_async(
+          pool.get_scheduler(), 4, [](int value) { return just(value * 2); }) |
+      reduce_stream(0, [](int state, int value) { return state + value; }));
+
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(*result, 9900);
+}
+
+TEST(transform_stream_async, OrderedKeepsSourceOrder) {
+  timed_single_thread_context context;
+  auto scheduler = context.get_scheduler();
+  std::vector<int> values;
+
+  // Later values complete first.
+  sync_wait(for_each(
+      transform_stream_async(
+          range_stream{0, 4},
+          scheduler,
+          4,
+          [scheduler](int value) {
+            return schedule_after(scheduler, (4 - value) * 10ms) |
+                then([value] { return value; });
+          }),
+      [&](int value) { values.push_back(value); }));
+
+  EXPECT_EQ(values, (std::vector<int>{0, 1, 2, 3}));
+}
+
+TEST(transform_stream_async, UnorderedEmitsInCompletionOrder) {
+  timed_single_thread_context context;
+  auto scheduler = context.get_scheduler();
+  std::vector<int> values;
+
+  sync_wait(for_each(
+      transform_stream_async_unordered(
+          range_stream{0, 4},
+          scheduler,
+          4,
+          [scheduler](int value) {
+            return schedule_after(scheduler, (4 - value) * 10ms) |
+                then([value] { return value; });
+          }),
+      [&](int value) { values.push_back(value); }));
+
+  EXPECT_EQ(values, (std::vector<int>{3, 2, 1, 0}));
+}
+
+TEST(transform_stream_async, LimitsConcurrency) {
+  static_thread_pool pool{4};
+  std::atomic<int> inFlight{0};
+  std::atomic<int> maxInFlight{0};
+  std::vector<int> values;
+
+  sync_wait(for_each(
+      transform_stream_async_unordered(
+          range_stream{0, 50},
+          pool.get_scheduler(),
+          3,
+          [&](int value) {
+            return just() | then([&, value] {
+                     int now = ++inFlight;
+                     int max = maxInFlight.load();
+                     while (now > max &&
+                            !maxInFlight.compare_exchange_weak(max, now)) {
+                     }
+                     std::this_thread::sleep_for(1ms);
+                     --inFlight;
+                     return value;
+                   });
+          }),
+      [&](int value) { values.push_back(value); }));
+
+  EXPECT_LE(maxInFlight.load(), 3);
+  std::sort(values.begin(), values.end());
+  ASSERT_EQ(values.size(), 50u);
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_EQ(values[i], i);
+  }
+}
+
+TEST(transform_stream_async, ErrorEndsStreamAfterEarlierValues) {
+  static_thread_pool pool{2};
+  std::vector<int> values;
+  bool caughtError = false;
+
+  try {
+    sync_wait(for_each(
+        transform_stream_async(
+            range_stream{0, 10},
+            pool.get_scheduler(),
+            4,
+            [](int value) {
+              return just(value) | then([](int v) {
+                       if (v == 5) {
+                         throw std::runtime_error{"five"};
+                       }
+                       return v;
+                     });
+            }),
+        [&](int value) { values.push_back(value); }));
+  } catch (const std::runtime_error&) {
+    caughtError = true;
+  }
+
+  EXPECT_TRUE(caughtError);
+  EXPECT_EQ(values, (std::vector<int>{0, 1, 2, 3, 4}));
+}
+
+TEST(transform_stream_async, CleanupCancelsInFlightElements) {
+  timed_single_thread_context context;
+  auto scheduler = context.get_scheduler();
+  auto stream = transform_stream_async_unordered(
+      range_stream{0, 10}, scheduler, 4, [scheduler](int value) {
+        return schedule_after(scheduler, value == 0 ? 0ms : 1h) |
+            then([value] { return value; });
+      });
+
+  std::optional<int> first = sync_wait(next(stream));
+  ASSERT_TRUE(first.has_value());
+  EXPECT_EQ(*first, 0);
+
+  auto start = std::chrono::steady_clock::now();
+  sync_wait(cleanup(stream));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 1min);
+}
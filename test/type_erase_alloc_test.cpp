@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/type_erased_stream.hpp>
+
+#include <unifex/range_stream.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/transform_stream.hpp>
+
+#include "allocation_counter.hpp"
+
+#include <optional>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+using unifex_test::allocation_count;
+
+namespace {
+auto squares() {
+  return transform_stream(
+      range_stream{0, 100}, [](int value) { return value * value; });
+}
+
+template <typename Stream>
+int sum_of_next_values(Stream& stream) {
+  int sum = 0;
+  while (std::optional<int> value = sync_wait(next(stream))) {
+    sum += *value;
+  }
+  sync_wait(cleanup(stream));
+  return sum;
+}
+}  // namespace
+
+TEST(type_erase_alloc, HeapStreamOnlyAllocatesOnConstruction) {
+  auto before = allocation_count();
+  auto stream = type_erase<int>(squares());
+  EXPECT_EQ(allocation_count() - before, 1u);
+
+  before = allocation_count();
+  EXPECT_EQ(sum_of_next_values(stream), 328350);
+  EXPECT_EQ(allocation_count() - before, 0u);
+}
+
+TEST(type_erase_alloc, InlineStreamDoesNotAllocate) {
+  auto before = allocation_count();
+  auto stream =
+      basic_type_erase<1024, alignof(std::max_align_t), int>(squares());
+  EXPECT_EQ(sum_of_next_values(stream), 328350);
+  EXPECT_EQ(allocation_count() - before, 0u);
+}
+
+TEST(type_erase_alloc, TooLargeStreamFallsBackToHeap) {
+  auto before = allocation_count();
+  auto stream = basic_type_erase<16, alignof(void*), int>(squares());
+  EXPECT_EQ(allocation_count() - before, 1u);
+  EXPECT_EQ(sum_of_next_values(stream), 328350);
+}
+
+TEST(type_erase_alloc, MoveInlineStream) {
+  using erased = basic_type_erased_stream<1024, alignof(std::max_align_t), int>;
+  erased first = basic_type_erase<1024, alignof(std::max_align_t), int>(
+      range_stream{0, 10});
+  ASSERT_EQ(sync_wait(next(first)), std::optional<int>{0});
+
+  auto before = allocation_count();
+  erased second = std::move(first);
+  erased third = basic_type_erase<1024, alignof(std::max_align_t), int>(
+      range_stream{100, 101});
+  third = std::move(second);
+  EXPECT_EQ(allocation_count() - before, 0u);
+
+  // Picks up where 'first' left off.
+  EXPECT_EQ(sum_of_next_values(third), 45);
+}
+
+TEST(type_erase_alloc, MoveFromMovedFromStream) {
+  auto first = type_erase<int>(range_stream{0, 10});
+  auto second = std::move(first);
+  // 'first' is empty now; moving it again must leave both empty.
+  auto third = std::move(first);
+  first = std::move(third);
+  EXPECT_EQ(sum_of_next_values(second), 45);
+}
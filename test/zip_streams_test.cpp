@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unifex/zip_streams.hpp>
+
+#include <unifex/for_each.hpp>
+#include <unifex/just_done.hpp>
+#include <unifex/let_done.hpp>
+#include <unifex/range_stream.hpp>
+#include <unifex/single_thread_context.hpp>
+#include <unifex/sync_wait.hpp>
+#include <unifex/then.hpp>
+#include <unifex/transform_stream.hpp>
+#include <unifex/via_stream.hpp>
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unifex;
+
+namespace {
+// Records the order in which streams are cleaned up.
+template <typename Stream>
+struct cleanup_tracking_stream {
+  Stream inner_;
+  int id_;
+  std::vector<int>& cleanups_;
+
+  friend auto tag_invoke(tag_t<next>, cleanup_tracking_stream& s) {
+    return next(s.inner_);
+  }
+  friend auto tag_invoke(tag_t<cleanup>, cleanup_tracking_stream& s) {
+    return let_done(
+        cleanup(s.inner_), [&cleanups = s.cleanups_, id = s.id_] {
+          cleanups.push_back(id);
+          return just_done();
+        });
+  }
+};
+}  // namespace
+
+TEST(zip_streams, Smoke) {
+  std::vector<std::pair<int, int>> values;
+
+  sync_wait(for_each(
+      zip_streams(range_stream{0, 5}, range_stream{10, 20}),
+      [&](int a, int b) { values.emplace_back(a, b); }));
+
+  EXPECT_EQ(
+      values,
+      (std::vector<std::pair<int, int>>{
+          {0, 10}, {1, 11}, {2, 12}, {3, 13}, {4, 14}}));
+}
+
+TEST(zip_streams, StreamsOnOtherThreads) {
+  single_thread_context thread1;
+  single_thread_context thread2;
+  int count = 0;
+
+  sync_wait(for_each(
+      zip_streams(
+          via_stream(thread1.get_scheduler(), range_stream{0, 100}),
+          transform_stream(
+              via_stream(thread2.get_scheduler(), range_stream{0, 100}),
+              [](int value) { return value * 0.5; })),
+      [&](int a, double b) {
+        EXPECT_EQ(a * 0.5, b);
+        ++count;
+      }));
+
+  EXPECT_EQ(count, 100);
+}
+
+TEST(zip_streams, ForwardsError) {
+  bool caughtError = false;
+
+  try {
+    sync_wait(for_each(
+        zip_streams(
+            range_stream{0, 10},
+            transform_stream(
+                range_stream{0, 10},
+                [](int value) {
+                  if (value == 3) {
+                    throw std::runtime_error{"three"};
+                  }
+                  return value;
+                })),
+        [](int, int) {}));
+  } catch (const std::runtime_error&) {
+    caughtError = true;
+  }
+
+  EXPECT_TRUE(caughtError);
+}
+
+TEST(zip_streams, CleansUpEveryStreamInOrder) {
+  std::vector<int> cleanups;
+  auto stream = zip_streams(
+      cleanup_tracking_stream<range_stream>{range_stream{0, 1}, 1, cleanups},
+      cleanup_tracking_stream<range_stream>{range_stream{0, 5}, 2, cleanups},
+      cleanup_tracking_stream<range_stream>{range_stream{0, 5}, 3, cleanups});
+
+  EXPECT_TRUE(sync_wait(next(stream)).has_value());
+  EXPECT_FALSE(sync_wait(next(stream)).has_value());
+  sync_wait(cleanup(stream));
+
+  EXPECT_EQ(cleanups, (std::vector<int>{1, 2, 3}));
+}